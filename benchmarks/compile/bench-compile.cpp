@@ -0,0 +1,283 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-object.h"
+#include "../src/codegen/emit.h"
+#include "../src/codegen/profile.h"
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+#include "../src/passes/pass-manager.h"
+
+/*
+ * The time of each phase of the compiler on synthetic sources that grow
+ * with the second argument of the benchmarks:
+ *
+ *   0: deep-expressions  8 functions with expressions nested N times
+ *   1: many-functions    N functions of a few lines
+ *   2: for-nests         8 functions with N nested `for`
+ *
+ * The phases before the measured one run with the timing paused. To keep
+ * the results, e.g. to compare two commits:
+ *
+ *   arx_compile_benchmarks --benchmark_out=compile.json \
+ *     --benchmark_out_format=json
+ */
+
+static const char* CORPORA[] = {
+  "deep-expressions", "many-functions", "for-nests"};
+static const char* OPERATORS[] = {" + ", " * ", " - "};
+
+/**
+ * @brief Get the source of a corpus of the given size.
+ *
+ */
+static auto make_source(int64_t corpus, int64_t size) -> std::string {
+  std::string source;
+  int64_t count = corpus == 1 ? size : 8;
+  for (int64_t i = 0; i < count; ++i) {
+    std::string name = "kernel" + std::to_string(i);
+    if (corpus == 0) {
+      std::string expr = "x";
+      for (int64_t depth = 0; depth < size; ++depth) {
+        expr = "(" + expr + OPERATORS[depth % 3] +
+          (depth % 2 ? "y" : std::to_string(depth + i)) + ")";
+      }
+      source += "fn " + name + "(x, y):\n  " + expr + "\n\n";
+    } else if (corpus == 1) {
+      source += "fn " + name + "(x, y, z):\n";
+      source += "  var a = x * y, b = y + z in\n";
+      source += "  if a < b: a * " + std::to_string(i);
+      source += " + b else: a - b\n\n";
+    } else {
+      std::string body = "total = total + i0";
+      std::string loops;
+      for (int64_t depth = 0; depth < size; ++depth) {
+        std::string var = "i" + std::to_string(depth);
+        loops += "for " + var + " = 0, " + var + " < n in ";
+        body += depth > 0 ? " * " + var : "";
+      }
+      source += "fn " + name + "(n):\n";
+      source += "  var total = 0 in\n";
+      source += "    (" + loops + body + ") + total\n\n";
+    }
+  }
+  return source;
+}
+
+/**
+ * @brief The corpora and their sizes.
+ *
+ */
+static void corpora(benchmark::internal::Benchmark* bench) {
+  bench->ArgNames({"corpus", "size"});
+  for (int64_t size : {64, 512}) {
+    bench->Args({0, size});
+  }
+  for (int64_t size : {64, 512}) {
+    bench->Args({1, size});
+  }
+  for (int64_t size : {4, 16}) {
+    bench->Args({2, size});
+  }
+}
+
+/**
+ * @brief Parse the source of the benchmark.
+ *
+ */
+static auto parse(const std::string& source) -> std::unique_ptr<TreeAST> {
+  Parser::setup();
+  string_to_buffer(source);
+  Lexer::reset();
+  return Parser::parse();
+}
+
+/**
+ * @brief Generate the code of the source in ArxLLVM::module, for the host.
+ *
+ */
+static auto generate_ir(
+  const std::string& source, llvm::TargetMachine& machine) -> void {
+  auto ast = parse(source);
+  ASTToObjectVisitor codegen;
+  codegen.initialize();
+  codegen.main_loop(*ast);
+  ArxLLVM::module->setTargetTriple(machine.getTargetTriple().str());
+  ArxLLVM::module->setDataLayout(machine.createDataLayout());
+}
+
+/**
+ * @brief Count the instructions of ArxLLVM::module.
+ *
+ */
+static auto count_instructions() -> int64_t {
+  int64_t count = 0;
+  for (auto& fn : ArxLLVM::module->functions()) {
+    count += fn.getInstructionCount();
+  }
+  return count;
+}
+
+/**
+ * @brief Create the target machine of the host.
+ * @return nullptr if it can't be created, with the error of the benchmark.
+ */
+static auto create_machine(benchmark::State& state)
+  -> std::unique_ptr<llvm::TargetMachine> {
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+  auto machine_builder = llvm::orc::JITTargetMachineBuilder::detectHost();
+  if (!machine_builder) {
+    llvm::consumeError(machine_builder.takeError());
+    state.SkipWithError("The host target machine could not be created");
+    return nullptr;
+  }
+  auto machine = machine_builder->createTargetMachine();
+  if (!machine) {
+    llvm::consumeError(machine.takeError());
+    state.SkipWithError("The host target machine could not be created");
+    return nullptr;
+  }
+  return std::move(*machine);
+}
+
+// the tokens of the source, bytes_per_second is the speed of the lexer
+static void BM_Lex(benchmark::State& state) {
+  std::string source = make_source(state.range(0), state.range(1));
+  int64_t tokens = 0;
+
+  for (auto _ : state) {
+    string_to_buffer(source);
+    Lexer::reset();
+    tokens = 0;
+    while (Lexer::get_next_token() != tok_eof) {
+      ++tokens;
+    }
+  }
+
+  state.SetLabel(CORPORA[state.range(0)]);
+  state.SetBytesProcessed(
+    state.iterations() * static_cast<int64_t>(source.size()));
+  state.counters["tokens"] = static_cast<double>(tokens);
+}
+
+// the AST of the source, items_per_second is the number of nodes per
+// second
+static void BM_Parse(benchmark::State& state) {
+  std::string source = make_source(state.range(0), state.range(1));
+
+  for (auto _ : state) {
+    auto ast = parse(source);
+    benchmark::DoNotOptimize(ast.get());
+  }
+
+  // an empty pass just counts the nodes
+  auto ast = parse(source);
+  ASTPass counter("count");
+  counter.run(*ast);
+
+  state.SetLabel(CORPORA[state.range(0)]);
+  state.SetBytesProcessed(
+    state.iterations() * static_cast<int64_t>(source.size()));
+  state.SetItemsProcessed(state.iterations() * counter.nodes);
+  state.counters["nodes"] = counter.nodes;
+}
+
+// the LLVM IR of the AST, items_per_second is the number of instructions
+// per second
+static void BM_IRGen(benchmark::State& state) {
+  std::string source = make_source(state.range(0), state.range(1));
+  int64_t instructions = 0;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ast = parse(source);
+    state.ResumeTiming();
+
+    ASTToObjectVisitor codegen;
+    codegen.initialize();
+    codegen.main_loop(*ast);
+    instructions = count_instructions();
+  }
+
+  state.SetLabel(CORPORA[state.range(0)]);
+  state.SetItemsProcessed(state.iterations() * instructions);
+  state.counters["instructions"] = static_cast<double>(instructions);
+}
+
+// the O2 pipeline of the compiler (see ArxProfile::optimize) on the IR
+static void BM_Optimize(benchmark::State& state) {
+  std::unique_ptr<llvm::TargetMachine> machine = create_machine(state);
+  if (!machine) {
+    return;
+  }
+  std::string source = make_source(state.range(0), state.range(1));
+  int64_t instructions = 0;
+  int64_t optimized = 0;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    generate_ir(source, *machine);
+    instructions = count_instructions();
+    state.ResumeTiming();
+
+    ArxProfile::optimize(*ArxLLVM::module, machine.get());
+    optimized = count_instructions();
+  }
+
+  state.SetLabel(CORPORA[state.range(0)]);
+  state.SetItemsProcessed(state.iterations() * instructions);
+  state.counters["instructions"] = static_cast<double>(instructions);
+  state.counters["optimized"] = static_cast<double>(optimized);
+}
+
+// the object of the IR, written by the backend of the host
+static void BM_Emit(benchmark::State& state) {
+  std::unique_ptr<llvm::TargetMachine> machine = create_machine(state);
+  if (!machine) {
+    return;
+  }
+  llvm::SmallString<128> path;
+  if (llvm::sys::fs::createTemporaryFile("arx-bench", "o", path)) {
+    state.SkipWithError("The object file could not be created");
+    return;
+  }
+  std::string source = make_source(state.range(0), state.range(1));
+  int64_t instructions = 0;
+  uint64_t object_size = 0;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    generate_ir(source, *machine);
+    instructions = count_instructions();
+    state.ResumeTiming();
+
+    if (!ArxEmit::write(*ArxLLVM::module, machine.get(), path.c_str())) {
+      state.SkipWithError("The object could not be written");
+      break;
+    }
+  }
+
+  llvm::sys::fs::file_size(path, object_size);
+  llvm::sys::fs::remove(path);
+  state.SetLabel(CORPORA[state.range(0)]);
+  state.SetItemsProcessed(state.iterations() * instructions);
+  state.counters["object_bytes"] = static_cast<double>(object_size);
+}
+
+BENCHMARK(BM_Lex)->Apply(corpora);
+BENCHMARK(BM_Parse)->Apply(corpora);
+BENCHMARK(BM_IRGen)->Apply(corpora)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Optimize)->Apply(corpora)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Emit)->Apply(corpora)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-llvm-ir.h"
+#include "../src/codegen/debug-info.h"
+#include "../src/codegen/emit.h"
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+
+static const char* LEVELS[] = {"none", "line-tables-only", "full"};
+
+/**
+ * @brief Get a source with `count` functions of a few lines.
+ *
+ */
+static auto make_source(int64_t count) -> std::string {
+  std::string source;
+  for (int64_t i = 0; i < count; ++i) {
+    std::string name = "kernel" + std::to_string(i);
+    source += "fn " + name + "(x, y, z):\n";
+    source += "  var a = x * y, b = y + z in\n";
+    source += "  if a < b: a * " + std::to_string(i) + " + b else: a - b\n\n";
+  }
+  return source;
+}
+
+// the time of the code generation and of the object, and the size of the
+// object, at each level of -g (0: none, 1: line-tables-only, 2: full)
+static void BM_CompileDebugInfo(benchmark::State& state) {
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+  auto machine_builder = llvm::orc::JITTargetMachineBuilder::detectHost();
+  if (!machine_builder) {
+    llvm::consumeError(machine_builder.takeError());
+    state.SkipWithError("The host target machine could not be created");
+    return;
+  }
+  auto machine = machine_builder->createTargetMachine();
+  if (!machine) {
+    llvm::consumeError(machine.takeError());
+    state.SkipWithError("The host target machine could not be created");
+    return;
+  }
+
+  llvm::SmallString<128> path;
+  if (llvm::sys::fs::createTemporaryFile("arx-bench", "o", path)) {
+    state.SkipWithError("The object file could not be created");
+    return;
+  }
+
+  std::string source = make_source(state.range(1));
+  ArxDebugInfo::level = LEVELS[state.range(0)];
+  INPUT_FILE = "kernels.arx";
+  uint64_t object_size = 0;
+
+  for (auto _ : state) {
+    Parser::setup();
+    string_to_buffer(source);
+    Lexer::reset();
+    auto ast = Parser::parse();
+
+    ASTToLLVMIRVisitor codegen;
+    codegen.initialize();
+    codegen.main_loop(*ast);
+    ArxDebugInfo::finalize();
+    ArxLLVM::module->setTargetTriple((*machine)->getTargetTriple().str());
+    ArxLLVM::module->setDataLayout((*machine)->createDataLayout());
+
+    if (!ArxEmit::write(*ArxLLVM::module, machine->get(), path.c_str())) {
+      state.SkipWithError("The object could not be written");
+      break;
+    }
+    llvm::sys::fs::file_size(path, object_size);
+  }
+
+  ArxDebugInfo::level = "none";
+  INPUT_FILE = "";
+  llvm::sys::fs::remove(path);
+  state.SetLabel(LEVELS[state.range(0)]);
+  state.counters["object_bytes"] = static_cast<double>(object_size);
+}
+
+BENCHMARK(BM_CompileDebugInfo)
+  ->ArgsProduct({{0, 1, 2}, {16, 256}})
+  ->Unit(benchmark::kMillisecond);
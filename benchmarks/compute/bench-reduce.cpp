@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+
+// float (*)(float)
+using arx_fn_t = float (*)(float);
+
+/**
+ * @brief JIT-compile the Arx reductions used by the benchmarks.
+ *
+ */
+static auto get_function(const char* name) -> arx_fn_t {
+  static ASTToJITVisitor codegen;
+  static bool compiled = false;
+
+  if (!compiled) {
+    Parser::setup();
+    string_to_buffer((char*) R""""(
+  fn loop_sum_squares(n):
+    var acc = 0 in
+      (for i = 0, i < n in acc = acc + i * i) + acc
+
+  fn builtin_sum_squares(n):
+    sum(i = 0, n, i * i)
+  )"""");
+    Lexer::reset();
+    auto ast = Parser::parse();
+
+    codegen.initialize();
+    codegen.main_loop(*ast);
+    codegen.optimize();
+    codegen.add_module();
+    compiled = true;
+  }
+  return reinterpret_cast<arx_fn_t>(codegen.lookup(name));
+}
+
+/**
+ * @brief Run a reduction of `state.range(0)` squares.
+ *
+ */
+static auto run_reduction(benchmark::State& state, const char* name)
+  -> void {
+  arx_fn_t fn = get_function(name);
+  if (!fn) {
+    state.SkipWithError("Arx functions could not be compiled");
+    return;
+  }
+
+  float n = static_cast<float>(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fn(n));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// hand-written `for` loop with a `var` accumulator
+static void BM_ArxLoopSum(benchmark::State& state) {
+  run_reduction(state, "loop_sum_squares");
+}
+
+// `sum` builtin: fused loop with a phi accumulator
+static void BM_ArxBuiltinSum(benchmark::State& state) {
+  run_reduction(state, "builtin_sum_squares");
+}
+
+BENCHMARK(BM_ArxLoopSum)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_ArxBuiltinSum)->Range(1 << 10, 1 << 20);
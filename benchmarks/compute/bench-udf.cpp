@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+
+#include <arrow/api.h>
+#include <arrow/compute/api.h>
+
+#include "../src/compute/udf.h"
+
+/**
+ * @brief Registry with the Arx functions used by the benchmarks.
+ *
+ */
+static auto get_registry() -> arrow::compute::FunctionRegistry* {
+  static std::unique_ptr<arrow::compute::FunctionRegistry> registry;
+
+  if (!registry) {
+    registry = arrow::compute::FunctionRegistry::Make(
+      arrow::compute::GetFunctionRegistry());
+    auto status = ArxUDF::register_functions(
+      R""""(
+  fn average(x, y):
+    (x + y) * 0.5
+  )"""",
+      registry.get(),
+      "arx_");
+    if (!status.ok()) {
+      return nullptr;
+    }
+  }
+  return registry.get();
+}
+
+static auto make_array(int64_t size, float start)
+  -> std::shared_ptr<arrow::Array> {
+  arrow::FloatBuilder builder;
+  if (!builder.Reserve(size).ok()) {
+    return nullptr;
+  }
+  for (int64_t i = 0; i < size; ++i) {
+    builder.UnsafeAppend(start + static_cast<float>(i % 1024));
+  }
+  return builder.Finish().ValueOrDie();
+}
+
+// (x + y) * 0.5 as a single JIT-compiled Arx kernel
+static void BM_ArxUDFAverage(benchmark::State& state) {
+  auto registry = get_registry();
+  if (!registry) {
+    state.SkipWithError("Arx functions could not be registered");
+    return;
+  }
+
+  arrow::compute::ExecContext ctx(
+    arrow::default_memory_pool(), nullptr, registry);
+  auto x = make_array(state.range(0), 1);
+  auto y = make_array(state.range(0), 2);
+
+  for (auto _ : state) {
+    auto result = arrow::compute::CallFunction("arx_average", {x, y}, &ctx);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// (x + y) * 0.5 with the Arrow built-in compute functions
+static void BM_ArrowAverage(benchmark::State& state) {
+  auto x = make_array(state.range(0), 1);
+  auto y = make_array(state.range(0), 2);
+
+  for (auto _ : state) {
+    auto sum = arrow::compute::Add(x, y).ValueOrDie();
+    auto result = arrow::compute::Multiply(sum, arrow::Datum(0.5f));
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ArxUDFAverage)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_ArrowAverage)->Range(1 << 10, 1 << 22);
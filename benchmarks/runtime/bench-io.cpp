@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+
+#include "../src/arx-io.h"
+
+/**
+ * @brief Get the values printed by the benchmarks, from 0 to 1e6.
+ *
+ */
+static auto get_value(int64_t i) -> float {
+  return static_cast<float>(i % 1000000) * 1.37f;
+}
+
+/**
+ * @brief Print `state.range(0)` floats with fprintf to /dev/null.
+ *
+ */
+static auto run_fprintf(benchmark::State& state, const char* format)
+  -> void {
+  FILE* file = fopen("/dev/null", "w");
+  if (!file) {
+    state.SkipWithError("/dev/null could not be opened");
+    return;
+  }
+
+  for (auto _ : state) {
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      fprintf(file, format, get_value(i));
+    }
+    fflush(file);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  fclose(file);
+}
+
+/**
+ * @brief Print `state.range(0)` floats with ArxWriter to /dev/null.
+ *
+ */
+static auto run_writer(benchmark::State& state, bool is_fixed) -> void {
+  FILE* file = fopen("/dev/null", "w");
+  if (!file) {
+    state.SkipWithError("/dev/null could not be opened");
+    return;
+  }
+
+  {
+    ArxWriter writer(file);
+    char text[64];
+    for (auto _ : state) {
+      for (int64_t i = 0; i < state.range(0); ++i) {
+        char* end = arx_format_float(
+          text, text + sizeof(text) - 1, get_value(i), is_fixed);
+        *end++ = '\n';
+        writer.write(text, static_cast<size_t>(end - text));
+      }
+      writer.flush();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  fclose(file);
+}
+
+// the format of printd
+static void BM_FprintfFixed(benchmark::State& state) {
+  run_fprintf(state, "%f\n");
+}
+
+// the digits needed to read back any float
+static void BM_FprintfRoundTrip(benchmark::State& state) {
+  run_fprintf(state, "%.9g\n");
+}
+
+// printd
+static void BM_WriterFixed(benchmark::State& state) {
+  run_writer(state, true);
+}
+
+// arx_print
+static void BM_WriterShortest(benchmark::State& state) {
+  run_writer(state, false);
+}
+
+BENCHMARK(BM_FprintfFixed)->Arg(1 << 20);
+BENCHMARK(BM_FprintfRoundTrip)->Arg(1 << 20);
+BENCHMARK(BM_WriterFixed)->Arg(1 << 20);
+BENCHMARK(BM_WriterShortest)->Arg(1 << 20);
@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <vector>
+
+#include "../src/arx-math.h"
+
+/**
+ * @brief Get `state.range(0)` values in [-10, 10).
+ *
+ */
+static auto get_values(benchmark::State& state) -> std::vector<float> {
+  std::vector<float> values(static_cast<size_t>(state.range(0)));
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = static_cast<float>(i % 2000) * 0.01f - 10.0f;
+  }
+  return values;
+}
+
+/**
+ * @brief Apply the vector function to the values, 4 lanes at a time.
+ *
+ */
+template <typename Fn>
+static auto run_vector(benchmark::State& state, Fn fn) -> void {
+  std::vector<float> values = get_values(state);
+  std::vector<float> results(values.size());
+  for (auto _ : state) {
+    for (size_t i = 0; i + 4 <= values.size(); i += 4) {
+      arx_f32x4_t x = {values[i], values[i + 1], values[i + 2], values[i + 3]};
+      arx_f32x4_t y = fn(x);
+      for (size_t lane = 0; lane < 4; ++lane) {
+        results[i + lane] = y[lane];
+      }
+    }
+    benchmark::DoNotOptimize(results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * @brief Apply the scalar function of libm to the values.
+ *
+ */
+template <typename Fn>
+static auto run_scalar(benchmark::State& state, Fn fn) -> void {
+  std::vector<float> values = get_values(state);
+  std::vector<float> results(values.size());
+  for (auto _ : state) {
+    for (size_t i = 0; i < values.size(); ++i) {
+      results[i] = fn(values[i]);
+    }
+    benchmark::DoNotOptimize(results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_ArxExp(benchmark::State& state) {
+  run_vector(state, arx_exp_f32x4);
+}
+
+static void BM_LibmExp(benchmark::State& state) {
+  run_scalar(state, [](float x) { return std::exp(x); });
+}
+
+static void BM_ArxLog(benchmark::State& state) {
+  run_vector(state, [](arx_f32x4_t x) { return arx_log_f32x4(x + 11.0f); });
+}
+
+static void BM_LibmLog(benchmark::State& state) {
+  run_scalar(state, [](float x) { return std::log(x + 11.0f); });
+}
+
+static void BM_ArxSin(benchmark::State& state) {
+  run_vector(state, arx_sin_f32x4);
+}
+
+static void BM_LibmSin(benchmark::State& state) {
+  run_scalar(state, [](float x) { return std::sin(x); });
+}
+
+BENCHMARK(BM_ArxExp)->Arg(1 << 16);
+BENCHMARK(BM_LibmExp)->Arg(1 << 16);
+BENCHMARK(BM_ArxLog)->Arg(1 << 16);
+BENCHMARK(BM_LibmLog)->Arg(1 << 16);
+BENCHMARK(BM_ArxSin)->Arg(1 << 16);
+BENCHMARK(BM_LibmSin)->Arg(1 << 16);
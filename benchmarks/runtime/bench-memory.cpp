@@ -0,0 +1,34 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstdlib>
+
+#include "../src/arx-memory.h"
+
+/**
+ * @brief Allocate and release blocks of `state.range(0)` bytes with the
+ *        allocator of the arrays.
+ *
+ */
+static void BM_ArxAlloc(benchmark::State& state) {
+  int64_t size = state.range(0);
+  for (auto _ : state) {
+    void* ptr = arx_alloc(size);
+    benchmark::DoNotOptimize(ptr);
+    arx_free(ptr);
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+// the baseline: zero filled blocks without alignment
+static void BM_Calloc(benchmark::State& state) {
+  auto size = static_cast<size_t>(state.range(0));
+  for (auto _ : state) {
+    void* ptr = std::calloc(1, size);
+    benchmark::DoNotOptimize(ptr);
+    std::free(ptr);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ArxAlloc)->Range(64, 1 << 20);
+BENCHMARK(BM_Calloc)->Range(64, 1 << 20);
@@ -0,0 +1,36 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+#include "../src/arx-parallel.h"
+
+/**
+ * @brief Sum the halves of the iterations, the body of the loops.
+ *
+ */
+static auto sum_halves(void*, int64_t begin, int64_t end) -> float {
+  float sum = 0;
+  for (int64_t i = begin; i < end; ++i) {
+    sum += static_cast<float>(i) * 0.5f;
+  }
+  return sum;
+}
+
+// a loop of `state.range(0)` iterations run by the thread pool
+static void BM_ArxParfor(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+      arx_parfor(sum_halves, nullptr, state.range(0), ARX_REDUCE_ADD));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// the same loop in the current thread
+static void BM_SerialLoop(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sum_halves(nullptr, 0, state.range(0)));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ArxParfor)->Range(1 << 10, 1 << 22)->UseRealTime();
+BENCHMARK(BM_SerialLoop)->Range(1 << 10, 1 << 22)->UseRealTime();
@@ -0,0 +1,153 @@
+#include "arx-io.h"      // for ArxWriter, arx_print, ARX_IO_BUFFER_SIZE
+#include <charconv>      // for to_chars, chars_format
+#include <cstdio>        // for FILE, fwrite, fflush, stdout, stderr
+#include <cstring>       // for memcpy
+#include <mutex>         // for lock_guard
+#include <system_error>  // for errc
+
+// enough for "%f" of the largest float (47 characters) and the new line
+static const size_t FLOAT_TEXT_SIZE = 64;
+
+ArxWriter::ArxWriter(FILE* file) : file(file), size(0) {}
+
+/**
+ * @brief Write the rest of the buffer, the writers of stdout and stderr are
+ *        destroyed at the exit of the process.
+ *
+ */
+ArxWriter::~ArxWriter() {
+  this->flush();
+}
+
+/**
+ * @brief Get the writer of stdout.
+ *
+ */
+auto ArxWriter::get_stdout() -> ArxWriter& {
+  static ArxWriter writer(stdout);
+  return writer;
+}
+
+/**
+ * @brief Get the writer of stderr.
+ *
+ */
+auto ArxWriter::get_stderr() -> ArxWriter& {
+  static ArxWriter writer(stderr);
+  return writer;
+}
+
+/**
+ * @brief Append `size` bytes to the buffer.
+ *
+ * The text larger than the buffer is written directly to the stream.
+ */
+auto ArxWriter::write(const char* data, size_t size) -> void {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (this->size + size > ARX_IO_BUFFER_SIZE) {
+    this->flush_buffer();
+  }
+  if (size > ARX_IO_BUFFER_SIZE) {
+    fwrite(data, 1, size, this->file);
+    return;
+  }
+  std::memcpy(this->buffer + this->size, data, size);
+  this->size += size;
+}
+
+/**
+ * @brief Write the buffer to the stream and flush the stream.
+ *
+ */
+auto ArxWriter::flush() -> void {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->flush_buffer();
+  fflush(this->file);
+}
+
+/**
+ * @brief Write the buffer to the stream, the mutex should be locked.
+ *
+ */
+auto ArxWriter::flush_buffer() -> void {
+  if (this->size > 0) {
+    fwrite(this->buffer, 1, this->size, this->file);
+    this->size = 0;
+  }
+}
+
+/**
+ * @brief Format a float in [first, last).
+ * @param is_fixed Format it as "%f", otherwise with the shortest text that
+ *        reads back to the same float.
+ * @return The end of the text.
+ */
+auto arx_format_float(char* first, char* last, float value, bool is_fixed)
+  -> char* {
+  auto result = is_fixed
+    ? std::to_chars(first, last, value, std::chars_format::fixed, 6)
+    : std::to_chars(first, last, value);
+  return result.ec == std::errc() ? result.ptr : first;
+}
+
+/**
+ * @brief Write the float and a new line to the stdout writer.
+ *
+ */
+static auto write_line(ArxWriter& writer, float value, bool is_fixed)
+  -> void {
+  char text[FLOAT_TEXT_SIZE];
+  char* end = arx_format_float(text, text + sizeof(text) - 1, value, is_fixed);
+  *end++ = '\n';
+  writer.write(text, static_cast<size_t>(end - text));
+}
+
+/**
+ * @brief Print the float to stdout with the shortest text that reads back
+ *        to the same float, returning 0.
+ *
+ */
+extern "C" DLLEXPORT auto arx_print(float value) -> float {
+  write_line(ArxWriter::get_stdout(), value, false);
+  return 0;
+}
+
+/**
+ * @brief putchar to stdout that takes a float and returns 0.
+ *
+ */
+extern "C" DLLEXPORT auto arx_putchar(float c) -> float {
+  char text = static_cast<char>(c);
+  ArxWriter::get_stdout().write(&text, 1);
+  return 0;
+}
+
+/**
+ * @brief Write the buffers of stdout and stderr, returning 0.
+ *
+ */
+extern "C" DLLEXPORT auto arx_flush() -> float {
+  ArxWriter::get_stdout().flush();
+  ArxWriter::get_stderr().flush();
+  return 0;
+}
+
+/**
+ * @brief putchar to stderr that takes a float and returns 0.
+ *
+ */
+extern "C" DLLEXPORT auto putchard(float c) -> float {
+  char text = static_cast<char>(c);
+  ArxWriter::get_stderr().write(&text, 1);
+  return 0;
+}
+
+/**
+ * @brief printf to stderr that takes a float, prints it as "%f\n" and
+ *        returns 0.
+ *
+ */
+extern "C" DLLEXPORT auto printd(float value) -> float {
+  write_line(ArxWriter::get_stderr(), value, true);
+  return 0;
+}
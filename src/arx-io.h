@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for int32_t
+#include <cstdio>   // for FILE
+#include <mutex>    // for mutex
+
+/*
+ * Output of the generated code.
+ *
+ * The text is written to a buffer per stream, and the buffer is written to
+ * the stream with a single call when it is full, when it is flushed with
+ * arx_flush (after each batch of a JIT kernel, at the end of
+ * ArxStream::run and before an abort) and at the exit of the process. So
+ * printing a value costs a copy instead of a system call. The floats are
+ * formatted with std::to_chars (Ryu): arx_print writes the shortest text
+ * that reads back to the same float, printd keeps the 6 decimals of "%f".
+ *
+ * The functions take and return floats, so they can be declared with
+ * `extern` in the Arx sources:
+ *
+ *   extern arx_print(x)
+ */
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+const size_t ARX_IO_BUFFER_SIZE = 1 << 16;
+
+/**
+ * @brief Buffered writer of a stream, it can be used by several threads.
+ *
+ */
+class ArxWriter {
+ public:
+  explicit ArxWriter(FILE* file);
+  ~ArxWriter();
+
+  static auto get_stdout() -> ArxWriter&;
+  static auto get_stderr() -> ArxWriter&;
+
+  auto write(const char* data, size_t size) -> void;
+  auto flush() -> void;
+
+ private:
+  FILE* file;
+  std::mutex mutex;
+  size_t size;
+  char buffer[ARX_IO_BUFFER_SIZE];
+
+  auto flush_buffer() -> void;
+};
+
+auto arx_format_float(char* first, char* last, float value, bool is_fixed)
+  -> char*;
+
+extern "C" {
+DLLEXPORT auto arx_print(float value) -> float;
+DLLEXPORT auto arx_putchar(float c) -> float;
+DLLEXPORT auto arx_flush() -> float;
+DLLEXPORT auto putchard(float c) -> float;
+DLLEXPORT auto printd(float value) -> float;
+}
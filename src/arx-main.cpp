@@ -0,0 +1,31 @@
+#include <cmath>   // for isnan
+#include <limits>  // for numeric_limits
+
+#include "arx-io.h"  // for arx_flush
+
+/*
+ * Entry point of the programs compiled by arx.
+ *
+ * The `main` function of the Arx source is emitted as `arx_main` (see
+ * compile_object), and this `main` calls it. The buffered output is
+ * written before the exit, and the result of `arx_main` is the exit code:
+ * it is clamped to the range of int, and NaN is a failure.
+ */
+
+extern "C" auto arx_main() -> float;
+
+auto main() -> int {
+  float result = arx_main();
+  arx_flush();
+  if (std::isnan(result)) {
+    return 1;
+  }
+  // 2^31 is the first float out of the int range
+  if (result >= 2147483648.0F) {
+    return std::numeric_limits<int>::max();
+  }
+  if (result < -2147483648.0F) {
+    return std::numeric_limits<int>::min();
+  }
+  return static_cast<int>(result);
+}
@@ -0,0 +1,279 @@
+#include "arx-math.h"  // for arx_sqrt, arx_sin, arx_f32x4_t, ...
+#include <bit>         // for bit_cast
+#include <cfloat>      // for FLT_MIN, FLT_MAX
+#include <cmath>       // for sqrt, exp, log, pow, sin, cos, ...
+#include <cstdint>     // for int32_t, INT32_MIN
+
+// the lane masks of the comparisons of arx_f32x4_t: -1 (true) or 0
+typedef int32_t arx_i32x4_t __attribute__((vector_size(16)));
+typedef double arx_f64x4_t __attribute__((vector_size(32)));
+
+const int ARX_F32X4_LANES = 4;
+
+/**
+ * @brief Square root.
+ *
+ */
+extern "C" DLLEXPORT auto arx_sqrt(float x) -> float {
+  return std::sqrt(x);
+}
+
+/**
+ * @brief Exponential.
+ *
+ */
+extern "C" DLLEXPORT auto arx_exp(float x) -> float {
+  return std::exp(x);
+}
+
+/**
+ * @brief Natural logarithm.
+ *
+ */
+extern "C" DLLEXPORT auto arx_log(float x) -> float {
+  return std::log(x);
+}
+
+/**
+ * @brief `x` to the power `y`.
+ *
+ */
+extern "C" DLLEXPORT auto arx_pow(float x, float y) -> float {
+  return std::pow(x, y);
+}
+
+/**
+ * @brief Sine, in radians.
+ *
+ */
+extern "C" DLLEXPORT auto arx_sin(float x) -> float {
+  return std::sin(x);
+}
+
+/**
+ * @brief Cosine, in radians.
+ *
+ */
+extern "C" DLLEXPORT auto arx_cos(float x) -> float {
+  return std::cos(x);
+}
+
+/**
+ * @brief Tangent, in radians.
+ *
+ */
+extern "C" DLLEXPORT auto arx_tan(float x) -> float {
+  return std::tan(x);
+}
+
+/**
+ * @brief Largest integer not greater than `x`.
+ *
+ */
+extern "C" DLLEXPORT auto arx_floor(float x) -> float {
+  return std::floor(x);
+}
+
+/**
+ * @brief Smallest integer not less than `x`.
+ *
+ */
+extern "C" DLLEXPORT auto arx_ceil(float x) -> float {
+  return std::ceil(x);
+}
+
+/**
+ * @brief Absolute value.
+ *
+ */
+extern "C" DLLEXPORT auto arx_abs(float x) -> float {
+  return std::fabs(x);
+}
+
+//===----------------------------------------------------------------------===
+// Vector variants
+//===----------------------------------------------------------------------===
+
+/**
+ * @brief Select the lanes of `a` where the mask is true, else of `b`.
+ *
+ */
+static auto select(arx_i32x4_t mask, arx_f32x4_t a, arx_f32x4_t b)
+  -> arx_f32x4_t {
+  return std::bit_cast<arx_f32x4_t>(
+    (std::bit_cast<arx_i32x4_t>(a) & mask) |
+    (std::bit_cast<arx_i32x4_t>(b) & ~mask));
+}
+
+/**
+ * @brief exp of the lanes in [-87.3, 88.3].
+ *
+ * x = n ln(2) + r, with |r| <= ln(2) / 2, and exp(x) = 2^n exp(r).
+ */
+static auto exp_kernel(arx_f32x4_t x) -> arx_f32x4_t {
+  // round to the nearest integer, in the float
+  const float round = 12582912.0f;  // 1.5 * 2^23
+  arx_f32x4_t n = (x * 1.44269504088896341f + round) - round;
+  arx_f32x4_t r = x - n * 0.693359375f - n * -2.12194440e-4f;
+
+  arx_f32x4_t p = 1.9875691500e-4f * r + 1.3981999507e-3f;
+  p = p * r + 8.3334519073e-3f;
+  p = p * r + 4.1665795894e-2f;
+  p = p * r + 1.6666665459e-1f;
+  p = p * r + 5.0000001201e-1f;
+  p = p * r * r + r + 1.0f;
+
+  // 2^n, built from its exponent bits
+  arx_i32x4_t exponent = (__builtin_convertvector(n, arx_i32x4_t) + 127)
+    << 23;
+  return p * std::bit_cast<arx_f32x4_t>(exponent);
+}
+
+/**
+ * @brief log of the lanes that are positive normal floats.
+ *
+ * x = m 2^e, with m in [sqrt(0.5), sqrt(2)), and log(x) = log(m) + e ln(2).
+ */
+static auto log_kernel(arx_f32x4_t x) -> arx_f32x4_t {
+  arx_i32x4_t bits = std::bit_cast<arx_i32x4_t>(x);
+  arx_i32x4_t e = ((bits >> 23) & 0xff) - 126;
+  arx_f32x4_t m = std::bit_cast<arx_f32x4_t>((bits & 0x007fffff) | 0x3f000000);
+
+  // m in [0.5, 1): below sqrt(0.5), 2m - 1 and e - 1, else m - 1
+  arx_i32x4_t is_small = m < 0.707106781186547524f;
+  e = e + is_small;
+  m = m + select(is_small, m, arx_f32x4_t{}) - 1.0f;
+  arx_f32x4_t ef = __builtin_convertvector(e, arx_f32x4_t);
+
+  arx_f32x4_t z = m * m;
+  arx_f32x4_t p = 7.0376836292e-2f * m - 1.1514610310e-1f;
+  p = p * m + 1.1676998740e-1f;
+  p = p * m - 1.2420140846e-1f;
+  p = p * m + 1.4249322787e-1f;
+  p = p * m - 1.6668057665e-1f;
+  p = p * m + 2.0000714765e-1f;
+  p = p * m - 2.4999993993e-1f;
+  p = p * m + 3.3333331174e-1f;
+  arx_f32x4_t y = p * m * z + ef * -2.12194440e-4f - 0.5f * z;
+  return m + y + ef * 0.693359375f;
+}
+
+/**
+ * @brief sin (`is_cos` false) or cos of the lanes in [-8192, 8192].
+ *
+ * The lanes are reduced to [-pi/4, pi/4] in the octant j (even), and
+ * computed with the polynomial of sin or cos of the octant.
+ */
+static auto sin_cos_kernel(arx_f32x4_t x, bool is_cos) -> arx_f32x4_t {
+  arx_i32x4_t bits = std::bit_cast<arx_i32x4_t>(x);
+  arx_f32x4_t ax = std::bit_cast<arx_f32x4_t>(bits & 0x7fffffff);
+
+  // note: the reduction is in double, so the lanes close to the multiples
+  //       of pi/4 keep their precision; pi/4 = PIO4_HI + PIO4_LO, where
+  //       y * PIO4_HI is exact.
+  const double PIO4_HI = 0x1.921fb544p-1;
+  const double PIO4_LO = 3.038550253253096e-11;
+  arx_f64x4_t dx = __builtin_convertvector(ax, arx_f64x4_t);
+  arx_i32x4_t j =
+    __builtin_convertvector(dx * 1.2732395447351628, arx_i32x4_t);
+  j = (j + 1) & ~1;
+  arx_f64x4_t y = __builtin_convertvector(j, arx_f64x4_t);
+  arx_f32x4_t r =
+    __builtin_convertvector((dx - y * PIO4_HI) - y * PIO4_LO, arx_f32x4_t);
+  arx_f32x4_t z = r * r;
+
+  arx_f32x4_t cos_poly = 2.443315711809948e-5f * z - 1.388731625493765e-3f;
+  cos_poly = cos_poly * z + 4.166664568298827e-2f;
+  cos_poly = cos_poly * z * z - 0.5f * z + 1.0f;
+
+  arx_f32x4_t sin_poly = -1.9515295891e-4f * z + 8.3321608736e-3f;
+  sin_poly = sin_poly * z - 1.6666654611e-1f;
+  sin_poly = sin_poly * z * r + r;
+
+  // sin: the sign of x, cos: even, one octant later
+  arx_i32x4_t sign =
+    is_cos ? ((j + 2) & 4) << 29 : ((j & 4) << 29) ^ (bits & INT32_MIN);
+  arx_i32x4_t is_odd_octant = (j & 2) != 0;
+  arx_i32x4_t use_cos = is_cos ? ~is_odd_octant : is_odd_octant;
+  arx_f32x4_t result = select(use_cos, cos_poly, sin_poly);
+  return std::bit_cast<arx_f32x4_t>(std::bit_cast<arx_i32x4_t>(result) ^ sign);
+}
+
+/**
+ * @brief Apply the kernel to the lanes where `in_range` is true, and the
+ *        scalar function to the other lanes.
+ *
+ */
+template <typename Kernel, typename Scalar>
+static auto map_lanes(
+  arx_f32x4_t x, arx_i32x4_t in_range, Kernel kernel, Scalar scalar)
+  -> arx_f32x4_t {
+  // the kernels only see valid values
+  arx_f32x4_t result = kernel(select(in_range, x, arx_f32x4_t{} + 1.0f));
+  for (int i = 0; i < ARX_F32X4_LANES; ++i) {
+    if (!in_range[i]) {
+      result[i] = scalar(x[i]);
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief exp of 4 floats.
+ *
+ */
+extern "C" DLLEXPORT auto arx_exp_f32x4(arx_f32x4_t x) -> arx_f32x4_t {
+  return map_lanes(
+    x, x >= -87.3f && x <= 88.3f, exp_kernel, [](float v) {
+      return std::exp(v);
+    });
+}
+
+/**
+ * @brief log of 4 floats.
+ *
+ */
+extern "C" DLLEXPORT auto arx_log_f32x4(arx_f32x4_t x) -> arx_f32x4_t {
+  return map_lanes(
+    x, x >= FLT_MIN && x <= FLT_MAX, log_kernel, [](float v) {
+      return std::log(v);
+    });
+}
+
+/**
+ * @brief sin of 4 floats.
+ *
+ */
+extern "C" DLLEXPORT auto arx_sin_f32x4(arx_f32x4_t x) -> arx_f32x4_t {
+  return map_lanes(
+    x,
+    x >= -8192.0f && x <= 8192.0f,
+    [](arx_f32x4_t v) { return sin_cos_kernel(v, false); },
+    [](float v) { return std::sin(v); });
+}
+
+/**
+ * @brief cos of 4 floats.
+ *
+ */
+extern "C" DLLEXPORT auto arx_cos_f32x4(arx_f32x4_t x) -> arx_f32x4_t {
+  return map_lanes(
+    x,
+    x >= -8192.0f && x <= 8192.0f,
+    [](arx_f32x4_t v) { return sin_cos_kernel(v, true); },
+    [](float v) { return std::cos(v); });
+}
+
+/**
+ * @brief pow of 4 floats, lane by lane.
+ *
+ * exp(y log(x)) loses the precision of large results, so it uses libm.
+ */
+extern "C" DLLEXPORT auto arx_pow_f32x4(arx_f32x4_t x, arx_f32x4_t y)
+  -> arx_f32x4_t {
+  arx_f32x4_t result;
+  for (int i = 0; i < ARX_F32X4_LANES; ++i) {
+    result[i] = std::pow(x[i], y[i]);
+  }
+  return result;
+}
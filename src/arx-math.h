@@ -0,0 +1,47 @@
+#pragma once
+
+/*
+ * Math functions of the generated code.
+ *
+ * The functions of libm take doubles, so an Arx program that declares
+ * `extern sin(x)` passes a float where a double is expected. These
+ * functions take and return floats and use the float versions of libm
+ * (sinf, ...):
+ *
+ *   extern arx_sin(x)
+ *
+ * The builtins `exp`, `log`, `sin`, `cos` and `pow` of the vectors of
+ * floats call the vector variants (e.g. arx_exp_f32x4), and the loop
+ * vectorizer calls them for the loops that call the scalar builtins (see
+ * ArxMath). They compute the 4 lanes with the polynomials of Cephes, and
+ * the lanes out of the range of the polynomials (large, infinite or NaN
+ * values) with libm.
+ */
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+// the LLVM <4 x float>, passed in a vector register
+typedef float arx_f32x4_t __attribute__((vector_size(16)));
+
+extern "C" {
+DLLEXPORT auto arx_sqrt(float x) -> float;
+DLLEXPORT auto arx_exp(float x) -> float;
+DLLEXPORT auto arx_log(float x) -> float;
+DLLEXPORT auto arx_pow(float x, float y) -> float;
+DLLEXPORT auto arx_sin(float x) -> float;
+DLLEXPORT auto arx_cos(float x) -> float;
+DLLEXPORT auto arx_tan(float x) -> float;
+DLLEXPORT auto arx_floor(float x) -> float;
+DLLEXPORT auto arx_ceil(float x) -> float;
+DLLEXPORT auto arx_abs(float x) -> float;
+
+DLLEXPORT auto arx_exp_f32x4(arx_f32x4_t x) -> arx_f32x4_t;
+DLLEXPORT auto arx_log_f32x4(arx_f32x4_t x) -> arx_f32x4_t;
+DLLEXPORT auto arx_sin_f32x4(arx_f32x4_t x) -> arx_f32x4_t;
+DLLEXPORT auto arx_cos_f32x4(arx_f32x4_t x) -> arx_f32x4_t;
+DLLEXPORT auto arx_pow_f32x4(arx_f32x4_t x, arx_f32x4_t y) -> arx_f32x4_t;
+}
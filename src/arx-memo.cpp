@@ -0,0 +1,160 @@
+#include "arx-memo.h"  // for arx_memo_lookup, arx_memo_insert, ...
+#include <atomic>      // for atomic_ref, memory_order
+#include <cstdint>     // for int64_t, int32_t, uint64_t
+#include <thread>      // for yield
+
+/**
+ * @brief Hash the bits of the arguments (splitmix64 finalizer per slot).
+ *
+ */
+static auto hash_key(const int64_t* key, int32_t nargs) -> uint64_t {
+  uint64_t hash = 0x9e3779b97f4a7c15ULL * static_cast<uint64_t>(nargs + 1);
+  for (int32_t i = 0; i < nargs; ++i) {
+    hash ^= static_cast<uint64_t>(key[i]);
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+  }
+  // 0 is used for the empty entries
+  return hash | 1;
+}
+
+/**
+ * @brief Get the entry `idx` of the table.
+ *
+ */
+static auto get_entry(int64_t* table, int32_t nargs, uint64_t idx)
+  -> int64_t* {
+  return table + 1 + idx * static_cast<uint64_t>(nargs + 2);
+}
+
+/**
+ * @brief Check if the entry stores the key.
+ *
+ */
+static auto is_key(
+  const int64_t* entry, uint64_t hash, const int64_t* key, int32_t nargs)
+  -> bool {
+  if (static_cast<uint64_t>(entry[0]) != hash) {
+    return false;
+  }
+  for (int32_t i = 0; i < nargs; ++i) {
+    if (entry[2 + i] != key[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Lock the table for the thread-safe functions.
+ *
+ */
+class MemoLock {
+ public:
+  std::atomic_ref<int64_t> lock;
+
+  explicit MemoLock(int64_t* table) : lock(table[0]) {
+    int64_t expected = 0;
+    while (!this->lock.compare_exchange_weak(
+      expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+      expected = 0;
+      std::this_thread::yield();
+    }
+  }
+
+  ~MemoLock() {
+    this->lock.store(0, std::memory_order_release);
+  }
+};
+
+//===----------------------------------------------------------------------===
+// Functions used by the generated code.
+//===----------------------------------------------------------------------===
+
+/**
+ * @brief Find the result cached for the arguments.
+ * @return 1 and the result in `value` when it is found, otherwise 0.
+ */
+extern "C" DLLEXPORT auto arx_memo_lookup(
+  int64_t* table,
+  int32_t capacity,
+  int32_t nargs,
+  const int64_t* key,
+  int64_t* value) -> int32_t {
+  uint64_t hash = hash_key(key, nargs);
+  uint64_t mask = static_cast<uint64_t>(capacity) - 1;
+
+  for (uint64_t probe = 0; probe < ARX_MEMO_MAX_PROBES; ++probe) {
+    int64_t* entry = get_entry(table, nargs, (hash + probe) & mask);
+    if (entry[0] == 0) {
+      return 0;
+    }
+    if (is_key(entry, hash, key, nargs)) {
+      *value = entry[1];
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Cache the result for the arguments.
+ *
+ * The first free entry of the probe sequence is used, or the first entry
+ * when all of them are used by other keys.
+ */
+extern "C" DLLEXPORT auto arx_memo_insert(
+  int64_t* table,
+  int32_t capacity,
+  int32_t nargs,
+  const int64_t* key,
+  int64_t value) -> void {
+  uint64_t hash = hash_key(key, nargs);
+  uint64_t mask = static_cast<uint64_t>(capacity) - 1;
+
+  int64_t* entry = get_entry(table, nargs, hash & mask);
+  for (uint64_t probe = 0; probe < ARX_MEMO_MAX_PROBES; ++probe) {
+    int64_t* candidate = get_entry(table, nargs, (hash + probe) & mask);
+    if (candidate[0] == 0 || is_key(candidate, hash, key, nargs)) {
+      entry = candidate;
+      break;
+    }
+  }
+
+  entry[0] = static_cast<int64_t>(hash);
+  entry[1] = value;
+  for (int32_t i = 0; i < nargs; ++i) {
+    entry[2 + i] = key[i];
+  }
+}
+
+/**
+ * @brief Thread-safe arx_memo_lookup.
+ *
+ */
+extern "C" DLLEXPORT auto arx_memo_lookup_sync(
+  int64_t* table,
+  int32_t capacity,
+  int32_t nargs,
+  const int64_t* key,
+  int64_t* value) -> int32_t {
+  MemoLock lock(table);
+  return arx_memo_lookup(table, capacity, nargs, key, value);
+}
+
+/**
+ * @brief Thread-safe arx_memo_insert.
+ *
+ * The lock is not held while the result is computed, so two threads can
+ * compute the same result and the last one is cached.
+ */
+extern "C" DLLEXPORT auto arx_memo_insert_sync(
+  int64_t* table,
+  int32_t capacity,
+  int32_t nargs,
+  const int64_t* key,
+  int64_t value) -> void {
+  MemoLock lock(table);
+  arx_memo_insert(table, capacity, nargs, key, value);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>  // for int32_t, int64_t
+
+/*
+ * The cache of a memoized function (see `@memo`) is a zero initialized
+ * array of int64 emitted by the compiler for each function:
+ *
+ *   slot 0       a spin lock, used only by the thread-safe functions
+ *   slots 1..    `capacity` entries of `nargs + 2` slots each
+ *
+ * and an entry is:
+ *
+ *   slot 0       the hash of the key with the lowest bit set (0 is empty)
+ *   slot 1       the bits of the result
+ *   slots 2..    the bits of the arguments (the key)
+ *
+ * It is an open addressed table with linear probing, `capacity` is a power
+ * of two. A key is searched in at most ARX_MEMO_MAX_PROBES entries, and
+ * when all of them are used by other keys the first one is replaced, so
+ * the size is bounded and no memory is allocated at run time.
+ */
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+const int32_t ARX_MEMO_DEFAULT_CAPACITY = 1024;
+const int32_t ARX_MEMO_MAX_CAPACITY = 1 << 24;
+const int32_t ARX_MEMO_MAX_PROBES = 8;
+
+/**
+ * @brief Number of int64 slots used by a cache.
+ *
+ */
+inline auto arx_memo_table_size(int32_t capacity, int32_t nargs) -> int64_t {
+  return 1 + static_cast<int64_t>(capacity) * (nargs + 2);
+}
+
+extern "C" {
+DLLEXPORT auto arx_memo_lookup(
+  int64_t* table,
+  int32_t capacity,
+  int32_t nargs,
+  const int64_t* key,
+  int64_t* value) -> int32_t;
+DLLEXPORT auto arx_memo_insert(
+  int64_t* table,
+  int32_t capacity,
+  int32_t nargs,
+  const int64_t* key,
+  int64_t value) -> void;
+DLLEXPORT auto arx_memo_lookup_sync(
+  int64_t* table,
+  int32_t capacity,
+  int32_t nargs,
+  const int64_t* key,
+  int64_t* value) -> int32_t;
+DLLEXPORT auto arx_memo_insert_sync(
+  int64_t* table,
+  int32_t capacity,
+  int32_t nargs,
+  const int64_t* key,
+  int64_t value) -> void;
+}
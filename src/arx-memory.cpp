@@ -0,0 +1,56 @@
+#include "arx-memory.h"  // for arx_alloc, arx_free, ARX_ALLOC_ALIGNMENT
+#include <algorithm>     // for max
+#include <atomic>        // for atomic, memory_order_relaxed
+#include <cstdint>       // for int64_t
+#include <cstdio>        // for fprintf, stderr
+#include <cstdlib>       // for aligned_alloc, free, abort
+#include <cstring>       // for memset
+
+#include "arx-io.h"  // for arx_flush
+
+// the number of calls to arx_alloc in the process
+static std::atomic<int64_t> alloc_count(0);
+
+/**
+ * @brief Allocate a zero filled block of `size` bytes.
+ *
+ * The generated code doesn't check the result, so the process is aborted
+ * when there is no memory left.
+ */
+extern "C" DLLEXPORT auto arx_alloc(int64_t size) -> void* {
+  alloc_count.fetch_add(1, std::memory_order_relaxed);
+
+  // aligned_alloc needs a multiple of the alignment
+  auto aligned_size = static_cast<size_t>(
+    (std::max<int64_t>(size, 1) + ARX_ALLOC_ALIGNMENT - 1) /
+    ARX_ALLOC_ALIGNMENT * ARX_ALLOC_ALIGNMENT);
+  void* ptr = std::aligned_alloc(
+    static_cast<size_t>(ARX_ALLOC_ALIGNMENT), aligned_size);
+  if (!ptr) {
+    // the buffered output is written before the error
+    arx_flush();
+    fprintf(
+      stderr,
+      "Error: arx_alloc: out of memory (%lld bytes)\n",
+      static_cast<long long>(size));
+    std::abort();
+  }
+  return std::memset(ptr, 0, aligned_size);
+}
+
+/**
+ * @brief Release a block allocated by arx_alloc.
+ *
+ */
+extern "C" DLLEXPORT auto arx_free(void* ptr) -> void {
+  std::free(ptr);
+}
+
+/**
+ * @brief Get the number of blocks allocated by arx_alloc since the start of
+ *        the process.
+ *
+ */
+extern "C" DLLEXPORT auto arx_alloc_count() -> int64_t {
+  return alloc_count.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>  // for int64_t
+
+/*
+ * Heap memory of the generated code, e.g. the storage of the arrays (see
+ * datatypes.h). The blocks are zero filled and aligned to a cache line, so
+ * the vector loads of the array elements don't cross cache lines more than
+ * needed.
+ *
+ * The allocations are counted, so the tests and the benchmarks can check
+ * that a function doesn't use the heap (see ArxEscape).
+ */
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+const int64_t ARX_ALLOC_ALIGNMENT = 64;
+
+extern "C" {
+DLLEXPORT auto arx_alloc(int64_t size) -> void*;
+DLLEXPORT auto arx_free(void* ptr) -> void;
+DLLEXPORT auto arx_alloc_count() -> int64_t;
+}
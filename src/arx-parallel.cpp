@@ -0,0 +1,249 @@
+#include "arx-parallel.h"  // for ArxThreadPool, arx_parfor, ArxReduceOp
+#include <algorithm>        // for min, max
+#include <atomic>           // for atomic, memory_order
+#include <cmath>            // for fminf, fmaxf, INFINITY
+#include <cstdint>          // for int64_t, int32_t
+#include <cstdlib>          // for getenv, atoi
+#include <memory>           // for make_unique
+#include <mutex>            // for lock_guard, unique_lock
+#include <thread>           // for thread, yield
+#include <vector>           // for vector
+
+/**
+ * @brief The iterations of a `parfor` loop and their partial reductions.
+ *
+ */
+struct ArxParallelJob {
+  arx_parfor_body_t body;
+  void* env;
+  int64_t count;
+  int64_t chunk_size;
+  std::vector<float> partials;
+  std::atomic<int64_t> remaining;
+};
+
+// index of the worker run by the current thread, -1 for the other threads
+static thread_local int worker_idx = -1;
+
+/**
+ * @brief Get the neutral value of the reduction.
+ *
+ */
+static auto reduce_identity(int32_t op) -> float {
+  switch (op) {
+    case ARX_REDUCE_MUL:
+      return 1.0f;
+    case ARX_REDUCE_MIN:
+      return INFINITY;
+    case ARX_REDUCE_MAX:
+      return -INFINITY;
+    default:
+      return 0.0f;
+  }
+}
+
+/**
+ * @brief Combine two partial reductions, like the generated code.
+ *
+ * min and max ignore NaN, like llvm.minnum and llvm.maxnum.
+ */
+static auto reduce_combine(int32_t op, float lhs, float rhs) -> float {
+  switch (op) {
+    case ARX_REDUCE_ADD:
+      return lhs + rhs;
+    case ARX_REDUCE_MUL:
+      return lhs * rhs;
+    case ARX_REDUCE_MIN:
+      return fminf(lhs, rhs);
+    case ARX_REDUCE_MAX:
+      return fmaxf(lhs, rhs);
+    default:
+      return 0.0f;
+  }
+}
+
+/**
+ * @brief Run a chunk of a job.
+ *
+ * The job can be released by its thread as soon as `remaining` is 0, so
+ * it is the last access to it.
+ */
+static auto run_task(const ArxParallelTask& task) -> void {
+  ArxParallelJob* job = task.job;
+  int64_t begin = task.chunk * job->chunk_size;
+  int64_t end = std::min(job->count, begin + job->chunk_size);
+  job->partials[static_cast<size_t>(task.chunk)] =
+    job->body(job->env, begin, end);
+  job->remaining.fetch_sub(1, std::memory_order_release);
+}
+
+ArxThreadPool::ArxThreadPool(int num_threads) : pending(0), stop(false) {
+  for (int i = 0; i < num_threads; ++i) {
+    this->workers.emplace_back(std::make_unique<Worker>());
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    this->threads.emplace_back(&ArxThreadPool::work, this, i);
+  }
+}
+
+ArxThreadPool::~ArxThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(this->sleep_mutex);
+    this->stop = true;
+  }
+  this->sleep_cv.notify_all();
+  for (auto& thread : this->threads) {
+    thread.join();
+  }
+}
+
+/**
+ * @brief Get the pool of the process.
+ *
+ * The number of workers is ARX_NUM_THREADS, or the number of cores.
+ */
+auto ArxThreadPool::get() -> ArxThreadPool& {
+  static ArxThreadPool pool([]() {
+    const char* num_threads = std::getenv("ARX_NUM_THREADS");
+    if (num_threads && std::atoi(num_threads) > 0) {
+      return std::atoi(num_threads);
+    }
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }());
+  return pool;
+}
+
+auto ArxThreadPool::size() const -> int {
+  return static_cast<int>(this->workers.size());
+}
+
+/**
+ * @brief Get a task from the back of the worker deque, or steal one from
+ *        the front of the other deques.
+ * @param idx The worker index, or -1 to only steal.
+ */
+auto ArxThreadPool::pop(int idx, ArxParallelTask& task) -> bool {
+  int size = this->size();
+
+  if (idx >= 0) {
+    Worker& worker = *this->workers[static_cast<size_t>(idx)];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!worker.tasks.empty()) {
+      task = worker.tasks.back();
+      worker.tasks.pop_back();
+      this->pending.fetch_sub(1);
+      return true;
+    }
+  }
+
+  for (int i = 1; i <= size; ++i) {
+    int victim = (std::max(idx, 0) + i) % size;
+    if (victim == idx) {
+      continue;
+    }
+    Worker& worker = *this->workers[static_cast<size_t>(victim)];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!worker.tasks.empty()) {
+      task = worker.tasks.front();
+      worker.tasks.pop_front();
+      this->pending.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Main loop of a worker thread.
+ *
+ */
+auto ArxThreadPool::work(int idx) -> void {
+  worker_idx = idx;
+  ArxParallelTask task;
+
+  while (true) {
+    if (this->pop(idx, task)) {
+      run_task(task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(this->sleep_mutex);
+    this->sleep_cv.wait(
+      lock, [this]() { return this->stop || this->pending.load() > 0; });
+    if (this->stop) {
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Run all the chunks of the job, and wait for them.
+ *
+ * The chunks are spread over the deques, and the current thread runs
+ * chunks (of any job) until the job is done.
+ */
+auto ArxThreadPool::run(ArxParallelJob& job) -> void {
+  int64_t num_chunks = static_cast<int64_t>(job.partials.size());
+  int size = this->size();
+  int first = std::max(worker_idx, 0);
+
+  job.remaining.store(num_chunks);
+  for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    Worker& worker =
+      *this->workers[static_cast<size_t>((first + chunk) % size)];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.tasks.push_back({&job, chunk});
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->sleep_mutex);
+    this->pending.fetch_add(num_chunks);
+  }
+  this->sleep_cv.notify_all();
+
+  ArxParallelTask task;
+  while (job.remaining.load(std::memory_order_acquire) > 0) {
+    if (this->pop(worker_idx, task)) {
+      run_task(task);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===
+// Functions used by the generated code.
+//===----------------------------------------------------------------------===
+
+/**
+ * @brief Run the `count` iterations of an outlined `parfor` body.
+ * @return The reduction of the partial results (0 without reduction).
+ */
+extern "C" DLLEXPORT auto arx_parfor(
+  arx_parfor_body_t body, void* env, int64_t count, int32_t op) -> float {
+  if (count <= 0) {
+    return reduce_identity(op);
+  }
+
+  ArxThreadPool& pool = ArxThreadPool::get();
+  int64_t num_chunks = std::min(count, static_cast<int64_t>(pool.size()) * 4);
+  int64_t chunk_size = (count + num_chunks - 1) / num_chunks;
+  num_chunks = (count + chunk_size - 1) / chunk_size;
+
+  if (num_chunks == 1) {
+    return reduce_combine(op, reduce_identity(op), body(env, 0, count));
+  }
+
+  ArxParallelJob job;
+  job.body = body;
+  job.env = env;
+  job.count = count;
+  job.chunk_size = chunk_size;
+  job.partials.resize(static_cast<size_t>(num_chunks));
+  pool.run(job);
+
+  float result = reduce_identity(op);
+  for (float partial : job.partials) {
+    result = reduce_combine(op, result, partial);
+  }
+  return result;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>              // for atomic
+#include <condition_variable>  // for condition_variable
+#include <cstdint>             // for int32_t, int64_t
+#include <deque>               // for deque
+#include <memory>              // for unique_ptr
+#include <mutex>               // for mutex
+#include <thread>              // for thread
+#include <vector>              // for vector
+
+/*
+ * Runtime of the `parfor` loops.
+ *
+ * The body of a `parfor` is outlined by the compiler into a function that
+ * runs the iterations [begin, end) and returns their reduction. The
+ * iterations are split in chunks, and the chunks are run by a pool of
+ * worker threads with a deque each: a worker pops the chunks from the back
+ * of its deque and steals from the front of the other deques when it is
+ * empty. The thread that runs the loop also runs chunks while it waits,
+ * so nested loops don't block the workers.
+ *
+ * The partial reductions are combined in the order of the chunks, so the
+ * result doesn't depend on the scheduling.
+ */
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+/**
+ * @brief Reduction operator of a `parfor` loop.
+ *
+ */
+enum ArxReduceOp : int32_t {
+  ARX_REDUCE_NONE = 0,
+  ARX_REDUCE_ADD = 1,
+  ARX_REDUCE_MUL = 2,
+  ARX_REDUCE_MIN = 3,
+  ARX_REDUCE_MAX = 4,
+};
+
+// outlined loop body: (environment, first iteration, end iteration)
+typedef float (*arx_parfor_body_t)(void*, int64_t, int64_t);
+
+struct ArxParallelJob;
+
+/**
+ * @brief A chunk of iterations of a job.
+ *
+ */
+struct ArxParallelTask {
+  ArxParallelJob* job;
+  int64_t chunk;
+};
+
+/**
+ * @brief Work-stealing thread pool.
+ *
+ */
+class ArxThreadPool {
+ public:
+  explicit ArxThreadPool(int num_threads);
+  ~ArxThreadPool();
+
+  static auto get() -> ArxThreadPool&;
+
+  auto size() const -> int;
+  auto run(ArxParallelJob& job) -> void;
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<ArxParallelTask> tasks;
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> threads;
+  std::mutex sleep_mutex;
+  std::condition_variable sleep_cv;
+  std::atomic<int64_t> pending;
+  std::atomic<bool> stop;
+
+  auto work(int idx) -> void;
+  auto pop(int idx, ArxParallelTask& task) -> bool;
+};
+
+extern "C" {
+DLLEXPORT auto arx_parfor(
+  arx_parfor_body_t body, void* env, int64_t count, int32_t op) -> float;
+}
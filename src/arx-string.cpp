@@ -0,0 +1,247 @@
+#include "arx-string.h"  // for ArxString, arx_string_t, ArxStringArena
+#include <algorithm>     // for min, max, clamp
+#include <cstring>       // for memcpy, memcmp, memset
+#include <memory>        // for unique_ptr, make_unique
+#include <string_view>   // for string_view
+
+#include "arx-io.h"  // for ArxWriter
+
+// the blocks are large enough for the strings of a whole batch
+const size_t STRING_ARENA_BLOCK_SIZE = 64 * 1024;
+
+/**
+ * @brief Unpack a string value.
+ *
+ */
+auto ArxString::from_value(arx_string_t value) -> ArxString {
+  ArxString s;
+  memcpy(&s, &value, sizeof(s));
+  return s;
+}
+
+/**
+ * @brief Create a string view, the data is copied only if it is inlined.
+ *
+ * The unused inline bytes are zeroed, so two inline strings are equal if
+ * their values are equal (and the empty string is 0).
+ */
+auto ArxString::make(const char* data, int64_t length) -> ArxString {
+  ArxString s;
+  memset(&s, 0, sizeof(s));
+  s.length = static_cast<int32_t>(length);
+
+  if (s.length <= ARX_STRING_INLINE_SIZE) {
+    if (s.length > 0) {
+      memcpy(s.prefix, data, static_cast<size_t>(s.length));
+    }
+    return s;
+  }
+
+  memcpy(s.prefix, data, sizeof(s.prefix));
+  s.ptr = data;
+  return s;
+}
+
+/**
+ * @brief Check if the data is stored in the value itself.
+ *
+ */
+auto ArxString::is_inline() const -> bool {
+  return this->length <= ARX_STRING_INLINE_SIZE;
+}
+
+/**
+ * @brief Get a pointer to the data.
+ *
+ * For inline strings it points into this object, so it is only valid while
+ * the object is alive.
+ */
+auto ArxString::data() const -> const char* {
+  return this->is_inline() ? this->prefix : this->ptr;
+}
+
+/**
+ * @brief Pack the string to the value used by the generated code.
+ *
+ */
+auto ArxString::to_value() const -> arx_string_t {
+  arx_string_t value;
+  memcpy(&value, this, sizeof(value));
+  return value;
+}
+
+/**
+ * @brief Allocate memory that lives until the next reset.
+ *
+ */
+auto ArxStringArena::allocate(size_t size) -> char* {
+  if (this->used + size > this->capacity) {
+    size_t block_size = std::max(size, STRING_ARENA_BLOCK_SIZE);
+    this->blocks.push_back(std::make_unique<char[]>(block_size));
+    this->used = 0;
+    this->capacity = block_size;
+  }
+
+  char* result = this->blocks.back().get() + this->used;
+  this->used += size;
+  return result;
+}
+
+/**
+ * @brief Release the memory of all the strings allocated in the arena.
+ *
+ * The last block is kept, so an arena that is reset after each batch
+ * doesn't allocate memory in the steady state.
+ */
+auto ArxStringArena::reset() -> void {
+  if (this->blocks.size() > 1) {
+    this->blocks.erase(this->blocks.begin(), this->blocks.end() - 1);
+    this->capacity = STRING_ARENA_BLOCK_SIZE;
+  }
+  this->used = 0;
+}
+
+/**
+ * @brief Get the string arena of the current thread.
+ *
+ */
+auto get_string_arena() -> ArxStringArena& {
+  static thread_local ArxStringArena arena;
+  return arena;
+}
+
+/**
+ * @brief Get the data of a string as a string_view.
+ *
+ */
+static auto get_view(const ArxString& s) -> std::string_view {
+  return std::string_view(s.data(), static_cast<size_t>(s.length));
+}
+
+//===----------------------------------------------------------------------===
+// Functions used by the generated code.
+//===----------------------------------------------------------------------===
+
+/**
+ * @brief Create a string value from a buffer, without copying long data.
+ *
+ */
+extern "C" DLLEXPORT auto arx_string_view(const char* data, int64_t length)
+  -> arx_string_t {
+  return ArxString::make(data, length).to_value();
+}
+
+/**
+ * @brief Concatenate two strings, long results are allocated in the arena.
+ *
+ */
+extern "C" DLLEXPORT auto arx_string_concat(
+  arx_string_t lhs, arx_string_t rhs) -> arx_string_t {
+  ArxString s1 = ArxString::from_value(lhs);
+  ArxString s2 = ArxString::from_value(rhs);
+  int64_t length = static_cast<int64_t>(s1.length) + s2.length;
+
+  char buffer[ARX_STRING_INLINE_SIZE];
+  char* data = length <= ARX_STRING_INLINE_SIZE
+    ? buffer
+    : get_string_arena().allocate(static_cast<size_t>(length));
+
+  memcpy(data, s1.data(), static_cast<size_t>(s1.length));
+  memcpy(data + s1.length, s2.data(), static_cast<size_t>(s2.length));
+  return ArxString::make(data, length).to_value();
+}
+
+/**
+ * @brief Compare two strings byte by byte.
+ * @return A negative value, 0 or a positive value, like memcmp.
+ *
+ * The prefixes are compared first, so the data of long strings is only
+ * read when they have the same 4 first bytes.
+ */
+extern "C" DLLEXPORT auto arx_string_compare(
+  arx_string_t lhs, arx_string_t rhs) -> int32_t {
+  ArxString s1 = ArxString::from_value(lhs);
+  ArxString s2 = ArxString::from_value(rhs);
+  size_t length = static_cast<size_t>(std::min(s1.length, s2.length));
+
+  int result = memcmp(s1.prefix, s2.prefix, std::min(length, size_t{4}));
+  if (result == 0 && length > 4) {
+    result = memcmp(s1.data() + 4, s2.data() + 4, length - 4);
+  }
+  if (result == 0) {
+    result = (s1.length > s2.length) - (s1.length < s2.length);
+  }
+  return result;
+}
+
+//===----------------------------------------------------------------------===
+// "Library" functions that can be "extern'd" from user code, e.g.:
+//   extern str_len(s: string) -> float
+//===----------------------------------------------------------------------===
+
+/**
+ * @brief Get the length of a string in bytes.
+ *
+ */
+extern "C" DLLEXPORT auto str_len(arx_string_t s) -> float {
+  return static_cast<float>(ArxString::from_value(s).length);
+}
+
+/**
+ * @brief Check if two strings are equal, returning 1 or 0.
+ *
+ */
+extern "C" DLLEXPORT auto str_eq(arx_string_t lhs, arx_string_t rhs)
+  -> float {
+  ArxString s1 = ArxString::from_value(lhs);
+  ArxString s2 = ArxString::from_value(rhs);
+
+  // the length and the prefix are in the first 8 bytes, and inline strings
+  // are zero padded, so they are equal only if their values are equal.
+  if (s1.length != s2.length || memcmp(s1.prefix, s2.prefix, 4) != 0) {
+    return 0;
+  }
+  if (s1.is_inline()) {
+    return lhs == rhs ? 1 : 0;
+  }
+  return get_view(s1) == get_view(s2) ? 1 : 0;
+}
+
+/**
+ * @brief Find the first occurrence of `sub` in `s`.
+ * @return The position of `sub` or -1 if it is not found.
+ */
+extern "C" DLLEXPORT auto str_find(arx_string_t s, arx_string_t sub)
+  -> float {
+  ArxString s1 = ArxString::from_value(s);
+  ArxString s2 = ArxString::from_value(sub);
+  size_t pos = get_view(s1).find(get_view(s2));
+  return pos == std::string_view::npos ? -1 : static_cast<float>(pos);
+}
+
+/**
+ * @brief Get the bytes of `s` in [start, end), without copying the data.
+ *
+ * The positions are clamped to the string, so an invalid range returns an
+ * empty string. The result of a slice of a long string points to the same
+ * data as `s`.
+ */
+extern "C" DLLEXPORT auto str_slice(arx_string_t s, float start, float end)
+  -> arx_string_t {
+  ArxString str = ArxString::from_value(s);
+  int64_t length = str.length;
+  int64_t first = std::clamp(static_cast<int64_t>(start), int64_t{0}, length);
+  int64_t last = std::clamp(static_cast<int64_t>(end), first, length);
+  return ArxString::make(str.data() + first, last - first).to_value();
+}
+
+/**
+ * @brief Write a string to stderr, returning 0.
+ *
+ * It uses the buffer of printd, so their output keeps its order.
+ */
+extern "C" DLLEXPORT auto prints(arx_string_t s) -> float {
+  ArxString str = ArxString::from_value(s);
+  ArxWriter::get_stderr().write(str.data(), static_cast<size_t>(str.length));
+  return 0;
+}
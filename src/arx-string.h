@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for int32_t, int64_t
+#include <memory>   // for unique_ptr
+#include <vector>   // for vector
+
+/*
+ * A string (or binary) value is a 16 bytes view (little endian):
+ *
+ *   bytes 0-3    length (int32)
+ *   bytes 4-15   the data, when length <= ARX_STRING_INLINE_SIZE
+ *   bytes 4-7    the first 4 bytes of the data (prefix), otherwise
+ *   bytes 8-15   a pointer to the data, otherwise
+ *
+ * It is the same inline representation of the Arrow string views (and
+ * Umbra/DuckDB strings), so short strings don't point to any memory and
+ * most comparisons are resolved with the length and the prefix. Long
+ * strings never own their data: a slice of a string, or a string read from
+ * an Arrow array, is just a pointer to the original bytes.
+ *
+ * In the generated code the value is an i128, so it is passed in registers
+ * and the runtime functions below use the same calling convention.
+ */
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+const int32_t ARX_STRING_INLINE_SIZE = 12;
+
+__extension__ typedef __int128 arx_string_t;
+
+/**
+ * @brief Unpacked string value (see the layout above).
+ *
+ */
+struct ArxString {
+  int32_t length;
+  char prefix[4];
+  const char* ptr;
+
+  static auto from_value(arx_string_t value) -> ArxString;
+  static auto make(const char* data, int64_t length) -> ArxString;
+
+  auto is_inline() const -> bool;
+  auto data() const -> const char*;
+  auto to_value() const -> arx_string_t;
+};
+
+/**
+ * @brief Buffers of an Arrow string or binary array (int32 offsets).
+ *
+ * It is the input of a string argument in the JIT kernels, the value `i`
+ * is `data[offsets[i]:offsets[i + 1]]`.
+ */
+struct ArxStringBuffers {
+  const int32_t* offsets;
+  const char* data;
+};
+
+/**
+ * @brief Memory for the strings created at runtime (e.g. concatenations).
+ *
+ * The memory is allocated in large blocks and released all at once, so
+ * creating a string costs a pointer bump. Each thread has its own arena.
+ */
+class ArxStringArena {
+ private:
+  std::vector<std::unique_ptr<char[]>> blocks;
+  size_t used = 0;
+  size_t capacity = 0;
+
+ public:
+  auto allocate(size_t size) -> char*;
+  auto reset() -> void;
+};
+
+auto get_string_arena() -> ArxStringArena&;
+
+extern "C" {
+  DLLEXPORT auto arx_string_view(const char* data, int64_t length)
+    -> arx_string_t;
+  DLLEXPORT auto arx_string_concat(arx_string_t lhs, arx_string_t rhs)
+    -> arx_string_t;
+  DLLEXPORT auto arx_string_compare(arx_string_t lhs, arx_string_t rhs)
+    -> int32_t;
+
+  DLLEXPORT auto str_len(arx_string_t s) -> float;
+  DLLEXPORT auto str_eq(arx_string_t lhs, arx_string_t rhs) -> float;
+  DLLEXPORT auto str_find(arx_string_t s, arx_string_t sub) -> float;
+  DLLEXPORT auto str_slice(arx_string_t s, float start, float end)
+    -> arx_string_t;
+  DLLEXPORT auto prints(arx_string_t s) -> float;
+}
@@ -1,6 +1,10 @@
-#include <string>
+#include <string>  // for string
+#include <vector>  // for vector
 
 #include <glog/logging.h>               // for COMPACT_GOOGLE_LOG_INFO, LOG
+#include <llvm/IR/Attributes.h>         // for Attribute
+#include <llvm/IR/DataLayout.h>         // for DataLayout, StructLayout
+#include <llvm/IR/DerivedTypes.h>       // for FixedVectorType
 #include <llvm/IR/DIBuilder.h>          // for DIBuilder
 #include <llvm/IR/IRBuilder.h>          // for IRBuilder
 #include <llvm/IR/Module.h>             // for Module
@@ -10,8 +14,11 @@
 #include <llvm/Target/TargetOptions.h>  // for TargetOptions
 
 #include "codegen/arx-llvm.h"  // for ArxLLVM
+#include "codegen/generic.h"   // for ArxGeneric
 #include "codegen/jit.h"       // for ArxJIT
-#include "parser.h"            // for ArxJIT
+#include "codegen/record.h"    // for ArxRecord
+#include "datatypes.h"         // for get_type_bit_width, is_vector_type
+#include "parser.h"            // for Parser, StructFields
 
 std::unique_ptr<llvm::LLVMContext> ArxLLVM::context;
 std::unique_ptr<llvm::Module> ArxLLVM::module;
@@ -20,6 +27,9 @@ std::unique_ptr<llvm::DIBuilder> ArxLLVM::di_builder;
 std::unique_ptr<llvm::orc::ArxJIT> ArxLLVM::jit;
 
 std::map<std::string, llvm::AllocaInst*> ArxLLVM::named_values;
+std::map<std::string, std::string> ArxLLVM::named_types;
+std::map<std::string, std::unique_ptr<ExprAST>> ArxLLVM::named_constants;
+std::map<std::string, std::string> ArxLLVM::named_constant_types;
 std::map<std::string, std::unique_ptr<PrototypeAST>> ArxLLVM::function_protos;
 
 /* Data types */
@@ -27,6 +37,9 @@ llvm::Type* ArxLLVM::FLOAT_TYPE;
 llvm::Type* ArxLLVM::DOUBLE_TYPE;
 llvm::Type* ArxLLVM::INT8_TYPE;
 llvm::Type* ArxLLVM::INT32_TYPE;
+llvm::Type* ArxLLVM::INT64_TYPE;
+llvm::Type* ArxLLVM::INT128_TYPE;
+llvm::Type* ArxLLVM::INT256_TYPE;
 llvm::Type* ArxLLVM::VOID_TYPE;
 
 /* Debug Information Data types */
@@ -34,11 +47,33 @@ llvm::DIType* ArxLLVM::DI_FLOAT_TYPE;
 llvm::DIType* ArxLLVM::DI_DOUBLE_TYPE;
 llvm::DIType* ArxLLVM::DI_INT8_TYPE;
 llvm::DIType* ArxLLVM::DI_INT32_TYPE;
+llvm::DIType* ArxLLVM::DI_INT64_TYPE;
+llvm::DIType* ArxLLVM::DI_INT128_TYPE;
+llvm::DIType* ArxLLVM::DI_INT256_TYPE;
 llvm::DIType* ArxLLVM::DI_VOID_TYPE;
 
 llvm::ExitOnError ArxLLVM::exit_on_err;
 
 extern bool IS_BUILD_LIB = false;  // default value
+std::string TARGET_CPU = "generic";
+
+// note: meson.build sets ARX_RUNTIME_DIR to the installation directory
+//       of the libraries.
+#ifndef ARX_RUNTIME_DIR
+#define ARX_RUNTIME_DIR ""
+#endif
+std::string RUNTIME_DIR = ARX_RUNTIME_DIR;
+std::vector<std::string> LINK_FILES;
+
+/**
+ * @brief Get the path of the runtime library in RUNTIME_DIR.
+ * @param extension `.a` for the static library, `.so` for the shared one.
+ */
+auto ArxLLVM::get_runtime_library(const std::string& extension)
+  -> std::string {
+  std::string name = "libarxrt" + extension;
+  return RUNTIME_DIR == "" ? name : RUNTIME_DIR + "/" + name;
+}
 
 auto ArxLLVM::get_data_type(std::string type_name) -> llvm::Type* {
   if (type_name == "float") {
@@ -55,6 +90,36 @@ auto ArxLLVM::get_data_type(std::string type_name) -> llvm::Type* {
     return ArxLLVM::VOID_TYPE;
   }
 
+  if (is_vector_type(type_name)) {
+    int bits = get_vector_element_bit_width(type_name);
+    llvm::Type* element_type = !is_float_vector_type(type_name)
+      ? llvm::Type::getIntNTy(*ArxLLVM::context, bits)
+      : bits == 32 ? ArxLLVM::FLOAT_TYPE
+                   : ArxLLVM::DOUBLE_TYPE;
+    return llvm::FixedVectorType::get(
+      element_type, get_vector_lanes(type_name));
+  }
+
+  if (is_record_type(type_name)) {
+    return ArxRecord::get_struct_type(type_name);
+  }
+  if (is_array_type(type_name)) {
+    return llvm::PointerType::getUnqual(
+      ArxRecord::get_storage_type(type_name));
+  }
+
+  // temporal and decimal types are lowered to integers (see datatypes.h)
+  switch (get_type_bit_width(type_name)) {
+    case 32:
+      return ArxLLVM::INT32_TYPE;
+    case 64:
+      return ArxLLVM::INT64_TYPE;
+    case 128:
+      return ArxLLVM::INT128_TYPE;
+    case 256:
+      return ArxLLVM::INT256_TYPE;
+  }
+
   llvm::errs() << "[EE] type_name not valid.\n";
   return nullptr;
 }
@@ -74,10 +139,118 @@ auto ArxLLVM::get_di_data_type(std::string di_type_name) -> llvm::DIType* {
     return ArxLLVM::DI_VOID_TYPE;
   }
 
+  if (is_vector_type(di_type_name)) {
+    int bits = get_vector_element_bit_width(di_type_name);
+    int lanes = get_vector_lanes(di_type_name);
+    bool is_float = is_float_vector_type(di_type_name);
+    llvm::DIType* element_type = ArxLLVM::di_builder->createBasicType(
+      di_type_name.substr(0, di_type_name.find('x')),
+      bits,
+      is_float ? llvm::dwarf::DW_ATE_float : llvm::dwarf::DW_ATE_signed);
+    return ArxLLVM::di_builder->createVectorType(
+      bits * lanes,
+      bits * lanes,
+      element_type,
+      ArxLLVM::di_builder->getOrCreateArray(
+        {ArxLLVM::di_builder->getOrCreateSubrange(0, lanes)}));
+  }
+
+  if (is_record_type(di_type_name)) {
+    const llvm::DataLayout& data_layout = ArxLLVM::module->getDataLayout();
+    llvm::StructType* struct_type = ArxRecord::get_struct_type(di_type_name);
+    const llvm::StructLayout* layout =
+      data_layout.getStructLayout(struct_type);
+    const StructFields& fields = Parser::struct_fields[di_type_name];
+
+    std::vector<llvm::Metadata*> members;
+    for (unsigned i = 0; i < fields.size(); ++i) {
+      llvm::Type* field_type = struct_type->getElementType(i);
+      members.push_back(ArxLLVM::di_builder->createMemberType(
+        nullptr,
+        fields[i].first,
+        nullptr,
+        0,
+        data_layout.getTypeSizeInBits(field_type),
+        data_layout.getABITypeAlign(field_type).value() * 8,
+        layout->getElementOffsetInBits(i),
+        llvm::DINode::FlagZero,
+        ArxLLVM::get_di_data_type(fields[i].second)));
+    }
+    return ArxLLVM::di_builder->createStructType(
+      nullptr,
+      di_type_name,
+      nullptr,
+      0,
+      data_layout.getTypeSizeInBits(struct_type),
+      layout->getAlignment().value() * 8,
+      llvm::DINode::FlagZero,
+      nullptr,
+      ArxLLVM::di_builder->getOrCreateArray(members));
+  }
+  // an array is described as a pointer to its first element
+  if (is_array_type(di_type_name)) {
+    return ArxLLVM::di_builder->createPointerType(
+      ArxLLVM::get_di_data_type(get_array_element_type(di_type_name)),
+      ArxLLVM::module->getDataLayout().getPointerSizeInBits());
+  }
+
+  switch (get_type_bit_width(di_type_name)) {
+    case 32:
+      return ArxLLVM::DI_INT32_TYPE;
+    case 64:
+      return ArxLLVM::DI_INT64_TYPE;
+    case 128:
+      return ArxLLVM::DI_INT128_TYPE;
+    case 256:
+      return ArxLLVM::DI_INT256_TYPE;
+  }
+
   llvm::errs() << "[EE] di_type_name not valid.\n";
   return nullptr;
 }
 
+/**
+ * @brief Attach the Arx type names of the prototype to the function.
+ * @param fn The function created from the prototype.
+ * @param proto The function prototype.
+ *
+ * The integer types of the generated code don't distinguish e.g. a date32
+ * from a time32 or the scale of a decimal, so the type names are kept as
+ * string attributes of the return value and of the arguments.
+ */
+auto ArxLLVM::set_type_names(llvm::Function* fn, PrototypeAST& proto)
+  -> void {
+  fn->addRetAttr(
+    llvm::Attribute::get(*ArxLLVM::context, "arx-type", proto.type_name));
+  for (unsigned idx = 0, e = proto.args.size(); idx != e; ++idx) {
+    fn->addParamAttr(
+      idx,
+      llvm::Attribute::get(
+        *ArxLLVM::context, "arx-type", proto.args[idx]->type_name));
+  }
+}
+
+/**
+ * @brief Get the Arx type name of the function return value.
+ *
+ */
+auto ArxLLVM::get_return_type_name(llvm::Function* fn) -> std::string {
+  llvm::Attribute attr =
+    fn->getAttributes().getRetAttrs().getAttribute("arx-type");
+  return attr.isValid() ? attr.getValueAsString().str() : "float";
+}
+
+/**
+ * @brief Get the Arx type name of a function argument.
+ *
+ */
+auto ArxLLVM::get_arg_type_name(llvm::Function* fn, unsigned idx)
+  -> std::string {
+  llvm::Attribute attr =
+    fn->getAttributes().getParamAttrs(idx).getAttribute("arx-type");
+  return attr.isValid() ? attr.getValueAsString().str() : "float";
+}
+
 auto ArxLLVM::initialize() -> void {
   // initialize the target registry etc.
   llvm::InitializeAllTargetInfos();
@@ -90,6 +263,12 @@ auto ArxLLVM::initialize() -> void {
   llvm::InitializeNativeTargetAsmPrinter();
   llvm::InitializeNativeTargetAsmParser();
 
+  // the module and the builders of a previous compilation use the old
+  // context, so they are released before it.
+  ArxLLVM::di_builder.reset();
+  ArxLLVM::ir_builder.reset();
+  ArxLLVM::module.reset();
+
   ArxLLVM::context = std::make_unique<llvm::LLVMContext>();
   ArxLLVM::module =
     std::make_unique<llvm::Module>("arx jit", *ArxLLVM::context);
@@ -102,15 +281,35 @@ auto ArxLLVM::initialize() -> void {
   ArxLLVM::DOUBLE_TYPE = llvm::Type::getDoubleTy(*ArxLLVM::context);
   ArxLLVM::INT8_TYPE = llvm::Type::getInt8Ty(*ArxLLVM::context);
   ArxLLVM::INT32_TYPE = llvm::Type::getInt32Ty(*ArxLLVM::context);
+  ArxLLVM::INT64_TYPE = llvm::Type::getInt64Ty(*ArxLLVM::context);
+  ArxLLVM::INT128_TYPE = llvm::Type::getInt128Ty(*ArxLLVM::context);
+  ArxLLVM::INT256_TYPE = llvm::Type::getIntNTy(*ArxLLVM::context, 256);
   ArxLLVM::VOID_TYPE = llvm::Type::getVoidTy(*ArxLLVM::context);
 
+  // the generic functions of the previous compilation
+  ArxGeneric::functions.clear();
+
   LOG(INFO) << "initialize Target";
 
   // LLVM IR
 
-  ArxLLVM::jit = ArxLLVM::exit_on_err(llvm::orc::ArxJIT::Create());
+  // note: the JIT keeps the code of the modules already added to it, so it
+  //       is created just once and shared by every compilation.
+  if (!ArxLLVM::jit) {
+    // note: the runtime is linked whole into the arx executable (and into
+    //       the tests), and its symbols are exported, so the JIT code uses
+    //       the same copy as the compiler, e.g. the same string arena.
+    ArxLLVM::jit = ArxLLVM::exit_on_err(llvm::orc::ArxJIT::Create());
+  }
   ArxLLVM::module->setDataLayout(ArxLLVM::jit->get_data_layout());
+}
 
+/**
+ * @brief Create the DIBuilder of ArxLLVM::module and the debug types, only
+ *        used with debug information (see ArxDebugInfo).
+ *
+ */
+auto ArxLLVM::initialize_debug_info() -> void {
   // Create a new builder for the module.
   ArxLLVM::di_builder = std::make_unique<llvm::DIBuilder>(*ArxLLVM::module);
 
@@ -123,4 +322,10 @@ auto ArxLLVM::initialize() -> void {
     "int8", 8, llvm::dwarf::DW_ATE_signed);
   ArxLLVM::DI_INT32_TYPE = ArxLLVM::di_builder->createBasicType(
     "int32", 32, llvm::dwarf::DW_ATE_signed);
+  ArxLLVM::DI_INT64_TYPE = ArxLLVM::di_builder->createBasicType(
+    "int64", 64, llvm::dwarf::DW_ATE_signed);
+  ArxLLVM::DI_INT128_TYPE = ArxLLVM::di_builder->createBasicType(
+    "int128", 128, llvm::dwarf::DW_ATE_signed);
+  ArxLLVM::DI_INT256_TYPE = ArxLLVM::di_builder->createBasicType(
+    "int256", 256, llvm::dwarf::DW_ATE_signed);
 }
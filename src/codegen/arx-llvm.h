@@ -1,5 +1,8 @@
 #pragma once
 
+#include <string>  // for string
+#include <vector>  // for vector
+
 #include <llvm/IR/DIBuilder.h>   // for DIBuilder
 #include <llvm/IR/IRBuilder.h>   // for IRBuilder
 #include <llvm/IR/Module.h>      // for Module
@@ -17,6 +20,9 @@ class ArxLLVM {
   static std::unique_ptr<llvm::orc::ArxJIT> jit;
 
   static std::map<std::string, llvm::AllocaInst*> named_values;
+  static std::map<std::string, std::string> named_types;
+  static std::map<std::string, std::unique_ptr<ExprAST>> named_constants;
+  static std::map<std::string, std::string> named_constant_types;
   static std::map<std::string, std::unique_ptr<PrototypeAST>> function_protos;
 
   static llvm::ExitOnError exit_on_err;
@@ -26,6 +32,9 @@ class ArxLLVM {
   static llvm::Type* FLOAT_TYPE;
   static llvm::Type* INT8_TYPE;
   static llvm::Type* INT32_TYPE;
+  static llvm::Type* INT64_TYPE;
+  static llvm::Type* INT128_TYPE;
+  static llvm::Type* INT256_TYPE;
   static llvm::Type* VOID_TYPE;
 
   /* Debug Information Data types */
@@ -33,11 +42,28 @@ class ArxLLVM {
   static llvm::DIType* DI_FLOAT_TYPE;
   static llvm::DIType* DI_INT8_TYPE;
   static llvm::DIType* DI_INT32_TYPE;
+  static llvm::DIType* DI_INT64_TYPE;
+  static llvm::DIType* DI_INT128_TYPE;
+  static llvm::DIType* DI_INT256_TYPE;
   static llvm::DIType* DI_VOID_TYPE;
 
   static auto get_data_type(std::string type_name) -> llvm::Type*;
   static auto get_di_data_type(std::string type_name) -> llvm::DIType*;
+  static auto set_type_names(llvm::Function* fn, PrototypeAST& proto)
+    -> void;
+  static auto get_return_type_name(llvm::Function* fn) -> std::string;
+  static auto get_arg_type_name(llvm::Function* fn, unsigned idx)
+    -> std::string;
+  static auto get_runtime_library(const std::string& extension)
+    -> std::string;
   static auto initialize() -> void;
+  static auto initialize_debug_info() -> void;
 };
 
 extern bool IS_BUILD_LIB;
+// the CPU of the objects: generic, native (the host) or a CPU name
+extern std::string TARGET_CPU;
+// the directory of the runtime library (libarxrt.a and libarxrt.so)
+extern std::string RUNTIME_DIR;
+// the objects of the other Arx modules of the program (--build-lib)
+extern std::vector<std::string> LINK_FILES;
@@ -0,0 +1,279 @@
+#include "codegen/ast-to-jit.h"  // for ASTToJITVisitor
+#include <cstdint>                 // for uint64_t
+#include <memory>                  // for unique_ptr
+#include <string>                  // for string
+#include <vector>                  // for vector
+
+#include <glog/logging.h>                                      // for LOG
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>  // for JITT...
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>  // for ThreadSafeM...
+#include <llvm/IR/BasicBlock.h>                         // for BasicBlock
+#include <llvm/IR/Constants.h>                          // for ConstantInt
+#include <llvm/IR/DerivedTypes.h>                       // for FunctionType
+#include <llvm/IR/Function.h>                           // for Function
+#include <llvm/IR/Instructions.h>                       // for PHINode
+#include <llvm/IR/IRBuilder.h>                          // for IRBuilder
+#include <llvm/IR/Module.h>                             // for Module
+#include <llvm/IR/PassManager.h>                        // for ModuleAnaly...
+#include <llvm/IR/Verifier.h>                           // for verifyFunction
+#include <llvm/Passes/OptimizationLevel.h>  // for OptimizationLevel
+#include <llvm/Passes/PassBuilder.h>        // for PassBuilder
+#include <llvm/Support/Error.h>             // for consumeError
+#include <llvm/Target/TargetMachine.h>      // for TargetMachine
+
+#include "codegen/arx-llvm.h"  // for ArxLLVM
+#include "codegen/jit.h"       // for ArxJIT
+#include "codegen/math.h"      // for ArxMath
+#include "datatypes.h"         // for is_string_type
+
+/**
+ * @brief Get the name of the vectorized kernel for the given function.
+ * @param name The Arx function name.
+ * @return The kernel symbol name.
+ */
+auto get_kernel_name(std::string name) -> std::string {
+  return "__arx_kernel_" + name;
+}
+
+/**
+ * @brief Emit a vectorized kernel that applies `fn` over buffers.
+ * @param fn The scalar function generated from an Arx FunctionAST.
+ * @return The kernel function.
+ *
+ * The kernel has the following signature:
+ *
+ *   void kernel(
+ *     int64_t length,
+ *     const void* const* inputs,
+ *     const int64_t* strides,
+ *     void* out)
+ *
+ * `inputs[j]` points to the values of the argument `j` and `strides[j]` is
+ * the distance between two consecutive values (1 for arrays and 0 for
+ * scalars that should be broadcast). The values use the physical type of
+ * each argument (e.g. int32 for date32 and int128 for decimal128), the same
+ * layout used by Arrow, so the buffers are read and written in place. The
+ * scalar function is called inside a single counted loop, so after the
+ * optimization the call is inlined and the loop vectorized.
+ *
+ * For string and binary arguments, `inputs[j]` points to the offsets and
+ * data buffers of the Arrow array (see ArxStringBuffers) and the string
+ * views are created from them, without copying the data. String results
+ * are written as views, that should be copied to an Arrow array by the
+ * caller.
+ */
+auto ASTToJITVisitor::emit_kernel(llvm::Function* fn) -> llvm::Function* {
+  llvm::Type* int64_type = llvm::Type::getInt64Ty(*ArxLLVM::context);
+  llvm::Type* void_ptr_type = llvm::Type::getInt8PtrTy(*ArxLLVM::context);
+  llvm::Type* int64_ptr_type = llvm::PointerType::getUnqual(int64_type);
+  llvm::Type* inputs_type = llvm::PointerType::getUnqual(void_ptr_type);
+
+  llvm::FunctionType* kernel_type = llvm::FunctionType::get(
+    ArxLLVM::VOID_TYPE,
+    {int64_type, inputs_type, int64_ptr_type, void_ptr_type},
+    false /* isVarArg */);
+
+  llvm::Function* kernel = llvm::Function::Create(
+    kernel_type,
+    llvm::Function::ExternalLinkage,
+    get_kernel_name(std::string(fn->getName())),
+    ArxLLVM::module.get());
+
+  auto kernel_args = kernel->arg_begin();
+  llvm::Value* length = kernel_args++;
+  llvm::Value* inputs = kernel_args++;
+  llvm::Value* strides = kernel_args++;
+  llvm::Value* out = kernel_args++;
+  length->setName("length");
+  inputs->setName("inputs");
+  strides->setName("strides");
+  out->setName("out");
+
+  // the output buffer is never read by the kernel and it doesn't overlap
+  // with the inputs, this is required by the loop vectorizer.
+  kernel->addParamAttr(3, llvm::Attribute::NoAlias);
+  fn->addFnAttr(llvm::Attribute::InlineHint);
+
+  llvm::BasicBlock* entry_bb =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "entry", kernel);
+  llvm::BasicBlock* loop_bb =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "loop", kernel);
+  llvm::BasicBlock* exit_bb =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "exit", kernel);
+
+  ArxLLVM::ir_builder->SetInsertPoint(entry_bb);
+
+  llvm::Type* int32_ptr_type =
+    llvm::PointerType::getUnqual(ArxLLVM::INT32_TYPE);
+  llvm::FunctionCallee string_view = ArxLLVM::module->getOrInsertFunction(
+    "arx_string_view", ArxLLVM::INT128_TYPE, void_ptr_type, int64_type);
+
+  std::vector<llvm::Value*> input_ptrs;
+  std::vector<llvm::Value*> input_data;
+  std::vector<llvm::Value*> input_strides;
+  for (unsigned i = 0, e = fn->arg_size(); i != e; ++i) {
+    llvm::Type* arg_type = fn->getArg(i)->getType();
+    llvm::Value* input = ArxLLVM::ir_builder->CreateLoad(
+      void_ptr_type,
+      ArxLLVM::ir_builder->CreateConstGEP1_64(void_ptr_type, inputs, i),
+      "input");
+
+    if (is_string_type(ArxLLVM::get_arg_type_name(fn, i))) {
+      // ArxStringBuffers: {const int32_t* offsets, const char* data}
+      llvm::Value* buffers = ArxLLVM::ir_builder->CreatePointerCast(
+        input, llvm::PointerType::getUnqual(void_ptr_type));
+      input_ptrs.push_back(ArxLLVM::ir_builder->CreatePointerCast(
+        ArxLLVM::ir_builder->CreateLoad(void_ptr_type, buffers, "offsets"),
+        int32_ptr_type));
+      input_data.push_back(ArxLLVM::ir_builder->CreateLoad(
+        void_ptr_type,
+        ArxLLVM::ir_builder->CreateConstGEP1_64(void_ptr_type, buffers, 1),
+        "data"));
+    } else {
+      input_ptrs.push_back(ArxLLVM::ir_builder->CreatePointerCast(
+        input, llvm::PointerType::getUnqual(arg_type)));
+      input_data.push_back(nullptr);
+    }
+
+    input_strides.push_back(ArxLLVM::ir_builder->CreateLoad(
+      int64_type,
+      ArxLLVM::ir_builder->CreateConstGEP1_64(int64_type, strides, i),
+      "stride"));
+  }
+
+  llvm::Type* out_type = fn->getReturnType();
+  llvm::Value* out_ptr = ArxLLVM::ir_builder->CreatePointerCast(
+    out, llvm::PointerType::getUnqual(out_type));
+
+  llvm::Value* zero = llvm::ConstantInt::get(int64_type, 0);
+  ArxLLVM::ir_builder->CreateCondBr(
+    ArxLLVM::ir_builder->CreateICmpSGT(length, zero), loop_bb, exit_bb);
+
+  ArxLLVM::ir_builder->SetInsertPoint(loop_bb);
+  llvm::PHINode* idx = ArxLLVM::ir_builder->CreatePHI(int64_type, 2, "idx");
+  idx->addIncoming(zero, entry_bb);
+
+  std::vector<llvm::Value*> args;
+  for (unsigned i = 0, e = fn->arg_size(); i != e; ++i) {
+    llvm::Value* offset =
+      ArxLLVM::ir_builder->CreateMul(idx, input_strides[i], "offset");
+    llvm::Type* arg_type = fn->getArg(i)->getType();
+
+    if (input_data[i]) {
+      llvm::Value* start = ArxLLVM::ir_builder->CreateLoad(
+        ArxLLVM::INT32_TYPE,
+        ArxLLVM::ir_builder->CreateGEP(
+          ArxLLVM::INT32_TYPE, input_ptrs[i], offset),
+        "start");
+      llvm::Value* end = ArxLLVM::ir_builder->CreateLoad(
+        ArxLLVM::INT32_TYPE,
+        ArxLLVM::ir_builder->CreateGEP(
+          ArxLLVM::INT32_TYPE,
+          input_ptrs[i],
+          ArxLLVM::ir_builder->CreateAdd(
+            offset, llvm::ConstantInt::get(int64_type, 1))),
+        "end");
+      llvm::Value* data = ArxLLVM::ir_builder->CreateGEP(
+        ArxLLVM::INT8_TYPE,
+        input_data[i],
+        ArxLLVM::ir_builder->CreateSExt(start, int64_type));
+      llvm::Value* size = ArxLLVM::ir_builder->CreateSExt(
+        ArxLLVM::ir_builder->CreateSub(end, start), int64_type);
+      args.push_back(
+        ArxLLVM::ir_builder->CreateCall(string_view, {data, size}, "arg"));
+      continue;
+    }
+
+    args.push_back(ArxLLVM::ir_builder->CreateLoad(
+      arg_type,
+      ArxLLVM::ir_builder->CreateGEP(arg_type, input_ptrs[i], offset),
+      "arg"));
+  }
+
+  llvm::Value* result = ArxLLVM::ir_builder->CreateCall(fn, args, "result");
+  ArxLLVM::ir_builder->CreateStore(
+    result, ArxLLVM::ir_builder->CreateGEP(out_type, out_ptr, idx));
+
+  llvm::Value* next_idx = ArxLLVM::ir_builder->CreateAdd(
+    idx, llvm::ConstantInt::get(int64_type, 1), "nextidx", true, true);
+  idx->addIncoming(next_idx, loop_bb);
+  ArxLLVM::ir_builder->CreateCondBr(
+    ArxLLVM::ir_builder->CreateICmpSLT(next_idx, length), loop_bb, exit_bb);
+
+  ArxLLVM::ir_builder->SetInsertPoint(exit_bb);
+  ArxLLVM::ir_builder->CreateRetVoid();
+
+  llvm::verifyFunction(*kernel);
+  return kernel;
+}
+
+/**
+ * @brief Optimize ArxLLVM::module for the host CPU.
+ *
+ * It runs the default O2 pipeline, that inlines the scalar functions into
+ * the kernels and vectorizes their loops.
+ */
+auto ASTToJITVisitor::optimize() -> void {
+  auto jit_target_machine_builder =
+    ArxLLVM::exit_on_err(llvm::orc::JITTargetMachineBuilder::detectHost());
+  std::unique_ptr<llvm::TargetMachine> target_machine =
+    ArxLLVM::exit_on_err(jit_target_machine_builder.createTargetMachine());
+
+  ArxLLVM::module->setTargetTriple(target_machine->getTargetTriple().str());
+
+  llvm::LoopAnalysisManager loop_am;
+  llvm::FunctionAnalysisManager function_am;
+  llvm::CGSCCAnalysisManager cgscc_am;
+  llvm::ModuleAnalysisManager module_am;
+
+  // the vector functions of the runtime, for the loops that call `exp`,
+  // `log`, ... (see ArxMath)
+  ArxMath::register_vector_functions(
+    function_am, target_machine->getTargetTriple());
+
+  llvm::PassBuilder pass_builder(target_machine.get());
+  pass_builder.registerModuleAnalyses(module_am);
+  pass_builder.registerCGSCCAnalyses(cgscc_am);
+  pass_builder.registerFunctionAnalyses(function_am);
+  pass_builder.registerLoopAnalyses(loop_am);
+  pass_builder.crossRegisterProxies(loop_am, function_am, cgscc_am, module_am);
+
+  llvm::ModulePassManager module_pm =
+    pass_builder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2);
+
+  LOG(INFO) << "JIT: optimize module";
+  module_pm.run(*ArxLLVM::module, module_am);
+}
+
+/**
+ * @brief Move ArxLLVM::module (and its context) to the JIT.
+ *
+ * After this call, ArxLLVM::initialize should be called again before
+ * generating new code.
+ */
+auto ASTToJITVisitor::add_module() -> void {
+  LOG(INFO) << "JIT: add module";
+
+  // the builders reference the module and the context that are moved to the
+  // JIT, so they should not be used anymore.
+  ArxLLVM::di_builder.reset();
+  ArxLLVM::ir_builder.reset();
+
+  ArxLLVM::exit_on_err(ArxLLVM::jit->addModule(llvm::orc::ThreadSafeModule(
+    std::move(ArxLLVM::module), std::move(ArxLLVM::context))));
+}
+
+/**
+ * @brief Look up the address of a JIT-compiled symbol.
+ * @param name The symbol name.
+ * @return The symbol address or nullptr if it was not found.
+ */
+auto ASTToJITVisitor::lookup(std::string name) -> void* {
+  auto symbol = ArxLLVM::jit->lookup(name);
+  if (!symbol) {
+    llvm::consumeError(symbol.takeError());
+    return nullptr;
+  }
+  return reinterpret_cast<void*>(
+    static_cast<uintptr_t>(symbol->getAddress()));
+}
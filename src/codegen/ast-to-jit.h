@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>  // for string
+
+#include "codegen/ast-to-object.h"  // for ASTToObjectVisitor
+
+namespace llvm {
+  class Function;
+}
+
+/**
+ * @brief Code generation for the embedded JIT (ArxLLVM::jit).
+ *
+ * It reuses the code generation from ASTToObjectVisitor, but instead of
+ * emitting an object file, the module is optimized for the host CPU and
+ * added to the JIT, so the generated functions can be called directly
+ * from the current process.
+ */
+class ASTToJITVisitor : public ASTToObjectVisitor {
+ public:
+  ASTToJITVisitor() = default;
+
+  auto emit_kernel(llvm::Function* fn) -> llvm::Function*;
+  auto optimize() -> void;
+  auto add_module() -> void;
+  auto lookup(std::string name) -> void*;
+};
+
+auto get_kernel_name(std::string name) -> std::string;
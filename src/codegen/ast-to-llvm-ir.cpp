@@ -3,7 +3,6 @@
 #include <llvm/ADT/iterator_range.h>    // for iterator_range
 #include <llvm/ADT/SmallVector.h>       // for SmallVector
 #include <llvm/ADT/StringRef.h>         // for StringRef
-#include <llvm/ADT/Triple.h>            // for Triple
 #include <llvm/BinaryFormat/Dwarf.h>    // for SourceLanguage, TypeKind
 #include <llvm/IR/Argument.h>           // for Argument
 #include <llvm/IR/BasicBlock.h>         // for BasicBlock
@@ -17,10 +16,9 @@
 #include <llvm/IR/Module.h>             // for Module
 #include <llvm/IR/Verifier.h>           // for verifyFunction
 #include <llvm/Support/Error.h>         // for ExitOnError
-#include <llvm/Support/Host.h>          // for getProcessTriple
 #include <llvm/Support/raw_ostream.h>   // for errs, raw_fd_ostream
 #include <llvm/Support/TargetSelect.h>  // for InitializeNativeTarget, Initi...
-#include <cstdio>                       // for fprintf, stderr
+#include <cstdio>                       // for fprintf, fileno, stderr
 #include <cstdlib>                      // for exit
 #include <fstream>                      // for operator<<
 #include <map>                          // for map
@@ -30,7 +28,13 @@
 #include <vector>                       // for vector
 #include "codegen/arx-llvm.h"           // for ArxLLVM
 #include "codegen/ast-to-object.h"      // for ASTToObjectVisitor
+#include "codegen/const-eval.h"         // for ArxConstEval
+#include "codegen/debug-info.h"         // for ArxDebugInfo
+#include "codegen/fp-mode.h"            // for ArxFPMode
+#include "codegen/generic.h"            // for ArxGeneric
 #include "codegen/jit.h"                // for ArxJIT
+#include "codegen/memo.h"               // for ArxMemo
+#include "codegen/tail-call.h"          // for ArxTailCall
 #include "lexer.h"                      // for Lexer
 #include "parser.h"                     // for PrototypeAST, FunctionAST
 
@@ -42,15 +46,17 @@ extern std::string INPUT_FILE;
 extern std::string OUTPUT_FILE;
 extern std::string ARX_VERSION;
 
-auto ASTToLLVMIRVisitor::CreateFunctionType(unsigned NumArgs)
+auto ASTToLLVMIRVisitor::CreateFunctionType(llvm::Function* fn)
   -> llvm::DISubroutineType* {
   llvm::SmallVector<llvm::Metadata*, 8> EltTys;
 
   // Add the result type.
-  EltTys.emplace_back(ArxLLVM::DI_FLOAT_TYPE);
+  EltTys.emplace_back(
+    ArxLLVM::get_di_data_type(ArxLLVM::get_return_type_name(fn)));
 
-  for (unsigned i = 0, e = NumArgs; i != e; ++i) {
-    EltTys.emplace_back(ArxLLVM::DI_FLOAT_TYPE);
+  for (unsigned i = 0, e = fn->arg_size(); i != e; ++i) {
+    EltTys.emplace_back(
+      ArxLLVM::get_di_data_type(ArxLLVM::get_arg_type_name(fn, i)));
   }
 
   return ArxLLVM::di_builder->createSubroutineType(
@@ -60,6 +66,9 @@ auto ASTToLLVMIRVisitor::CreateFunctionType(unsigned NumArgs)
 // DebugInfo
 
 auto ASTToLLVMIRVisitor::emitLocation(ExprAST& ast) -> void {
+  if (!this->llvm_di_compile_unit) {
+    return;
+  }
   if (!std::addressof(ast)) {
     return ArxLLVM::ir_builder->SetCurrentDebugLocation(llvm::DebugLoc());
   }
@@ -84,6 +93,15 @@ auto ASTToLLVMIRVisitor::visit(FloatExprAST& expr) -> void {
   ASTToObjectVisitor::visit(expr);
 }
 
+/**
+ * @brief Code generation for StringExprAST.
+ *
+ */
+auto ASTToLLVMIRVisitor::visit(StringExprAST& expr) -> void {
+  this->emitLocation(expr);
+  ASTToObjectVisitor::visit(expr);
+}
+
 /**
  * @brief Code generation for VariableExprAST.
  *
@@ -147,6 +165,15 @@ auto ASTToLLVMIRVisitor::visit(VarExprAST& expr) -> void {
   ASTToObjectVisitor::visit(expr);
 }
 
+/**
+ * @brief Code generation for ConstExprAST.
+ *
+ */
+auto ASTToLLVMIRVisitor::visit(ConstExprAST& expr) -> void {
+  this->emitLocation(expr);
+  ASTToObjectVisitor::visit(expr);
+}
+
 /**
  * @brief Code generation for PrototypeExprAST.
  *
@@ -159,9 +186,17 @@ auto ASTToLLVMIRVisitor::visit(PrototypeAST& expr) -> void {
  * @brief Code generation for FunctionExprAST.
  *
  * Transfer ownership of the prototype to the ArxLLVM::function_protos map,
- * but keep a reference to it for use below.
+ * but keep a reference to it for use below. The generic functions are only
+ * generated when they are called (see ArxGeneric).
  */
 auto ASTToLLVMIRVisitor::visit(FunctionAST& expr) -> void {
+  if (!expr.proto->type_params.empty()) {
+    ArxGeneric::add(expr);
+    this->result_func = nullptr;
+    return;
+  }
+  ArxGeneric::remove(expr.proto->get_name());
+
   auto& proto = *(expr.proto);
   ArxLLVM::function_protos[expr.proto->get_name()] = std::move(expr.proto);
   this->getFunction(proto.get_name());
@@ -178,67 +213,79 @@ auto ASTToLLVMIRVisitor::visit(FunctionAST& expr) -> void {
     llvm::BasicBlock::Create(*ArxLLVM::context, "entry", fn);
   ArxLLVM::ir_builder->SetInsertPoint(basic_block);
 
+  // the fast-math flags of the function, restored after its body
+  llvm::IRBuilderBase::FastMathFlagGuard fmf_guard(*ArxLLVM::ir_builder);
+  ArxFPMode::apply(fn, proto);
+
   /* debugging-code:start*/
-  // Create a subprogram DIE for this function.
-  llvm::DIFile* di_unit = ArxLLVM::di_builder->createFile(
-    this->llvm_di_compile_unit->getFilename(),
-    this->llvm_di_compile_unit->getDirectory());
-  llvm::DIScope* file_context = di_unit;
+  // Create a subprogram DIE for this function, the line tables only need
+  // its name and its line.
+  llvm::DISubprogram* di_subprogram = nullptr;
   unsigned line_no = proto.get_line();
-  unsigned ScopeLine = line_no;
-  llvm::DISubprogram* di_subprogram = ArxLLVM::di_builder->createFunction(
-    file_context,
-    proto.get_name(),
-    llvm::StringRef(),
-    di_unit,
-    line_no,
-    CreateFunctionType(fn->arg_size()),
-    ScopeLine,
-    llvm::DINode::FlagPrototyped,
-    llvm::DISubprogram::SPFlagDefinition);
-  fn->setSubprogram(di_subprogram);
-
-  // Push the current scope.
-  this->llvm_di_lexical_blocks.emplace_back(di_subprogram);
-
-  // Unset the location for the prologue emission (leading instructions with no
-  // location in a function are considered part of the prologue and the
-  // debugger will run past them when breaking on a function)
-  ExprAST null_ast;
-  this->emitLocation(null_ast);
-
+  if (this->llvm_di_compile_unit) {
+    llvm::DIFile* di_unit = this->llvm_di_compile_unit->getFile();
+    llvm::DISubroutineType* di_function_type = ArxDebugInfo::is_full()
+      ? CreateFunctionType(fn)
+      : ArxLLVM::di_builder->createSubroutineType(
+          ArxLLVM::di_builder->getOrCreateTypeArray(llvm::None));
+    di_subprogram = ArxLLVM::di_builder->createFunction(
+      di_unit,
+      proto.get_name(),
+      llvm::StringRef(),
+      di_unit,
+      line_no,
+      di_function_type,
+      line_no,
+      llvm::DINode::FlagPrototyped,
+      llvm::DISubprogram::SPFlagDefinition);
+    fn->setSubprogram(di_subprogram);
+
+    // Push the current scope.
+    this->llvm_di_lexical_blocks.emplace_back(di_subprogram);
+
+    // Unset the location for the prologue emission (leading instructions
+    // with no location in a function are considered part of the prologue
+    // and the debugger will run past them when breaking on a function)
+    ExprAST null_ast;
+    this->emitLocation(null_ast);
+  }
   /* debugging-code:end*/
 
   // Record the function arguments in the named_values map.
   // std::cout << "Record the function arguments in the named_values map.";
   ArxLLVM::named_values.clear();
+  ArxLLVM::named_types.clear();
 
   unsigned arg_idx = 0;
   for (auto& llvm_arg : fn->args()) {
+    std::string arg_type =
+      ArxLLVM::get_arg_type_name(fn, llvm_arg.getArgNo());
+
     // Create an alloca for this variable.
-    // TODO: get type_name from the actual variable
     llvm::AllocaInst* alloca =
-      this->create_entry_block_alloca(fn, llvm_arg.getName(), "float");
+      this->create_entry_block_alloca(fn, llvm_arg.getName(), arg_type);
 
     /* debugging-code: start */
     // Create a debug descriptor for the variable.
-    llvm::DILocalVariable* di_local_variable =
-      ArxLLVM::di_builder->createParameterVariable(
-        di_subprogram,
-        llvm_arg.getName(),
-        ++arg_idx,
-        di_unit,
-        line_no,
-        ArxLLVM::DI_FLOAT_TYPE,
-        true);
-
-    ArxLLVM::di_builder->insertDeclare(
-      alloca,
-      di_local_variable,
-      ArxLLVM::di_builder->createExpression(),
-      llvm::DILocation::get(
-        di_subprogram->getContext(), line_no, 0, di_subprogram),
-      ArxLLVM::ir_builder->GetInsertBlock());
+    if (di_subprogram && ArxDebugInfo::is_full()) {
+      llvm::DILocalVariable* di_local_variable =
+        ArxLLVM::di_builder->createParameterVariable(
+          di_subprogram,
+          llvm_arg.getName(),
+          ++arg_idx,
+          di_subprogram->getFile(),
+          line_no,
+          ArxLLVM::get_di_data_type(arg_type),
+          true);
+
+      ArxLLVM::di_builder->insertDeclare(
+        alloca,
+        di_local_variable,
+        ArxLLVM::di_builder->createExpression(),
+        llvm::DILocation::get(
+          di_subprogram->getContext(), line_no, 0, di_subprogram),
+        ArxLLVM::ir_builder->GetInsertBlock());
+    }
 
     /* debugging-code-end */
 
@@ -247,6 +294,11 @@ auto ASTToLLVMIRVisitor::visit(FunctionAST& expr) -> void {
 
     // Add arguments to variable symbol table.
     ArxLLVM::named_values[std::string(llvm_arg.getName())] = alloca;
+    ArxLLVM::named_types[std::string(llvm_arg.getName())] = arg_type;
+  }
+
+  if (proto.args.empty() && proto.get_name() != "__anon_expr") {
+    proto.constant = this->fold_constant(*expr.body, proto.constant_type);
   }
 
   this->emitLocation(*expr.body.get());
@@ -254,18 +306,34 @@ auto ASTToLLVMIRVisitor::visit(FunctionAST& expr) -> void {
   expr.body->accept(*this);
   llvm::Value* llvm_return_val = this->result_val;
 
+  if (llvm_return_val) {
+    llvm_return_val = this->cast_value(
+      *expr.body,
+      llvm_return_val,
+      this->result_type,
+      ArxLLVM::get_return_type_name(fn));
+  }
+
   if (llvm_return_val) {
     // Finish off the function.
     ArxLLVM::ir_builder->CreateRet(llvm_return_val);
 
-    // Pop off the lexical block for the function.
-    this->llvm_di_lexical_blocks.pop_back();
-
     // Validate the generated code, checking for consistency.
     llvm::verifyFunction(*fn);
 
-    this->result_func = fn;
-    return;
+    proto.is_pure = ArxConstEval::is_pure(proto, *expr.body);
+
+    ArxTailCall::eliminate(fn, proto, *expr.body);
+
+    if (ArxMemo::apply(fn, proto, *expr.body)) {
+      // Pop off the lexical block for the function.
+      if (di_subprogram) {
+        this->llvm_di_lexical_blocks.pop_back();
+      }
+
+      this->result_func = fn;
+      return;
+    }
   }
 
   // Error reading body, remove function.
@@ -273,9 +341,10 @@ auto ASTToLLVMIRVisitor::visit(FunctionAST& expr) -> void {
 
   this->result_func = nullptr;
 
-  // Pop off the lexical block for the function since we added it
-  // unconditionally.
-  this->llvm_di_lexical_blocks.pop_back();
+  // Pop off the lexical block for the function.
+  if (di_subprogram) {
+    this->llvm_di_lexical_blocks.pop_back();
+  }
 }
 
 /**
@@ -284,6 +353,10 @@ auto ASTToLLVMIRVisitor::visit(FunctionAST& expr) -> void {
  */
 auto ASTToLLVMIRVisitor::initialize() -> void {
   ArxLLVM::initialize();
+
+  // the compile unit of the input file, nullptr without -g
+  this->llvm_di_compile_unit = ArxDebugInfo::create_compile_unit(INPUT_FILE);
+  this->llvm_di_lexical_blocks.clear();
 }
 
 /**
@@ -301,50 +374,16 @@ auto compile_llvm_ir(TreeAST& ast) -> int {
   // Run the main "interpreter loop" now.
   LOG(INFO) << "Starting main_loop";
 
-  // Create the compile unit for the module.
-  // Currently down as "fib.ks" as a filename since we're redirecting stdin
-  // but we'd like actual source locations.
-  codegen->llvm_di_compile_unit = ArxLLVM::di_builder->createCompileUnit(
-    llvm::dwarf::DW_LANG_C,
-    ArxLLVM::di_builder->createFile("fib.ks", "."),
-    "Arx Compiler",
-    false,
-    "",
-    0);
-
-  LOG(INFO) << "initialize Target";
-
-  // Add the current debug info version into the module.
-  ArxLLVM::module->addModuleFlag(
-    llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
-
-  // Darwin only supports dwarf2.
-  if (llvm::Triple(llvm::sys::getProcessTriple()).isOSDarwin()) {
-    ArxLLVM::module->addModuleFlag(llvm::Module::Warning, "Dwarf Version", 2);
-  }
-
-  // Construct the DIBuilder, we do this here because we need the module.
-  ArxLLVM::di_builder = std::make_unique<llvm::DIBuilder>(*ArxLLVM::module);
-
-  // Create the compile unit for the module.
-  // Currently down as "fib.ks" as a filename since we're redirecting stdin
-  // but we'd like actual source locations.
-  codegen->llvm_di_compile_unit = ArxLLVM::di_builder->createCompileUnit(
-    llvm::dwarf::DW_LANG_C,
-    ArxLLVM::di_builder->createFile("fib.arxks", "."),
-    "Arx Compiler",
-    false,
-    "",
-    0);
-
-  // Run the main "interpreter loop" now.
   codegen->main_loop(ast);
 
   // Finalize the debug info.
-  ArxLLVM::di_builder->finalize();
+  ArxDebugInfo::finalize();
+
+  ArxFPMode::record(*ArxLLVM::module);
 
-  // Print out all of the generated code.
-  ArxLLVM::module->print(llvm::errs(), nullptr);
+  // Print out all of the generated code, llvm::errs() is not buffered.
+  llvm::raw_fd_ostream err_stream(fileno(stderr), false);
+  ArxLLVM::module->print(err_stream, nullptr);
 
   return 0;
 }
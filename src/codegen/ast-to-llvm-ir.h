@@ -40,7 +40,8 @@ auto open_shell_llvm_ir() -> int;
 class ASTToLLVMIRVisitor : public ASTToObjectVisitor {
  public:
   // DebugInfo
-  llvm::DICompileUnit* llvm_di_compile_unit;
+  // nullptr without debug information (see ArxDebugInfo)
+  llvm::DICompileUnit* llvm_di_compile_unit = nullptr;
   std::vector<llvm::DIScope*> llvm_di_lexical_blocks;
 
   llvm::ExitOnError exit_on_err;
@@ -48,6 +49,7 @@ class ASTToLLVMIRVisitor : public ASTToObjectVisitor {
   ASTToLLVMIRVisitor() = default;
 
   virtual void visit(FloatExprAST&) override;
+  virtual void visit(StringExprAST&) override;
   virtual void visit(VariableExprAST&) override;
   virtual void visit(UnaryExprAST&) override;
   virtual void visit(BinaryExprAST&) override;
@@ -55,11 +57,12 @@ class ASTToLLVMIRVisitor : public ASTToObjectVisitor {
   virtual void visit(IfExprAST&) override;
   virtual void visit(ForExprAST&) override;
   virtual void visit(VarExprAST&) override;
+  virtual void visit(ConstExprAST&) override;
   virtual void visit(PrototypeAST&) override;
   virtual void visit(FunctionAST&) override;
 
   auto initialize() -> void;
-  auto CreateFunctionType(unsigned NumArgs) -> llvm::DISubroutineType*;
+  auto CreateFunctionType(llvm::Function* fn) -> llvm::DISubroutineType*;
 
   // DebugInfo
   void emitLocation(ExprAST& AST);
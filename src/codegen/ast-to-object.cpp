@@ -1,48 +1,73 @@
-#include <cassert>  // for assert
-#include <cstdio>   // for fprintf, stderr, fputc
-#include <cstdlib>  // for exit
+#include <algorithm>  // for max, min
+#include <cctype>     // for isdigit
+#include <cmath>      // for pow
+#include <cstdio>     // for fprintf, stderr
+#include <cstdlib>    // for exit
 #include <iostream>
 #include <map>           // for map, operator==, _Rb_tree_ite...
 #include <memory>        // for unique_ptr, allocator, make_u...
+#include <set>           // for set
 #include <string>        // for string, operator<=>, operator+
-#include <system_error>  // for error_code
 #include <utility>       // for pair, move
 #include <vector>        // for vector
 
 #include <glog/logging.h>               // for COMPACT_GOOGLE_LOG_INFO, LOG
 #include <llvm/ADT/APFloat.h>           // for APFloat
+#include <llvm/ADT/APInt.h>             // for APInt
 #include <llvm/ADT/iterator_range.h>    // for iterator_range
 #include <llvm/ADT/Optional.h>          // for Optional
+#include <llvm/ADT/StringMap.h>         // for StringMap
 #include <llvm/ADT/StringRef.h>         // for StringRef
 #include <llvm/ADT/Twine.h>             // for Twine
 #include <llvm/IR/Argument.h>           // for Argument
 #include <llvm/IR/BasicBlock.h>         // for BasicBlock
 #include <llvm/IR/Constant.h>           // for Constant
 #include <llvm/IR/Constants.h>          // for ConstantFP
+#include <llvm/IR/DebugInfo.h>          // for stripDebugInfo
+#include <llvm/IR/DebugLoc.h>           // for DebugLoc
 #include <llvm/IR/DerivedTypes.h>       // for FunctionType
 #include <llvm/IR/Function.h>           // for Function
 #include <llvm/IR/Instructions.h>       // for AllocaInst, CallInst, PHINode
+#include <llvm/IR/Intrinsics.h>         // for Intrinsic
 #include <llvm/IR/IRBuilder.h>          // for IRBuilder
-#include <llvm/IR/LegacyPassManager.h>  // for PassManager
 #include <llvm/IR/LLVMContext.h>        // for LLVMContext
 #include <llvm/IR/Module.h>             // for Module
+#include <llvm/IR/Operator.h>           // for FastMathFlags
 #include <llvm/IR/Type.h>               // for Type
 #include <llvm/IR/Verifier.h>           // for verifyFunction
 #include <llvm/MC/TargetRegistry.h>     // for Target, TargetRegistry
-#include <llvm/Support/CodeGen.h>       // for CodeGenFileType, Model
-#include <llvm/Support/FileSystem.h>    // for OpenFlags
-#include <llvm/Support/Host.h>          // for getDefaultTargetTriple
+#include <llvm/Support/CodeGen.h>       // for Model
+#include <llvm/Support/FileSystem.h>    // for OpenFlags, remove
+#include <llvm/Support/Host.h>          // for getDefaultTargetTriple, get...
 #include <llvm/Support/raw_ostream.h>   // for errs, raw_fd_ostream, raw_ost...
 #include <llvm/Support/TargetSelect.h>  // for InitializeAllAsmParsers, Init...
 #include <llvm/Target/TargetMachine.h>  // for TargetMachine
 #include <llvm/Target/TargetOptions.h>  // for TargetOptions
 
-#include "codegen/arx-llvm.h"       // for ArxLLVM
-#include "codegen/ast-to-object.h"  // for ASTToObjectVisitor, compile_o...
-#include "error.h"                  // for LogErrorV
-#include "io.h"                     // for ArxFile
-#include "lexer.h"                  // for Lexer
-#include "parser.h"                 // for PrototypeAST, ExprAST, ForExp...
+#include "arx-parallel.h"            // for ArxReduceOp
+#include "arx-string.h"              // for ARX_STRING_INLINE_SIZE
+#include "codegen/arx-llvm.h"        // for ArxLLVM
+#include "codegen/ast-to-llvm-ir.h"  // for ASTToLLVMIRVisitor
+#include "codegen/ast-to-object.h"   // for ASTToObjectVisitor, compile_o...
+#include "codegen/const-eval.h"      // for ArxConstEval
+#include "codegen/debug-info.h"      // for ArxDebugInfo
+#include "codegen/emit.h"            // for ArxEmit
+#include "codegen/escape.h"          // for ArxEscape
+#include "codegen/fp-mode.h"         // for ArxFPMode
+#include "codegen/generic.h"         // for ArxGeneric, TypeArgs
+#include "codegen/lto.h"             // for ArxLTO
+#include "codegen/math.h"            // for ArxMath
+#include "codegen/memo.h"            // for ArxMemo
+#include "codegen/profile.h"         // for ArxProfile
+#include "codegen/record.h"          // for ArxRecord
+#include "codegen/tail-call.h"       // for ArxTailCall
+#include "codegen/vector.h"          // for ArxVector
+#include "datatypes.h"               // for get_decimal_scale, is_decimal_type
+#include "error.h"                   // for LogErrorV
+#include "io.h"                      // for INPUT_FILE, OUTPUT_FILE
+#include "lexer.h"                   // for Lexer
+#include "parser.h"                  // for PrototypeAST, ExprAST, ForExp...
+#include "time-report.h"             // for ArxTimeReport, ArxPhase
 
 namespace llvm {
   class Value;
@@ -80,6 +105,7 @@ auto ASTToObjectVisitor::getFunction(std::string name) -> void {
     return;
   }
 
+  this->result_func = nullptr;
   auto FI = ArxLLVM::function_protos.find(name);
   if (FI != ArxLLVM::function_protos.end()) {
     FI->second->accept(*this);
@@ -111,6 +137,449 @@ auto ASTToObjectVisitor::create_entry_block_alloca(
 auto ASTToObjectVisitor::clean() -> void {
   this->result_val = nullptr;
   this->result_func = nullptr;
+  this->result_type = "";
+}
+
+/**
+ * @brief Get 10^exponent as a constant of the given integer type.
+ *
+ */
+static auto get_pow10(llvm::Type* type, int exponent) -> llvm::ConstantInt* {
+  llvm::APInt value(type->getIntegerBitWidth(), 1);
+  for (int i = 0; i < exponent; ++i) {
+    value *= 10;
+  }
+  return llvm::ConstantInt::get(*ArxLLVM::context, value);
+}
+
+/**
+ * @brief Get the value of a numeric literal scaled by 10^scale.
+ * @param expr The numeric literal.
+ * @param type The integer type of the result.
+ * @param scale The number of decimal digits kept after the point.
+ *
+ * The conversion uses the literal text, so it is exact (e.g. 0.1 is 1 with
+ * scale 1 instead of the nearest float). The literals without text (e.g.
+ * folded by the AST passes) use the float with 6 decimals (std::to_string),
+ * so they are not exact. Extra digits are rounded half away from zero.
+ */
+static auto get_scaled_literal(
+  FloatExprAST& expr, llvm::Type* type, int scale) -> llvm::ConstantInt* {
+  std::string literal =
+    expr.literal.empty() ? std::to_string(expr.val) : expr.literal;
+
+  // the magnitude is rounded, then negated
+  bool is_negative = !literal.empty() && literal[0] == '-';
+  if (is_negative) {
+    literal.erase(0, 1);
+  }
+
+  size_t point = literal.find('.');
+  std::string digits = literal.substr(0, point);
+  std::string fraction =
+    point == std::string::npos ? "" : literal.substr(point + 1);
+
+  bool round_up = static_cast<int>(fraction.size()) > scale &&
+    fraction[static_cast<size_t>(scale)] >= '5';
+  fraction.resize(static_cast<size_t>(scale), '0');
+  digits += fraction;
+
+  llvm::APInt value(
+    type->getIntegerBitWidth(), digits.empty() ? "0" : digits, 10);
+  if (round_up) {
+    ++value;
+  }
+  if (is_negative) {
+    value.negate();
+  }
+  return llvm::ConstantInt::get(*ArxLLVM::context, value);
+}
+
+/**
+ * @brief Get the decimal type of a numeric literal, like decimal128(3,2)
+ *        for 1.25.
+ *
+ */
+static auto get_literal_decimal_type(FloatExprAST& expr) -> std::string {
+  int scale = get_literal_scale(expr.literal);
+  int precision = 0;
+  for (char c : expr.literal) {
+    if (isdigit(c) && (precision > 0 || c != '0')) {
+      ++precision;
+    }
+  }
+  return get_decimal_type_name(std::max(precision, scale + 1), scale);
+}
+
+/**
+ * @brief Divide a wide unsigned integer by 10^exponent, in 64-bit limbs.
+ * @param value The unsigned value, its width is a multiple of 64 bits.
+ * @param exponent The power of ten of the divisor.
+ *
+ * The backend can't lower a division wider than 128 bits (e.g. the i256 of
+ * decimal256), so each limb is divided as an i128 by a divisor of at most
+ * 10^19, which fits in 64 bits. Larger divisors are split in such steps.
+ */
+static auto udiv_pow10_by_limbs(llvm::Value* value, int exponent)
+  -> llvm::Value* {
+  llvm::Type* value_type = value->getType();
+  unsigned limbs = value_type->getIntegerBitWidth() / 64;
+
+  while (exponent > 0) {
+    int step = std::min(exponent, 19);
+    exponent -= step;
+
+    llvm::Value* divisor = get_pow10(ArxLLVM::INT128_TYPE, step);
+    llvm::Value* remainder =
+      llvm::ConstantInt::get(ArxLLVM::INT128_TYPE, 0);
+    llvm::Value* quotient = llvm::ConstantInt::get(value_type, 0);
+
+    // the remainder is below the divisor, so each partial quotient fits in
+    // a limb
+    for (unsigned i = limbs; i-- > 0;) {
+      llvm::Value* limb = ArxLLVM::ir_builder->CreateZExt(
+        ArxLLVM::ir_builder->CreateTrunc(
+          ArxLLVM::ir_builder->CreateLShr(value, 64 * i),
+          ArxLLVM::INT64_TYPE),
+        ArxLLVM::INT128_TYPE);
+      llvm::Value* current = ArxLLVM::ir_builder->CreateOr(
+        ArxLLVM::ir_builder->CreateShl(remainder, 64), limb);
+      llvm::Value* limb_quotient =
+        ArxLLVM::ir_builder->CreateUDiv(current, divisor);
+      remainder = ArxLLVM::ir_builder->CreateURem(current, divisor);
+      quotient = ArxLLVM::ir_builder->CreateOr(
+        quotient,
+        ArxLLVM::ir_builder->CreateShl(
+          ArxLLVM::ir_builder->CreateZExt(limb_quotient, value_type),
+          64 * i));
+    }
+    value = quotient;
+  }
+  return value;
+}
+
+/**
+ * @brief Change the scale of a decimal value.
+ * @param value The scaled integer value.
+ * @param from_scale The current scale.
+ * @param to_scale The new scale.
+ * @param type The integer type of the result.
+ *
+ * When the scale is reduced, the value is rounded half away from zero.
+ */
+static auto rescale_decimal(
+  llvm::Value* value, int from_scale, int to_scale, llvm::Type* type)
+  -> llvm::Value* {
+  // extend before scaling up, so it doesn't overflow
+  if (
+    value->getType()->getIntegerBitWidth() < type->getIntegerBitWidth()) {
+    value = ArxLLVM::ir_builder->CreateSExt(value, type, "decext");
+  }
+
+  llvm::Type* value_type = value->getType();
+
+  if (to_scale > from_scale) {
+    value = ArxLLVM::ir_builder->CreateMul(
+      value, get_pow10(value_type, to_scale - from_scale), "rescale");
+  } else if (to_scale < from_scale) {
+    llvm::ConstantInt* divisor = get_pow10(value_type, from_scale - to_scale);
+    llvm::APInt half = divisor->getValue().udiv(2);
+    llvm::Value* is_negative = ArxLLVM::ir_builder->CreateICmpSLT(
+      value, llvm::ConstantInt::get(value_type, 0));
+    llvm::Value* adjust = ArxLLVM::ir_builder->CreateSelect(
+      is_negative,
+      llvm::ConstantInt::get(*ArxLLVM::context, -half),
+      llvm::ConstantInt::get(*ArxLLVM::context, half));
+    value = ArxLLVM::ir_builder->CreateAdd(value, adjust);
+
+    if (value_type->getIntegerBitWidth() > 128) {
+      // divide the magnitude, the division truncates toward zero as sdiv
+      llvm::Value* magnitude = ArxLLVM::ir_builder->CreateSelect(
+        is_negative, ArxLLVM::ir_builder->CreateNeg(value), value);
+      llvm::Value* quotient =
+        udiv_pow10_by_limbs(magnitude, from_scale - to_scale);
+      value = ArxLLVM::ir_builder->CreateSelect(
+        is_negative,
+        ArxLLVM::ir_builder->CreateNeg(quotient),
+        quotient,
+        "rescale");
+    } else {
+      value = ArxLLVM::ir_builder->CreateSDiv(value, divisor, "rescale");
+    }
+  }
+
+  if (value_type->getIntegerBitWidth() > type->getIntegerBitWidth()) {
+    value = ArxLLVM::ir_builder->CreateTrunc(value, type, "dectrunc");
+  }
+  return value;
+}
+
+/**
+ * @brief Get the value of a string literal (see arx-string.h).
+ *
+ * Short strings are an integer constant with the data inline. Long strings
+ * are stored in a global constant and the value points to it.
+ */
+static auto get_string_literal(const std::string& literal) -> llvm::Value* {
+  llvm::APInt value(128, literal.size());
+  size_t inline_size = literal.size() <= ARX_STRING_INLINE_SIZE
+    ? literal.size()
+    : 4 /* prefix */;
+
+  for (size_t i = 0; i < inline_size; ++i) {
+    llvm::APInt byte(128, static_cast<uint8_t>(literal[i]));
+    value |= byte.shl(static_cast<unsigned>(32 + 8 * i));
+  }
+
+  llvm::Constant* constant =
+    llvm::ConstantInt::get(*ArxLLVM::context, value);
+  if (literal.size() <= ARX_STRING_INLINE_SIZE) {
+    return constant;
+  }
+
+  llvm::Value* data = ArxLLVM::ir_builder->CreateGlobalString(
+    literal, ".str", 0, ArxLLVM::module.get());
+  llvm::Value* ptr = ArxLLVM::ir_builder->CreateShl(
+    ArxLLVM::ir_builder->CreatePtrToInt(data, ArxLLVM::INT128_TYPE), 64);
+  return ArxLLVM::ir_builder->CreateOr(ptr, constant, "strtmp");
+}
+
+/**
+ * @brief Get a string function from the runtime (see arx-string.h).
+ * @param name The function name.
+ * @param return_type The return type, the arguments are two strings.
+ */
+static auto get_string_function(const char* name, llvm::Type* return_type)
+  -> llvm::FunctionCallee {
+  return ArxLLVM::module->getOrInsertFunction(
+    name, return_type, ArxLLVM::INT128_TYPE, ArxLLVM::INT128_TYPE);
+}
+
+/**
+ * @brief Convert a value between two data types.
+ * @param expr The expression that generated the value.
+ * @param value The value to be converted.
+ * @param from_type The type name of the value.
+ * @param to_type The target type name.
+ * @return The converted value or nullptr if the conversion is not valid.
+ *
+ * Numeric literals are converted from their text, so they are exact for
+ * decimals. Temporal types with different units are converted between
+ * each other (e.g. date32 to timestamp), but not to decimals.
+ */
+auto ASTToObjectVisitor::cast_value(
+  ExprAST& expr,
+  llvm::Value* value,
+  const std::string& from_type,
+  const std::string& to_type) -> llvm::Value* {
+  if (from_type == to_type) {
+    return value;
+  }
+
+  if (from_type == "float" && is_vector_type(to_type)) {
+    return ArxVector::emit_broadcast(value, to_type);
+  }
+
+  llvm::Type* to_llvm_type = ArxLLVM::get_data_type(to_type);
+  ExprKind from_kind = get_type_kind(from_type);
+  ExprKind to_kind = get_type_kind(to_type);
+
+  if (from_kind == ExprKind::FloatDTKind) {
+    if (expr.kind == ExprKind::FloatDTKind) {
+      int scale = is_decimal_type(to_type) ? get_decimal_scale(to_type) : 0;
+      return get_scaled_literal(
+        static_cast<FloatExprAST&>(expr), to_llvm_type, scale);
+    }
+    if (is_temporal_type(to_type)) {
+      return ArxLLVM::ir_builder->CreateFPToSI(value, to_llvm_type, "fptoi");
+    }
+    if (is_decimal_type(to_type)) {
+      llvm::Value* scaled = ArxLLVM::ir_builder->CreateFMul(
+        ArxLLVM::ir_builder->CreateFPExt(value, ArxLLVM::DOUBLE_TYPE),
+        llvm::ConstantFP::get(
+          ArxLLVM::DOUBLE_TYPE, std::pow(10.0, get_decimal_scale(to_type))));
+      scaled = ArxLLVM::ir_builder->CreateUnaryIntrinsic(
+        llvm::Intrinsic::round, scaled);
+      return ArxLLVM::ir_builder->CreateFPToSI(scaled, to_llvm_type, "fptod");
+    }
+  }
+
+  if (to_kind == ExprKind::FloatDTKind) {
+    if (is_temporal_type(from_type)) {
+      return ArxLLVM::ir_builder->CreateSIToFP(value, to_llvm_type, "itofp");
+    }
+    if (is_decimal_type(from_type)) {
+      llvm::Value* unscaled = ArxLLVM::ir_builder->CreateFDiv(
+        ArxLLVM::ir_builder->CreateSIToFP(value, ArxLLVM::DOUBLE_TYPE),
+        llvm::ConstantFP::get(
+          ArxLLVM::DOUBLE_TYPE,
+          std::pow(10.0, get_decimal_scale(from_type))));
+      return ArxLLVM::ir_builder->CreateFPTrunc(
+        unscaled, to_llvm_type, "dtofp");
+    }
+  }
+
+  bool from_time = from_kind == ExprKind::Time32DTKind ||
+    from_kind == ExprKind::Time64DTKind;
+  bool to_time =
+    to_kind == ExprKind::Time32DTKind || to_kind == ExprKind::Time64DTKind;
+
+  if (
+    is_temporal_type(from_type) && is_temporal_type(to_type) &&
+    from_time == to_time) {
+    int64_t from_ticks = get_temporal_ticks_per_day(from_type);
+    int64_t to_ticks = get_temporal_ticks_per_day(to_type);
+
+    if (to_ticks > from_ticks) {
+      value = ArxLLVM::ir_builder->CreateSExtOrTrunc(value, to_llvm_type);
+      return ArxLLVM::ir_builder->CreateMul(
+        value,
+        llvm::ConstantInt::get(to_llvm_type, to_ticks / from_ticks),
+        "tounit");
+    }
+    // floor division, so the times before the epoch go to the previous
+    // unit (e.g. -1 us is the day -1)
+    llvm::Value* ratio =
+      llvm::ConstantInt::get(value->getType(), from_ticks / to_ticks);
+    llvm::Value* quotient =
+      ArxLLVM::ir_builder->CreateSDiv(value, ratio, "tounit");
+    llvm::Value* is_below = ArxLLVM::ir_builder->CreateICmpSLT(
+      ArxLLVM::ir_builder->CreateSRem(value, ratio),
+      llvm::ConstantInt::get(value->getType(), 0));
+    value = ArxLLVM::ir_builder->CreateSub(
+      quotient,
+      ArxLLVM::ir_builder->CreateZExt(is_below, value->getType()),
+      "tounit");
+    return ArxLLVM::ir_builder->CreateSExtOrTrunc(value, to_llvm_type);
+  }
+
+  // string and binary have the same layout
+  if (is_string_type(from_type) && is_string_type(to_type)) {
+    return value;
+  }
+
+  if (is_decimal_type(from_type) && is_decimal_type(to_type)) {
+    return rescale_decimal(
+      value,
+      get_decimal_scale(from_type),
+      get_decimal_scale(to_type),
+      to_llvm_type);
+  }
+
+  std::string msg = "Codegen: Cannot convert " + from_type + " to " + to_type;
+  return LogErrorV(msg.c_str());
+}
+
+/**
+ * @brief Evaluate a constant expression at compile time.
+ * @param expr The expression
+ * @param type_name Set to the type name of the result
+ * @return A literal with the value, or nullptr if it is not constant.
+ *
+ * Constant expressions are literals, constants, calls to functions without
+ * arguments that return a constant, the builtin operators on float and
+ * string constants and `if` with a constant condition. Float operations
+ * use the float arithmetic, so the result is the same as at runtime.
+ */
+auto ASTToObjectVisitor::fold_constant(ExprAST& expr, std::string& type_name)
+  -> std::unique_ptr<ExprAST> {
+  switch (expr.kind) {
+    case ExprKind::FloatDTKind: {
+      auto& literal = static_cast<FloatExprAST&>(expr);
+      type_name = "float";
+      return std::make_unique<FloatExprAST>(literal.val, literal.literal);
+    }
+    case ExprKind::StringDTKind: {
+      type_name = "string";
+      return std::make_unique<StringExprAST>(
+        static_cast<StringExprAST&>(expr).val);
+    }
+    case ExprKind::VariableKind: {
+      auto& var = static_cast<VariableExprAST&>(expr);
+      auto constant = ArxLLVM::named_constants.find(var.name);
+      if (
+        ArxLLVM::named_values[var.name] ||
+        constant == ArxLLVM::named_constants.end() || !constant->second) {
+        return nullptr;
+      }
+      auto value = this->fold_constant(*constant->second, type_name);
+      type_name = ArxLLVM::named_constant_types[var.name];
+      return value;
+    }
+    case ExprKind::CallKind: {
+      auto& call = static_cast<CallExprAST&>(expr);
+      auto proto = ArxLLVM::function_protos.find(call.callee);
+      if (proto == ArxLLVM::function_protos.end()) {
+        return nullptr;
+      }
+
+      if (!call.args.empty()) {
+        return this->evaluate_call(call, type_name);
+      }
+      if (
+        !proto->second->constant ||
+        proto->second->constant_type != proto->second->type_name) {
+        return nullptr;
+      }
+      auto value = this->fold_constant(*proto->second->constant, type_name);
+      type_name = proto->second->constant_type;
+      return value;
+    }
+    case ExprKind::IfKind: {
+      auto& if_expr = static_cast<IfExprAST&>(expr);
+      std::string cond_type;
+      auto cond = this->fold_constant(*if_expr.cond, cond_type);
+      if (!cond || cond_type != "float") {
+        return nullptr;
+      }
+      if (static_cast<FloatExprAST&>(*cond).val != 0.0f) {
+        return this->fold_constant(*if_expr.then, type_name);
+      }
+      return this->fold_constant(*if_expr.else_, type_name);
+    }
+    case ExprKind::BinaryOpKind: {
+      auto& binary = static_cast<BinaryExprAST&>(expr);
+      std::string lhs_type, rhs_type;
+      auto lhs = this->fold_constant(*binary.lhs, lhs_type);
+      auto rhs = this->fold_constant(*binary.rhs, rhs_type);
+      if (!lhs || !rhs || lhs_type != rhs_type) {
+        return nullptr;
+      }
+
+      if (lhs_type == "float") {
+        float lhs_val = static_cast<FloatExprAST&>(*lhs).val;
+        float rhs_val = static_cast<FloatExprAST&>(*rhs).val;
+        type_name = "float";
+        switch (binary.op) {
+          case '+':
+            return std::make_unique<FloatExprAST>(lhs_val + rhs_val);
+          case '-':
+            return std::make_unique<FloatExprAST>(lhs_val - rhs_val);
+          case '*':
+            return std::make_unique<FloatExprAST>(lhs_val * rhs_val);
+          case '<':
+            // unordered, like the `fcmp ult` emitted for the operator
+            return std::make_unique<FloatExprAST>(
+              !(lhs_val >= rhs_val) ? 1.0f : 0.0f);
+        }
+      } else if (is_string_type(lhs_type)) {
+        const std::string& lhs_val = static_cast<StringExprAST&>(*lhs).val;
+        const std::string& rhs_val = static_cast<StringExprAST&>(*rhs).val;
+        switch (binary.op) {
+          case '+':
+            type_name = lhs_type;
+            return std::make_unique<StringExprAST>(lhs_val + rhs_val);
+          case '<':
+            type_name = "float";
+            return std::make_unique<FloatExprAST>(
+              lhs_val < rhs_val ? 1.0f : 0.0f);
+        }
+      }
+      return nullptr;
+    }
+    default:
+      return nullptr;
+  }
 }
 
 /**
@@ -120,23 +589,104 @@ auto ASTToObjectVisitor::clean() -> void {
 auto ASTToObjectVisitor::visit(FloatExprAST& expr) -> void {
   this->result_val =
     llvm::ConstantFP::get(*ArxLLVM::context, llvm::APFloat(expr.val));
+  this->result_type = "float";
+}
+
+/**
+ * @brief Code generation for StringExprAST.
+ *
+ */
+auto ASTToObjectVisitor::visit(StringExprAST& expr) -> void {
+  this->result_val = get_string_literal(expr.val);
+  this->result_type = "string";
+}
+
+/**
+ * @brief Evaluate a call to a pure function with constant arguments.
+ * @param expr The call expression
+ * @param type_name Set to the type name of the result
+ * @return A literal with the result, or nullptr if it was not evaluated.
+ */
+auto ASTToObjectVisitor::evaluate_call(
+  CallExprAST& expr, std::string& type_name) -> std::unique_ptr<ExprAST> {
+  auto proto = ArxLLVM::function_protos.find(expr.callee);
+  if (
+    proto == ArxLLVM::function_protos.end() || !proto->second->is_pure ||
+    proto->second->args.size() != expr.args.size()) {
+    return nullptr;
+  }
+
+  std::vector<float> args;
+  for (auto& arg : expr.args) {
+    std::string arg_type;
+    auto value = this->fold_constant(*arg, arg_type);
+    if (!value || arg_type != "float") {
+      return nullptr;
+    }
+    args.push_back(static_cast<FloatExprAST&>(*value).val);
+  }
+
+  llvm::Function* fn = ArxLLVM::module->getFunction(expr.callee);
+  float result;
+  if (!fn || !ArxConstEval::evaluate(fn, args, result)) {
+    return nullptr;
+  }
+
+  type_name = "float";
+  return std::make_unique<FloatExprAST>(result);
+}
+
+/**
+ * @brief Emit the value of a folded constant expression.
+ * @param expr The expression, it is used for the debug location
+ * @param value The literal returned by fold_constant
+ * @param from_type The type name of the constant
+ * @param to_type The type name of the result
+ */
+auto ASTToObjectVisitor::emit_constant(
+  ExprAST& expr,
+  std::unique_ptr<ExprAST> value,
+  const std::string& from_type,
+  const std::string& to_type) -> void {
+  value->loc = expr.loc;
+  value->accept(*this);
+  if (!this->result_val) {
+    return;
+  }
+
+  this->result_val =
+    this->cast_value(*value, this->result_val, this->result_type, from_type);
+  if (this->result_val) {
+    this->result_val =
+      this->cast_value(*value, this->result_val, from_type, to_type);
+  }
+  this->result_type = to_type;
 }
 
 /**
  * @brief Code generation for VariableExprAST.
  *
+ * Constants are replaced by their values.
  */
 auto ASTToObjectVisitor::visit(VariableExprAST& expr) -> void {
   llvm::Value* expr_var = ArxLLVM::named_values[expr.name];
 
   if (!expr_var) {
+    std::string const_type;
+    auto value = this->fold_constant(expr, const_type);
+    if (value) {
+      this->emit_constant(expr, std::move(value), const_type, const_type);
+      return;
+    }
+
     auto msg = std::string("Unknown variable name: ") + expr.name;
     this->result_val = LogErrorV(msg.c_str());
     return;
   }
 
+  this->result_type = ArxLLVM::named_types[expr.name];
   this->result_val = ArxLLVM::ir_builder->CreateLoad(
-    ArxLLVM::FLOAT_TYPE, expr_var, expr.name.c_str());
+    ArxLLVM::get_data_type(this->result_type), expr_var, expr.name.c_str());
 }
 
 /**
@@ -152,6 +702,8 @@ auto ASTToObjectVisitor::visit(UnaryExprAST& expr) -> void {
     return;
   }
 
+  std::string operand_type = this->result_type;
+
   this->getFunction(std::string("unary") + expr.op_code);
   llvm::Function* fn = this->result_func;
   if (!fn) {
@@ -159,18 +711,39 @@ auto ASTToObjectVisitor::visit(UnaryExprAST& expr) -> void {
     return;
   }
 
+  operand_value = this->cast_value(
+    *expr.operand,
+    operand_value,
+    operand_type,
+    ArxLLVM::get_arg_type_name(fn, 0));
+  if (!operand_value) {
+    this->result_val = nullptr;
+    return;
+  }
+
   this->result_val =
     ArxLLVM::ir_builder->CreateCall(fn, operand_value, "unop");
+  this->result_type = ArxLLVM::get_return_type_name(fn);
 }
 
 /**
  * @brief Code generation for BinaryExprAST.
  *
+ * The operands are converted to a common type first: numeric literals take
+ * the type of the other operand, and float values are converted to the
+ * temporal or decimal type of the other operand. Temporal values are
+ * integers in their own unit. Decimal additions use the largest scale of
+ * the operands and multiplications add their scales, like Arrow.
  */
 auto ASTToObjectVisitor::visit(BinaryExprAST& expr) -> void {
   // Special case '=' because we don't want to emit the lhs as an
   // expression.*/
   if (expr.op == '=') {
+    if (expr.lhs->kind == ExprKind::AccessKind) {
+      return this->emit_access_store(
+        static_cast<AccessExprAST&>(*expr.lhs), *expr.rhs);
+    }
+
     // Assignment requires the lhs to be an identifier.
     // This assume we're building without RTTI because LLVM builds that
     // way by default.  If you build LLVM with RTTI this can be changed
@@ -192,62 +765,297 @@ auto ASTToObjectVisitor::visit(BinaryExprAST& expr) -> void {
 
     // Look up the name.//
     llvm::Value* variable = ArxLLVM::named_values[var_lhs->get_name()];
+    if (!variable && ArxLLVM::named_constants[var_lhs->get_name()]) {
+      std::string msg =
+        "Codegen: Cannot assign to const `" + var_lhs->get_name() + "`";
+      this->result_val = LogErrorV(msg.c_str());
+      return;
+    }
     if (!variable) {
       this->result_val = LogErrorV("Unknown variable name");
       return;
     }
 
+    std::string var_type = ArxLLVM::named_types[var_lhs->get_name()];
+    if (is_array_type(var_type)) {
+      this->result_val = LogErrorV("Codegen: Arrays can't be assigned");
+      return;
+    }
+    val = this->cast_value(*expr.rhs, val, this->result_type, var_type);
+    if (!val) {
+      this->result_val = nullptr;
+      return;
+    }
+
     ArxLLVM::ir_builder->CreateStore(val, variable);
     this->result_val = val;
+    this->result_type = var_type;
+    return;
   }
 
   expr.lhs.get()->accept(*this);
   llvm::Value* llvm_val_lhs = this->result_val;
+  std::string lhs_type = this->result_type;
   expr.rhs.get()->accept(*this);
   llvm::Value* llvm_val_rhs = this->result_val;
+  std::string rhs_type = this->result_type;
 
   if (!llvm_val_lhs || !llvm_val_rhs) {
     this->result_val = nullptr;
     return;
   }
 
-  switch (expr.op) {
-    case '+':
-      this->result_val =
-        ArxLLVM::ir_builder->CreateFAdd(llvm_val_lhs, llvm_val_rhs, "addtmp");
+  // lane-wise operators, a float operand is broadcast
+  if (is_vector_type(lhs_type) || is_vector_type(rhs_type)) {
+    std::string vector_type = is_vector_type(lhs_type) ? lhs_type : rhs_type;
+    llvm_val_lhs =
+      this->cast_value(*expr.lhs, llvm_val_lhs, lhs_type, vector_type);
+    llvm_val_rhs =
+      this->cast_value(*expr.rhs, llvm_val_rhs, rhs_type, vector_type);
+    if (!llvm_val_lhs || !llvm_val_rhs) {
+      this->result_val = nullptr;
       return;
-    case '-':
-      this->result_val =
-        ArxLLVM::ir_builder->CreateFSub(llvm_val_lhs, llvm_val_rhs, "subtmp");
+    }
+
+    this->result_val =
+      ArxVector::emit_binary(expr.op, llvm_val_lhs, llvm_val_rhs);
+    this->result_type = vector_type;
+    if (!this->result_val) {
+      std::string msg = "Codegen: Invalid operator for vectors: '" +
+        std::string(1, expr.op) + "'";
+      this->result_val = LogErrorV(msg.c_str());
+    }
+    return;
+  }
+
+  // Convert the operands to a common type.
+  if (lhs_type != rhs_type && (lhs_type == "float" || rhs_type == "float")) {
+    bool is_lhs_float = lhs_type == "float";
+    ExprAST& float_expr = is_lhs_float ? *expr.lhs : *expr.rhs;
+    std::string& float_type = is_lhs_float ? lhs_type : rhs_type;
+    std::string& other_type = is_lhs_float ? rhs_type : lhs_type;
+    llvm::Value*& float_val = is_lhs_float ? llvm_val_lhs : llvm_val_rhs;
+
+    // decimal literals keep their own scale, e.g. `price * 1.05`, but the
+    // folded values (without a literal text) take the other operand type
+    std::string target_type = other_type;
+    if (
+      is_decimal_type(other_type) &&
+      float_expr.kind == ExprKind::FloatDTKind &&
+      !static_cast<FloatExprAST&>(float_expr).literal.empty()) {
+      target_type =
+        get_literal_decimal_type(static_cast<FloatExprAST&>(float_expr));
+    }
+
+    float_val =
+      this->cast_value(float_expr, float_val, float_type, target_type);
+    if (!float_val) {
+      this->result_val = nullptr;
       return;
-    case '*':
-      this->result_val =
-        ArxLLVM::ir_builder->CreateFMul(llvm_val_lhs, llvm_val_rhs, "multmp");
+    }
+    float_type = target_type;
+  }
+
+  if (is_decimal_type(lhs_type) && is_decimal_type(rhs_type)) {
+    int lhs_scale = get_decimal_scale(lhs_type);
+    int rhs_scale = get_decimal_scale(rhs_type);
+    int lhs_precision = get_decimal_precision(lhs_type);
+    int rhs_precision = get_decimal_precision(rhs_type);
+
+    int scale;
+    int precision;
+    if (expr.op == '*') {
+      scale = lhs_scale + rhs_scale;
+      precision = lhs_precision + rhs_precision + 1;
+    } else {
+      scale = std::max(lhs_scale, rhs_scale);
+      int digits =
+        std::max(lhs_precision - lhs_scale, rhs_precision - rhs_scale);
+      precision = digits + scale + 1;
+    }
+    precision = std::min(precision, DECIMAL256_MAX_PRECISION);
+
+    if (scale > precision) {
+      this->result_val = LogErrorV("Codegen: decimal scale overflow");
+      return;
+    }
+
+    std::string decimal_type = get_decimal_type_name(precision, scale);
+    llvm::Type* decimal_llvm_type = ArxLLVM::get_data_type(decimal_type);
+
+    // for multiplications the scales are just added, so the operands are
+    // only extended to the result type.
+    int lhs_target_scale = expr.op == '*' ? lhs_scale : scale;
+    int rhs_target_scale = expr.op == '*' ? rhs_scale : scale;
+    llvm_val_lhs = rescale_decimal(
+      llvm_val_lhs, lhs_scale, lhs_target_scale, decimal_llvm_type);
+    llvm_val_rhs = rescale_decimal(
+      llvm_val_rhs, rhs_scale, rhs_target_scale, decimal_llvm_type);
+
+    switch (expr.op) {
+      case '+':
+        this->result_val =
+          ArxLLVM::ir_builder->CreateAdd(llvm_val_lhs, llvm_val_rhs, "addtmp");
+        this->result_type = decimal_type;
+        return;
+      case '-':
+        this->result_val =
+          ArxLLVM::ir_builder->CreateSub(llvm_val_lhs, llvm_val_rhs, "subtmp");
+        this->result_type = decimal_type;
+        return;
+      case '*':
+        this->result_val =
+          ArxLLVM::ir_builder->CreateMul(llvm_val_lhs, llvm_val_rhs, "multmp");
+        this->result_type = decimal_type;
+        return;
+      case '<':
+        llvm_val_lhs = ArxLLVM::ir_builder->CreateICmpSLT(
+          llvm_val_lhs, llvm_val_rhs, "cmptmp");
+        this->result_val = ArxLLVM::ir_builder->CreateUIToFP(
+          llvm_val_lhs, ArxLLVM::FLOAT_TYPE, "booltmp");
+        this->result_type = "float";
+        return;
+    }
+  } else if (is_temporal_type(lhs_type) || is_temporal_type(rhs_type)) {
+    if (lhs_type != rhs_type) {
+      std::string msg = "Codegen: Invalid operands for '" +
+        std::string(1, expr.op) + "': " + lhs_type + " and " + rhs_type;
+      this->result_val = LogErrorV(msg.c_str());
       return;
-    case '<':
-      llvm_val_lhs = ArxLLVM::ir_builder->CreateFCmpULT(
-        llvm_val_lhs, llvm_val_rhs, "cmptmp");
-      // Convert bool 0/1 to float 0.0 or 1.0 //
-      this->result_val = ArxLLVM::ir_builder->CreateUIToFP(
-        llvm_val_lhs, ArxLLVM::FLOAT_TYPE, "booltmp");
+    }
+
+    // the difference of two temporal values is kept in the same unit
+    switch (expr.op) {
+      case '+':
+        this->result_val =
+          ArxLLVM::ir_builder->CreateAdd(llvm_val_lhs, llvm_val_rhs, "addtmp");
+        this->result_type = lhs_type;
+        return;
+      case '-':
+        this->result_val =
+          ArxLLVM::ir_builder->CreateSub(llvm_val_lhs, llvm_val_rhs, "subtmp");
+        this->result_type = lhs_type;
+        return;
+      case '<':
+        llvm_val_lhs = ArxLLVM::ir_builder->CreateICmpSLT(
+          llvm_val_lhs, llvm_val_rhs, "cmptmp");
+        this->result_val = ArxLLVM::ir_builder->CreateUIToFP(
+          llvm_val_lhs, ArxLLVM::FLOAT_TYPE, "booltmp");
+        this->result_type = "float";
+        return;
+    }
+  } else if (is_string_type(lhs_type) || is_string_type(rhs_type)) {
+    if (lhs_type != rhs_type) {
+      std::string msg = "Codegen: Invalid operands for '" +
+        std::string(1, expr.op) + "': " + lhs_type + " and " + rhs_type;
+      this->result_val = LogErrorV(msg.c_str());
       return;
+    }
+
+    switch (expr.op) {
+      case '+':
+        this->result_val = ArxLLVM::ir_builder->CreateCall(
+          get_string_function("arx_string_concat", ArxLLVM::INT128_TYPE),
+          {llvm_val_lhs, llvm_val_rhs},
+          "concattmp");
+        this->result_type = lhs_type;
+        return;
+      case '<':
+        llvm_val_lhs = ArxLLVM::ir_builder->CreateCall(
+          get_string_function("arx_string_compare", ArxLLVM::INT32_TYPE),
+          {llvm_val_lhs, llvm_val_rhs},
+          "strcmptmp");
+        llvm_val_lhs = ArxLLVM::ir_builder->CreateICmpSLT(
+          llvm_val_lhs,
+          llvm::ConstantInt::get(ArxLLVM::INT32_TYPE, 0),
+          "cmptmp");
+        this->result_val = ArxLLVM::ir_builder->CreateUIToFP(
+          llvm_val_lhs, ArxLLVM::FLOAT_TYPE, "booltmp");
+        this->result_type = "float";
+        return;
+    }
+  } else if (lhs_type == "float" && rhs_type == "float") {
+    switch (expr.op) {
+      case '+':
+        this->result_val = ArxLLVM::ir_builder->CreateFAdd(
+          llvm_val_lhs, llvm_val_rhs, "addtmp");
+        this->result_type = "float";
+        return;
+      case '-':
+        this->result_val = ArxLLVM::ir_builder->CreateFSub(
+          llvm_val_lhs, llvm_val_rhs, "subtmp");
+        this->result_type = "float";
+        return;
+      case '*':
+        this->result_val = ArxLLVM::ir_builder->CreateFMul(
+          llvm_val_lhs, llvm_val_rhs, "multmp");
+        this->result_type = "float";
+        return;
+      case '<':
+        llvm_val_lhs = ArxLLVM::ir_builder->CreateFCmpULT(
+          llvm_val_lhs, llvm_val_rhs, "cmptmp");
+        // Convert bool 0/1 to float 0.0 or 1.0 //
+        this->result_val = ArxLLVM::ir_builder->CreateUIToFP(
+          llvm_val_lhs, ArxLLVM::FLOAT_TYPE, "booltmp");
+        this->result_type = "float";
+        return;
+    }
   }
 
   // If it wasn't a builtin binary operator, it must be a user defined
   // one. Emit a call to it.
   this->getFunction(std::string("binary") + expr.op);
   llvm::Function* fn = this->result_func;
-  assert(fn && "binary operator not found!");
+  if (!fn) {
+    std::string msg = "Codegen: Invalid binary operator '" +
+      std::string(1, expr.op) + "' for " + lhs_type;
+    this->result_val = LogErrorV(msg.c_str());
+    return;
+  }
+
+  llvm_val_lhs = this->cast_value(
+    *expr.lhs, llvm_val_lhs, lhs_type, ArxLLVM::get_arg_type_name(fn, 0));
+  llvm_val_rhs = this->cast_value(
+    *expr.rhs, llvm_val_rhs, rhs_type, ArxLLVM::get_arg_type_name(fn, 1));
+  if (!llvm_val_lhs || !llvm_val_rhs) {
+    this->result_val = nullptr;
+    return;
+  }
 
   llvm::Value* Ops[] = {llvm_val_lhs, llvm_val_rhs};
   this->result_val = ArxLLVM::ir_builder->CreateCall(fn, Ops, "binop");
+  this->result_type = ArxLLVM::get_return_type_name(fn);
 }
 
 /**
  * @brief Code generation for CallExprAST.
  *
+ * Calls to functions that return a constant, and calls to pure functions
+ * with constant arguments, are replaced by their value.
  */
 auto ASTToObjectVisitor::visit(CallExprAST& expr) -> void {
+  if (ArxGeneric::is_generic(expr.callee)) {
+    return this->emit_generic_call(expr);
+  }
+  if (
+    ArxLLVM::function_protos.find(expr.callee) ==
+      ArxLLVM::function_protos.end() &&
+    (is_vector_type(expr.callee) || ArxVector::is_builtin(expr.callee))) {
+    return this->emit_vector_builtin(expr);
+  }
+  if (
+    ArxLLVM::function_protos.find(expr.callee) ==
+      ArxLLVM::function_protos.end() &&
+    ArxMath::is_builtin(expr.callee)) {
+    return this->emit_math_builtin(expr);
+  }
+  if (
+    ArxLLVM::function_protos.find(expr.callee) ==
+      ArxLLVM::function_protos.end() &&
+    (is_record_type(expr.callee) || ArxRecord::is_builtin(expr.callee))) {
+    return this->emit_record_builtin(expr);
+  }
+
   this->getFunction(expr.callee);
   llvm::Function* CalleeF = this->result_func;
   if (!CalleeF) {
@@ -255,6 +1063,26 @@ auto ASTToObjectVisitor::visit(CallExprAST& expr) -> void {
     return;
   }
 
+  auto proto = ArxLLVM::function_protos.find(expr.callee);
+  if (
+    expr.args.empty() && proto != ArxLLVM::function_protos.end() &&
+    proto->second->constant) {
+    std::string const_type;
+    this->emit_constant(
+      expr,
+      this->fold_constant(*proto->second->constant, const_type),
+      proto->second->constant_type,
+      ArxLLVM::get_return_type_name(CalleeF));
+    return;
+  }
+
+  std::string result_type;
+  auto result = this->evaluate_call(expr, result_type);
+  if (result) {
+    this->emit_constant(expr, std::move(result), result_type, result_type);
+    return;
+  }
+
   if (CalleeF->arg_size() != expr.args.size()) {
     this->result_val = LogErrorV("Incorrect # arguments passed");
     return;
@@ -264,6 +1092,13 @@ auto ASTToObjectVisitor::visit(CallExprAST& expr) -> void {
   for (unsigned i = 0, e = expr.args.size(); i != e; ++i) {
     expr.args[i].get()->accept(*this);
     llvm::Value* ArgsV_item = this->result_val;
+    if (ArgsV_item) {
+      ArgsV_item = this->cast_value(
+        *expr.args[i],
+        ArgsV_item,
+        this->result_type,
+        ArxLLVM::get_arg_type_name(CalleeF, i));
+    }
     ArgsV.push_back(ArgsV_item);
     if (!ArgsV.back()) {
       this->result_val = nullptr;
@@ -273,60 +1108,454 @@ auto ASTToObjectVisitor::visit(CallExprAST& expr) -> void {
 
   this->result_val =
     ArxLLVM::ir_builder->CreateCall(CalleeF, ArgsV, "calltmp");
+  this->result_type = ArxLLVM::get_return_type_name(CalleeF);
 }
 
 /**
- * @brief Code generation for IfExprAST.
+ * @brief Code generation for the calls to the generic functions.
+ *
+ * The instance for the types of the arguments is generated on the first
+ * call with these types (see ArxGeneric).
  */
-auto ASTToObjectVisitor::visit(IfExprAST& expr) -> void {
-  expr.cond.get()->accept(*this);
-  llvm::Value* CondV = this->result_val;
+auto ASTToObjectVisitor::emit_generic_call(CallExprAST& expr) -> void {
+  FunctionAST& generic = *ArxGeneric::functions[expr.callee];
+
+  std::vector<llvm::Value*> values;
+  std::vector<std::string> types;
+  for (auto& arg : expr.args) {
+    arg->accept(*this);
+    if (!this->result_val) {
+      return;
+    }
+    values.push_back(this->result_val);
+    types.push_back(this->result_type);
+  }
 
-  if (!CondV) {
+  TypeArgs type_args;
+  if (!ArxGeneric::bind_types(*generic.proto, types, type_args)) {
     this->result_val = nullptr;
     return;
   }
-
-  // Convert condition to a bool by comparing non-equal to 0.0.
-  CondV = ArxLLVM::ir_builder->CreateFCmpONE(
-    CondV,
-    llvm::ConstantFP::get(*ArxLLVM::context, llvm::APFloat(0.0)),
-    "ifcond");
-
-  llvm::Function* fn = ArxLLVM::ir_builder->GetInsertBlock()->getParent();
-
-  // Create blocks for the then and else cases.  Insert the 'then' block
-  // at the end of the function.
-  llvm::BasicBlock* ThenBB =
-    llvm::BasicBlock::Create(*ArxLLVM::context, "then", fn);
-  llvm::BasicBlock* ElseBB =
-    llvm::BasicBlock::Create(*ArxLLVM::context, "else");
-  llvm::BasicBlock* MergeBB =
-    llvm::BasicBlock::Create(*ArxLLVM::context, "ifcont");
-
-  ArxLLVM::ir_builder->CreateCondBr(CondV, ThenBB, ElseBB);
-
-  // Emit then value.
-  ArxLLVM::ir_builder->SetInsertPoint(ThenBB);
-
-  expr.then.get()->accept(*this);
-  llvm::Value* ThenV = this->result_val;
-  if (!ThenV) {
+  std::string name = ArxGeneric::get_instance_name(*generic.proto, type_args);
+  if (
+    ArxLLVM::function_protos.find(name) == ArxLLVM::function_protos.end() &&
+    !this->emit_generic_instance(generic, type_args)) {
     this->result_val = nullptr;
     return;
   }
 
-  ArxLLVM::ir_builder->CreateBr(MergeBB);
-  // Codegen of 'then' can change the current block, update ThenBB for
-  // the PHI.
-  ThenBB = ArxLLVM::ir_builder->GetInsertBlock();
+  this->getFunction(name);
+  llvm::Function* fn = this->result_func;
+  for (unsigned i = 0; i < values.size(); ++i) {
+    values[i] = this->cast_value(
+      *expr.args[i],
+      values[i],
+      types[i],
+      ArxLLVM::get_arg_type_name(fn, i));
+    if (!values[i]) {
+      this->result_val = nullptr;
+      return;
+    }
+  }
 
-  // Emit else block.
-  fn->getBasicBlockList().push_back(ElseBB);
-  ArxLLVM::ir_builder->SetInsertPoint(ElseBB);
+  this->result_val = ArxLLVM::ir_builder->CreateCall(fn, values, "calltmp");
+  this->result_type = ArxLLVM::get_return_type_name(fn);
+}
+
+/**
+ * @brief Generate the instance of a generic function for the types.
+ * @return false if the body is not valid for these types.
+ *
+ * The instance is generated like the other functions, in the middle of the
+ * function of the call, so the state of the caller is restored after it.
+ */
+auto ASTToObjectVisitor::emit_generic_instance(
+  FunctionAST& generic, const TypeArgs& type_args) -> bool {
+  // the body is in use when the instance calls itself with other types
+  if (!generic.body) {
+    std::string msg = "Codegen: `" + generic.proto->get_name() +
+      "` can't call itself with other types";
+    LogErrorV(msg.c_str());
+    return false;
+  }
+
+  auto proto = ArxGeneric::make_instance_proto(*generic.proto, type_args);
+  if (!proto) {
+    return false;
+  }
+  std::string name = proto->get_name();
+
+  llvm::IRBuilderBase::InsertPointGuard insert_point_guard(
+    *ArxLLVM::ir_builder);
+  auto named_values = ArxLLVM::named_values;
+  auto named_types = ArxLLVM::named_types;
+  TypeArgs outer_type_args = this->type_args;
+
+  FunctionAST instance(std::move(proto), std::move(generic.body));
+  this->type_args = type_args;
+  instance.accept(*this);
+  bool is_valid = this->result_func != nullptr;
+  generic.body = std::move(instance.body);
+
+  this->type_args = outer_type_args;
+  ArxLLVM::named_values = named_values;
+  ArxLLVM::named_types = named_types;
+
+  if (!is_valid) {
+    // the next calls report the error again
+    ArxLLVM::function_protos.erase(name);
+  }
+  return is_valid;
+}
+
+/**
+ * @brief Code generation for the vector constructors and builtins.
+ *
+ * See ArxVector for the list of builtins.
+ */
+auto ASTToObjectVisitor::emit_vector_builtin(CallExprAST& expr) -> void {
+  const std::string& name = expr.callee;
+
+  std::vector<llvm::Value*> values;
+  std::vector<std::string> types;
+  for (auto& arg : expr.args) {
+    arg->accept(*this);
+    if (!this->result_val) {
+      return;
+    }
+    values.push_back(this->result_val);
+    types.push_back(this->result_type);
+  }
+
+  auto error = [&](const std::string& msg) {
+    this->result_val = LogErrorV(msg.c_str());
+  };
+
+  // the constant lane index of the argument `idx`, in [0, limit)
+  auto get_lane = [&](size_t idx, int limit, int& lane) -> bool {
+    std::string type_name;
+    auto value = this->fold_constant(*expr.args[idx], type_name);
+    if (!value || type_name != "float") {
+      return false;
+    }
+    float index = static_cast<FloatExprAST&>(*value).val;
+    lane = static_cast<int>(index);
+    return index == lane && lane >= 0 && lane < limit;
+  };
+
+  if (is_vector_type(name)) {
+    int lanes = get_vector_lanes(name);
+    if (values.size() == 1) {
+      this->result_val =
+        this->cast_value(*expr.args[0], values[0], types[0], name);
+      this->result_type = name;
+      return;
+    }
+    if (values.size() != static_cast<size_t>(lanes)) {
+      error(
+        "Codegen: `" + name + "` expects 1 or " + std::to_string(lanes) +
+        " arguments");
+      return;
+    }
+
+    llvm::Value* vector =
+      llvm::PoisonValue::get(ArxLLVM::get_data_type(name));
+    for (int i = 0; i < lanes; ++i) {
+      llvm::Value* lane =
+        this->cast_value(*expr.args[i], values[i], types[i], "float");
+      if (!lane) {
+        this->result_val = nullptr;
+        return;
+      }
+      vector = ArxLLVM::ir_builder->CreateInsertElement(
+        vector, ArxVector::from_float(lane, name), i);
+    }
+    this->result_val = vector;
+    this->result_type = name;
+    return;
+  }
+
+  if (values.empty() || !is_vector_type(types[0])) {
+    error("Codegen: `" + name + "` expects a vector");
+    return;
+  }
+  const std::string vector_type = types[0];
+  int lanes = get_vector_lanes(vector_type);
+  int lane;
+
+  if (name == "extract" || name == "broadcast") {
+    if (values.size() != 2 || !get_lane(1, lanes, lane)) {
+      error("Codegen: `" + name + "(v, i)` expects a constant lane index");
+      return;
+    }
+    if (name == "extract") {
+      this->result_val = ArxVector::to_float(
+        ArxLLVM::ir_builder->CreateExtractElement(values[0], lane));
+      this->result_type = "float";
+    } else {
+      this->result_val = ArxLLVM::ir_builder->CreateShuffleVector(
+        values[0], std::vector<int>(lanes, lane), "broadcast");
+      this->result_type = vector_type;
+    }
+  } else if (name == "insert") {
+    if (values.size() != 3 || !get_lane(1, lanes, lane)) {
+      error("Codegen: `insert(v, i, x)` expects a constant lane index");
+      return;
+    }
+    llvm::Value* value =
+      this->cast_value(*expr.args[2], values[2], types[2], "float");
+    if (!value) {
+      this->result_val = nullptr;
+      return;
+    }
+    this->result_val = ArxLLVM::ir_builder->CreateInsertElement(
+      values[0], ArxVector::from_float(value, vector_type), lane);
+    this->result_type = vector_type;
+  } else if (name == "shuffle") {
+    // the lanes of the concatenation of two vectors of the same type
+    llvm::Value* second = nullptr;
+    if (values.size() > 1 && is_vector_type(types[1])) {
+      if (types[1] != vector_type) {
+        error(
+          "Codegen: `shuffle` of different vector types: " + vector_type +
+          " and " + types[1]);
+        return;
+      }
+      second = values[1];
+    }
+
+    std::vector<int> mask;
+    int limit = second ? 2 * lanes : lanes;
+    for (size_t i = second ? 2 : 1; i < values.size(); ++i) {
+      if (!get_lane(i, limit, lane)) {
+        error("Codegen: `shuffle` expects constant lane indexes");
+        return;
+      }
+      mask.push_back(lane);
+    }
+
+    std::string result_type =
+      get_vector_type_name(vector_type, static_cast<int>(mask.size()));
+    if (!is_vector_type(result_type)) {
+      error("Codegen: `shuffle` expects 2, 4, ..., 64 lane indexes");
+      return;
+    }
+    this->result_val = second
+      ? ArxLLVM::ir_builder->CreateShuffleVector(values[0], second, mask)
+      : ArxLLVM::ir_builder->CreateShuffleVector(values[0], mask);
+    this->result_type = result_type;
+  } else {
+    if (values.size() != 1) {
+      error("Codegen: `" + name + "` expects one vector");
+      return;
+    }
+    this->result_val = ArxVector::emit_reduce(name, values[0]);
+    this->result_type = "float";
+  }
+}
+
+/**
+ * @brief Code generation for the math builtins.
+ *
+ * The arguments are floats or vectors of the same type, see ArxMath.
+ */
+auto ASTToObjectVisitor::emit_math_builtin(CallExprAST& expr) -> void {
+  const std::string& name = expr.callee;
+  size_t arity = ArxMath::get_arity(name);
+  if (expr.args.size() != arity) {
+    std::string msg = "Codegen: `" + name + "` expects " +
+      std::to_string(arity) + (arity == 1 ? " argument" : " arguments");
+    this->result_val = LogErrorV(msg.c_str());
+    return;
+  }
+
+  // the vector type of the arguments, or float
+  std::vector<llvm::Value*> values;
+  std::vector<std::string> types;
+  std::string type_name = "float";
+  for (auto& arg : expr.args) {
+    arg->accept(*this);
+    if (!this->result_val) {
+      return;
+    }
+    values.push_back(this->result_val);
+    types.push_back(this->result_type);
+
+    if (!is_vector_type(this->result_type)) {
+      continue;
+    }
+    if (type_name != "float" && type_name != this->result_type) {
+      std::string msg = "Codegen: `" + name + "` of different vector types: " +
+        type_name + " and " + this->result_type;
+      this->result_val = LogErrorV(msg.c_str());
+      return;
+    }
+    type_name = this->result_type;
+  }
+
+  if (
+    is_vector_type(type_name) &&
+    !ArxLLVM::get_data_type(type_name)->getScalarType()->isFloatingPointTy()) {
+    std::string msg = "Codegen: `" + name +
+      "` expects floats or vectors of floats, not " + type_name;
+    this->result_val = LogErrorV(msg.c_str());
+    return;
+  }
+
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] =
+      this->cast_value(*expr.args[i], values[i], types[i], type_name);
+    if (!values[i]) {
+      this->result_val = nullptr;
+      return;
+    }
+  }
+
+  this->result_val = ArxMath::emit(name, values);
+  this->result_type = type_name;
+}
+
+/**
+ * @brief Code generation for the struct constructors and the array
+ *        builtins.
+ *
+ * See ArxRecord for the list of builtins.
+ */
+auto ASTToObjectVisitor::emit_record_builtin(CallExprAST& expr) -> void {
+  if (expr.callee == "len") {
+    if (expr.args.size() != 1) {
+      this->result_val = LogErrorV("Codegen: Expected `len(array)`");
+      return;
+    }
+    expr.args[0]->accept(*this);
+    if (!this->result_val) {
+      return;
+    }
+    if (!is_array_type(this->result_type)) {
+      std::string msg =
+        "Codegen: `len` expects an array, not " + this->result_type;
+      this->result_val = LogErrorV(msg.c_str());
+      return;
+    }
+    this->result_val = llvm::ConstantFP::get(
+      ArxLLVM::FLOAT_TYPE,
+      static_cast<double>(get_array_length(this->result_type)));
+    this->result_type = "float";
+    return;
+  }
+
+  const StructFields& fields = Parser::struct_fields[expr.callee];
+  llvm::StructType* struct_type = ArxRecord::get_struct_type(expr.callee);
+
+  if (expr.args.empty()) {
+    this->result_val = llvm::Constant::getNullValue(struct_type);
+    this->result_type = expr.callee;
+    return;
+  }
+  if (expr.args.size() != fields.size()) {
+    std::string msg = "Codegen: `" + expr.callee + "` expects " +
+      std::to_string(fields.size()) + " fields";
+    this->result_val = LogErrorV(msg.c_str());
+    return;
+  }
+
+  llvm::Value* record = llvm::PoisonValue::get(struct_type);
+  for (unsigned i = 0; i < fields.size(); ++i) {
+    expr.args[i]->accept(*this);
+    llvm::Value* field = this->result_val;
+    if (field) {
+      field = this->cast_value(
+        *expr.args[i], field, this->result_type, fields[i].second);
+    }
+    if (!field) {
+      this->result_val = nullptr;
+      return;
+    }
+    record = ArxLLVM::ir_builder->CreateInsertValue(record, field, {i});
+  }
+
+  this->result_val = record;
+  this->result_type = expr.callee;
+}
+
+/**
+ * @brief Convert a condition value to a bool by comparing non-equal to 0.
+ *
+ * @return The bool, or nullptr for vectors (the lanes should be reduced).
+ */
+static auto get_condition(llvm::Value* value, const char* name)
+  -> llvm::Value* {
+  if (value->getType()->isVectorTy()) {
+    return LogErrorV("Codegen: A vector cannot be used as a condition");
+  }
+  if (value->getType()->isIntegerTy()) {
+    return ArxLLVM::ir_builder->CreateICmpNE(
+      value, llvm::ConstantInt::get(value->getType(), 0), name);
+  }
+  return ArxLLVM::ir_builder->CreateFCmpONE(
+    value, llvm::ConstantFP::get(value->getType(), 0.0), name);
+}
+
+/**
+ * @brief Code generation for IfExprAST.
+ *
+ * The `else` value is converted to the type of the `then` value.
+ */
+auto ASTToObjectVisitor::visit(IfExprAST& expr) -> void {
+  expr.cond.get()->accept(*this);
+  llvm::Value* CondV = this->result_val;
+
+  if (!CondV) {
+    this->result_val = nullptr;
+    return;
+  }
+
+  // Convert condition to a bool by comparing non-equal to 0.0.
+  CondV = get_condition(CondV, "ifcond");
+  if (!CondV) {
+    this->result_val = nullptr;
+    return;
+  }
+
+  llvm::Function* fn = ArxLLVM::ir_builder->GetInsertBlock()->getParent();
+
+  // Create blocks for the then and else cases.  Insert the 'then' block
+  // at the end of the function.
+  llvm::BasicBlock* ThenBB =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "then", fn);
+  llvm::BasicBlock* ElseBB =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "else");
+  llvm::BasicBlock* MergeBB =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "ifcont");
+
+  ArxLLVM::ir_builder->CreateCondBr(CondV, ThenBB, ElseBB);
+
+  // Emit then value.
+  ArxLLVM::ir_builder->SetInsertPoint(ThenBB);
+
+  expr.then.get()->accept(*this);
+  llvm::Value* ThenV = this->result_val;
+  if (!ThenV) {
+    this->result_val = nullptr;
+    return;
+  }
+  std::string then_type = this->result_type;
+
+  ArxLLVM::ir_builder->CreateBr(MergeBB);
+  // Codegen of 'then' can change the current block, update ThenBB for
+  // the PHI.
+  ThenBB = ArxLLVM::ir_builder->GetInsertBlock();
+
+  // Emit else block.
+  fn->getBasicBlockList().push_back(ElseBB);
+  ArxLLVM::ir_builder->SetInsertPoint(ElseBB);
 
   expr.else_.get()->accept(*this);
   llvm::Value* ElseV = this->result_val;
+  if (ElseV) {
+    ElseV =
+      this->cast_value(*expr.else_, ElseV, this->result_type, then_type);
+  }
   if (!ElseV) {
     this->result_val = nullptr;
     return;
@@ -341,12 +1570,13 @@ auto ASTToObjectVisitor::visit(IfExprAST& expr) -> void {
   fn->getBasicBlockList().push_back(MergeBB);
   ArxLLVM::ir_builder->SetInsertPoint(MergeBB);
   llvm::PHINode* PN =
-    ArxLLVM::ir_builder->CreatePHI(ArxLLVM::FLOAT_TYPE, 2, "iftmp");
+    ArxLLVM::ir_builder->CreatePHI(ThenV->getType(), 2, "iftmp");
 
   PN->addIncoming(ThenV, ThenBB);
   PN->addIncoming(ElseV, ElseBB);
 
   this->result_val = PN;
+  this->result_type = then_type;
   return;
 }
 
@@ -356,6 +1586,12 @@ auto ASTToObjectVisitor::visit(IfExprAST& expr) -> void {
  * @param expr A `for` expression.
  */
 auto ASTToObjectVisitor::visit(ForExprAST& expr) -> void {
+  if (expr.is_parallel) {
+    return this->emit_parallel_for(expr);
+  } else if (expr.is_range) {
+    return this->emit_range_for(expr);
+  }
+
   llvm::Function* fn = ArxLLVM::ir_builder->GetInsertBlock()->getParent();
 
   // Create an alloca for the variable in the entry block.
@@ -366,6 +1602,10 @@ auto ASTToObjectVisitor::visit(ForExprAST& expr) -> void {
   // Emit the start code first, without 'variable' in scope.
   expr.start.get()->accept(*this);
   llvm::Value* StartVal = this->result_val;
+  if (StartVal) {
+    StartVal =
+      this->cast_value(*expr.start, StartVal, this->result_type, "float");
+  }
   if (!StartVal) {
     this->result_val = nullptr;
     return;
@@ -383,96 +1623,609 @@ auto ASTToObjectVisitor::visit(ForExprAST& expr) -> void {
   // LoopBB.
   ArxLLVM::ir_builder->CreateBr(LoopBB);
 
-  // start insertion in LoopBB.
-  ArxLLVM::ir_builder->SetInsertPoint(LoopBB);
+  // start insertion in LoopBB.
+  ArxLLVM::ir_builder->SetInsertPoint(LoopBB);
+
+  // Within the loop, the variable is defined equal to the PHI node.  If
+  // it shadows an existing variable, we have to restore it, so save it
+  // now.
+  llvm::AllocaInst* OldVal = ArxLLVM::named_values[expr.var_name];
+  std::string OldType = ArxLLVM::named_types[expr.var_name];
+  ArxLLVM::named_values[expr.var_name] = alloca;
+  ArxLLVM::named_types[expr.var_name] = "float";
+
+  // Emit the body of the loop.  This, like any other expr, can change
+  // the current basic_block.  Note that we ignore the value computed by the
+  // body, but don't allow an error.
+  expr.body.get()->accept(*this);
+  llvm::Value* body_val = this->result_val;
+
+  if (!body_val) {
+    this->result_val = nullptr;
+    return;
+  }
+
+  // Emit the step value.
+  llvm::Value* StepVal = nullptr;
+  if (expr.step) {
+    expr.step.get()->accept(*this);
+    StepVal = this->result_val;
+    if (StepVal) {
+      StepVal =
+        this->cast_value(*expr.step, StepVal, this->result_type, "float");
+    }
+    if (!StepVal) {
+      this->result_val = nullptr;
+      return;
+    }
+  } else {
+    // If not specified, use 1.0.
+    StepVal = llvm::ConstantFP::get(ArxLLVM::FLOAT_TYPE, 1.0);
+  }
+
+  // Compute the end condition.
+  expr.end.get()->accept(*this);
+  llvm::Value* EndCond = this->result_val;
+  if (!EndCond) {
+    this->result_val = nullptr;
+    return;
+  }
+
+  // Reload, increment, and restore the alloca.  This handles the case
+  // where the body of the loop mutates the variable.
+  llvm::Value* CurVar = ArxLLVM::ir_builder->CreateLoad(
+    ArxLLVM::FLOAT_TYPE, alloca, expr.var_name.c_str());
+  llvm::Value* NextVar =
+    ArxLLVM::ir_builder->CreateFAdd(CurVar, StepVal, "nextvar");
+  ArxLLVM::ir_builder->CreateStore(NextVar, alloca);
+
+  // Convert condition to a bool by comparing non-equal to 0.0.
+  EndCond = get_condition(EndCond, "loopcond");
+  if (!EndCond) {
+    this->result_val = nullptr;
+    return;
+  }
+
+  // Create the "after loop" block and insert it.
+  llvm::BasicBlock* AfterBB =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "afterloop", fn);
+
+  // Insert the conditional branch into the end of LoopEndBB.
+  ArxLLVM::ir_builder->CreateCondBr(EndCond, LoopBB, AfterBB);
+
+  // Any new code will be inserted in AfterBB.
+  ArxLLVM::ir_builder->SetInsertPoint(AfterBB);
+
+  // Restore the unshadowed variable.
+  if (OldVal) {
+    ArxLLVM::named_values[expr.var_name] = OldVal;
+    ArxLLVM::named_types[expr.var_name] = OldType;
+  } else {
+    ArxLLVM::named_values.erase(expr.var_name);
+    ArxLLVM::named_types.erase(expr.var_name);
+  }
+
+  // for expr always returns 0.0.
+  this->result_val = llvm::Constant::getNullValue(ArxLLVM::FLOAT_TYPE);
+  this->result_type = "float";
+}
+
+/**
+ * @brief Collect the names of the variables used in the expression.
+ *
+ */
+static auto collect_variables(ExprAST* expr, std::set<std::string>& names)
+  -> void {
+  if (!expr) {
+    return;
+  }
+
+  switch (expr->kind) {
+    case ExprKind::VariableKind:
+      names.insert(static_cast<VariableExprAST*>(expr)->name);
+      break;
+    case ExprKind::UnaryOpKind:
+      collect_variables(
+        static_cast<UnaryExprAST*>(expr)->operand.get(), names);
+      break;
+    case ExprKind::BinaryOpKind: {
+      auto binary = static_cast<BinaryExprAST*>(expr);
+      collect_variables(binary->lhs.get(), names);
+      collect_variables(binary->rhs.get(), names);
+      break;
+    }
+    case ExprKind::CallKind:
+      for (auto& arg : static_cast<CallExprAST*>(expr)->args) {
+        collect_variables(arg.get(), names);
+      }
+      break;
+    case ExprKind::IfKind: {
+      auto if_expr = static_cast<IfExprAST*>(expr);
+      collect_variables(if_expr->cond.get(), names);
+      collect_variables(if_expr->then.get(), names);
+      collect_variables(if_expr->else_.get(), names);
+      break;
+    }
+    case ExprKind::ForKind: {
+      auto for_expr = static_cast<ForExprAST*>(expr);
+      collect_variables(for_expr->start.get(), names);
+      collect_variables(for_expr->end.get(), names);
+      collect_variables(for_expr->step.get(), names);
+      collect_variables(for_expr->body.get(), names);
+      break;
+    }
+    case ExprKind::VarKind: {
+      auto var_expr = static_cast<VarExprAST*>(expr);
+      for (auto& var : var_expr->var_names) {
+        collect_variables(var.second.get(), names);
+      }
+      collect_variables(var_expr->body.get(), names);
+      break;
+    }
+    case ExprKind::ConstKind: {
+      auto const_expr = static_cast<ConstExprAST*>(expr);
+      for (auto& constant : const_expr->const_names) {
+        collect_variables(constant.second.get(), names);
+      }
+      collect_variables(const_expr->body.get(), names);
+      break;
+    }
+    case ExprKind::AccessKind: {
+      auto access = static_cast<AccessExprAST*>(expr);
+      collect_variables(access->base.get(), names);
+      collect_variables(access->index.get(), names);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Get the reduction operator of a range loop (as in the runtime).
+ *
+ */
+static auto get_reduce_op(const std::string& reduce_op) -> ArxReduceOp {
+  if (reduce_op == "+") {
+    return ARX_REDUCE_ADD;
+  } else if (reduce_op == "*") {
+    return ARX_REDUCE_MUL;
+  } else if (reduce_op == "min") {
+    return ARX_REDUCE_MIN;
+  } else if (reduce_op == "max") {
+    return ARX_REDUCE_MAX;
+  }
+  return ARX_REDUCE_NONE;
+}
+
+/**
+ * @brief Get the neutral value of a reduction.
+ *
+ */
+static auto get_reduce_identity(ArxReduceOp reduce_op) -> float {
+  switch (reduce_op) {
+    case ARX_REDUCE_MUL:
+      return 1.0f;
+    case ARX_REDUCE_MIN:
+      return INFINITY;
+    case ARX_REDUCE_MAX:
+      return -INFINITY;
+    default:
+      return 0.0f;
+  }
+}
+
+/**
+ * @brief Emit the combination of an accumulator and a value.
+ *
+ * min and max ignore NaN (llvm.minnum and llvm.maxnum).
+ */
+static auto emit_reduce(
+  ArxReduceOp reduce_op, llvm::Value* acc, llvm::Value* value)
+  -> llvm::Value* {
+  switch (reduce_op) {
+    case ARX_REDUCE_ADD:
+      return ArxLLVM::ir_builder->CreateFAdd(acc, value, "acc");
+    case ARX_REDUCE_MUL:
+      return ArxLLVM::ir_builder->CreateFMul(acc, value, "acc");
+    case ARX_REDUCE_MIN:
+      return ArxLLVM::ir_builder->CreateMinNum(acc, value, "acc");
+    default:
+      return ArxLLVM::ir_builder->CreateMaxNum(acc, value, "acc");
+  }
+}
+
+/**
+ * @brief Emit the bounds and the number of iterations of a range loop.
+ *
+ * The variable takes the values start + k * step, for k in [0, count).
+ * @return false if a bound has an error.
+ */
+auto ASTToObjectVisitor::emit_range_count(
+  ForExprAST& expr,
+  llvm::Value*& start_val,
+  llvm::Value*& step_val,
+  llvm::Value*& count_val) -> bool {
+  llvm::Type* float_type = ArxLLVM::FLOAT_TYPE;
+  llvm::Type* int64_type = ArxLLVM::INT64_TYPE;
+
+  std::vector<llvm::Value*> bounds;
+  for (ExprAST* bound : {expr.start.get(), expr.end.get(), expr.step.get()}) {
+    if (!bound) {
+      // If not specified, the step is 1.0.
+      bounds.push_back(llvm::ConstantFP::get(float_type, 1.0));
+      continue;
+    }
+    bound->accept(*this);
+    llvm::Value* value = this->result_val;
+    if (value) {
+      value = this->cast_value(*bound, value, this->result_type, "float");
+    }
+    if (!value) {
+      return false;
+    }
+    bounds.push_back(value);
+  }
+  start_val = bounds[0];
+  step_val = bounds[2];
+
+  // count = max(ceil((end - start) / step), 0), and 0 for a zero step,
+  // since the count is infinite then (fptosi would be poison)
+  count_val = ArxLLVM::ir_builder->CreateUnaryIntrinsic(
+    llvm::Intrinsic::ceil,
+    ArxLLVM::ir_builder->CreateFDiv(
+      ArxLLVM::ir_builder->CreateFSub(bounds[1], start_val), step_val));
+  llvm::Value* has_iterations = ArxLLVM::ir_builder->CreateAnd(
+    ArxLLVM::ir_builder->CreateFCmpONE(
+      step_val, llvm::ConstantFP::get(float_type, 0.0)),
+    ArxLLVM::ir_builder->CreateFCmpOGT(
+      count_val, llvm::ConstantFP::get(float_type, 0.0)));
+  count_val = ArxLLVM::ir_builder->CreateSelect(
+    has_iterations,
+    ArxLLVM::ir_builder->CreateFPToSI(count_val, int64_type),
+    llvm::ConstantInt::get(int64_type, 0),
+    "count");
+  return true;
+}
+
+/**
+ * @brief Code generation for a range builtin (`sum`, `min`, `max`, `map`
+ *        and `reduce`).
+ *
+ * The loop is fused with the reduction: the body is emitted once, and its
+ * value is combined into an accumulator (a phi node, not an alloca). The
+ * combination allows reassociation, and only it: the body keeps the
+ * floating-point mode of the function (see ArxFPMode). So the loop
+ * vectorizer can split the accumulator over the vector lanes and
+ * interleave the iterations.
+ *
+ * The value is the reduction of the body values, or 0.0 for `map`.
+ */
+auto ASTToObjectVisitor::emit_range_for(ForExprAST& expr) -> void {
+  llvm::Function* fn = ArxLLVM::ir_builder->GetInsertBlock()->getParent();
+  llvm::Type* float_type = ArxLLVM::FLOAT_TYPE;
+  llvm::Type* int64_type = ArxLLVM::INT64_TYPE;
+
+  llvm::Value *start_val, *step_val, *count_val;
+  if (!this->emit_range_count(expr, start_val, step_val, count_val)) {
+    this->result_val = nullptr;
+    return;
+  }
+
+  llvm::AllocaInst* alloca =
+    this->create_entry_block_alloca(fn, expr.var_name, "float");
+  llvm::AllocaInst* old_val = ArxLLVM::named_values[expr.var_name];
+  std::string old_type = ArxLLVM::named_types[expr.var_name];
+  ArxLLVM::named_values[expr.var_name] = alloca;
+  ArxLLVM::named_types[expr.var_name] = "float";
+
+  auto restore = [&]() {
+    if (old_val) {
+      ArxLLVM::named_values[expr.var_name] = old_val;
+      ArxLLVM::named_types[expr.var_name] = old_type;
+    } else {
+      ArxLLVM::named_values.erase(expr.var_name);
+      ArxLLVM::named_types.erase(expr.var_name);
+    }
+  };
+
+  ArxReduceOp reduce_op = get_reduce_op(expr.reduce_op);
+  llvm::Value* identity =
+    llvm::ConstantFP::get(float_type, get_reduce_identity(reduce_op));
+
+  llvm::BasicBlock* pre_bb = ArxLLVM::ir_builder->GetInsertBlock();
+  llvm::BasicBlock* loop_bb =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "loop", fn);
+  llvm::BasicBlock* after_bb =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "afterloop", fn);
+  ArxLLVM::ir_builder->CreateCondBr(
+    ArxLLVM::ir_builder->CreateICmpSGT(
+      count_val, llvm::ConstantInt::get(int64_type, 0)),
+    loop_bb,
+    after_bb);
+
+  ArxLLVM::ir_builder->SetInsertPoint(loop_bb);
+  llvm::PHINode* idx = ArxLLVM::ir_builder->CreatePHI(int64_type, 2, "iter");
+  llvm::PHINode* acc_phi = nullptr;
+  if (reduce_op != ARX_REDUCE_NONE) {
+    acc_phi = ArxLLVM::ir_builder->CreatePHI(float_type, 2, "acc");
+  }
+
+  ArxLLVM::ir_builder->CreateStore(
+    ArxLLVM::ir_builder->CreateFAdd(
+      start_val,
+      ArxLLVM::ir_builder->CreateFMul(
+        ArxLLVM::ir_builder->CreateSIToFP(idx, float_type), step_val)),
+    alloca);
+  expr.body->accept(*this);
+  llvm::Value* body_val = this->result_val;
+  if (body_val && reduce_op != ARX_REDUCE_NONE) {
+    body_val =
+      this->cast_value(*expr.body, body_val, this->result_type, "float");
+  }
+  if (!body_val) {
+    restore();
+    this->result_val = nullptr;
+    return;
+  }
+
+  llvm::Value* acc = nullptr;
+  if (reduce_op != ARX_REDUCE_NONE) {
+    llvm::IRBuilderBase::FastMathFlagGuard guard(*ArxLLVM::ir_builder);
+    llvm::FastMathFlags fmf = ArxLLVM::ir_builder->getFastMathFlags();
+    fmf.setAllowReassoc();
+    ArxLLVM::ir_builder->setFastMathFlags(fmf);
+    acc = emit_reduce(reduce_op, acc_phi, body_val);
+  }
+
+  llvm::Value* next_idx = ArxLLVM::ir_builder->CreateAdd(
+    idx, llvm::ConstantInt::get(int64_type, 1), "nextiter", true, true);
+  llvm::BasicBlock* loop_end_bb = ArxLLVM::ir_builder->GetInsertBlock();
+  idx->addIncoming(llvm::ConstantInt::get(int64_type, 0), pre_bb);
+  idx->addIncoming(next_idx, loop_end_bb);
+  if (acc_phi) {
+    acc_phi->addIncoming(identity, pre_bb);
+    acc_phi->addIncoming(acc, loop_end_bb);
+  }
+  ArxLLVM::ir_builder->CreateCondBr(
+    ArxLLVM::ir_builder->CreateICmpSLT(next_idx, count_val),
+    loop_bb,
+    after_bb);
+
+  ArxLLVM::ir_builder->SetInsertPoint(after_bb);
+  restore();
+  this->result_type = "float";
+  if (reduce_op == ARX_REDUCE_NONE) {
+    this->result_val = llvm::Constant::getNullValue(float_type);
+    return;
+  }
 
-  // Within the loop, the variable is defined equal to the PHI node.  If
-  // it shadows an existing variable, we have to restore it, so save it
-  // now.
-  llvm::AllocaInst* OldVal = ArxLLVM::named_values[expr.var_name];
-  ArxLLVM::named_values[expr.var_name] = alloca;
+  llvm::PHINode* result =
+    ArxLLVM::ir_builder->CreatePHI(float_type, 2, "reduce");
+  result->addIncoming(identity, pre_bb);
+  result->addIncoming(acc, loop_end_bb);
+  this->result_val = result;
+}
 
-  // Emit the body of the loop.  This, like any other expr, can change
-  // the current basic_block.  Note that we ignore the value computed by the
-  // body, but don't allow an error.
-  expr.body.get()->accept(*this);
-  llvm::Value* body_val = this->result_val;
+/**
+ * @brief Code generation for a `parfor` ForExprAST.
+ *
+ * The body is outlined into `<function>.parfor`, a function that runs the
+ * iterations [begin, end) of the loop and returns their reduction, and
+ * the loop is a call to arx_parfor, that runs the chunks of iterations in
+ * parallel (see arx-parallel.h).
+ *
+ * The variables used by the body are copied to an environment struct, so
+ * the assignments in the body are local to the chunk. The value of the
+ * loop is the reduction of the body values, or 0.0 without `reduce`.
+ */
+auto ASTToObjectVisitor::emit_parallel_for(ForExprAST& expr) -> void {
+  llvm::Function* fn = ArxLLVM::ir_builder->GetInsertBlock()->getParent();
+  llvm::Type* float_type = ArxLLVM::FLOAT_TYPE;
+  llvm::Type* int64_type = ArxLLVM::INT64_TYPE;
 
-  if (!body_val) {
+  llvm::Value *start_val, *step_val, *count_val;
+  if (!this->emit_range_count(expr, start_val, step_val, count_val)) {
     this->result_val = nullptr;
     return;
   }
 
-  // Emit the step value.
-  llvm::Value* StepVal = nullptr;
-  if (expr.step) {
-    expr.step.get()->accept(*this);
-    StepVal = this->result_val;
-    if (!StepVal) {
-      this->result_val = nullptr;
-      return;
+  // environment: {start, step, captured variables...}
+  std::set<std::string> names;
+  collect_variables(expr.body.get(), names);
+  std::vector<std::string> captured;
+  std::vector<llvm::Type*> env_types = {float_type, float_type};
+  for (const std::string& name : names) {
+    auto alloca = ArxLLVM::named_values.find(name);
+    if (
+      name != expr.var_name && alloca != ArxLLVM::named_values.end() &&
+      alloca->second) {
+      captured.push_back(name);
+      env_types.push_back(alloca->second->getAllocatedType());
     }
-  } else {
-    // If not specified, use 1.0.
-    StepVal = llvm::ConstantFP::get(*ArxLLVM::context, llvm::APFloat(1.0));
   }
 
-  // Compute the end condition.
-  expr.end.get()->accept(*this);
-  llvm::Value* EndCond = this->result_val;
-  if (!EndCond) {
-    this->result_val = nullptr;
-    return;
+  llvm::StructType* env_type =
+    llvm::StructType::get(*ArxLLVM::context, env_types);
+  llvm::IRBuilder<> entry_builder(
+    &fn->getEntryBlock(), fn->getEntryBlock().begin());
+  llvm::AllocaInst* env = entry_builder.CreateAlloca(env_type, nullptr, "env");
+
+  ArxLLVM::ir_builder->CreateStore(
+    start_val, ArxLLVM::ir_builder->CreateStructGEP(env_type, env, 0));
+  ArxLLVM::ir_builder->CreateStore(
+    step_val, ArxLLVM::ir_builder->CreateStructGEP(env_type, env, 1));
+  for (unsigned i = 0; i < captured.size(); ++i) {
+    llvm::AllocaInst* alloca = ArxLLVM::named_values[captured[i]];
+    ArxLLVM::ir_builder->CreateStore(
+      ArxLLVM::ir_builder->CreateLoad(alloca->getAllocatedType(), alloca),
+      ArxLLVM::ir_builder->CreateStructGEP(env_type, env, i + 2));
   }
 
-  // Reload, increment, and restore the alloca.  This handles the case
-  // where the body of the loop mutates the variable.
-  llvm::Value* CurVar = ArxLLVM::ir_builder->CreateLoad(
-    ArxLLVM::FLOAT_TYPE, alloca, expr.var_name.c_str());
-  llvm::Value* NextVar =
-    ArxLLVM::ir_builder->CreateFAdd(CurVar, StepVal, "nextvar");
-  ArxLLVM::ir_builder->CreateStore(NextVar, alloca);
+  // outline the body
+  llvm::Type* void_ptr_type = llvm::PointerType::getUnqual(ArxLLVM::INT8_TYPE);
+  llvm::FunctionType* body_type = llvm::FunctionType::get(
+    float_type, {void_ptr_type, int64_type, int64_type}, false);
+  llvm::Function* outlined = llvm::Function::Create(
+    body_type,
+    llvm::Function::InternalLinkage,
+    fn->getName() + ".parfor",
+    ArxLLVM::module.get());
+  // the body keeps the floating-point mode of the function
+  ArxFPMode::copy(fn, outlined);
+
+  auto saved_ip = ArxLLVM::ir_builder->saveIP();
+  llvm::DebugLoc saved_loc = ArxLLVM::ir_builder->getCurrentDebugLocation();
+  std::map<std::string, llvm::AllocaInst*> saved_values =
+    ArxLLVM::named_values;
+  std::map<std::string, std::string> saved_types = ArxLLVM::named_types;
+
+  auto restore = [&]() {
+    ArxLLVM::named_values = saved_values;
+    ArxLLVM::named_types = saved_types;
+    ArxLLVM::ir_builder->restoreIP(saved_ip);
+    ArxLLVM::ir_builder->SetCurrentDebugLocation(saved_loc);
+  };
 
-  // Convert condition to a bool by comparing non-equal to 0.0.
-  EndCond = ArxLLVM::ir_builder->CreateFCmpONE(
-    EndCond,
-    llvm::ConstantFP::get(*ArxLLVM::context, llvm::APFloat(0.0)),
-    "loopcond");
+  llvm::BasicBlock* entry_bb =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "entry", outlined);
+  llvm::BasicBlock* loop_bb =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "loop", outlined);
+  llvm::BasicBlock* exit_bb =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "exit", outlined);
 
-  // Create the "after loop" block and insert it.
-  llvm::BasicBlock* AfterBB =
-    llvm::BasicBlock::Create(*ArxLLVM::context, "afterloop", fn);
+  ArxLLVM::ir_builder->SetInsertPoint(entry_bb);
+  ArxLLVM::named_values.clear();
+  ArxLLVM::named_types.clear();
+
+  llvm::Value* outlined_env = ArxLLVM::ir_builder->CreatePointerCast(
+    outlined->getArg(0), llvm::PointerType::getUnqual(env_type));
+  llvm::Value* begin = outlined->getArg(1);
+  llvm::Value* end = outlined->getArg(2);
+  outlined->getArg(0)->setName("env");
+  begin->setName("begin");
+  end->setName("end");
+
+  start_val = ArxLLVM::ir_builder->CreateLoad(
+    float_type,
+    ArxLLVM::ir_builder->CreateStructGEP(env_type, outlined_env, 0),
+    "start");
+  step_val = ArxLLVM::ir_builder->CreateLoad(
+    float_type,
+    ArxLLVM::ir_builder->CreateStructGEP(env_type, outlined_env, 1),
+    "step");
+  for (unsigned i = 0; i < captured.size(); ++i) {
+    const std::string& name = captured[i];
+    llvm::AllocaInst* alloca =
+      this->create_entry_block_alloca(outlined, name, saved_types[name]);
+    ArxLLVM::ir_builder->CreateStore(
+      ArxLLVM::ir_builder->CreateLoad(
+        env_types[i + 2],
+        ArxLLVM::ir_builder->CreateStructGEP(env_type, outlined_env, i + 2)),
+      alloca);
+    ArxLLVM::named_values[name] = alloca;
+    ArxLLVM::named_types[name] = saved_types[name];
+  }
 
-  // Insert the conditional branch into the end of LoopEndBB.
-  ArxLLVM::ir_builder->CreateCondBr(EndCond, LoopBB, AfterBB);
+  llvm::AllocaInst* var_alloca =
+    this->create_entry_block_alloca(outlined, expr.var_name, "float");
+  ArxLLVM::named_values[expr.var_name] = var_alloca;
+  ArxLLVM::named_types[expr.var_name] = "float";
+
+  ArxReduceOp reduce_op = get_reduce_op(expr.reduce_op);
+  llvm::AllocaInst* acc_alloca =
+    this->create_entry_block_alloca(outlined, "acc", "float");
+  ArxLLVM::ir_builder->CreateStore(
+    llvm::ConstantFP::get(float_type, get_reduce_identity(reduce_op)),
+    acc_alloca);
+  ArxLLVM::ir_builder->CreateCondBr(
+    ArxLLVM::ir_builder->CreateICmpSLT(begin, end), loop_bb, exit_bb);
+
+  // var = start + k * step
+  ArxLLVM::ir_builder->SetInsertPoint(loop_bb);
+  llvm::PHINode* idx = ArxLLVM::ir_builder->CreatePHI(int64_type, 2, "iter");
+  idx->addIncoming(begin, entry_bb);
+  ArxLLVM::ir_builder->CreateStore(
+    ArxLLVM::ir_builder->CreateFAdd(
+      start_val,
+      ArxLLVM::ir_builder->CreateFMul(
+        ArxLLVM::ir_builder->CreateSIToFP(idx, float_type), step_val)),
+    var_alloca);
 
-  // Any new code will be inserted in AfterBB.
-  ArxLLVM::ir_builder->SetInsertPoint(AfterBB);
+  expr.body->accept(*this);
+  llvm::Value* body_val = this->result_val;
+  if (body_val && reduce_op != ARX_REDUCE_NONE) {
+    body_val =
+      this->cast_value(*expr.body, body_val, this->result_type, "float");
+  }
+  if (!body_val) {
+    outlined->eraseFromParent();
+    restore();
+    this->result_val = nullptr;
+    return;
+  }
 
-  // Restore the unshadowed variable.
-  if (OldVal) {
-    ArxLLVM::named_values[expr.var_name] = OldVal;
-  } else {
-    ArxLLVM::named_values.erase(expr.var_name);
+  if (reduce_op != ARX_REDUCE_NONE) {
+    llvm::Value* acc = ArxLLVM::ir_builder->CreateLoad(float_type, acc_alloca);
+    ArxLLVM::ir_builder->CreateStore(
+      emit_reduce(reduce_op, acc, body_val), acc_alloca);
   }
 
-  // for expr always returns 0.0.
-  this->result_val = llvm::Constant::getNullValue(ArxLLVM::FLOAT_TYPE);
+  llvm::Value* next_idx = ArxLLVM::ir_builder->CreateAdd(
+    idx, llvm::ConstantInt::get(int64_type, 1), "nextiter", true, true);
+  idx->addIncoming(next_idx, ArxLLVM::ir_builder->GetInsertBlock());
+  ArxLLVM::ir_builder->CreateCondBr(
+    ArxLLVM::ir_builder->CreateICmpSLT(next_idx, end), loop_bb, exit_bb);
+
+  ArxLLVM::ir_builder->SetInsertPoint(exit_bb);
+  ArxLLVM::ir_builder->CreateRet(
+    ArxLLVM::ir_builder->CreateLoad(float_type, acc_alloca));
+
+  // the locations of the body belong to the debug info of `fn`
+  llvm::stripDebugInfo(*outlined);
+  llvm::verifyFunction(*outlined);
+  restore();
+
+  llvm::FunctionCallee parfor = ArxLLVM::module->getOrInsertFunction(
+    "arx_parfor",
+    float_type,
+    llvm::PointerType::getUnqual(body_type),
+    void_ptr_type,
+    int64_type,
+    ArxLLVM::INT32_TYPE);
+  this->result_val = ArxLLVM::ir_builder->CreateCall(
+    parfor,
+    {outlined,
+     ArxLLVM::ir_builder->CreatePointerCast(env, void_ptr_type),
+     count_val,
+     llvm::ConstantInt::get(ArxLLVM::INT32_TYPE, reduce_op)},
+    "parfor");
+  this->result_type = "float";
 }
 
 /**
  * @brief Code generation for VarExprAST.
  *
+ * Variables without a type annotation take the type of their initializer.
+ * The storage of the arrays is allocated here and released after the body,
+ * in the stack frame when they don't escape (see ArxEscape). The arrays
+ * are not copied, so a variable can't be initialized with an array and
+ * the body can't return one.
  */
 auto ASTToObjectVisitor::visit(VarExprAST& expr) -> void {
   std::vector<llvm::AllocaInst*> old_bindings;
+  std::vector<std::string> old_types;
+  std::set<std::string> allocated_arrays;
+  std::set<std::string> on_stack_arrays;
 
   llvm::Function* fn = ArxLLVM::ir_builder->GetInsertBlock()->getParent();
 
   // Register all variables and emit their initializer.
-  for (auto& i : expr.var_names) {
-    const std::string& var_name = i.first;
-    ExprAST* Init = i.second.get();
+  for (unsigned i = 0, e = expr.var_names.size(); i != e; ++i) {
+    const std::string& var_name = expr.var_names[i].first;
+    ExprAST* Init = expr.var_names[i].second.get();
+    std::string var_type =
+      ArxGeneric::resolve_type(expr.type_names[i], this->type_args);
 
     // Emit the initializer before adding the variable to scope, this
     // prevents the initializer from referencing the variable itself, and
@@ -481,54 +2234,402 @@ auto ASTToObjectVisitor::visit(VarExprAST& expr) -> void {
     //    var a = a in ...   # refers to outer 'a'.
 
     llvm::Value* InitVal = nullptr;
-    if (Init) {
+    if (is_array_type(var_type)) {
+      if (Init) {
+        this->result_val = LogErrorV(
+          "Codegen: Arrays are zero filled, they can't be initialized");
+        return;
+      }
+      bool on_stack = ArxEscape::is_stack_allocated(
+        var_type, var_name, expr.body.get());
+      InitVal = ArxRecord::emit_alloc(var_type, on_stack);
+      allocated_arrays.insert(var_name);
+      if (on_stack) {
+        on_stack_arrays.insert(var_name);
+      }
+    } else if (Init) {
       Init->accept(*this);
       InitVal = this->result_val;
+      if (InitVal && is_array_type(this->result_type)) {
+        std::string msg = "Codegen: `" + var_name +
+          "` can't be initialized with an array, the arrays are not copied";
+        InitVal = LogErrorV(msg.c_str());
+      }
+      if (InitVal) {
+        if (var_type == "") {
+          var_type = this->result_type;
+        }
+        InitVal =
+          this->cast_value(*Init, InitVal, this->result_type, var_type);
+      }
       if (!InitVal) {
         this->result_val = nullptr;
         return;
       }
-    } else {  // If not specified, use 0.0.
-      InitVal = llvm::ConstantFP::get(*ArxLLVM::context, llvm::APFloat(0.0));
+    } else {  // If not specified, use 0.
+      if (var_type == "") {
+        var_type = "float";
+      }
+      InitVal =
+        llvm::Constant::getNullValue(ArxLLVM::get_data_type(var_type));
     }
 
-    // TODO: replace "float" for the actual type_name from the argument
     llvm::AllocaInst* alloca =
-      create_entry_block_alloca(fn, var_name, "float");
+      create_entry_block_alloca(fn, var_name, var_type);
     ArxLLVM::ir_builder->CreateStore(InitVal, alloca);
 
     // Remember the old variable binding so that we can restore the
     // binding when we unrecurse.
     old_bindings.push_back(ArxLLVM::named_values[var_name]);
+    old_types.push_back(ArxLLVM::named_types[var_name]);
 
     // Remember this binding.
     ArxLLVM::named_values[var_name] = alloca;
+    ArxLLVM::named_types[var_name] = var_type;
   }
 
   // Codegen the body, now that all vars are in scope.
   expr.body.get()->accept(*this);
   llvm::Value* body_val = this->result_val;
+  if (
+    body_val && !allocated_arrays.empty() &&
+    is_array_type(this->result_type)) {
+    body_val = LogErrorV(
+      "Codegen: The value of a `var` with arrays can't be an array, they "
+      "are released at its end");
+  }
   if (!body_val) {
     this->result_val = nullptr;
     return;
   }
 
-  // Pop all our variables from scope.
+  // Release the arrays and pop all our variables from scope.
   for (unsigned i = 0, e = expr.var_names.size(); i != e; ++i) {
-    ArxLLVM::named_values[expr.var_names[i].first] = old_bindings[i];
+    const std::string& var_name = expr.var_names[i].first;
+    const std::string& var_type = ArxLLVM::named_types[var_name];
+    if (allocated_arrays.count(var_name) > 0) {
+      ArxRecord::emit_free(
+        ArxLLVM::ir_builder->CreateLoad(
+          ArxLLVM::get_data_type(var_type), ArxLLVM::named_values[var_name]),
+        var_type,
+        on_stack_arrays.count(var_name) > 0);
+    }
+    ArxLLVM::named_values[var_name] = old_bindings[i];
+    ArxLLVM::named_types[var_name] = old_types[i];
   }
 
   // Return the body computation.
   this->result_val = body_val;
 }
 
+/**
+ * @brief Code generation for ConstExprAST.
+ *
+ * The values are evaluated at compile time, no code is emitted for them.
+ * Top level constants stay in scope until the end of the module, the
+ * others only in the body, where they shadow the variables with the same
+ * name.
+ */
+auto ASTToObjectVisitor::visit(ConstExprAST& expr) -> void {
+  std::vector<llvm::AllocaInst*> old_bindings;
+  std::vector<std::unique_ptr<ExprAST>> old_constants;
+  std::vector<std::string> old_types;
+
+  // the variables of the last function are not in scope at the top level
+  if (!expr.body) {
+    ArxLLVM::named_values.clear();
+    ArxLLVM::named_types.clear();
+  }
+
+  for (unsigned i = 0, e = expr.const_names.size(); i != e; ++i) {
+    const std::string& const_name = expr.const_names[i].first;
+    std::string value_type;
+
+    // As for `var`, the value is evaluated before the constant is in scope.
+    auto value = this->fold_constant(*expr.const_names[i].second, value_type);
+    if (!value) {
+      std::string msg = "Codegen: The value of const `" + const_name +
+        "` is not a constant expression";
+      this->result_val = LogErrorV(msg.c_str());
+      return;
+    }
+
+    // literals are converted exactly to the annotated type when used
+    std::string const_type =
+      ArxGeneric::resolve_type(expr.type_names[i], this->type_args);
+    if (const_type == "") {
+      const_type = value_type;
+    }
+    bool is_convertible = value_type == const_type ||
+      (value_type == "float" &&
+       (is_temporal_type(const_type) || is_decimal_type(const_type))) ||
+      (is_string_type(value_type) && is_string_type(const_type));
+    if (!is_convertible) {
+      std::string msg =
+        "Codegen: Cannot convert " + value_type + " to " + const_type;
+      this->result_val = LogErrorV(msg.c_str());
+      return;
+    }
+
+    if (expr.body) {
+      old_bindings.push_back(ArxLLVM::named_values[const_name]);
+      old_constants.push_back(
+        std::move(ArxLLVM::named_constants[const_name]));
+      old_types.push_back(ArxLLVM::named_constant_types[const_name]);
+      ArxLLVM::named_values[const_name] = nullptr;
+    }
+
+    ArxLLVM::named_constants[const_name] = std::move(value);
+    ArxLLVM::named_constant_types[const_name] = const_type;
+  }
+
+  if (!expr.body) {
+    this->result_val = nullptr;
+    this->result_type = "";
+    return;
+  }
+
+  expr.body->accept(*this);
+
+  // Pop all our constants from scope.
+  for (unsigned i = 0, e = expr.const_names.size(); i != e; ++i) {
+    const std::string& const_name = expr.const_names[i].first;
+    ArxLLVM::named_values[const_name] = old_bindings[i];
+    ArxLLVM::named_constants[const_name] = std::move(old_constants[i]);
+    ArxLLVM::named_constant_types[const_name] = old_types[i];
+  }
+}
+
+/**
+ * @brief Emit the array and the index of an element access.
+ * @return false if they are not valid.
+ */
+auto ASTToObjectVisitor::emit_element_index(
+  AccessExprAST& expr,
+  llvm::Value*& array,
+  std::string& array_type,
+  llvm::Value*& index) -> bool {
+  expr.base->accept(*this);
+  array = this->result_val;
+  array_type = this->result_type;
+  if (!array) {
+    return false;
+  }
+  if (!is_array_type(array_type)) {
+    std::string msg = "Codegen: Only arrays can be indexed, not " + array_type;
+    LogErrorV(msg.c_str());
+    return false;
+  }
+
+  // note: the index is not checked against the array length
+  expr.index->accept(*this);
+  if (!this->result_val) {
+    return false;
+  }
+  if (this->result_type != "float") {
+    LogErrorV("Codegen: The array index should be a float");
+    return false;
+  }
+  index = ArxLLVM::ir_builder->CreateFPToSI(
+    this->result_val, ArxLLVM::INT64_TYPE, "idx");
+  return true;
+}
+
+/**
+ * @brief Check if the field access has an address, i.e. if it is a field
+ *        of a variable or of an array element.
+ *
+ */
+static auto is_addressable(AccessExprAST& expr) -> bool {
+  ExprAST& base = *expr.base;
+  return base.kind == ExprKind::VariableKind ||
+    (base.kind == ExprKind::AccessKind &&
+     static_cast<AccessExprAST&>(base).index);
+}
+
+/**
+ * @brief Get the field index of a field access.
+ * @return The field index or -1 if it is not valid.
+ */
+static auto get_field_index(
+  const std::string& type_name, const std::string& field) -> int {
+  if (!is_record_type(type_name)) {
+    std::string msg = "Codegen: Only structs have fields, not " + type_name;
+    LogErrorV(msg.c_str());
+    return -1;
+  }
+
+  int field_idx = get_record_field_index(type_name, field);
+  if (field_idx < 0) {
+    std::string msg =
+      "Codegen: `" + type_name + "` doesn't have the field `" + field + "`";
+    LogErrorV(msg.c_str());
+  }
+  return field_idx;
+}
+
+/**
+ * @brief Get the address of a field of a variable or of an array element.
+ * @return The address or nullptr if the access is not valid.
+ */
+auto ASTToObjectVisitor::emit_field_ptr(
+  AccessExprAST& expr, std::string& field_type) -> llvm::Value* {
+  std::string record_type;
+  int field_idx;
+
+  if (expr.base->kind == ExprKind::AccessKind) {
+    llvm::Value* array;
+    std::string array_type;
+    llvm::Value* index;
+    if (!this->emit_element_index(
+          static_cast<AccessExprAST&>(*expr.base), array, array_type, index)) {
+      return nullptr;
+    }
+
+    record_type = get_array_element_type(array_type);
+    field_idx = get_field_index(record_type, expr.field);
+    if (field_idx < 0) {
+      return nullptr;
+    }
+    field_type = Parser::struct_fields[record_type][field_idx].second;
+    return ArxRecord::emit_element_ptr(array, array_type, index, field_idx);
+  }
+
+  auto& variable = static_cast<VariableExprAST&>(*expr.base);
+  llvm::AllocaInst* alloca = ArxLLVM::named_values[variable.name];
+  if (!alloca) {
+    std::string msg = "Unknown variable name: " + variable.name;
+    LogErrorV(msg.c_str());
+    return nullptr;
+  }
+
+  record_type = ArxLLVM::named_types[variable.name];
+  field_idx = get_field_index(record_type, expr.field);
+  if (field_idx < 0) {
+    return nullptr;
+  }
+  field_type = Parser::struct_fields[record_type][field_idx].second;
+  return ArxLLVM::ir_builder->CreateStructGEP(
+    ArxRecord::get_struct_type(record_type),
+    alloca,
+    static_cast<unsigned>(field_idx),
+    expr.field);
+}
+
+/**
+ * @brief Code generation for AccessExprAST.
+ *
+ * The fields of the variables and of the array elements are loaded from
+ * their address, so `a[i].x` loads just the field. The fields of the other
+ * values (e.g. a struct returned by a call) are extracted from the value.
+ */
+auto ASTToObjectVisitor::visit(AccessExprAST& expr) -> void {
+  if (expr.index) {
+    llvm::Value* array;
+    std::string array_type;
+    llvm::Value* index;
+    if (!this->emit_element_index(expr, array, array_type, index)) {
+      this->result_val = nullptr;
+      return;
+    }
+    this->result_val = ArxRecord::emit_load_element(array, array_type, index);
+    this->result_type = get_array_element_type(array_type);
+    return;
+  }
+
+  if (is_addressable(expr)) {
+    std::string field_type;
+    llvm::Value* field_ptr = this->emit_field_ptr(expr, field_type);
+    if (!field_ptr) {
+      this->result_val = nullptr;
+      return;
+    }
+    this->result_val = ArxLLVM::ir_builder->CreateLoad(
+      ArxLLVM::get_data_type(field_type), field_ptr, expr.field);
+    this->result_type = field_type;
+    return;
+  }
+
+  expr.base->accept(*this);
+  if (!this->result_val) {
+    return;
+  }
+  int field_idx = get_field_index(this->result_type, expr.field);
+  if (field_idx < 0) {
+    this->result_val = nullptr;
+    return;
+  }
+  this->result_type =
+    Parser::struct_fields[this->result_type][field_idx].second;
+  this->result_val = ArxLLVM::ir_builder->CreateExtractValue(
+    this->result_val, {static_cast<unsigned>(field_idx)}, expr.field);
+}
+
+/**
+ * @brief Code generation for the assignment of an array element or of a
+ *        field, like `a[i].x = 1`.
+ *
+ */
+auto ASTToObjectVisitor::emit_access_store(
+  AccessExprAST& expr, ExprAST& value_expr) -> void {
+  if (!expr.index && !is_addressable(expr)) {
+    this->result_val = LogErrorV(
+      "Codegen: destination of '=' must be a variable, an element or a "
+      "field");
+    return;
+  }
+
+  value_expr.accept(*this);
+  llvm::Value* value = this->result_val;
+  std::string value_type = this->result_type;
+  if (!value) {
+    return;
+  }
+
+  if (expr.index) {
+    llvm::Value* array;
+    std::string array_type;
+    llvm::Value* index;
+    if (!this->emit_element_index(expr, array, array_type, index)) {
+      this->result_val = nullptr;
+      return;
+    }
+    std::string element_type = get_array_element_type(array_type);
+    value = this->cast_value(value_expr, value, value_type, element_type);
+    if (!value) {
+      this->result_val = nullptr;
+      return;
+    }
+    ArxRecord::emit_store_element(array, array_type, index, value);
+    this->result_val = value;
+    this->result_type = element_type;
+    return;
+  }
+
+  std::string field_type;
+  llvm::Value* field_ptr = this->emit_field_ptr(expr, field_type);
+  if (field_ptr) {
+    value = this->cast_value(value_expr, value, value_type, field_type);
+  }
+  if (!field_ptr || !value) {
+    this->result_val = nullptr;
+    return;
+  }
+  ArxLLVM::ir_builder->CreateStore(value, field_ptr);
+  this->result_val = value;
+  this->result_type = field_type;
+}
+
 /**
  * @brief Code generation for PrototypeExprAST.
  *
  */
 auto ASTToObjectVisitor::visit(PrototypeAST& expr) -> void {
-  std::vector<llvm::Type*> args_type(expr.args.size(), ArxLLVM::FLOAT_TYPE);
-  llvm::Type* return_type = ArxLLVM::get_data_type("float");
+  std::vector<llvm::Type*> args_type;
+  for (auto& arg : expr.args) {
+    args_type.push_back(ArxLLVM::get_data_type(arg->type_name));
+  }
+  llvm::Type* return_type = ArxLLVM::get_data_type(expr.type_name);
 
   llvm::FunctionType* fn_type =
     llvm::FunctionType::get(return_type, args_type, false /* isVarArg */);
@@ -545,6 +2646,8 @@ auto ASTToObjectVisitor::visit(PrototypeAST& expr) -> void {
     arg.setName(expr.args[idx++]->name);
   }
 
+  ArxLLVM::set_type_names(fn, expr);
+
   this->result_func = fn;
 }
 
@@ -552,9 +2655,17 @@ auto ASTToObjectVisitor::visit(PrototypeAST& expr) -> void {
  * @brief Code generation for FunctionExprAST.
  *
  * Transfer ownership of the prototype to the ArxLLVM::function_protos map,
- * but keep a reference to it for use below.
+ * but keep a reference to it for use below. The generic functions are only
+ * generated when they are called (see ArxGeneric).
  */
 auto ASTToObjectVisitor::visit(FunctionAST& expr) -> void {
+  if (!expr.proto->type_params.empty()) {
+    ArxGeneric::add(expr);
+    this->result_func = nullptr;
+    return;
+  }
+  ArxGeneric::remove(expr.proto->get_name());
+
   auto& proto = *(expr.proto);
   ArxLLVM::function_protos[expr.proto->get_name()] = std::move(expr.proto);
   this->getFunction(proto.get_name());
@@ -571,26 +2682,46 @@ auto ASTToObjectVisitor::visit(FunctionAST& expr) -> void {
     llvm::BasicBlock::Create(*ArxLLVM::context, "entry", fn);
   ArxLLVM::ir_builder->SetInsertPoint(basic_block);
 
+  // the fast-math flags of the function, restored after its body
+  llvm::IRBuilderBase::FastMathFlagGuard fmf_guard(*ArxLLVM::ir_builder);
+  ArxFPMode::apply(fn, proto);
+
   // Record the function arguments in the named_values map.
   // std::cout << "Record the function arguments in the named_values map.";
   ArxLLVM::named_values.clear();
+  ArxLLVM::named_types.clear();
 
   for (auto& llvm_arg : fn->args()) {
+    std::string arg_type =
+      ArxLLVM::get_arg_type_name(fn, llvm_arg.getArgNo());
+
     // Create an alloca for this variable.
-    // TODO: replace "float" for the actual type_name from the argument
     llvm::AllocaInst* alloca =
-      this->create_entry_block_alloca(fn, llvm_arg.getName(), "float");
+      this->create_entry_block_alloca(fn, llvm_arg.getName(), arg_type);
 
     // Store the initial value into the alloca.
     ArxLLVM::ir_builder->CreateStore(&llvm_arg, alloca);
 
     // Add arguments to variable symbol table.
     ArxLLVM::named_values[std::string(llvm_arg.getName())] = alloca;
+    ArxLLVM::named_types[std::string(llvm_arg.getName())] = arg_type;
+  }
+
+  if (proto.args.empty() && proto.get_name() != "__anon_expr") {
+    proto.constant = this->fold_constant(*expr.body, proto.constant_type);
   }
 
   expr.body->accept(*this);
   llvm::Value* llvm_return_val = this->result_val;
 
+  if (llvm_return_val) {
+    llvm_return_val = this->cast_value(
+      *expr.body,
+      llvm_return_val,
+      this->result_type,
+      ArxLLVM::get_return_type_name(fn));
+  }
+
   if (llvm_return_val) {
     // Finish off the function.
     ArxLLVM::ir_builder->CreateRet(llvm_return_val);
@@ -598,8 +2729,14 @@ auto ASTToObjectVisitor::visit(FunctionAST& expr) -> void {
     // Validate the generated code, checking for consistency.
     llvm::verifyFunction(*fn);
 
-    this->result_func = fn;
-    return;
+    proto.is_pure = ArxConstEval::is_pure(proto, *expr.body);
+
+    ArxTailCall::eliminate(fn, proto, *expr.body);
+
+    if (ArxMemo::apply(fn, proto, *expr.body)) {
+      this->result_func = fn;
+      return;
+    }
   }
 
   // Error reading body, remove function.
@@ -626,50 +2763,57 @@ auto ASTToObjectVisitor::main_loop(TreeAST& ast) -> void {
   }
 }
 
-//===----------------------------------------------------------------------===
-// "Library" functions that can be "extern'd" from user code.
-//===----------------------------------------------------------------------===
-
-#ifdef _WIN32
-#define DLLEXPORT __declspec(dllexport)
-#else
-#define DLLEXPORT
-#endif
-
-/**
- * @brief putchar that takes a float and returns 0.
- *
- */
-extern "C" DLLEXPORT auto putchard(float X) -> float {
-  fputc(static_cast<char>(X), stderr);
-  return 0;
-}
-
-/**
- * @brief printf that takes a float prints it as "%f\n", returning 0.
- *
- */
-extern "C" DLLEXPORT auto printd(float X) -> float {
-  fprintf(stderr, "%f\n", X);
-  return 0;
-}
-
 /**
  * @brief Compile an AST to object file.
  *
  * @param tree_ast The AST tree object.
  */
 auto compile_object(TreeAST& tree_ast) -> int {
-  auto codegen = std::make_unique<ASTToObjectVisitor>(ASTToObjectVisitor());
+  std::unique_ptr<ASTToObjectVisitor> codegen;
 
   Lexer::get_next_token();
 
-  codegen->initialize();
+  // with -g the visitor of the LLVM IR adds the debug information
+  if (ArxDebugInfo::is_enabled()) {
+    auto ir_codegen = std::make_unique<ASTToLLVMIRVisitor>();
+    ir_codegen->initialize();
+    codegen = std::move(ir_codegen);
+  } else {
+    codegen = std::make_unique<ASTToObjectVisitor>();
+    codegen->initialize();
+  }
 
   // Run the main "interpreter loop" now.
   LOG(INFO) << "Starting main_loop";
 
+  ArxTimeReport::begin("ir-gen");
   codegen->main_loop(tree_ast);
+  ArxTimeReport::end();
+
+  // the `main` of the program is in the runtime library, it calls the
+  // `main` function of the source. The other outputs are not linked.
+  bool is_program = !IS_BUILD_LIB && ArxEmit::is_object();
+  if (is_program) {
+    // the object of a program is linked from its file
+    if (OUTPUT_FILE == "-") {
+      llvm::errs() << "ARX[FAIL]: The object of a program can't be written "
+                      "to stdout, use --build-lib with `--output -`.\n";
+      return 1;
+    }
+    llvm::Function* main_fn = ArxLLVM::module->getFunction("main");
+    if (!main_fn || main_fn->isDeclaration() || main_fn->arg_size() != 0) {
+      llvm::errs() << "ARX[FAIL]: A program needs a `main` function without "
+                      "arguments (or --build-lib for a library).\n";
+      return 1;
+    }
+    // the runtime calls it as `float arx_main()`
+    if (main_fn->getReturnType() != ArxLLVM::FLOAT_TYPE) {
+      llvm::errs() << "ARX[FAIL]: The `main` function of a program should "
+                      "return a float.\n";
+      return 1;
+    }
+    main_fn->setName("arx_main");
+  }
 
   LOG(INFO) << "target_triple";
 
@@ -687,93 +2831,117 @@ auto compile_object(TreeAST& tree_ast) -> int {
     return 1;
   }
 
-  auto CPU = "generic";
-  auto Features = "";
+  // `native` is the host CPU with its features, e.g. AVX2 for the vector
+  // types, otherwise the backend only uses the baseline of the target.
+  std::string CPU = TARGET_CPU;
+  std::string Features = "";
+  if (TARGET_CPU == "native") {
+    CPU = llvm::sys::getHostCPUName().str();
+    llvm::StringMap<bool> host_features;
+    if (llvm::sys::getHostCPUFeatures(host_features)) {
+      for (auto& feature : host_features) {
+        Features += Features.empty() ? "" : ",";
+        Features += (feature.second ? "+" : "-") + feature.first().str();
+      }
+    }
+  }
 
   LOG(INFO) << "Target Options";
 
   llvm::TargetOptions opt;
+  ArxFPMode::set_target_options(opt);
   auto reloc_model = llvm::Optional<llvm::Reloc::Model>();
 
   LOG(INFO) << "Target Machine";
   auto the_target_machine = Target->createTargetMachine(
     target_triple, CPU, Features, opt, reloc_model);
 
+  ArxFPMode::record(*ArxLLVM::module);
+  ArxDebugInfo::finalize();
+
   LOG(INFO) << "Set Data Layout";
 
   ArxLLVM::module->setDataLayout(the_target_machine->createDataLayout());
 
+  if (ArxProfile::is_enabled()) {
+    ArxPhase phase("optimization");
+    if (!ArxProfile::optimize(*ArxLLVM::module, the_target_machine)) {
+      delete the_target_machine;
+      return 1;
+    }
+  }
+
   LOG(INFO) << "dest output";
-  std::error_code error_code;
 
   if (OUTPUT_FILE == "") {
-    OUTPUT_FILE = INPUT_FILE + ".o";
+    OUTPUT_FILE = INPUT_FILE + ArxEmit::get_extension();
   }
 
-  llvm::raw_fd_ostream dest(OUTPUT_FILE, error_code, llvm::sys::fs::OF_None);
-
-  if (error_code) {
-    llvm::errs() << "Could not open file: " << error_code.message();
-    delete the_target_machine;
-    return 1;
+  {
+    ArxPhase phase("codegen");
+    if (!ArxEmit::write(*ArxLLVM::module, the_target_machine, OUTPUT_FILE)) {
+      delete the_target_machine;
+      return 1;
+    }
   }
 
-  llvm::legacy::PassManager pass;
-
-  auto file_type = llvm::CGFT_ObjectFile;
-
-  if (the_target_machine->addPassesToEmitFile(
-        pass, dest, nullptr, file_type)) {
-    llvm::errs() << "the_target_machine can't emit a file of this type";
+  if (!is_program) {
     delete the_target_machine;
-    return 1;
-  }
-
-  pass.run(*ArxLLVM::module);
-  dest.flush();
-
-  delete the_target_machine;
-
-  if (IS_BUILD_LIB) {
     return 0;
   }
 
-  // generate an executable file
+  // generate an executable file, its `main` is the entry point of the
+  // runtime library (arx-main.cpp) that calls `arx_main`.
+  ArxPhase link_phase("link");
 
   std::string linker_path = "clang++";
   std::string executable_path = INPUT_FILE + "c";
-  // note: it just have a purpose to demonstrate an initial implementation
-  //       it will be improved in a follow-up PR
-  std::string content =
-    "#include <iostream>\n"
-    "int main() {\n"
-    "  std::cout << \"ARX[WARNING]: "
-    "This is an empty executable file\" << std::endl;\n"
-    "}\n";
-
-  std::string main_cpp_path = ArxFile::create_tmp_file(content);
-
-  if (main_cpp_path == "") {
-    llvm::errs() << "ARX[FAIL]: Executable file was not created.";
-    return 1;
+  std::string runtime_library = ArxLLVM::get_runtime_library(".a");
+
+  std::vector<std::string> objects{OUTPUT_FILE};
+  objects.insert(objects.end(), LINK_FILES.begin(), LINK_FILES.end());
+
+  // with --lto the objects are bitcode, they are optimized together (with
+  // the runtime when its bitcode is installed) and compiled here.
+  if (ArxLTO::is_enabled()) {
+    std::string runtime_bitcode = ArxLTO::get_runtime_bitcode();
+    if (runtime_bitcode != "") {
+      objects.push_back(runtime_bitcode);
+      runtime_library = "";
+    }
+    ArxTimeReport::begin("lto");
+    objects = ArxLTO::link(objects, executable_path, the_target_machine);
+    ArxTimeReport::end();
+    if (objects.empty()) {
+      delete the_target_machine;
+      return 1;
+    }
   }
 
+  delete the_target_machine;
+
   /* Example (running it from a shell prompt):
      clang++ \
-       ${CLANG_EXTRAS} \
-       ${DEBUG_FLAGS} \
        -fPIC \
-       -std=c++20 \
-       "${TEST_DIR_PATH}/integration/${test_name}.cpp" \
-       ${OBJECT_FILE} \
+       ${OBJECT_FILE} ${LINK_FILES} \
+       ${RUNTIME_DIR}/libarxrt.a \
+       -lpthread \
+       -lm \
        -o "${TMP_DIR}/main"
   */
 
-  std::vector<std::string> compiler_args{
-    "-fPIC", "-std=c++20", main_cpp_path, OUTPUT_FILE, "-o", executable_path};
+  std::vector<std::string> compiler_args{"-fPIC"};
+  compiler_args.insert(compiler_args.end(), objects.begin(), objects.end());
+  if (runtime_library != "") {
+    compiler_args.push_back(runtime_library);
+  }
+  compiler_args.insert(
+    compiler_args.end(), {"-lpthread", "-lm", "-o", executable_path});
 
-  // Add any additional compiler flags or include paths as needed
-  // compiler_args.push_back("-I/path/to/include");
+  // e.g. the profile runtime
+  for (auto& arg : ArxProfile::get_link_args()) {
+    compiler_args.push_back(arg);
+  }
 
   std::string compiler_cmd =
     linker_path + " " + string_join(compiler_args, " ");
@@ -781,7 +2949,12 @@ auto compile_object(TreeAST& tree_ast) -> int {
   std::cout << "ARX[INFO]: " << compiler_cmd << std::endl;
   int compile_result = system(compiler_cmd.c_str());
 
-  ArxFile::delete_file(main_cpp_path);
+  // the objects of the LTO are temporary
+  if (ArxLTO::is_enabled()) {
+    for (auto& object : objects) {
+      llvm::sys::fs::remove(object);
+    }
+  }
 
   if (compile_result != 0) {
     llvm::errs() << "failed to compile and link object file";
@@ -7,6 +7,7 @@
 #include <map>                    // for map
 #include <memory>                 // for unique_ptr
 #include <string>                 // for string
+#include "codegen/generic.h"      // for TypeArgs
 #include "codegen/jit.h"          // for ArxJIT
 #include "parser.h"               // for PrototypeAST (ptr only), TreeAST (p...
 
@@ -29,10 +30,14 @@ class ASTToObjectVisitor : public Visitor {
  public:
   llvm::Value* result_val;
   llvm::Function* result_func;
+  std::string result_type;
+  // the types of the type parameters of the generic instance in progress
+  TypeArgs type_args;
 
   ASTToObjectVisitor() = default;
 
   virtual void visit(FloatExprAST&) override;
+  virtual void visit(StringExprAST&) override;
   virtual void visit(VariableExprAST&) override;
   virtual void visit(UnaryExprAST&) override;
   virtual void visit(BinaryExprAST&) override;
@@ -40,6 +45,8 @@ class ASTToObjectVisitor : public Visitor {
   virtual void visit(IfExprAST&) override;
   virtual void visit(ForExprAST&) override;
   virtual void visit(VarExprAST&) override;
+  virtual void visit(ConstExprAST&) override;
+  virtual void visit(AccessExprAST&) override;
   virtual void visit(PrototypeAST&) override;
   virtual void visit(FunctionAST&) override;
   virtual void clean() override;
@@ -48,6 +55,41 @@ class ASTToObjectVisitor : public Visitor {
   auto create_entry_block_alloca(
     llvm::Function* fn, llvm::StringRef var_name, std::string type_name)
     -> llvm::AllocaInst*;
+  auto cast_value(
+    ExprAST& expr,
+    llvm::Value* value,
+    const std::string& from_type,
+    const std::string& to_type) -> llvm::Value*;
+  auto fold_constant(ExprAST& expr, std::string& type_name)
+    -> std::unique_ptr<ExprAST>;
+  auto evaluate_call(CallExprAST& expr, std::string& type_name)
+    -> std::unique_ptr<ExprAST>;
+  auto emit_constant(
+    ExprAST& expr,
+    std::unique_ptr<ExprAST> value,
+    const std::string& from_type,
+    const std::string& to_type) -> void;
+  auto emit_range_count(
+    ForExprAST& expr,
+    llvm::Value*& start_val,
+    llvm::Value*& step_val,
+    llvm::Value*& count_val) -> bool;
+  auto emit_range_for(ForExprAST& expr) -> void;
+  auto emit_parallel_for(ForExprAST& expr) -> void;
+  auto emit_vector_builtin(CallExprAST& expr) -> void;
+  auto emit_math_builtin(CallExprAST& expr) -> void;
+  auto emit_record_builtin(CallExprAST& expr) -> void;
+  auto emit_generic_call(CallExprAST& expr) -> void;
+  auto emit_generic_instance(FunctionAST& generic, const TypeArgs& type_args)
+    -> bool;
+  auto emit_element_index(
+    AccessExprAST& expr,
+    llvm::Value*& array,
+    std::string& array_type,
+    llvm::Value*& index) -> bool;
+  auto emit_field_ptr(AccessExprAST& expr, std::string& field_type)
+    -> llvm::Value*;
+  auto emit_access_store(AccessExprAST& expr, ExprAST& value_expr) -> void;
   auto main_loop(TreeAST&) -> void;
   auto initialize() -> void;
 };
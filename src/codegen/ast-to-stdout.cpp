@@ -18,6 +18,7 @@ class ASTToOutputVisitor
   ~ASTToOutputVisitor() = default;
 
   virtual void visit(FloatExprAST&) override;
+  virtual void visit(StringExprAST&) override;
   virtual void visit(VariableExprAST&) override;
   virtual void visit(UnaryExprAST&) override;
   virtual void visit(BinaryExprAST&) override;
@@ -25,6 +26,8 @@ class ASTToOutputVisitor
   virtual void visit(IfExprAST&) override;
   virtual void visit(ForExprAST&) override;
   virtual void visit(VarExprAST&) override;
+  virtual void visit(ConstExprAST&) override;
+  virtual void visit(AccessExprAST&) override;
   virtual void visit(PrototypeAST&) override;
   virtual void visit(FunctionAST&) override;
 
@@ -51,6 +54,11 @@ void ASTToOutputVisitor::visit(FloatExprAST& expr) {
             << expr.val << ")";
 }
 
+void ASTToOutputVisitor::visit(StringExprAST& expr) {
+  std::cout << this->indentation() << this->get_annotation() << "(String \""
+            << expr.val << "\")";
+}
+
 void ASTToOutputVisitor::visit(VariableExprAST& expr) {
   std::cout << this->indentation() << this->get_annotation()
             << "(VariableExprAST " << expr.name << ")";
@@ -195,6 +203,54 @@ void ASTToOutputVisitor::visit(VarExprAST& expr) {
   std::cout << ")" << std::endl;
 }
 
+void ASTToOutputVisitor::visit(ConstExprAST& expr) {
+  std::cout << "(ConstExprAST " << std::endl;
+  this->indent += INDENT_SIZE;
+
+  for (auto const_expr = expr.const_names.begin();
+       const_expr != expr.const_names.end();
+       ++const_expr) {
+    std::cout << this->indentation() << const_expr->first << " = ";
+    const_expr->second->accept(*this);
+    std::cout << "," << std::endl;
+  }
+
+  if (expr.body) {
+    expr.body->accept(*this);
+    std::cout << std::endl;
+  }
+
+  this->indent -= INDENT_SIZE;
+
+  std::cout << ")" << std::endl;
+}
+
+void ASTToOutputVisitor::visit(AccessExprAST& expr) {
+  std::cout << this->indentation() << this->get_annotation() << '('
+            << std::endl;
+  this->indent += INDENT_SIZE;
+
+  std::cout << this->indentation() << "AccessExprAST " << expr.field << '('
+            << std::endl;
+  this->indent += INDENT_SIZE;
+
+  this->set_annotation("<BASE>");
+  expr.base->accept(*this);
+  std::cout << std::endl;
+
+  if (expr.index) {
+    this->set_annotation("<INDEX>");
+    expr.index->accept(*this);
+    std::cout << std::endl;
+  }
+
+  this->indent -= INDENT_SIZE;
+  std::cout << this->indentation() << ")" << std::endl;
+
+  this->indent -= INDENT_SIZE;
+  std::cout << this->indentation() << ")";
+}
+
 void ASTToOutputVisitor::visit(PrototypeAST& expr) {
   // TODO: implement it
   std::cout << "(PrototypeAST " << expr.name << ")" << std::endl;
@@ -205,8 +261,12 @@ void ASTToOutputVisitor::visit(FunctionAST& expr) {
   this->indent += INDENT_SIZE;
 
   // create the function and open the args section
-  std::cout << this->indentation() << "Function " << expr.proto->name
-            << " <ARGS> (" << std::endl;
+  std::cout << this->indentation() << "Function " << expr.proto->name;
+  for (size_t i = 0; i < expr.proto->type_params.size(); ++i) {
+    std::cout << (i == 0 ? "[" : ", ") << expr.proto->type_params[i];
+  }
+  std::cout << (expr.proto->type_params.empty() ? "" : "]") << " <ARGS> ("
+            << std::endl;
   this->indent += INDENT_SIZE;
 
   // std::cout << expr.proto->args.front();
@@ -0,0 +1,397 @@
+#include "codegen/const-eval.h"  // for ArxConstEval
+#include <cstdint>                // for int64_t, int32_t, uintptr_t
+#include <memory>                 // for unique_ptr, make_unique
+#include <set>                    // for set
+#include <string>                 // for string, to_string
+#include <utility>                // for move
+#include <vector>                 // for vector
+
+#include <glog/logging.h>                               // for LOG
+#include <llvm/ADT/SmallVector.h>                       // for SmallVector
+#include <llvm/Bitcode/BitcodeReader.h>                 // for parseBitco...
+#include <llvm/Bitcode/BitcodeWriter.h>                 // for WriteBitco...
+#include <llvm/ExecutionEngine/Orc/Core.h>              // for ResourceTr...
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>  // for ThreadSafe...
+#include <llvm/IR/BasicBlock.h>                         // for BasicBlock
+#include <llvm/IR/Constants.h>                          // for ConstantInt
+#include <llvm/IR/DebugInfo.h>                          // for StripDebug...
+#include <llvm/IR/Function.h>                           // for Function
+#include <llvm/IR/GlobalVariable.h>                     // for GlobalVari...
+#include <llvm/IR/IRBuilder.h>                          // for IRBuilder
+#include <llvm/IR/Instructions.h>                       // for CallInst
+#include <llvm/IR/LLVMContext.h>                        // for LLVMContext
+#include <llvm/IR/Module.h>                             // for Module
+#include <llvm/IR/Verifier.h>                           // for verifyModule
+#include <llvm/Support/MemoryBuffer.h>                  // for MemoryBuff...
+#include <llvm/Support/raw_ostream.h>                   // for raw_svecto...
+#include <llvm/Transforms/Utils/Cloning.h>              // for CloneModule
+#include <llvm/Transforms/Utils/ValueMapper.h>          // for ValueToVal...
+
+#include "codegen/arx-llvm.h"  // for ArxLLVM
+#include "codegen/math.h"      // for ArxMath
+#include "parser.h"            // for ExprAST, PrototypeAST
+
+int64_t ArxConstEval::max_steps = 1000000;
+int64_t ArxConstEval::max_depth = 10000;
+int ArxConstEval::max_calls = 1000;
+int ArxConstEval::calls = 0;
+
+/**
+ * @brief Check if the expression only calls pure functions.
+ * @param expr The expression.
+ * @param self The name of the function, recursive calls are pure.
+ */
+static auto is_pure_expr(ExprAST* expr, const std::string& self) -> bool {
+  if (!expr) {
+    return true;
+  }
+
+  auto is_pure_callee = [&self](const std::string& name) {
+    if (name == self) {
+      return true;
+    }
+    auto proto = ArxLLVM::function_protos.find(name);
+    if (proto == ArxLLVM::function_protos.end()) {
+      return ArxMath::is_builtin(name);
+    }
+    return proto->second && proto->second->is_pure;
+  };
+
+  switch (expr->kind) {
+    case ExprKind::FloatDTKind:
+    case ExprKind::VariableKind:
+      return true;
+    case ExprKind::UnaryOpKind: {
+      auto unary = static_cast<UnaryExprAST*>(expr);
+      return is_pure_callee(std::string("unary") + unary->op_code) &&
+        is_pure_expr(unary->operand.get(), self);
+    }
+    case ExprKind::BinaryOpKind: {
+      // the assignments only change the local variables
+      auto binary = static_cast<BinaryExprAST*>(expr);
+      switch (binary->op) {
+        case '=':
+        case '+':
+        case '-':
+        case '*':
+        case '<':
+          break;
+        default:
+          if (!is_pure_callee(std::string("binary") + binary->op)) {
+            return false;
+          }
+      }
+      return is_pure_expr(binary->lhs.get(), self) &&
+        is_pure_expr(binary->rhs.get(), self);
+    }
+    case ExprKind::CallKind: {
+      auto call = static_cast<CallExprAST*>(expr);
+      if (!is_pure_callee(call->callee)) {
+        return false;
+      }
+      for (auto& arg : call->args) {
+        if (!is_pure_expr(arg.get(), self)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case ExprKind::IfKind: {
+      auto if_expr = static_cast<IfExprAST*>(expr);
+      return is_pure_expr(if_expr->cond.get(), self) &&
+        is_pure_expr(if_expr->then.get(), self) &&
+        is_pure_expr(if_expr->else_.get(), self);
+    }
+    case ExprKind::ForKind: {
+      // `parfor` calls the parallel runtime
+      auto for_expr = static_cast<ForExprAST*>(expr);
+      return !for_expr->is_parallel &&
+        is_pure_expr(for_expr->start.get(), self) &&
+        is_pure_expr(for_expr->end.get(), self) &&
+        is_pure_expr(for_expr->step.get(), self) &&
+        is_pure_expr(for_expr->body.get(), self);
+    }
+    case ExprKind::VarKind: {
+      auto var_expr = static_cast<VarExprAST*>(expr);
+      for (auto& var : var_expr->var_names) {
+        if (!is_pure_expr(var.second.get(), self)) {
+          return false;
+        }
+      }
+      return is_pure_expr(var_expr->body.get(), self);
+    }
+    case ExprKind::ConstKind:
+      return is_pure_expr(static_cast<ConstExprAST*>(expr)->body.get(), self);
+    default:
+      // e.g. strings, the runtime functions allocate their results
+      return false;
+  }
+}
+
+/**
+ * @brief Check if the function is pure.
+ * @param proto The function prototype.
+ * @param body The function body.
+ *
+ * The arguments and the return value should be floats, so the function
+ * can be called from the compiler.
+ */
+auto ArxConstEval::is_pure(PrototypeAST& proto, ExprAST& body) -> bool {
+  if (proto.type_name != "float") {
+    return false;
+  }
+  for (auto& arg : proto.args) {
+    if (arg->type_name != "float") {
+      return false;
+    }
+  }
+  return is_pure_expr(&body, proto.get_name());
+}
+
+/**
+ * @brief Collect the function and the functions called by it.
+ * @return false if it calls a function that is not defined.
+ */
+static auto collect_callees(
+  llvm::Function* fn, std::set<const llvm::GlobalValue*>& callees) -> bool {
+  std::vector<llvm::Function*> pending = {fn};
+  callees.insert(fn);
+
+  while (!pending.empty()) {
+    llvm::Function* caller = pending.back();
+    pending.pop_back();
+
+    // note: a function without terminators is still being generated.
+    for (llvm::BasicBlock& block : *caller) {
+      if (!block.getTerminator()) {
+        return false;
+      }
+      for (llvm::Instruction& inst : block) {
+        auto call = llvm::dyn_cast<llvm::CallInst>(&inst);
+        if (!call) {
+          continue;
+        }
+        llvm::Function* callee = call->getCalledFunction();
+        if (!callee || (callee->isDeclaration() && !callee->isIntrinsic())) {
+          return false;
+        }
+        if (!callee->isIntrinsic() && callees.insert(callee).second) {
+          pending.push_back(callee);
+        }
+      }
+    }
+  }
+  return !fn->isDeclaration();
+}
+
+/**
+ * @brief Count the executed basic blocks and the call depth.
+ *
+ * Each block decreases `arx.eval.steps`, and the entry blocks increase
+ * `arx.eval.depth`. When the budget is over, the steps are set to -1 and
+ * all the functions return 0, so the evaluation stops quickly.
+ */
+static auto add_budget_checks(llvm::Module& module) -> void {
+  llvm::LLVMContext& context = module.getContext();
+  llvm::Type* int64_type = llvm::Type::getInt64Ty(context);
+  llvm::IRBuilder<> builder(context);
+
+  auto steps = new llvm::GlobalVariable(
+    module,
+    int64_type,
+    false,
+    llvm::GlobalValue::InternalLinkage,
+    llvm::ConstantInt::get(int64_type, 0),
+    "arx.eval.steps");
+  auto depth = new llvm::GlobalVariable(
+    module,
+    int64_type,
+    false,
+    llvm::GlobalValue::InternalLinkage,
+    llvm::ConstantInt::get(int64_type, 0),
+    "arx.eval.depth");
+
+  for (llvm::Function& fn : module) {
+    if (fn.isDeclaration()) {
+      continue;
+    }
+    fn.setLinkage(llvm::GlobalValue::InternalLinkage);
+
+    std::vector<llvm::BasicBlock*> blocks;
+    for (llvm::BasicBlock& block : fn) {
+      blocks.push_back(&block);
+
+      if (auto ret = llvm::dyn_cast<llvm::ReturnInst>(block.getTerminator())) {
+        builder.SetInsertPoint(ret);
+        builder.CreateStore(
+          builder.CreateSub(
+            builder.CreateLoad(int64_type, depth),
+            llvm::ConstantInt::get(int64_type, 1)),
+          depth);
+      }
+    }
+
+    llvm::BasicBlock* exit_block =
+      llvm::BasicBlock::Create(context, "budget.exit", &fn);
+    builder.SetInsertPoint(exit_block);
+    builder.CreateStore(llvm::ConstantInt::get(int64_type, -1), steps);
+    builder.CreateRet(llvm::Constant::getNullValue(fn.getReturnType()));
+
+    for (llvm::BasicBlock* block : blocks) {
+      bool is_entry = block->isEntryBlock();
+      llvm::BasicBlock* body =
+        block->splitBasicBlock(block->getFirstInsertionPt(), "budget.ok");
+      block->getTerminator()->eraseFromParent();
+      builder.SetInsertPoint(block);
+
+      llvm::Value* steps_left = builder.CreateSub(
+        builder.CreateLoad(int64_type, steps),
+        llvm::ConstantInt::get(int64_type, 1));
+      builder.CreateStore(steps_left, steps);
+      llvm::Value* is_over = builder.CreateICmpSLT(
+        steps_left, llvm::ConstantInt::get(int64_type, 0));
+
+      if (is_entry) {
+        llvm::Value* level = builder.CreateAdd(
+          builder.CreateLoad(int64_type, depth),
+          llvm::ConstantInt::get(int64_type, 1));
+        builder.CreateStore(level, depth);
+        is_over = builder.CreateOr(
+          is_over,
+          builder.CreateICmpSGT(
+            level,
+            llvm::ConstantInt::get(int64_type, ArxConstEval::max_depth)));
+      }
+      builder.CreateCondBr(is_over, exit_block, body);
+    }
+  }
+}
+
+/**
+ * @brief Add a function that calls `fn` with the given arguments.
+ * @return The name of the new function.
+ *
+ * It is `i32 (float* result)`, it returns 0 when the budget was over.
+ */
+static auto add_eval_function(
+  llvm::Module& module, llvm::Function* fn, const std::vector<float>& args)
+  -> std::string {
+  llvm::LLVMContext& context = module.getContext();
+  llvm::Type* int64_type = llvm::Type::getInt64Ty(context);
+  llvm::Type* float_type = llvm::Type::getFloatTy(context);
+  llvm::GlobalVariable* steps = module.getNamedGlobal("arx.eval.steps");
+  llvm::GlobalVariable* depth = module.getNamedGlobal("arx.eval.depth");
+
+  std::string name = "arx.eval." + std::to_string(ArxConstEval::calls);
+  llvm::Function* eval_fn = llvm::Function::Create(
+    llvm::FunctionType::get(
+      llvm::Type::getInt32Ty(context), {float_type->getPointerTo()}, false),
+    llvm::Function::ExternalLinkage,
+    name,
+    module);
+
+  llvm::IRBuilder<> builder(
+    llvm::BasicBlock::Create(context, "entry", eval_fn));
+  builder.CreateStore(
+    llvm::ConstantInt::get(int64_type, ArxConstEval::max_steps), steps);
+  builder.CreateStore(llvm::ConstantInt::get(int64_type, 0), depth);
+
+  std::vector<llvm::Value*> call_args;
+  for (float arg : args) {
+    call_args.push_back(llvm::ConstantFP::get(float_type, arg));
+  }
+  builder.CreateStore(builder.CreateCall(fn, call_args), eval_fn->getArg(0));
+
+  llvm::Value* is_done = builder.CreateICmpSGE(
+    builder.CreateLoad(int64_type, steps),
+    llvm::ConstantInt::get(int64_type, 0));
+  builder.CreateRet(
+    builder.CreateZExt(is_done, llvm::Type::getInt32Ty(context)));
+
+  return name;
+}
+
+/**
+ * @brief Call a pure function at compile time.
+ * @param fn The function, from ArxLLVM::module.
+ * @param args The arguments.
+ * @param result The returned value.
+ * @return false if the function can't be called or the budget was over.
+ *
+ * The function and its callees are copied to a new module (with a new
+ * context, as the JIT owns the modules added to it), instrumented with the
+ * budget checks and removed from the JIT after the call.
+ */
+auto ArxConstEval::evaluate(
+  llvm::Function* fn, const std::vector<float>& args, float& result)
+  -> bool {
+  if (
+    ArxConstEval::max_steps <= 0 ||
+    ArxConstEval::calls >= ArxConstEval::max_calls ||
+    !fn->getReturnType()->isFloatTy() || fn->arg_size() != args.size()) {
+    return false;
+  }
+  for (llvm::Argument& arg : fn->args()) {
+    if (!arg.getType()->isFloatTy()) {
+      return false;
+    }
+  }
+
+  std::set<const llvm::GlobalValue*> callees;
+  if (!collect_callees(fn, callees)) {
+    return false;
+  }
+  ++ArxConstEval::calls;
+
+  llvm::ValueToValueMapTy value_map;
+  std::unique_ptr<llvm::Module> clone = llvm::CloneModule(
+    *ArxLLVM::module, value_map, [&callees](const llvm::GlobalValue* value) {
+      return callees.count(value) > 0;
+    });
+  llvm::StripDebugInfo(*clone);
+
+  llvm::SmallVector<char, 0> buffer;
+  llvm::raw_svector_ostream buffer_stream(buffer);
+  llvm::WriteBitcodeToFile(*clone, buffer_stream);
+  clone.reset();
+
+  auto context = std::make_unique<llvm::LLVMContext>();
+  auto module_or_err = llvm::parseBitcodeFile(
+    llvm::MemoryBufferRef(
+      llvm::StringRef(buffer.data(), buffer.size()), "arx eval"),
+    *context);
+  if (!module_or_err) {
+    llvm::consumeError(module_or_err.takeError());
+    return false;
+  }
+  std::unique_ptr<llvm::Module> module = std::move(*module_or_err);
+
+  add_budget_checks(*module);
+  std::string eval_name =
+    add_eval_function(*module, module->getFunction(fn->getName()), args);
+
+  if (llvm::verifyModule(*module, &llvm::errs())) {
+    return false;
+  }
+
+  LOG(INFO) << "ArxConstEval: evaluate " << fn->getName().str();
+
+  llvm::orc::ResourceTrackerSP tracker =
+    ArxLLVM::jit->get_main_jit_dylib().createResourceTracker();
+  ArxLLVM::exit_on_err(ArxLLVM::jit->addModule(
+    llvm::orc::ThreadSafeModule(std::move(module), std::move(context)),
+    tracker));
+
+  bool is_done = false;
+  auto symbol = ArxLLVM::jit->lookup(eval_name);
+  if (symbol) {
+    auto eval_fn = reinterpret_cast<int32_t (*)(float*)>(
+      static_cast<uintptr_t>(symbol->getAddress()));
+    is_done = eval_fn(&result) != 0;
+  } else {
+    llvm::consumeError(symbol.takeError());
+  }
+
+  ArxLLVM::exit_on_err(tracker->remove());
+  return is_done;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>  // for int64_t
+#include <vector>   // for vector
+
+#include "parser.h"  // for PrototypeAST, ExprAST
+
+namespace llvm {
+  class Function;
+}
+
+/**
+ * @brief Compile-time evaluation of pure functions with the embedded JIT.
+ *
+ * A function is pure when it only receives and returns floats and its body
+ * doesn't call any function with possible side effects (e.g. externs).
+ * Calls to a pure function with constant arguments are executed by
+ * ArxLLVM::jit while compiling, and the call is replaced by its result.
+ *
+ * The evaluated code counts the basic blocks it executes and the depth of
+ * its recursive calls. When one of them is over the budget, the evaluation
+ * is abandoned and the call is compiled as usual.
+ */
+class ArxConstEval {
+ public:
+  // maximum number of basic blocks executed by one call (0 disables it)
+  static int64_t max_steps;
+  // maximum depth of the recursive calls
+  static int64_t max_depth;
+  // maximum number of evaluated calls in one process
+  static int max_calls;
+  // number of evaluated calls
+  static int calls;
+
+  static auto is_pure(PrototypeAST& proto, ExprAST& body) -> bool;
+  static auto evaluate(
+    llvm::Function* fn, const std::vector<float>& args, float& result)
+    -> bool;
+};
@@ -0,0 +1,88 @@
+#include "codegen/debug-info.h"  // for ArxDebugInfo
+#include <string>                // for string
+
+#include <llvm/ADT/SmallString.h>       // for SmallString
+#include <llvm/ADT/Triple.h>            // for Triple
+#include <llvm/BinaryFormat/Dwarf.h>    // for DW_LANG_C
+#include <llvm/IR/DebugInfoMetadata.h>  // for DICompileUnit
+#include <llvm/IR/DIBuilder.h>          // for DIBuilder
+#include <llvm/IR/Module.h>             // for Module
+#include <llvm/Support/FileSystem.h>    // for make_absolute
+#include <llvm/Support/Host.h>          // for getDefaultTargetTriple
+#include <llvm/Support/Path.h>          // for filename, parent_path
+
+#include "codegen/arx-llvm.h"  // for ArxLLVM
+
+extern std::string ARX_VERSION;
+
+std::string ArxDebugInfo::level = "none";
+
+/**
+ * @brief Check if the compiler emits debug information.
+ *
+ */
+auto ArxDebugInfo::is_enabled() -> bool {
+  return ArxDebugInfo::level != "none";
+}
+
+/**
+ * @brief Check if the debug information has the types and the variables.
+ *
+ */
+auto ArxDebugInfo::is_full() -> bool {
+  return ArxDebugInfo::level == "full";
+}
+
+/**
+ * @brief Create the DIBuilder and the compile unit of ArxLLVM::module.
+ * @param input_file The source file, empty for stdin.
+ * @return The compile unit, or nullptr without debug information.
+ */
+auto ArxDebugInfo::create_compile_unit(const std::string& input_file)
+  -> llvm::DICompileUnit* {
+  if (!ArxDebugInfo::is_enabled()) {
+    return nullptr;
+  }
+
+  ArxLLVM::initialize_debug_info();
+
+  // Add the current debug info version into the module.
+  ArxLLVM::module->addModuleFlag(
+    llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
+
+  // Darwin only supports dwarf2.
+  if (llvm::Triple(llvm::sys::getDefaultTargetTriple()).isOSDarwin()) {
+    ArxLLVM::module->addModuleFlag(llvm::Module::Warning, "Dwarf Version", 2);
+  }
+
+  std::string filename = "<stdin>";
+  std::string directory = ".";
+  if (input_file != "") {
+    llvm::SmallString<256> path(input_file);
+    llvm::sys::fs::make_absolute(path);
+    filename = llvm::sys::path::filename(path).str();
+    directory = llvm::sys::path::parent_path(path).str();
+  }
+
+  return ArxLLVM::di_builder->createCompileUnit(
+    llvm::dwarf::DW_LANG_C,
+    ArxLLVM::di_builder->createFile(filename, directory),
+    "Arx Compiler " + ARX_VERSION,
+    false,
+    "",
+    0,
+    "",
+    ArxDebugInfo::is_full() ? llvm::DICompileUnit::FullDebug
+                            : llvm::DICompileUnit::LineTablesOnly);
+}
+
+/**
+ * @brief Finalize the debug information of ArxLLVM::module, before it is
+ *        written.
+ *
+ */
+auto ArxDebugInfo::finalize() -> void {
+  if (ArxLLVM::di_builder) {
+    ArxLLVM::di_builder->finalize();
+  }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>  // for string
+
+namespace llvm {
+  class DICompileUnit;
+}  // namespace llvm
+
+/**
+ * @brief Debug information of the generated code.
+ *
+ * `-g` selects how much debug information the compiler emits:
+ *
+ *   none              no metadata (the default)
+ *   line-tables-only  the functions and the lines of the instructions,
+ *                     enough for the profilers and the backtraces
+ *   full              also the types of the functions and the arguments,
+ *                     for the debuggers
+ *
+ * Without `-g` the compiler doesn't create the DIBuilder nor any metadata,
+ * so the IR, the objects and the compilation don't pay for it. The file of
+ * the compile unit is the input file (`<stdin>` for the shell).
+ */
+class ArxDebugInfo {
+ public:
+  // -g: none, line-tables-only or full
+  static std::string level;
+
+  static auto is_enabled() -> bool;
+  static auto is_full() -> bool;
+  static auto create_compile_unit(const std::string& input_file)
+    -> llvm::DICompileUnit*;
+  static auto finalize() -> void;
+};
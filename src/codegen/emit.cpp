@@ -0,0 +1,116 @@
+#include "codegen/emit.h"  // for ArxEmit
+#include <memory>          // for unique_ptr, make_unique
+#include <string>          // for string
+#include <system_error>    // for error_code
+
+#include <llvm/Analysis/ModuleSummaryAnalysis.h>  // for buildModuleSumma...
+#include <llvm/Analysis/ProfileSummaryInfo.h>     // for ProfileSummaryInfo
+#include <llvm/Bitcode/BitcodeWriter.h>           // for WriteBitcodeToFile
+#include <llvm/IR/LegacyPassManager.h>            // for PassManager
+#include <llvm/IR/Module.h>                       // for Module
+#include <llvm/IR/ModuleSummaryIndex.h>           // for ModuleSummaryIndex
+#include <llvm/Support/CodeGen.h>                 // for CodeGenFileType
+#include <llvm/Support/FileSystem.h>              // for OpenFlags
+#include <llvm/Support/ToolOutputFile.h>          // for ToolOutputFile
+#include <llvm/Support/raw_ostream.h>             // for buffer_ostream
+#include <llvm/Target/TargetMachine.h>            // for TargetMachine
+
+#include "codegen/lto.h"  // for ArxLTO
+
+std::string ArxEmit::kind = "obj";
+
+/**
+ * @brief Check if the output is an object (linked into a program).
+ *
+ */
+auto ArxEmit::is_object() -> bool {
+  return ArxEmit::kind == "obj";
+}
+
+/**
+ * @brief Get the extension of the output file.
+ *
+ */
+auto ArxEmit::get_extension() -> std::string {
+  if (ArxEmit::kind == "asm") {
+    return ".s";
+  } else if (ArxEmit::kind == "llvm-ir") {
+    return ".ll";
+  } else if (ArxEmit::kind == "llvm-bc") {
+    return ".bc";
+  }
+  return ".o";
+}
+
+/**
+ * @brief Write the bitcode of the module with its summary.
+ *
+ */
+static auto write_bitcode(llvm::Module& module, llvm::raw_ostream& out)
+  -> void {
+  // like llvm-as, without the frequency of the blocks
+  llvm::ProfileSummaryInfo profile_summary(module);
+  llvm::ModuleSummaryIndex index =
+    llvm::buildModuleSummaryIndex(module, nullptr, &profile_summary);
+  llvm::WriteBitcodeToFile(module, out, false, &index);
+}
+
+/**
+ * @brief Write the code of the module in the kind of ArxEmit::kind.
+ * @param module The module, with its target triple and data layout.
+ * @param machine The target machine of the assembly and of the object.
+ * @param path The output file, `-` for stdout.
+ * @return false if the file can't be written.
+ */
+auto ArxEmit::write(
+  llvm::Module& module, llvm::TargetMachine* machine, const std::string& path)
+  -> bool {
+  bool is_text = ArxEmit::kind == "asm" || ArxEmit::kind == "llvm-ir";
+  std::error_code error_code;
+  llvm::ToolOutputFile out(
+    path,
+    error_code,
+    is_text ? llvm::sys::fs::OF_Text : llvm::sys::fs::OF_None);
+  if (error_code) {
+    llvm::errs() << "ARX[FAIL]: Could not open file " << path << ": "
+                 << error_code.message() << "\n";
+    return false;
+  }
+
+  if (ArxEmit::kind == "llvm-ir") {
+    module.print(out.os(), nullptr);
+  } else if (ArxEmit::kind == "llvm-bc") {
+    write_bitcode(module, out.os());
+  } else if (ArxEmit::is_object() && ArxLTO::is_enabled()) {
+    // the optimization and the code generation run at the link
+    ArxLTO::write_bitcode(module, out.os());
+  } else {
+    // the object writer seeks back in the file, stdout is buffered here
+    llvm::raw_pwrite_stream* dest = &out.os();
+    std::unique_ptr<llvm::buffer_ostream> buffer;
+    if (!out.os().supportsSeeking()) {
+      buffer = std::make_unique<llvm::buffer_ostream>(out.os());
+      dest = buffer.get();
+    }
+
+    llvm::legacy::PassManager pass;
+    auto file_type = ArxEmit::kind == "asm" ? llvm::CGFT_AssemblyFile
+                                            : llvm::CGFT_ObjectFile;
+    if (machine->addPassesToEmitFile(pass, *dest, nullptr, file_type)) {
+      llvm::errs() << "ARX[FAIL]: The target machine can't emit a file of "
+                      "this type.\n";
+      return false;
+    }
+    pass.run(module);
+  }
+
+  out.os().flush();
+  if (out.os().has_error()) {
+    llvm::errs() << "ARX[FAIL]: Could not write file " << path << ": "
+                 << out.os().error().message() << "\n";
+    out.os().clear_error();
+    return false;
+  }
+  out.keep();
+  return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>  // for string
+
+namespace llvm {
+  class Module;
+  class TargetMachine;
+}  // namespace llvm
+
+/**
+ * @brief Output files of the compiler.
+ *
+ * `--emit` selects the file written to `--output` (by default the input
+ * file with the extension of the kind):
+ *
+ *   obj      the object, linked into a program without --build-lib (.o)
+ *   asm      the assembly of the target (.s)
+ *   llvm-ir  the textual LLVM IR (.ll)
+ *   llvm-bc  the LLVM bitcode (.bc)
+ *
+ * Only `obj` is linked. The files are written through a buffered stream
+ * that is removed if the output fails, and `-` writes to stdout. The
+ * bitcode has the symbol table of the module, the offsets of the
+ * functions and the module summary (the functions and their calls), so
+ * the tools can read its symbols without parsing it and load only the
+ * functions that they need (getLazyBitcodeModule).
+ */
+class ArxEmit {
+ public:
+  // --emit: obj, asm, llvm-ir or llvm-bc
+  static std::string kind;
+
+  static auto is_object() -> bool;
+  static auto get_extension() -> std::string;
+  static auto write(
+    llvm::Module& module,
+    llvm::TargetMachine* machine,
+    const std::string& path) -> bool;
+};
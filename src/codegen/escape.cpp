@@ -0,0 +1,143 @@
+#include "codegen/escape.h"  // for ArxEscape
+#include <cstdint>           // for int64_t, uint64_t
+#include <memory>            // for unique_ptr
+#include <string>            // for string
+
+#include <llvm/IR/DataLayout.h>  // for DataLayout
+#include <llvm/IR/Function.h>    // for Function
+#include <llvm/IR/Module.h>      // for Module
+
+#include "codegen/arx-llvm.h"  // for ArxLLVM
+#include "codegen/generic.h"   // for ArxGeneric
+#include "codegen/record.h"    // for ArxRecord
+#include "parser.h"            // for ExprAST, CallExprAST, VarExprAST
+
+int64_t ArxEscape::max_stack_size = 64 * 1024;
+
+/**
+ * @brief Check if the expression is a reference to the variable.
+ *
+ */
+static auto is_variable(ExprAST* expr, const std::string& var_name) -> bool {
+  return expr && expr->kind == ExprKind::VariableKind &&
+    static_cast<VariableExprAST*>(expr)->get_name() == var_name;
+}
+
+/**
+ * @brief Check if the function is a builtin, a generic function or if its
+ *        body is in the module, i.e. if it can't keep the address of an
+ *        array argument.
+ *
+ */
+static auto is_arx_function(const std::string& name) -> bool {
+  if (ArxRecord::is_builtin(name) || ArxGeneric::is_generic(name)) {
+    return true;
+  }
+  llvm::Function* fn = ArxLLVM::module->getFunction(name);
+  return fn && !fn->isDeclaration();
+}
+
+/**
+ * @brief Check if the array `var_name` escapes in the expression.
+ *
+ * The expression is walked in the scope of the variable, so the
+ * declarations with the same name hide it.
+ */
+auto ArxEscape::escapes(ExprAST* expr, const std::string& var_name) -> bool {
+  if (!expr) {
+    return false;
+  }
+
+  switch (expr->kind) {
+    case ExprKind::VariableKind:
+      // any other use than the ones below
+      return is_variable(expr, var_name);
+    case ExprKind::UnaryOpKind:
+      return ArxEscape::escapes(
+        static_cast<UnaryExprAST*>(expr)->operand.get(), var_name);
+    case ExprKind::BinaryOpKind: {
+      auto binary = static_cast<BinaryExprAST*>(expr);
+      return ArxEscape::escapes(binary->lhs.get(), var_name) ||
+        ArxEscape::escapes(binary->rhs.get(), var_name);
+    }
+    case ExprKind::CallKind: {
+      auto call = static_cast<CallExprAST*>(expr);
+      bool is_arx_callee = is_arx_function(call->callee);
+      for (auto& arg : call->args) {
+        if (is_arx_callee && is_variable(arg.get(), var_name)) {
+          continue;
+        }
+        if (ArxEscape::escapes(arg.get(), var_name)) {
+          return true;
+        }
+      }
+      return false;
+    }
+    case ExprKind::IfKind: {
+      auto if_expr = static_cast<IfExprAST*>(expr);
+      return ArxEscape::escapes(if_expr->cond.get(), var_name) ||
+        ArxEscape::escapes(if_expr->then.get(), var_name) ||
+        ArxEscape::escapes(if_expr->else_.get(), var_name);
+    }
+    case ExprKind::ForKind: {
+      auto for_expr = static_cast<ForExprAST*>(expr);
+      if (ArxEscape::escapes(for_expr->start.get(), var_name)) {
+        return true;
+      }
+      if (for_expr->var_name == var_name) {
+        return false;
+      }
+      return ArxEscape::escapes(for_expr->end.get(), var_name) ||
+        ArxEscape::escapes(for_expr->step.get(), var_name) ||
+        ArxEscape::escapes(for_expr->body.get(), var_name);
+    }
+    case ExprKind::VarKind: {
+      auto var_expr = static_cast<VarExprAST*>(expr);
+      bool is_hidden = false;
+      for (auto& var : var_expr->var_names) {
+        // e.g. `var qs = ps`, the variables bound to it are not tracked
+        if (ArxEscape::escapes(var.second.get(), var_name)) {
+          return true;
+        }
+        is_hidden = is_hidden || var.first == var_name;
+      }
+      return !is_hidden && ArxEscape::escapes(var_expr->body.get(), var_name);
+    }
+    case ExprKind::ConstKind: {
+      auto const_expr = static_cast<ConstExprAST*>(expr);
+      bool is_hidden = false;
+      for (auto& constant : const_expr->const_names) {
+        if (ArxEscape::escapes(constant.second.get(), var_name)) {
+          return true;
+        }
+        is_hidden = is_hidden || constant.first == var_name;
+      }
+      return !is_hidden &&
+        ArxEscape::escapes(const_expr->body.get(), var_name);
+    }
+    case ExprKind::AccessKind: {
+      auto access = static_cast<AccessExprAST*>(expr);
+      return (!is_variable(access->base.get(), var_name) &&
+              ArxEscape::escapes(access->base.get(), var_name)) ||
+        ArxEscape::escapes(access->index.get(), var_name);
+    }
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Check if the array declared by `var` can be allocated in the
+ *        stack frame.
+ * @param type_name The array type.
+ * @param var_name The variable name.
+ * @param body The body of the `var`, the scope of the variable.
+ */
+auto ArxEscape::is_stack_allocated(
+  const std::string& type_name, const std::string& var_name, ExprAST* body)
+  -> bool {
+  uint64_t size = ArxLLVM::module->getDataLayout().getTypeAllocSize(
+    ArxRecord::get_storage_type(type_name));
+  return static_cast<int64_t>(size) <= ArxEscape::max_stack_size &&
+    !ArxEscape::escapes(body, var_name);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>  // for int64_t
+#include <string>   // for string
+
+#include "parser.h"  // for ExprAST
+
+/**
+ * @brief Escape analysis of the arrays declared by `var`.
+ *
+ * The storage of an array is owned by its `var`, but its address can leave
+ * the Arx code: an array escapes when it is an argument of a function that
+ * isn't defined in the module (an extern, or a function of another module
+ * of the JIT), or when it is used as a value (e.g. the value of the body).
+ * The accesses `a[i]`, `len(a)` and the calls to the Arx functions, which
+ * can only read and write the elements, don't make it escape.
+ *
+ * The arrays that don't escape, and that are not larger than
+ * `max_stack_size`, are allocated in the stack frame (an alloca in the
+ * entry block), so the small arrays with constant indexes are replaced by
+ * scalars by the optimizer (SROA). The others are allocated by arx_alloc
+ * (see arx-memory.h).
+ */
+class ArxEscape {
+ public:
+  // the largest storage of an array in the stack frame, in bytes
+  static int64_t max_stack_size;
+
+  static auto escapes(ExprAST* expr, const std::string& var_name) -> bool;
+  static auto is_stack_allocated(
+    const std::string& type_name,
+    const std::string& var_name,
+    ExprAST* body) -> bool;
+};
@@ -0,0 +1,128 @@
+#include "codegen/fp-mode.h"  // for ArxFPMode
+#include <string>             // for string
+
+#include <llvm/IR/Function.h>           // for Function
+#include <llvm/IR/IRBuilder.h>          // for IRBuilder
+#include <llvm/IR/Metadata.h>           // for MDNode, MDString, NamedMDNode
+#include <llvm/IR/Module.h>             // for Module
+#include <llvm/IR/Operator.h>           // for FastMathFlags
+#include <llvm/Target/TargetOptions.h>  // for TargetOptions, FPOpFusion
+
+#include "codegen/arx-llvm.h"  // for ArxLLVM
+#include "parser.h"            // for PrototypeAST
+
+bool ArxFPMode::fast_math = false;
+std::string ArxFPMode::fp_contract = "off";
+
+// the attributes of the floating-point mode that the backend reads
+static const char* const FP_ATTRIBUTES[] = {
+  "unsafe-fp-math",
+  "no-infs-fp-math",
+  "no-nans-fp-math",
+  "no-signed-zeros-fp-math",
+  "approx-func-fp-math",
+};
+
+/**
+ * @brief Get the fast-math flags of the operations of a function.
+ *
+ * The decorator of the function (`PrototypeAST::fp_mode`) has priority
+ * over the command line.
+ */
+auto ArxFPMode::get_flags(const PrototypeAST& proto) -> llvm::FastMathFlags {
+  llvm::FastMathFlags flags;
+
+  if (proto.fp_mode == "fast" || (proto.fp_mode.empty() && fast_math)) {
+    flags.setFast();
+  } else if (
+    proto.fp_mode == "contract" ||
+    (proto.fp_mode.empty() && fp_contract != "off")) {
+    flags.setAllowContract();
+  }
+  return flags;
+}
+
+/**
+ * @brief Set the fast-math flags for the body of the function.
+ *
+ * The flags stay on ArxLLVM::ir_builder until they are changed, so the
+ * caller should restore them after the body (e.g. with a
+ * FastMathFlagGuard).
+ */
+auto ArxFPMode::apply(llvm::Function* fn, const PrototypeAST& proto)
+  -> void {
+  llvm::FastMathFlags flags = ArxFPMode::get_flags(proto);
+  ArxLLVM::ir_builder->setFastMathFlags(flags);
+
+  // the backend reads the mode of each function from these attributes, so
+  // they override the target options of the command line (but not the
+  // fusion, see set_target_options)
+  const char* fast = flags.isFast() ? "true" : "false";
+  for (const char* attribute : FP_ATTRIBUTES) {
+    fn->addFnAttr(attribute, fast);
+  }
+
+  // the decorator, for ArxFPMode::record
+  if (!proto.fp_mode.empty()) {
+    fn->addFnAttr("arx-fp-mode", proto.fp_mode);
+  }
+}
+
+/**
+ * @brief Copy the floating-point mode of a function to a function
+ *        outlined from its body (e.g. `parfor`).
+ *
+ */
+auto ArxFPMode::copy(const llvm::Function* from, llvm::Function* to)
+  -> void {
+  for (const char* attribute : FP_ATTRIBUTES) {
+    if (from->hasFnAttribute(attribute)) {
+      to->addFnAttr(from->getFnAttribute(attribute));
+    }
+  }
+}
+
+/**
+ * @brief Set the floating-point options of the target machine.
+ *
+ * The fusion option of the target machine is global, the function
+ * attributes don't reset it. So it is never `Fast`: the backend fuses the
+ * operations with the `contract` flag (see get_flags), and the functions
+ * with `@fastmath(off)` are not fused with `--fp-contract=fast`.
+ */
+auto ArxFPMode::set_target_options(llvm::TargetOptions& options) -> void {
+  options.UnsafeFPMath = fast_math;
+  options.NoInfsFPMath = fast_math;
+  options.NoNaNsFPMath = fast_math;
+  options.NoSignedZerosFPMath = fast_math;
+  options.ApproxFuncFPMath = fast_math;
+
+  if (fp_contract != "off") {
+    options.AllowFPOpFusion = llvm::FPOpFusion::Standard;
+  } else {
+    options.AllowFPOpFusion = llvm::FPOpFusion::Strict;
+  }
+}
+
+/**
+ * @brief Record the floating-point mode of the command line and the
+ *        decorators of the functions in the `llvm.ident` of the module.
+ *
+ * e.g. "arx fp-mode: strict, fp-contract: off, dot: fast, norm: contract"
+ */
+auto ArxFPMode::record(llvm::Module& module) -> void {
+  std::string ident = "arx fp-mode: ";
+  ident += fast_math ? "fast" : "strict";
+  ident += ", fp-contract: " + fp_contract;
+  for (llvm::Function& fn : module) {
+    if (fn.hasFnAttribute("arx-fp-mode")) {
+      ident += ", " + fn.getName().str() + ": " +
+        fn.getFnAttribute("arx-fp-mode").getValueAsString().str();
+    }
+  }
+
+  llvm::LLVMContext& context = module.getContext();
+  module.getOrInsertNamedMetadata("llvm.ident")
+    ->addOperand(
+      llvm::MDNode::get(context, {llvm::MDString::get(context, ident)}));
+}
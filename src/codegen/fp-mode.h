@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>  // for string
+
+#include "parser.h"  // for PrototypeAST
+
+namespace llvm {
+  class FastMathFlags;
+  class Function;
+  class Module;
+  class TargetOptions;
+}  // namespace llvm
+
+/**
+ * @brief Floating-point semantics of the generated code.
+ *
+ * The operations are strict IEEE by default. `--ffast-math` allows all
+ * the fast-math transformations (reassociation, reciprocals, no NaN, no
+ * infinity, no signed zero, approximate functions) and `--fp-contract`
+ * allows the fusion of multiplications and additions (FMA) of the Arx
+ * functions (`on` and `fast` are the same).
+ *
+ * A function can override the command line with a decorator:
+ * `@fastmath` (all the flags), `@fastmath(contract)` (only FMA) or
+ * `@fastmath(off)` (strict).
+ *
+ * The flags are set on ArxLLVM::ir_builder while the body of a function is
+ * generated, and the mode is recorded in the function attributes (that
+ * the backend reads) and in the `llvm.ident` of the module, with the
+ * decorators, emitted to the `.comment` section of the ELF objects.
+ */
+class ArxFPMode {
+ public:
+  // --ffast-math
+  static bool fast_math;
+  // --fp-contract: off, on or fast
+  static std::string fp_contract;
+
+  static auto get_flags(const PrototypeAST& proto) -> llvm::FastMathFlags;
+  static auto apply(llvm::Function* fn, const PrototypeAST& proto) -> void;
+  static auto copy(const llvm::Function* from, llvm::Function* to) -> void;
+  static auto set_target_options(llvm::TargetOptions& options) -> void;
+  static auto record(llvm::Module& module) -> void;
+};
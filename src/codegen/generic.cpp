@@ -0,0 +1,218 @@
+#include "codegen/generic.h"  // for ArxGeneric, TypeArgs
+#include <map>                // for map
+#include <memory>             // for unique_ptr, make_unique
+#include <string>             // for string
+#include <utility>            // for move
+#include <vector>             // for vector
+
+#include "codegen/arx-llvm.h"  // for ArxLLVM
+#include "datatypes.h"         // for is_array_type, is_record_type
+#include "error.h"             // for LogError
+#include "parser.h"            // for FunctionAST, PrototypeAST
+
+std::map<std::string, std::unique_ptr<FunctionAST>> ArxGeneric::functions;
+
+/**
+ * @brief Check if the function is a generic function.
+ *
+ */
+auto ArxGeneric::is_generic(const std::string& name) -> bool {
+  return ArxGeneric::functions.count(name) > 0;
+}
+
+/**
+ * @brief Remove the instances of a generic function from
+ *        ArxLLVM::function_protos, e.g. `axpy[f32x4]` for `axpy`.
+ *
+ */
+static auto remove_instances(const std::string& name) -> void {
+  const std::string prefix = name + "[";
+  for (auto it = ArxLLVM::function_protos.begin();
+       it != ArxLLVM::function_protos.end();) {
+    if (it->first.compare(0, prefix.size(), prefix) == 0) {
+      it = ArxLLVM::function_protos.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+/**
+ * @brief Move the prototype and the body of a generic function to
+ *        ArxGeneric::functions.
+ *
+ * The instances of a previous function with the same name are removed,
+ * so the next calls use the new body.
+ */
+auto ArxGeneric::add(FunctionAST& function) -> void {
+  std::string name = function.proto->get_name();
+  remove_instances(name);
+  ArxGeneric::functions[name] = std::make_unique<FunctionAST>(
+    std::move(function.proto), std::move(function.body));
+}
+
+/**
+ * @brief Remove a generic function and its instances, when a function
+ *        that is not generic is defined with its name.
+ *
+ */
+auto ArxGeneric::remove(const std::string& name) -> void {
+  if (ArxGeneric::functions.erase(name) > 0) {
+    remove_instances(name);
+  }
+}
+
+/**
+ * @brief Get the part of the type name that is a type parameter, i.e. the
+ *        whole name or the element of an array type like `T[8]`.
+ * @return The type parameter or an empty string.
+ */
+static auto get_type_param(PrototypeAST& proto, const std::string& type_name)
+  -> std::string {
+  std::string name = type_name.substr(0, type_name.find('['));
+  for (auto& type_param : proto.type_params) {
+    if (type_param == name) {
+      return name;
+    }
+  }
+  return "";
+}
+
+/**
+ * @brief Infer the type parameters of a generic function from the types
+ *        of the arguments of a call.
+ * @param proto The prototype of the generic function.
+ * @param arg_types The types of the arguments of the call.
+ * @param type_args The inferred types.
+ * @return false if the types can't be inferred.
+ */
+auto ArxGeneric::bind_types(
+  PrototypeAST& proto,
+  const std::vector<std::string>& arg_types,
+  TypeArgs& type_args) -> bool {
+  const std::string& name = proto.get_name();
+  if (arg_types.size() != proto.args.size()) {
+    std::string msg =
+      "Codegen: Incorrect # arguments passed to `" + name + "`";
+    LogError<ExprAST>(msg.c_str());
+    return false;
+  }
+
+  for (size_t i = 0; i < arg_types.size(); ++i) {
+    const std::string& arg_type = proto.args[i]->type_name;
+    std::string type_param = get_type_param(proto, arg_type);
+    if (type_param == "") {
+      continue;
+    }
+
+    // `T` takes the type of the argument, `T[N]` the type of its elements
+    std::string suffix = arg_type.substr(type_param.size());
+    const std::string& actual = arg_types[i];
+    if (
+      actual.size() <= suffix.size() ||
+      actual.compare(actual.size() - suffix.size(), suffix.size(), suffix) !=
+        0) {
+      std::string msg = "Codegen: The argument `" + proto.args[i]->name +
+        "` of `" + name + "` should be a " + arg_type + ", not " + actual;
+      LogError<ExprAST>(msg.c_str());
+      return false;
+    }
+    std::string type = actual.substr(0, actual.size() - suffix.size());
+
+    auto bound = type_args.find(type_param);
+    if (bound != type_args.end() && bound->second != type) {
+      std::string msg = "Codegen: `" + type_param + "` of `" + name +
+        "` is both " + bound->second + " and " + type;
+      LogError<ExprAST>(msg.c_str());
+      return false;
+    }
+    type_args[type_param] = type;
+  }
+
+  for (auto& type_param : proto.type_params) {
+    if (type_args.find(type_param) == type_args.end()) {
+      std::string msg = "Codegen: The type `" + type_param + "` of `" +
+        name + "` can't be inferred from the arguments";
+      LogError<ExprAST>(msg.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Replace the type parameter of a type name by its type.
+ *
+ */
+auto ArxGeneric::resolve_type(
+  const std::string& type_name, const TypeArgs& type_args) -> std::string {
+  std::string name = type_name.substr(0, type_name.find('['));
+  auto type_arg = type_args.find(name);
+  if (type_arg == type_args.end()) {
+    return type_name;
+  }
+  return type_arg->second + type_name.substr(name.size());
+}
+
+/**
+ * @brief Get the name of the instance, e.g. `axpy[f32x4]`.
+ *
+ */
+auto ArxGeneric::get_instance_name(
+  PrototypeAST& proto, const TypeArgs& type_args) -> std::string {
+  std::string name = proto.get_name() + "[";
+  for (size_t i = 0; i < proto.type_params.size(); ++i) {
+    name += (i > 0 ? "," : "") + type_args.at(proto.type_params[i]);
+  }
+  return name + "]";
+}
+
+/**
+ * @brief Get the prototype of the instance, with the types of the type
+ *        parameters.
+ * @return The prototype or nullptr if the types are not valid.
+ */
+auto ArxGeneric::make_instance_proto(
+  PrototypeAST& proto, const TypeArgs& type_args)
+  -> std::unique_ptr<PrototypeAST> {
+  // e.g. `T[8]@soa` needs a struct
+  auto check = [&](const std::string& type_name) {
+    if (
+      is_soa_array_type(type_name) &&
+      !is_record_type(get_array_element_type(type_name))) {
+      std::string msg =
+        "Codegen: The `soa` layout needs a struct element, not " + type_name;
+      LogError<ExprAST>(msg.c_str());
+      return false;
+    }
+    return true;
+  };
+
+  std::vector<std::unique_ptr<VariableExprAST>> args;
+  for (auto& arg : proto.args) {
+    std::string type_name =
+      ArxGeneric::resolve_type(arg->type_name, type_args);
+    if (!check(type_name)) {
+      return nullptr;
+    }
+    args.push_back(
+      std::make_unique<VariableExprAST>(arg->loc, arg->name, type_name));
+  }
+
+  std::string type_name = ArxGeneric::resolve_type(proto.type_name, type_args);
+  if (is_array_type(type_name)) {
+    return LogError<PrototypeAST>("Codegen: Functions can't return arrays.");
+  }
+
+  SourceLocation loc = proto.loc;
+  loc.line = proto.get_line();
+  auto instance = std::make_unique<PrototypeAST>(
+    loc,
+    ArxGeneric::get_instance_name(proto, type_args),
+    type_name,
+    std::move(args));
+  instance->memo_capacity = proto.memo_capacity;
+  instance->memo_sync = proto.memo_sync;
+  instance->fp_mode = proto.fp_mode;
+  return instance;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <map>     // for map
+#include <memory>  // for unique_ptr
+#include <string>  // for string
+#include <vector>  // for vector
+
+#include "parser.h"  // for FunctionAST, PrototypeAST
+
+// the concrete types of the type parameters, by parameter name
+typedef std::map<std::string, std::string> TypeArgs;
+
+/**
+ * @brief Monomorphization of the generic functions.
+ *
+ *   fn axpy[T](a, x: T, y: T) -> T:
+ *     a * x + y
+ *
+ * A generic function doesn't generate code when it is defined. Each call
+ * infers the type parameters from the types of its arguments (`x: T` or
+ * an array `xs: T[N]`), and calls the instance of the function for these
+ * types, e.g. `axpy[f32x4]`, that is generated on the first call. The
+ * calls with the same types share the instance, and each instance is
+ * specialized for its types, without dispatch or boxing at run time.
+ *
+ * The generic functions belong to the compilation that defines them
+ * (ArxLLVM::initialize clears them), and a function that is not generic
+ * with the same name replaces the generic one.
+ *
+ * In the body, the type parameters can be used in the type annotations of
+ * `var`.
+ */
+class ArxGeneric {
+ public:
+  // the generic functions, by name, their body is moved here
+  static std::map<std::string, std::unique_ptr<FunctionAST>> functions;
+
+  static auto is_generic(const std::string& name) -> bool;
+  static auto add(FunctionAST& function) -> void;
+  static auto remove(const std::string& name) -> void;
+  static auto bind_types(
+    PrototypeAST& proto,
+    const std::vector<std::string>& arg_types,
+    TypeArgs& type_args) -> bool;
+  static auto resolve_type(
+    const std::string& type_name, const TypeArgs& type_args) -> std::string;
+  static auto get_instance_name(
+    PrototypeAST& proto, const TypeArgs& type_args) -> std::string;
+  static auto make_instance_proto(
+    PrototypeAST& proto, const TypeArgs& type_args)
+    -> std::unique_ptr<PrototypeAST>;
+};
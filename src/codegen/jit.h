@@ -31,6 +31,7 @@
 #include <llvm/Support/Error.h>                                 // for Expected
 #include <memory>                                               // for __base
 #include <new>                                                  // for opera...
+#include <string>                                               // for string
 
 namespace llvm {
   class JITEvaluatedSymbol;
@@ -105,18 +106,23 @@ namespace llvm {
         auto _execution_session = std::make_unique<ExecutionSession>(
           std::move(*executor_process_control));
 
-        JITTargetMachineBuilder jit_target_machine_builder(
-          _execution_session->getExecutorProcessControl().getTargetTriple());
+        // note: use the host CPU (and its features) so the JIT-compiled
+        //       code can use the widest vector instructions available.
+        auto jit_target_machine_builder =
+          JITTargetMachineBuilder::detectHost();
+        if (!jit_target_machine_builder) {
+          return jit_target_machine_builder.takeError();
+        }
 
         auto _data_layout =
-          jit_target_machine_builder.getDefaultDataLayoutForTarget();
+          jit_target_machine_builder->getDefaultDataLayoutForTarget();
         if (!_data_layout) {
           return _data_layout.takeError();
         }
 
         return std::make_unique<ArxJIT>(
           std::move(_execution_session),
-          std::move(jit_target_machine_builder),
+          std::move(*jit_target_machine_builder),
           std::move(*_data_layout));
       }
 
@@ -0,0 +1,305 @@
+#include "codegen/lto.h"  // for ArxLTO
+#include <algorithm>      // for remove
+#include <memory>         // for unique_ptr, make_unique
+#include <set>            // for set
+#include <string>         // for string, to_string
+#include <system_error>   // for error_code
+#include <utility>        // for move
+#include <vector>         // for vector
+
+#include <llvm/ADT/SmallVector.h>               // for SmallVector
+#include <llvm/ADT/StringRef.h>                 // for StringRef
+#include <llvm/ADT/Triple.h>                    // for Triple
+#include <llvm/Analysis/CGSCCPassManager.h>     // for CGSCCAnalysisManager
+#include <llvm/Analysis/LoopAnalysisManager.h>  // for LoopAnalysisManager
+#include <llvm/BinaryFormat/Magic.h>            // for identify_magic
+#include <llvm/Bitcode/BitcodeReader.h>         // for getBitcodeLTOInfo
+#include <llvm/Bitcode/BitcodeWriter.h>         // for WriteBitcodeToFile
+#include <llvm/IR/LLVMContext.h>                // for LLVMContext
+#include <llvm/IR/Module.h>                     // for Module
+#include <llvm/IR/PassManager.h>                // for ModulePassManager
+#include <llvm/LTO/Config.h>                    // for Config
+#include <llvm/LTO/LTO.h>                       // for LTO, InputFile
+#include <llvm/Object/Archive.h>                // for Archive
+#include <llvm/Passes/PassBuilder.h>            // for PassBuilder
+#include <llvm/Support/Caching.h>               // for CachedFileStream
+#include <llvm/Support/Error.h>                 // for Error, toString
+#include <llvm/Support/FileSystem.h>            // for exists, remove
+#include <llvm/Support/MemoryBuffer.h>          // for MemoryBuffer
+#include <llvm/Support/Threading.h>  // for heavyweight_hardware_concurrency
+#include <llvm/Support/TimeProfiler.h>  // for timeTraceProfilerEnabled
+#include <llvm/Support/raw_ostream.h>                  // for errs
+#include <llvm/Target/TargetMachine.h>                 // for TargetMachine
+#include <llvm/Transforms/IPO/ThinLTOBitcodeWriter.h>  // for ThinLTOBitc...
+#include <llvm/Transforms/Utils/InjectTLIMappings.h>   // for InjectTLIMa...
+
+#include "codegen/arx-llvm.h"  // for ArxLLVM
+#include "codegen/math.h"      // for ArxMath
+
+std::string ArxLTO::mode = "";
+unsigned ArxLTO::jobs = 0;
+
+using MemoryBuffers = std::vector<std::unique_ptr<llvm::MemoryBuffer>>;
+
+/**
+ * @brief Check if the objects are bitcode for the LTO.
+ *
+ */
+auto ArxLTO::is_enabled() -> bool {
+  return ArxLTO::mode != "";
+}
+
+/**
+ * @brief Write the bitcode of the module, with its summary for ThinLTO.
+ *
+ * The LTO pipeline only knows the libraries of the target, so the vector
+ * functions of the runtime (see ArxMath) are recorded on the calls of the
+ * module here, for the loop vectorizer at the link.
+ */
+auto ArxLTO::write_bitcode(llvm::Module& module, llvm::raw_ostream& out)
+  -> void {
+  llvm::LoopAnalysisManager loop_am;
+  llvm::FunctionAnalysisManager function_am;
+  llvm::CGSCCAnalysisManager cgscc_am;
+  llvm::ModuleAnalysisManager module_am;
+
+  ArxMath::register_vector_functions(
+    function_am, llvm::Triple(module.getTargetTriple()));
+
+  llvm::PassBuilder pass_builder;
+  pass_builder.registerModuleAnalyses(module_am);
+  pass_builder.registerCGSCCAnalyses(cgscc_am);
+  pass_builder.registerFunctionAnalyses(function_am);
+  pass_builder.registerLoopAnalyses(loop_am);
+  pass_builder.crossRegisterProxies(loop_am, function_am, cgscc_am, module_am);
+
+  llvm::ModulePassManager module_pm;
+  module_pm.addPass(
+    llvm::createModuleToFunctionPassAdaptor(llvm::InjectTLIMappings()));
+  if (ArxLTO::mode == "thin") {
+    module_pm.addPass(llvm::ThinLTOBitcodeWriterPass(out, nullptr));
+  }
+  module_pm.run(module, module_am);
+
+  if (ArxLTO::mode != "thin") {
+    llvm::WriteBitcodeToFile(module, out);
+  }
+}
+
+/**
+ * @brief Get a copy of the bitcode of a module in the form of the mode:
+ *        with a summary for ThinLTO, without it for full LTO, since the
+ *        LTO of LLVM optimizes the modules with a summary separately.
+ * @param buffer The bitcode.
+ * @param name The name of the module.
+ */
+static auto get_bitcode(llvm::MemoryBufferRef buffer, const std::string& name)
+  -> llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> {
+  auto info = llvm::getBitcodeLTOInfo(buffer);
+  if (!info) {
+    return info.takeError();
+  }
+  if (info->HasSummary == (ArxLTO::mode == "thin")) {
+    return llvm::MemoryBuffer::getMemBufferCopy(buffer.getBuffer(), name);
+  }
+
+  llvm::LLVMContext context;
+  auto module = llvm::parseBitcodeFile(buffer, context);
+  if (!module) {
+    return module.takeError();
+  }
+  std::string bitcode;
+  llvm::raw_string_ostream out(bitcode);
+  ArxLTO::write_bitcode(**module, out);
+  out.flush();
+  return llvm::MemoryBuffer::getMemBufferCopy(bitcode, name);
+}
+
+/**
+ * @brief Read the bitcode of a file, or of the members of an archive.
+ * @param path The path of the file.
+ * @param buffers The buffers of the modules.
+ */
+static auto read_bitcode(const std::string& path, MemoryBuffers& buffers)
+  -> llvm::Error {
+  auto file = llvm::MemoryBuffer::getFile(path);
+  if (!file) {
+    return llvm::errorCodeToError(file.getError());
+  }
+
+  llvm::MemoryBufferRef file_ref = (*file)->getMemBufferRef();
+  if (
+    llvm::identify_magic(file_ref.getBuffer()) !=
+    llvm::file_magic::archive) {
+    auto bitcode = get_bitcode(file_ref, path);
+    if (!bitcode) {
+      return bitcode.takeError();
+    }
+    buffers.push_back(std::move(*bitcode));
+    return llvm::Error::success();
+  }
+
+  auto archive = llvm::object::Archive::create(file_ref);
+  if (!archive) {
+    return archive.takeError();
+  }
+
+  // e.g. libarxrt-lto.a(arx-io.cpp.o)
+  auto read_member =
+    [&](const llvm::object::Archive::Child& child) -> llvm::Error {
+    auto name = child.getName();
+    if (!name) {
+      return name.takeError();
+    }
+    auto member = child.getMemoryBufferRef();
+    if (!member) {
+      return member.takeError();
+    }
+    auto bitcode = get_bitcode(*member, path + "(" + name->str() + ")");
+    if (!bitcode) {
+      return bitcode.takeError();
+    }
+    buffers.push_back(std::move(*bitcode));
+    return llvm::Error::success();
+  };
+
+  llvm::Error children_err = llvm::Error::success();
+  for (auto& child : (*archive)->children(children_err)) {
+    if (auto err = read_member(child)) {
+      llvm::consumeError(std::move(children_err));
+      return err;
+    }
+  }
+  return children_err;
+}
+
+/**
+ * @brief Get the path of the bitcode of the runtime (libarxrt-lto.a).
+ * @return The path or an empty string if it is not installed or can't be
+ *         read (e.g. built by a clang of another LLVM version), then the
+ *         program links libarxrt.a.
+ */
+auto ArxLTO::get_runtime_bitcode() -> std::string {
+  std::string path = ArxLLVM::get_runtime_library("-lto.a");
+  if (!llvm::sys::fs::exists(path)) {
+    return "";
+  }
+
+  MemoryBuffers buffers;
+  llvm::Error err = read_bitcode(path, buffers);
+  for (auto& buffer : buffers) {
+    if (err) {
+      break;
+    }
+    auto input = llvm::lto::InputFile::create(buffer->getMemBufferRef());
+    if (!input) {
+      err = input.takeError();
+    }
+  }
+  if (err) {
+    llvm::errs() << "ARX[INFO]: " << path
+                 << " can't be read, the runtime is linked from libarxrt.a: "
+                 << llvm::toString(std::move(err)) << "\n";
+    return "";
+  }
+  return path;
+}
+
+/**
+ * @brief Optimize the bitcode of the modules together and compile it.
+ * @param paths The bitcode files (or archives) of the modules.
+ * @param output_prefix The prefix of the objects.
+ * @param machine The target machine of the objects.
+ * @return The paths of the objects, empty if the modules can't be linked.
+ */
+auto ArxLTO::link(
+  const std::vector<std::string>& paths,
+  const std::string& output_prefix,
+  llvm::TargetMachine* machine) -> std::vector<std::string> {
+  MemoryBuffers buffers;
+  for (auto& path : paths) {
+    if (auto err = read_bitcode(path, buffers)) {
+      llvm::errs() << "ARX[FAIL]: " << path
+                   << " can't be linked with --lto (the Arx modules should "
+                      "be compiled with --lto): "
+                   << llvm::toString(std::move(err)) << "\n";
+      return {};
+    }
+  }
+
+  llvm::lto::Config config;
+  config.CPU = machine->getTargetCPU().str();
+  config.Options = machine->Options;
+  config.DefaultTriple = machine->getTargetTriple().str();
+  llvm::SmallVector<llvm::StringRef, 16> features;
+  machine->getTargetFeatureString().split(features, ',', -1, false);
+  for (auto& feature : features) {
+    config.MAttrs.push_back(feature.str());
+  }
+  // the threads of the backends add their passes to the --time-trace
+  config.TimeTraceEnabled = llvm::timeTraceProfilerEnabled();
+  config.TimeTraceGranularity = 0;
+
+  llvm::lto::LTO lto(
+    std::move(config),
+    llvm::lto::createInProcessThinBackend(
+      llvm::heavyweight_hardware_concurrency(ArxLTO::jobs)));
+
+  // the first definition of a symbol prevails, like in the linker
+  std::set<std::string> defined;
+  for (auto& buffer : buffers) {
+    auto input = llvm::lto::InputFile::create(buffer->getMemBufferRef());
+    if (!input) {
+      llvm::errs() << "ARX[FAIL]: " << llvm::toString(input.takeError())
+                   << "\n";
+      return {};
+    }
+
+    std::vector<llvm::lto::SymbolResolution> resolutions;
+    for (auto& symbol : (*input)->symbols()) {
+      std::string name = symbol.getName().str();
+      llvm::lto::SymbolResolution resolution;
+      if (!symbol.isUndefined()) {
+        resolution.Prevailing = defined.insert(name).second;
+        resolution.FinalDefinitionInLinkageUnit = resolution.Prevailing;
+      }
+      // the entry point, and the `main` of the source that the runtime
+      // calls when it is not bitcode
+      resolution.VisibleToRegularObj = name == "main" || name == "arx_main";
+      resolutions.push_back(resolution);
+    }
+
+    if (auto err = lto.add(std::move(*input), resolutions)) {
+      llvm::errs() << "ARX[FAIL]: " << llvm::toString(std::move(err))
+                   << "\n";
+      return {};
+    }
+  }
+
+  // one object per task, the tasks run in parallel with ThinLTO
+  std::vector<std::string> objects(lto.getMaxTasks());
+  auto add_stream = [&](unsigned task)
+    -> llvm::Expected<std::unique_ptr<llvm::CachedFileStream>> {
+    std::string path = output_prefix + ".lto." + std::to_string(task) + ".o";
+    std::error_code error_code;
+    auto out = std::make_unique<llvm::raw_fd_ostream>(
+      path, error_code, llvm::sys::fs::OF_None);
+    if (error_code) {
+      return llvm::errorCodeToError(error_code);
+    }
+    objects[task] = path;
+    return std::make_unique<llvm::CachedFileStream>(std::move(out), path);
+  };
+
+  llvm::Error err = lto.run(add_stream);
+  objects.erase(
+    std::remove(objects.begin(), objects.end(), ""), objects.end());
+  if (err) {
+    llvm::errs() << "ARX[FAIL]: " << llvm::toString(std::move(err)) << "\n";
+    for (auto& object : objects) {
+      llvm::sys::fs::remove(object);
+    }
+    return {};
+  }
+  return objects;
+}
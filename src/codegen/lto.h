@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>  // for string
+#include <vector>  // for vector
+
+namespace llvm {
+  class Module;
+  class TargetMachine;
+  class raw_ostream;
+}  // namespace llvm
+
+/**
+ * @brief Link-time optimization of the Arx modules.
+ *
+ * Each source is compiled on its own, so a call to a function of another
+ * module (declared with `extern`) can't be inlined in the objects. With
+ * `--lto` the objects are LLVM bitcode, and the optimizer runs again when
+ * the program is linked, over all the modules:
+ *
+ *   arx --build-lib --lto=thin --input helpers.arx  # helpers.arx.o
+ *   arx --lto=thin --input main.arx --link helpers.arx.o
+ *
+ * `thin` writes a summary of each module with its bitcode; at the link,
+ * the functions that each module calls are imported into it, and the
+ * modules are optimized and compiled in parallel (`--lto-jobs`). `full`
+ * merges the modules into one and optimizes it as a whole, slower but it
+ * sees all the code at once.
+ *
+ * Only `main` (and `arx_main`, called by the runtime) is visible to the
+ * native objects, so the other functions are internalized and the ones
+ * without calls are removed. The runtime is also optimized with the
+ * modules when its bitcode (libarxrt-lto.a, built by clang) is in the
+ * runtime directory, otherwise the program links libarxrt.a.
+ */
+class ArxLTO {
+ public:
+  // --lto: thin, full or empty (native objects)
+  static std::string mode;
+  // --lto-jobs: threads of the ThinLTO backends, 0 for all the cores
+  static unsigned jobs;
+
+  static auto is_enabled() -> bool;
+  static auto write_bitcode(llvm::Module& module, llvm::raw_ostream& out)
+    -> void;
+  static auto get_runtime_bitcode() -> std::string;
+  static auto link(
+    const std::vector<std::string>& paths,
+    const std::string& output_prefix,
+    llvm::TargetMachine* machine) -> std::vector<std::string>;
+};
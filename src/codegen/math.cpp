@@ -0,0 +1,187 @@
+#include "codegen/math.h"  // for ArxMath
+#include <map>             // for map
+#include <string>          // for string
+#include <vector>          // for vector
+
+#include <llvm/ADT/Triple.h>                  // for Triple
+#include <llvm/Analysis/TargetLibraryInfo.h>  // for TargetLibraryInfoImpl
+#include <llvm/IR/Attributes.h>               // for Attribute
+#include <llvm/IR/DerivedTypes.h>             // for FixedVectorType
+#include <llvm/IR/Function.h>                 // for Function
+#include <llvm/IR/IRBuilder.h>                // for IRBuilder
+#include <llvm/IR/Intrinsics.h>               // for Intrinsic
+#include <llvm/IR/Module.h>                   // for Module
+#include <llvm/Support/TypeSize.h>            // for ElementCount
+
+#include "codegen/arx-llvm.h"  // for ArxLLVM
+
+// the lanes of the vector functions of the runtime, e.g. arx_exp_f32x4
+const unsigned ARX_MATH_VECTOR_LANES = 4;
+
+/**
+ * @brief Get the intrinsic of each builtin.
+ *
+ */
+static auto get_intrinsics()
+  -> const std::map<std::string, llvm::Intrinsic::ID>& {
+  static const std::map<std::string, llvm::Intrinsic::ID> intrinsics = {
+    {"sqrt", llvm::Intrinsic::sqrt},
+    {"exp", llvm::Intrinsic::exp},
+    {"log", llvm::Intrinsic::log},
+    {"sin", llvm::Intrinsic::sin},
+    {"cos", llvm::Intrinsic::cos},
+    {"pow", llvm::Intrinsic::pow},
+    {"fma", llvm::Intrinsic::fma},
+    {"abs", llvm::Intrinsic::fabs},
+    {"floor", llvm::Intrinsic::floor},
+    {"ceil", llvm::Intrinsic::ceil},
+  };
+  return intrinsics;
+}
+
+/**
+ * @brief Check if the builtin has a vector function in the runtime.
+ *
+ */
+static auto has_vector_function(const std::string& name) -> bool {
+  return name == "exp" || name == "log" || name == "sin" || name == "cos" ||
+    name == "pow";
+}
+
+/**
+ * @brief Check if the function name is a math builtin.
+ *
+ */
+auto ArxMath::is_builtin(const std::string& name) -> bool {
+  return get_intrinsics().count(name) > 0;
+}
+
+/**
+ * @brief Get the number of arguments of the builtin.
+ *
+ */
+auto ArxMath::get_arity(const std::string& name) -> size_t {
+  if (name == "fma") {
+    return 3;
+  }
+  return name == "pow" ? 2 : 1;
+}
+
+/**
+ * @brief Call the vector function of the runtime for each group of 4
+ *        lanes of the arguments.
+ *
+ */
+static auto emit_vector_call(
+  const std::string& name, std::vector<llvm::Value*>& args) -> llvm::Value* {
+  auto type = llvm::cast<llvm::FixedVectorType>(args[0]->getType());
+  unsigned lanes = type->getNumElements();
+  auto part_type =
+    llvm::FixedVectorType::get(ArxLLVM::FLOAT_TYPE, ARX_MATH_VECTOR_LANES);
+
+  llvm::Function* fn = ArxLLVM::module->getFunction("arx_" + name + "_f32x4");
+  if (!fn) {
+    std::vector<llvm::Type*> arg_types(args.size(), part_type);
+    fn = llvm::Function::Create(
+      llvm::FunctionType::get(part_type, arg_types, false),
+      llvm::Function::ExternalLinkage,
+      "arx_" + name + "_f32x4",
+      ArxLLVM::module.get());
+    fn->setDoesNotAccessMemory();
+    fn->setDoesNotThrow();
+  }
+
+  if (lanes == ARX_MATH_VECTOR_LANES) {
+    return ArxLLVM::ir_builder->CreateCall(fn, args, name);
+  }
+
+  // split the lanes, and concatenate the results
+  std::vector<llvm::Value*> parts;
+  for (unsigned first = 0; first < lanes; first += ARX_MATH_VECTOR_LANES) {
+    std::vector<int> mask;
+    for (unsigned i = 0; i < ARX_MATH_VECTOR_LANES; ++i) {
+      mask.push_back(static_cast<int>(first + i));
+    }
+    std::vector<llvm::Value*> part_args;
+    for (llvm::Value* arg : args) {
+      part_args.push_back(ArxLLVM::ir_builder->CreateShuffleVector(arg, mask));
+    }
+    parts.push_back(ArxLLVM::ir_builder->CreateCall(fn, part_args, name));
+  }
+  while (parts.size() > 1) {
+    std::vector<llvm::Value*> merged;
+    for (size_t i = 0; i < parts.size(); i += 2) {
+      auto part_lanes = llvm::cast<llvm::FixedVectorType>(parts[i]->getType())
+                          ->getNumElements();
+      std::vector<int> mask;
+      for (unsigned lane = 0; lane < 2 * part_lanes; ++lane) {
+        mask.push_back(static_cast<int>(lane));
+      }
+      merged.push_back(ArxLLVM::ir_builder->CreateShuffleVector(
+        parts[i], parts[i + 1], mask));
+    }
+    parts = merged;
+  }
+  return parts[0];
+}
+
+/**
+ * @brief Emit a builtin, the arguments have the same type.
+ *
+ */
+auto ArxMath::emit(const std::string& name, std::vector<llvm::Value*>& args)
+  -> llvm::Value* {
+  llvm::Type* type = args[0]->getType();
+
+  // the vectors of 4, 8, 16, ... floats (a power of 2)
+  auto vector_type = llvm::dyn_cast<llvm::FixedVectorType>(type);
+  if (
+    has_vector_function(name) && vector_type &&
+    vector_type->getElementType()->isFloatTy() &&
+    vector_type->getNumElements() % ARX_MATH_VECTOR_LANES == 0 &&
+    (vector_type->getNumElements() & (vector_type->getNumElements() - 1)) ==
+      0) {
+    return emit_vector_call(name, args);
+  }
+
+  llvm::Function* intrinsic = llvm::Intrinsic::getDeclaration(
+    ArxLLVM::module.get(), get_intrinsics().at(name), {type});
+  return ArxLLVM::ir_builder->CreateCall(intrinsic, args, name);
+}
+
+/**
+ * @brief Add the vector functions of the runtime as the variants of the
+ *        scalar functions and of their intrinsics.
+ *
+ */
+static auto add_vector_functions(llvm::TargetLibraryInfoImpl& tlii) -> void {
+  const llvm::ElementCount lanes =
+    llvm::ElementCount::getFixed(ARX_MATH_VECTOR_LANES);
+  tlii.addVectorizableFunctions({
+    {"expf", "arx_exp_f32x4", lanes},
+    {"llvm.exp.f32", "arx_exp_f32x4", lanes},
+    {"logf", "arx_log_f32x4", lanes},
+    {"llvm.log.f32", "arx_log_f32x4", lanes},
+    {"sinf", "arx_sin_f32x4", lanes},
+    {"llvm.sin.f32", "arx_sin_f32x4", lanes},
+    {"cosf", "arx_cos_f32x4", lanes},
+    {"llvm.cos.f32", "arx_cos_f32x4", lanes},
+    {"powf", "arx_pow_f32x4", lanes},
+    {"llvm.pow.f32", "arx_pow_f32x4", lanes},
+  });
+}
+
+/**
+ * @brief Register the TargetLibraryInfo with the vector functions of the
+ *        runtime, before the analyses of the PassBuilder.
+ * @param function_am The function analyses of the pipeline.
+ * @param triple The target triple of the module.
+ */
+auto ArxMath::register_vector_functions(
+  llvm::FunctionAnalysisManager& function_am, const llvm::Triple& triple)
+  -> void {
+  llvm::TargetLibraryInfoImpl tlii(triple);
+  add_vector_functions(tlii);
+  function_am.registerPass(
+    [tlii] { return llvm::TargetLibraryAnalysis(tlii); });
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>  // for string
+#include <vector>  // for vector
+
+#include <llvm/IR/PassManager.h>  // for FunctionAnalysisManager
+
+namespace llvm {
+  class Triple;
+  class Value;
+}  // namespace llvm
+
+/**
+ * @brief Code generation of the math builtins.
+ *
+ *   sqrt(x), exp(x), log(x), sin(x), cos(x), pow(x, y), fma(x, y, z),
+ *   abs(x), floor(x), ceil(x)
+ *
+ * The arguments are floats or vectors of floats (e.g. `f32x8`, a float
+ * argument is broadcast to the vector type), and the builtins are lowered
+ * to the LLVM intrinsics (`llvm.sqrt`, `llvm.fma`, ...), that the backend
+ * compiles to instructions or to calls to libm. `exp`, `log`, `sin`, `cos`
+ * and `pow` of the vectors of 4, 8, ... floats call the vector functions
+ * of the runtime (arx-math.h) instead of a libm call per lane.
+ *
+ * The vector functions are also registered in the TargetLibraryInfo of
+ * the optimizers (the JIT, the profile and the LTO pipelines), so the loop
+ * vectorizer can vectorize the loops that call the scalar builtins.
+ *
+ * A function of the module with the same name hides the builtin, e.g.
+ * `extern sin(x)`.
+ */
+class ArxMath {
+ public:
+  static auto is_builtin(const std::string& name) -> bool;
+  static auto get_arity(const std::string& name) -> size_t;
+  static auto emit(const std::string& name, std::vector<llvm::Value*>& args)
+    -> llvm::Value*;
+  static auto register_vector_functions(
+    llvm::FunctionAnalysisManager& function_am, const llvm::Triple& triple)
+    -> void;
+};
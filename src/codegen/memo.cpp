@@ -0,0 +1,266 @@
+#include "codegen/memo.h"  // for ArxMemo
+#include <cstdint>          // for uint64_t
+#include <string>           // for string
+#include <vector>           // for vector
+
+#include <llvm/IR/BasicBlock.h>        // for BasicBlock
+#include <llvm/IR/Constants.h>         // for ConstantInt, ConstantAggregat...
+#include <llvm/IR/DerivedTypes.h>      // for ArrayType, PointerType
+#include <llvm/IR/Function.h>          // for Function
+#include <llvm/IR/GlobalVariable.h>    // for GlobalVariable
+#include <llvm/IR/IRBuilder.h>         // for IRBuilder
+#include <llvm/IR/Module.h>            // for Module
+#include <llvm/Support/MathExtras.h>   // for PowerOf2Ceil
+
+#include "arx-memo.h"          // for arx_memo_table_size
+#include "codegen/arx-llvm.h"  // for ArxLLVM
+#include "error.h"             // for LogError
+#include "parser.h"            // for ExprAST, PrototypeAST
+
+bool ArxMemo::auto_memo = false;
+
+/**
+ * @brief Count the calls to the function `self` in the expression.
+ *
+ */
+auto ArxMemo::count_self_calls(ExprAST* expr, const std::string& self)
+  -> int {
+  if (!expr) {
+    return 0;
+  }
+
+  switch (expr->kind) {
+    case ExprKind::UnaryOpKind:
+      return ArxMemo::count_self_calls(
+        static_cast<UnaryExprAST*>(expr)->operand.get(), self);
+    case ExprKind::BinaryOpKind: {
+      auto binary = static_cast<BinaryExprAST*>(expr);
+      return ArxMemo::count_self_calls(binary->lhs.get(), self) +
+        ArxMemo::count_self_calls(binary->rhs.get(), self);
+    }
+    case ExprKind::CallKind: {
+      auto call = static_cast<CallExprAST*>(expr);
+      int count = call->callee == self ? 1 : 0;
+      for (auto& arg : call->args) {
+        count += ArxMemo::count_self_calls(arg.get(), self);
+      }
+      return count;
+    }
+    case ExprKind::IfKind: {
+      auto if_expr = static_cast<IfExprAST*>(expr);
+      return ArxMemo::count_self_calls(if_expr->cond.get(), self) +
+        ArxMemo::count_self_calls(if_expr->then.get(), self) +
+        ArxMemo::count_self_calls(if_expr->else_.get(), self);
+    }
+    case ExprKind::ForKind: {
+      auto for_expr = static_cast<ForExprAST*>(expr);
+      return ArxMemo::count_self_calls(for_expr->start.get(), self) +
+        ArxMemo::count_self_calls(for_expr->end.get(), self) +
+        ArxMemo::count_self_calls(for_expr->step.get(), self) +
+        ArxMemo::count_self_calls(for_expr->body.get(), self);
+    }
+    case ExprKind::VarKind: {
+      auto var_expr = static_cast<VarExprAST*>(expr);
+      int count = ArxMemo::count_self_calls(var_expr->body.get(), self);
+      for (auto& var : var_expr->var_names) {
+        count += ArxMemo::count_self_calls(var.second.get(), self);
+      }
+      return count;
+    }
+    case ExprKind::ConstKind: {
+      auto const_expr = static_cast<ConstExprAST*>(expr);
+      int count = ArxMemo::count_self_calls(const_expr->body.get(), self);
+      for (auto& constant : const_expr->const_names) {
+        count += ArxMemo::count_self_calls(constant.second.get(), self);
+      }
+      return count;
+    }
+    case ExprKind::AccessKind: {
+      auto access = static_cast<AccessExprAST*>(expr);
+      return ArxMemo::count_self_calls(access->base.get(), self) +
+        ArxMemo::count_self_calls(access->index.get(), self);
+    }
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Check if the values of the type can be used as cache keys.
+ *
+ */
+static auto is_memo_type(llvm::Type* type) -> bool {
+  return (type->isIntegerTy() || type->isFloatingPointTy()) &&
+    type->getPrimitiveSizeInBits() <= 64;
+}
+
+/**
+ * @brief Get the bits of a value as an int64.
+ *
+ */
+static auto to_bits(llvm::IRBuilder<>& builder, llvm::Value* value)
+  -> llvm::Value* {
+  llvm::Type* type = value->getType();
+  if (type->isFloatingPointTy()) {
+    value = builder.CreateBitCast(
+      value,
+      builder.getIntNTy(
+        static_cast<unsigned>(type->getPrimitiveSizeInBits())));
+  }
+  return builder.CreateZExtOrTrunc(value, ArxLLVM::INT64_TYPE);
+}
+
+/**
+ * @brief Get a value of the type from its bits (see to_bits).
+ *
+ */
+static auto from_bits(
+  llvm::IRBuilder<>& builder, llvm::Value* bits, llvm::Type* type)
+  -> llvm::Value* {
+  llvm::Value* value = builder.CreateZExtOrTrunc(
+    bits,
+    builder.getIntNTy(static_cast<unsigned>(type->getPrimitiveSizeInBits())));
+  return builder.CreateBitCast(value, type);
+}
+
+/**
+ * @brief Memoize the function if it has `@memo`, or if it is selected by
+ *        `auto_memo`.
+ * @param fn The generated function, it becomes the wrapper.
+ * @param proto The function prototype.
+ * @param body The function body.
+ * @return false if the function can't be memoized.
+ */
+auto ArxMemo::apply(llvm::Function* fn, PrototypeAST& proto, ExprAST& body)
+  -> bool {
+  bool is_auto = proto.memo_capacity == 0;
+  if (is_auto) {
+    if (
+      !ArxMemo::auto_memo || !proto.is_pure || proto.args.empty() ||
+      ArxMemo::count_self_calls(&body, proto.get_name()) < 2) {
+      return true;
+    }
+  }
+
+  bool is_valid = is_memo_type(fn->getReturnType());
+  for (auto& arg : fn->args()) {
+    is_valid = is_valid && is_memo_type(arg.getType());
+  }
+  if (!is_valid) {
+    if (is_auto) {
+      return true;
+    }
+    std::string msg = "Cannot memoize `" + proto.get_name() +
+      "`: the arguments and the result should be numbers of up to 64 bits";
+    LogError<ExprAST>(msg.c_str());
+    return false;
+  }
+
+  int32_t capacity = static_cast<int32_t>(llvm::PowerOf2Ceil(
+    static_cast<uint64_t>(
+      is_auto ? ARX_MEMO_DEFAULT_CAPACITY : proto.memo_capacity)));
+  int32_t nargs = static_cast<int32_t>(fn->arg_size());
+  std::string name = fn->getName().str();
+
+  // move the body to `<name>.impl`
+  llvm::Function* impl = llvm::Function::Create(
+    fn->getFunctionType(),
+    llvm::Function::InternalLinkage,
+    name + ".impl",
+    ArxLLVM::module.get());
+  while (!fn->empty()) {
+    llvm::BasicBlock& block = fn->front();
+    block.removeFromParent();
+    block.insertInto(impl);
+  }
+  for (unsigned i = 0; i < fn->arg_size(); ++i) {
+    impl->getArg(i)->setName(fn->getArg(i)->getName());
+    fn->getArg(i)->replaceAllUsesWith(impl->getArg(i));
+  }
+  impl->setSubprogram(fn->getSubprogram());
+  fn->setSubprogram(nullptr);
+
+  llvm::ArrayType* table_type = llvm::ArrayType::get(
+    ArxLLVM::INT64_TYPE,
+    static_cast<uint64_t>(arx_memo_table_size(capacity, nargs)));
+  auto table = new llvm::GlobalVariable(
+    *ArxLLVM::module,
+    table_type,
+    false,
+    llvm::GlobalValue::InternalLinkage,
+    llvm::ConstantAggregateZero::get(table_type),
+    name + ".memo");
+
+  llvm::Type* int64_ptr_type =
+    llvm::PointerType::getUnqual(ArxLLVM::INT64_TYPE);
+  llvm::FunctionCallee lookup = ArxLLVM::module->getOrInsertFunction(
+    proto.memo_sync ? "arx_memo_lookup_sync" : "arx_memo_lookup",
+    ArxLLVM::INT32_TYPE,
+    int64_ptr_type,
+    ArxLLVM::INT32_TYPE,
+    ArxLLVM::INT32_TYPE,
+    int64_ptr_type,
+    int64_ptr_type);
+  llvm::FunctionCallee insert = ArxLLVM::module->getOrInsertFunction(
+    proto.memo_sync ? "arx_memo_insert_sync" : "arx_memo_insert",
+    ArxLLVM::VOID_TYPE,
+    int64_ptr_type,
+    ArxLLVM::INT32_TYPE,
+    ArxLLVM::INT32_TYPE,
+    int64_ptr_type,
+    ArxLLVM::INT64_TYPE);
+
+  // the wrapper has no debug locations, it isn't in the source
+  llvm::IRBuilder<> builder(*ArxLLVM::context);
+  llvm::BasicBlock* entry_bb =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "entry", fn);
+  llvm::BasicBlock* hit_bb =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "hit", fn);
+  llvm::BasicBlock* miss_bb =
+    llvm::BasicBlock::Create(*ArxLLVM::context, "miss", fn);
+
+  builder.SetInsertPoint(entry_bb);
+  llvm::ArrayType* key_type = llvm::ArrayType::get(
+    ArxLLVM::INT64_TYPE, static_cast<uint64_t>(nargs));
+  llvm::Value* key = builder.CreateConstInBoundsGEP2_64(
+    key_type, builder.CreateAlloca(key_type, nullptr, "key"), 0, 0);
+  llvm::Value* value =
+    builder.CreateAlloca(ArxLLVM::INT64_TYPE, nullptr, "value");
+  llvm::Value* table_ptr =
+    builder.CreateConstInBoundsGEP2_64(table_type, table, 0, 0);
+  llvm::Value* llvm_capacity =
+    llvm::ConstantInt::get(ArxLLVM::INT32_TYPE, capacity);
+  llvm::Value* llvm_nargs = llvm::ConstantInt::get(ArxLLVM::INT32_TYPE, nargs);
+
+  std::vector<llvm::Value*> args;
+  for (auto& arg : fn->args()) {
+    builder.CreateStore(
+      to_bits(builder, &arg),
+      builder.CreateConstInBoundsGEP1_64(
+        ArxLLVM::INT64_TYPE, key, arg.getArgNo()));
+    args.push_back(&arg);
+  }
+
+  llvm::Value* found = builder.CreateCall(
+    lookup, {table_ptr, llvm_capacity, llvm_nargs, key, value}, "found");
+  builder.CreateCondBr(
+    builder.CreateICmpNE(
+      found, llvm::ConstantInt::get(ArxLLVM::INT32_TYPE, 0)),
+    hit_bb,
+    miss_bb);
+
+  builder.SetInsertPoint(hit_bb);
+  builder.CreateRet(from_bits(
+    builder,
+    builder.CreateLoad(ArxLLVM::INT64_TYPE, value, "cached"),
+    fn->getReturnType()));
+
+  builder.SetInsertPoint(miss_bb);
+  llvm::Value* result = builder.CreateCall(impl, args, "result");
+  builder.CreateCall(
+    insert,
+    {table_ptr, llvm_capacity, llvm_nargs, key, to_bits(builder, result)});
+  builder.CreateRet(result);
+
+  return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "parser.h"  // for PrototypeAST, ExprAST
+
+namespace llvm {
+  class Function;
+}
+
+/**
+ * @brief Memoization of the functions decorated with `@memo`.
+ *
+ * The body of a memoized function `f` is moved to the internal function
+ * `f.impl`, and `f` becomes a wrapper that looks up its arguments in the
+ * cache `f.memo` (see arx-memo.h) and calls `f.impl` only on a miss. The
+ * recursive calls in the body still call `f`, so they are memoized too.
+ *
+ * With `auto_memo`, the pure functions that call themselves more than once
+ * (e.g. fibonacci) are memoized without the decorator.
+ */
+class ArxMemo {
+ public:
+  // memoize the pure functions with tree recursion
+  static bool auto_memo;
+
+  static auto count_self_calls(ExprAST* expr, const std::string& self)
+    -> int;
+  static auto apply(llvm::Function* fn, PrototypeAST& proto, ExprAST& body)
+    -> bool;
+};
@@ -0,0 +1,107 @@
+#include "codegen/profile.h"  // for ArxProfile
+#include <string>             // for string
+#include <utility>            // for move
+#include <vector>             // for vector
+
+#include <glog/logging.h>                      // for LOG
+#include <llvm/ADT/Optional.h>                 // for Optional
+#include <llvm/Analysis/CGSCCPassManager.h>    // for CGSCCAnalysisManager
+#include <llvm/Analysis/LoopAnalysisManager.h>  // for LoopAnalysisManager
+#include <llvm/IR/Module.h>                    // for Module
+#include <llvm/IR/PassInstrumentation.h>  // for PassInstrumentationCallbacks
+#include <llvm/IR/PassManager.h>               // for ModuleAnalysisManager
+#include <llvm/Passes/OptimizationLevel.h>     // for OptimizationLevel
+#include <llvm/Passes/PassBuilder.h>           // for PassBuilder
+#include <llvm/ProfileData/InstrProfReader.h>  // for IndexedInstrProfReader
+#include <llvm/Support/Error.h>                // for toString
+#include <llvm/Support/PGOOptions.h>           // for PGOOptions
+#include <llvm/Support/raw_ostream.h>          // for errs
+#include <llvm/Target/TargetMachine.h>         // for TargetMachine
+
+#include "codegen/math.h"  // for ArxMath
+#include "time-report.h"     // for ArxTimeReport
+
+bool ArxProfile::generate = false;
+std::string ArxProfile::use_path = "";
+
+/**
+ * @brief Check if the objects are instrumented or optimized with a
+ *        profile.
+ *
+ */
+auto ArxProfile::is_enabled() -> bool {
+  return ArxProfile::generate || ArxProfile::use_path != "";
+}
+
+/**
+ * @brief Run the O2 pipeline on the module, with the instrumentation or
+ *        with the profile.
+ * @param module The module, with its target triple and data layout.
+ * @param machine The target machine of the object.
+ * @return false if the profile can't be read.
+ */
+auto ArxProfile::optimize(llvm::Module& module, llvm::TargetMachine* machine)
+  -> bool {
+  llvm::Optional<llvm::PGOOptions> pgo_options;
+  if (ArxProfile::generate) {
+    pgo_options =
+      llvm::PGOOptions("", "", "", llvm::PGOOptions::PGOAction::IRInstr);
+  } else if (ArxProfile::use_path != "") {
+    // note: LLVM aborts the compilation if the profile is not valid, so
+    //       the errors are reported before.
+    auto reader = llvm::IndexedInstrProfReader::create(ArxProfile::use_path);
+    if (!reader) {
+      llvm::errs() << "ARX[FAIL]: The profile " << ArxProfile::use_path
+                   << " can't be read (the .profraw files should be merged "
+                      "with `llvm-profdata merge`): "
+                   << llvm::toString(reader.takeError()) << "\n";
+      return false;
+    }
+    if (!reader.get()->isIRLevelProfile()) {
+      llvm::errs() << "ARX[FAIL]: The profile " << ArxProfile::use_path
+                   << " is not a profile of the instrumented IR (it "
+                      "should come from --profile-generate).\n";
+      return false;
+    }
+    pgo_options = llvm::PGOOptions(
+      ArxProfile::use_path, "", "", llvm::PGOOptions::PGOAction::IRUse);
+  }
+
+  llvm::LoopAnalysisManager loop_am;
+  llvm::FunctionAnalysisManager function_am;
+  llvm::CGSCCAnalysisManager cgscc_am;
+  llvm::ModuleAnalysisManager module_am;
+
+  // the time of each pass with --time-report
+  llvm::PassInstrumentationCallbacks pic;
+  ArxTimeReport::register_callbacks(pic);
+
+  // the vector functions of the runtime (see ArxMath)
+  ArxMath::register_vector_functions(function_am, machine->getTargetTriple());
+
+  llvm::PassBuilder pass_builder(
+    machine, llvm::PipelineTuningOptions(), pgo_options, &pic);
+  pass_builder.registerModuleAnalyses(module_am);
+  pass_builder.registerCGSCCAnalyses(cgscc_am);
+  pass_builder.registerFunctionAnalyses(function_am);
+  pass_builder.registerLoopAnalyses(loop_am);
+  pass_builder.crossRegisterProxies(loop_am, function_am, cgscc_am, module_am);
+
+  llvm::ModulePassManager module_pm =
+    pass_builder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2);
+
+  LOG(INFO) << "Profile: optimize module";
+  module_pm.run(module, module_am);
+  return true;
+}
+
+/**
+ * @brief Get the arguments of the linker for the profile runtime.
+ *
+ */
+auto ArxProfile::get_link_args() -> std::vector<std::string> {
+  if (ArxProfile::generate) {
+    return {"-fprofile-generate"};
+  }
+  return {};
+}
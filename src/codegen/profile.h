@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>  // for string
+#include <vector>  // for vector
+
+namespace llvm {
+  class Module;
+  class TargetMachine;
+}  // namespace llvm
+
+/**
+ * @brief Profile-guided optimization of the objects.
+ *
+ * The workflow has three steps:
+ *
+ *   arx --profile-generate --input kernel.arx  # instrumented program
+ *   ./kernel.arxc                              # writes default_*.profraw
+ *   llvm-profdata merge -o kernel.profdata default_*.profraw
+ *   arx --profile-use=kernel.profdata --input kernel.arx
+ *
+ * `--profile-generate` adds the IR instrumentation of LLVM (the counters
+ * of the edges of each function, InstrProfiling) to the module, and links
+ * the profile runtime of clang, that writes the counters at the exit of
+ * the program (to $LLVM_PROFILE_FILE if it is set). `--profile-use` reads
+ * the merged profile: the counts become the branch weights and the entry
+ * counts of the functions, so the optimizer inlines the hot calls, and
+ * the backend lays out the hot blocks of the `if` together and moves the
+ * cold ones away.
+ *
+ * Both modes run the O2 pipeline on the module before emitting the
+ * object, and the source should be the same in both compilations.
+ */
+class ArxProfile {
+ public:
+  // --profile-generate
+  static bool generate;
+  // --profile-use, the indexed profile (.profdata)
+  static std::string use_path;
+
+  static auto is_enabled() -> bool;
+  static auto optimize(llvm::Module& module, llvm::TargetMachine* machine)
+    -> bool;
+  static auto get_link_args() -> std::vector<std::string>;
+};
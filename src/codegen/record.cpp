@@ -0,0 +1,222 @@
+#include "codegen/record.h"  // for ArxRecord
+#include <cstdint>           // for uint64_t
+#include <string>            // for string
+#include <vector>            // for vector
+
+#include <llvm/IR/Constants.h>       // for ConstantInt
+#include <llvm/IR/DataLayout.h>      // for DataLayout
+#include <llvm/IR/DerivedTypes.h>    // for StructType, ArrayType
+#include <llvm/IR/Function.h>        // for Function
+#include <llvm/IR/Instructions.h>    // for AllocaInst
+#include <llvm/IR/IRBuilder.h>       // for IRBuilder
+#include <llvm/IR/Module.h>          // for Module
+#include <llvm/IR/Type.h>            // for Type
+#include <llvm/IR/Value.h>           // for Value
+#include <llvm/Support/Alignment.h>  // for Align, MaybeAlign
+
+#include "arx-memory.h"        // for ARX_ALLOC_ALIGNMENT
+#include "codegen/arx-llvm.h"  // for ArxLLVM
+#include "datatypes.h"         // for get_array_length, is_soa_array_type
+#include "parser.h"            // for Parser, StructFields
+
+/**
+ * @brief Check if the function name is a builtin of the arrays (but not a
+ *        struct constructor).
+ *
+ */
+auto ArxRecord::is_builtin(const std::string& name) -> bool {
+  return name == "len";
+}
+
+/**
+ * @brief Get the LLVM struct of a struct type, created on its first use.
+ *
+ */
+auto ArxRecord::get_struct_type(const std::string& type_name)
+  -> llvm::StructType* {
+  std::string llvm_name = "struct." + type_name;
+  if (
+    auto struct_type =
+      llvm::StructType::getTypeByName(*ArxLLVM::context, llvm_name)) {
+    return struct_type;
+  }
+
+  std::vector<llvm::Type*> field_types;
+  for (auto& field : Parser::struct_fields[type_name]) {
+    field_types.push_back(ArxLLVM::get_data_type(field.second));
+  }
+  return llvm::StructType::create(*ArxLLVM::context, field_types, llvm_name);
+}
+
+/**
+ * @brief Get the type of the storage of an array type.
+ *
+ */
+auto ArxRecord::get_storage_type(const std::string& type_name)
+  -> llvm::Type* {
+  std::string element_type = get_array_element_type(type_name);
+  auto length = static_cast<uint64_t>(get_array_length(type_name));
+
+  if (!is_soa_array_type(type_name)) {
+    return llvm::ArrayType::get(
+      ArxLLVM::get_data_type(element_type), length);
+  }
+
+  std::vector<llvm::Type*> column_types;
+  for (auto& field : Parser::struct_fields[element_type]) {
+    column_types.push_back(
+      llvm::ArrayType::get(ArxLLVM::get_data_type(field.second), length));
+  }
+  return llvm::StructType::get(*ArxLLVM::context, column_types);
+}
+
+/**
+ * @brief Allocate the zero filled storage of an array.
+ * @param type_name The array type name.
+ * @param on_stack If the storage is an alloca in the entry block of the
+ *        current function, else it is allocated by arx_alloc (see
+ *        arx-memory.h).
+ * @return The array value, a pointer to the storage.
+ */
+auto ArxRecord::emit_alloc(const std::string& type_name, bool on_stack)
+  -> llvm::Value* {
+  llvm::Type* storage_type = ArxRecord::get_storage_type(type_name);
+  uint64_t size =
+    ArxLLVM::module->getDataLayout().getTypeAllocSize(storage_type);
+  llvm::Value* size_val = llvm::ConstantInt::get(ArxLLVM::INT64_TYPE, size);
+
+  if (on_stack) {
+    llvm::Function* fn = ArxLLVM::ir_builder->GetInsertBlock()->getParent();
+    llvm::IRBuilder<> entry_builder(
+      &fn->getEntryBlock(), fn->getEntryBlock().begin());
+    llvm::AllocaInst* storage =
+      entry_builder.CreateAlloca(storage_type, nullptr, "storage");
+    storage->setAlignment(llvm::Align(ARX_ALLOC_ALIGNMENT));
+
+    // the alloca is reused when the `var` is in a loop
+    ArxLLVM::ir_builder->CreateLifetimeStart(
+      storage, llvm::cast<llvm::ConstantInt>(size_val));
+    ArxLLVM::ir_builder->CreateMemSet(
+      storage,
+      ArxLLVM::ir_builder->getInt8(0),
+      size_val,
+      llvm::MaybeAlign(ARX_ALLOC_ALIGNMENT));
+    return storage;
+  }
+
+  llvm::FunctionCallee alloc_fn = ArxLLVM::module->getOrInsertFunction(
+    "arx_alloc",
+    llvm::PointerType::getUnqual(ArxLLVM::INT8_TYPE),
+    ArxLLVM::INT64_TYPE);
+  llvm::Value* storage =
+    ArxLLVM::ir_builder->CreateCall(alloc_fn, {size_val}, "alloc");
+  return ArxLLVM::ir_builder->CreatePointerCast(
+    storage, llvm::PointerType::getUnqual(storage_type));
+}
+
+/**
+ * @brief Release the storage of an array (see emit_alloc).
+ *
+ */
+auto ArxRecord::emit_free(
+  llvm::Value* array, const std::string& type_name, bool on_stack) -> void {
+  if (on_stack) {
+    uint64_t size = ArxLLVM::module->getDataLayout().getTypeAllocSize(
+      ArxRecord::get_storage_type(type_name));
+    ArxLLVM::ir_builder->CreateLifetimeEnd(
+      array, ArxLLVM::ir_builder->getInt64(size));
+    return;
+  }
+
+  llvm::Type* void_ptr_type = llvm::PointerType::getUnqual(ArxLLVM::INT8_TYPE);
+  llvm::FunctionCallee free_fn = ArxLLVM::module->getOrInsertFunction(
+    "arx_free", ArxLLVM::VOID_TYPE, void_ptr_type);
+  ArxLLVM::ir_builder->CreateCall(
+    free_fn, {ArxLLVM::ir_builder->CreatePointerCast(array, void_ptr_type)});
+}
+
+/**
+ * @brief Get the address of an element of an array, or of a field of the
+ *        element.
+ * @param array The array value.
+ * @param type_name The array type name.
+ * @param index The element index, an int64.
+ * @param field The field index, or -1 for the whole element (it is not
+ *        valid for an array of structs with the `soa` layout).
+ */
+auto ArxRecord::emit_element_ptr(
+  llvm::Value* array,
+  const std::string& type_name,
+  llvm::Value* index,
+  int field) -> llvm::Value* {
+  llvm::Type* storage_type = ArxRecord::get_storage_type(type_name);
+  llvm::Value* zero = llvm::ConstantInt::get(ArxLLVM::INT32_TYPE, 0);
+
+  if (field < 0) {
+    return ArxLLVM::ir_builder->CreateInBoundsGEP(
+      storage_type, array, {zero, index}, "elemptr");
+  }
+
+  llvm::Value* field_idx = llvm::ConstantInt::get(ArxLLVM::INT32_TYPE, field);
+  if (is_soa_array_type(type_name)) {
+    return ArxLLVM::ir_builder->CreateInBoundsGEP(
+      storage_type, array, {zero, field_idx, index}, "fieldptr");
+  }
+  return ArxLLVM::ir_builder->CreateInBoundsGEP(
+    storage_type, array, {zero, index, field_idx}, "fieldptr");
+}
+
+/**
+ * @brief Load an element of an array.
+ *
+ * The fields of an element of a `soa` array are loaded one by one.
+ */
+auto ArxRecord::emit_load_element(
+  llvm::Value* array, const std::string& type_name, llvm::Value* index)
+  -> llvm::Value* {
+  std::string element_type = get_array_element_type(type_name);
+
+  if (!is_soa_array_type(type_name)) {
+    return ArxLLVM::ir_builder->CreateLoad(
+      ArxLLVM::get_data_type(element_type),
+      ArxRecord::emit_element_ptr(array, type_name, index, -1),
+      "elem");
+  }
+
+  llvm::StructType* struct_type = ArxRecord::get_struct_type(element_type);
+  llvm::Value* element = llvm::PoisonValue::get(struct_type);
+  for (unsigned i = 0; i < struct_type->getNumElements(); ++i) {
+    llvm::Value* field = ArxLLVM::ir_builder->CreateLoad(
+      struct_type->getElementType(i),
+      ArxRecord::emit_element_ptr(
+        array, type_name, index, static_cast<int>(i)),
+      "field");
+    element = ArxLLVM::ir_builder->CreateInsertValue(element, field, {i});
+  }
+  return element;
+}
+
+/**
+ * @brief Store an element of an array.
+ *
+ * The fields of an element of a `soa` array are stored one by one.
+ */
+auto ArxRecord::emit_store_element(
+  llvm::Value* array,
+  const std::string& type_name,
+  llvm::Value* index,
+  llvm::Value* value) -> void {
+  if (!is_soa_array_type(type_name)) {
+    ArxLLVM::ir_builder->CreateStore(
+      value, ArxRecord::emit_element_ptr(array, type_name, index, -1));
+    return;
+  }
+
+  auto struct_type = llvm::cast<llvm::StructType>(value->getType());
+  for (unsigned i = 0; i < struct_type->getNumElements(); ++i) {
+    ArxLLVM::ir_builder->CreateStore(
+      ArxLLVM::ir_builder->CreateExtractValue(value, {i}),
+      ArxRecord::emit_element_ptr(
+        array, type_name, index, static_cast<int>(i)));
+  }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>  // for string
+
+namespace llvm {
+  class StructType;
+  class Type;
+  class Value;
+}  // namespace llvm
+
+/**
+ * @brief Code generation of the structs and the arrays (see datatypes.h).
+ *
+ * A struct value is an LLVM struct, so it is passed and returned by value.
+ * An array value is a pointer to its storage, allocated by `var` and
+ * released at the end of its body, in the stack frame when it doesn't
+ * escape (see ArxEscape):
+ *
+ *   T[N]        [N x T], the fields of an element are contiguous
+ *   T[N]@soa    {[N x F1], [N x F2], ...}, the values of a field of all
+ *               the elements are contiguous
+ *
+ * The layout only changes the addresses of the elements, so the accesses
+ * `a[i].x` are the same in the source. With `@soa`, a loop over a field
+ * reads contiguous memory, and it can be vectorized without gathers.
+ *
+ * The builtins are:
+ *
+ *   T(a, b, ...)   struct of the fields, T() is zero filled
+ *   len(a)         the number of elements of the array, as a float
+ */
+class ArxRecord {
+ public:
+  static auto is_builtin(const std::string& name) -> bool;
+  static auto get_struct_type(const std::string& type_name)
+    -> llvm::StructType*;
+  static auto get_storage_type(const std::string& type_name) -> llvm::Type*;
+  static auto emit_alloc(const std::string& type_name, bool on_stack)
+    -> llvm::Value*;
+  static auto emit_free(
+    llvm::Value* array, const std::string& type_name, bool on_stack)
+    -> void;
+  static auto emit_element_ptr(
+    llvm::Value* array,
+    const std::string& type_name,
+    llvm::Value* index,
+    int field) -> llvm::Value*;
+  static auto emit_load_element(
+    llvm::Value* array, const std::string& type_name, llvm::Value* index)
+    -> llvm::Value*;
+  static auto emit_store_element(
+    llvm::Value* array,
+    const std::string& type_name,
+    llvm::Value* index,
+    llvm::Value* value) -> void;
+};
@@ -0,0 +1,71 @@
+#include "codegen/tail-call.h"  // for ArxTailCall
+#include <string>                // for string
+
+#include <llvm/IR/Function.h>                 // for Function
+#include <llvm/IR/PassManager.h>              // for FunctionPassManager
+#include <llvm/Passes/PassBuilder.h>          // for PassBuilder
+#include <llvm/Transforms/Scalar/TailRecursionElimination.h>  // for TailC...
+
+#include "parser.h"  // for ExprAST, PrototypeAST
+
+/**
+ * @brief Check if the expression calls `self` in a tail position.
+ *
+ */
+auto ArxTailCall::has_self_tail_call(ExprAST* expr, const std::string& self)
+  -> bool {
+  if (!expr) {
+    return false;
+  }
+
+  switch (expr->kind) {
+    case ExprKind::CallKind:
+      return static_cast<CallExprAST*>(expr)->callee == self;
+    case ExprKind::IfKind: {
+      auto if_expr = static_cast<IfExprAST*>(expr);
+      return ArxTailCall::has_self_tail_call(if_expr->then.get(), self) ||
+        ArxTailCall::has_self_tail_call(if_expr->else_.get(), self);
+    }
+    case ExprKind::VarKind:
+      return ArxTailCall::has_self_tail_call(
+        static_cast<VarExprAST*>(expr)->body.get(), self);
+    case ExprKind::ConstKind:
+      return ArxTailCall::has_self_tail_call(
+        static_cast<ConstExprAST*>(expr)->body.get(), self);
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Replace the self tail calls of the function by jumps to its entry.
+ * @param fn The generated function.
+ * @param proto The function prototype.
+ * @param body The function body.
+ * @return true if the function was changed.
+ *
+ * The arguments are stored in the allocas of the entry block, so a tail
+ * call just stores the new arguments and jumps back after the allocas.
+ */
+auto ArxTailCall::eliminate(
+  llvm::Function* fn, PrototypeAST& proto, ExprAST& body) -> bool {
+  if (!ArxTailCall::has_self_tail_call(&body, proto.get_name())) {
+    return false;
+  }
+
+  llvm::LoopAnalysisManager loop_am;
+  llvm::FunctionAnalysisManager function_am;
+  llvm::CGSCCAnalysisManager cgscc_am;
+  llvm::ModuleAnalysisManager module_am;
+
+  llvm::PassBuilder pass_builder;
+  pass_builder.registerModuleAnalyses(module_am);
+  pass_builder.registerCGSCCAnalyses(cgscc_am);
+  pass_builder.registerFunctionAnalyses(function_am);
+  pass_builder.registerLoopAnalyses(loop_am);
+  pass_builder.crossRegisterProxies(loop_am, function_am, cgscc_am, module_am);
+
+  llvm::FunctionPassManager function_pm;
+  function_pm.addPass(llvm::TailCallElimPass());
+  return !function_pm.run(*fn, function_am).areAllPreserved();
+}
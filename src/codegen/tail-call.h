@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>  // for string
+
+#include "parser.h"  // for PrototypeAST, ExprAST
+
+namespace llvm {
+  class Function;
+}
+
+/**
+ * @brief Lowering of the self tail calls to loops.
+ *
+ * A call is in a tail position when its value is the value of the function
+ * body, through the branches of `if` and the bodies of `var` and `const`,
+ * e.g. the recursive call of `fn sum(n, acc): if n < 1: acc else: sum(n -
+ * 1, acc + n)`.
+ *
+ * The functions with self tail calls are transformed by the LLVM tail call
+ * elimination as soon as they are generated, so the recursion runs in
+ * constant stack space even when the code isn't optimized.
+ */
+class ArxTailCall {
+ public:
+  static auto has_self_tail_call(ExprAST* expr, const std::string& self)
+    -> bool;
+  static auto eliminate(llvm::Function* fn, PrototypeAST& proto, ExprAST& body)
+    -> bool;
+};
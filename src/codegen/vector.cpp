@@ -0,0 +1,137 @@
+#include "codegen/vector.h"  // for ArxVector
+#include <string>            // for string
+
+#include <llvm/IR/Constants.h>     // for ConstantFP
+#include <llvm/IR/DerivedTypes.h>  // for FixedVectorType
+#include <llvm/IR/IRBuilder.h>     // for IRBuilder
+#include <llvm/IR/Operator.h>      // for FastMathFlags
+#include <llvm/IR/Type.h>          // for Type
+#include <llvm/IR/Value.h>         // for Value
+
+#include "codegen/arx-llvm.h"  // for ArxLLVM
+#include "datatypes.h"         // for get_vector_lanes, is_vector_type
+
+/**
+ * @brief Check if the function name is a vector builtin (but not a
+ *        vector constructor).
+ *
+ */
+auto ArxVector::is_builtin(const std::string& name) -> bool {
+  return name == "broadcast" || name == "extract" || name == "insert" ||
+    name == "shuffle" || name == "hsum" || name == "hprod" ||
+    name == "hmin" || name == "hmax";
+}
+
+/**
+ * @brief Convert a float to the element type of a vector type.
+ *
+ */
+auto ArxVector::from_float(llvm::Value* value, const std::string& type_name)
+  -> llvm::Value* {
+  llvm::Type* element_type =
+    ArxLLVM::get_data_type(type_name)->getScalarType();
+  if (element_type->isIntegerTy()) {
+    return ArxLLVM::ir_builder->CreateFPToSI(value, element_type, "fptoi");
+  }
+  return ArxLLVM::ir_builder->CreateFPCast(value, element_type);
+}
+
+/**
+ * @brief Convert a vector element to a float.
+ *
+ */
+auto ArxVector::to_float(llvm::Value* value) -> llvm::Value* {
+  if (value->getType()->isIntegerTy()) {
+    return ArxLLVM::ir_builder->CreateSIToFP(
+      value, ArxLLVM::FLOAT_TYPE, "itofp");
+  }
+  return ArxLLVM::ir_builder->CreateFPCast(value, ArxLLVM::FLOAT_TYPE);
+}
+
+/**
+ * @brief Broadcast a float to all the lanes of a vector type.
+ *
+ */
+auto ArxVector::emit_broadcast(
+  llvm::Value* value, const std::string& type_name) -> llvm::Value* {
+  return ArxLLVM::ir_builder->CreateVectorSplat(
+    get_vector_lanes(type_name),
+    ArxVector::from_float(value, type_name),
+    "broadcast");
+}
+
+/**
+ * @brief Emit a lane-wise operator on two vectors of the same type.
+ * @return The vector, or nullptr if the operator isn't supported.
+ */
+auto ArxVector::emit_binary(char op, llvm::Value* lhs, llvm::Value* rhs)
+  -> llvm::Value* {
+  bool is_float = lhs->getType()->isFPOrFPVectorTy();
+
+  switch (op) {
+    case '+':
+      return is_float ? ArxLLVM::ir_builder->CreateFAdd(lhs, rhs, "addtmp")
+                      : ArxLLVM::ir_builder->CreateAdd(lhs, rhs, "addtmp");
+    case '-':
+      return is_float ? ArxLLVM::ir_builder->CreateFSub(lhs, rhs, "subtmp")
+                      : ArxLLVM::ir_builder->CreateSub(lhs, rhs, "subtmp");
+    case '*':
+      return is_float ? ArxLLVM::ir_builder->CreateFMul(lhs, rhs, "multmp")
+                      : ArxLLVM::ir_builder->CreateMul(lhs, rhs, "multmp");
+    case '<': {
+      // 1 or 0 in each lane, like the float comparisons
+      llvm::Value* cmp = is_float
+        ? ArxLLVM::ir_builder->CreateFCmpULT(lhs, rhs, "cmptmp")
+        : ArxLLVM::ir_builder->CreateICmpSLT(lhs, rhs, "cmptmp");
+      return is_float
+        ? ArxLLVM::ir_builder->CreateUIToFP(cmp, lhs->getType(), "booltmp")
+        : ArxLLVM::ir_builder->CreateZExt(cmp, lhs->getType(), "booltmp");
+    }
+    default:
+      return nullptr;
+  }
+}
+
+/**
+ * @brief Emit a horizontal reduction (`hsum`, `hprod`, `hmin` or `hmax`)
+ *        of a vector.
+ *
+ * The floating-point reductions allow reassociation, so the backend can
+ * combine the lanes pairwise instead of in order.
+ * @return The reduction, as a float.
+ */
+auto ArxVector::emit_reduce(const std::string& name, llvm::Value* value)
+  -> llvm::Value* {
+  llvm::Type* element_type = value->getType()->getScalarType();
+  llvm::Value* result;
+
+  if (element_type->isFloatingPointTy()) {
+    llvm::IRBuilderBase::FastMathFlagGuard guard(*ArxLLVM::ir_builder);
+    llvm::FastMathFlags fmf = ArxLLVM::ir_builder->getFastMathFlags();
+    fmf.setAllowReassoc();
+    ArxLLVM::ir_builder->setFastMathFlags(fmf);
+
+    if (name == "hsum") {
+      result = ArxLLVM::ir_builder->CreateFAddReduce(
+        llvm::ConstantFP::get(element_type, -0.0), value);
+    } else if (name == "hprod") {
+      result = ArxLLVM::ir_builder->CreateFMulReduce(
+        llvm::ConstantFP::get(element_type, 1.0), value);
+    } else if (name == "hmin") {
+      result = ArxLLVM::ir_builder->CreateFPMinReduce(value);
+    } else {
+      result = ArxLLVM::ir_builder->CreateFPMaxReduce(value);
+    }
+  } else {
+    if (name == "hsum") {
+      result = ArxLLVM::ir_builder->CreateAddReduce(value);
+    } else if (name == "hprod") {
+      result = ArxLLVM::ir_builder->CreateMulReduce(value);
+    } else if (name == "hmin") {
+      result = ArxLLVM::ir_builder->CreateIntMinReduce(value, true);
+    } else {
+      result = ArxLLVM::ir_builder->CreateIntMaxReduce(value, true);
+    }
+  }
+  return ArxVector::to_float(result);
+}
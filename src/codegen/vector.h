@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>  // for string
+
+namespace llvm {
+  class Value;
+}
+
+/**
+ * @brief Code generation of the SIMD vector types (e.g. `f32x8`, see
+ *        datatypes.h).
+ *
+ * The operators `+`, `-`, `*` and `<` are lane-wise, and a float operand
+ * is broadcast to all the lanes. `<` gives 1 or 0 in each lane. The
+ * builtins are:
+ *
+ *   f32x4(a, b, c, d)      vector of the lanes
+ *   f32x4(x)               broadcast of a float
+ *   broadcast(v, i)        broadcast of the lane i of v
+ *   extract(v, i)          the lane i of v, as a float
+ *   insert(v, i, x)        v with x in the lane i
+ *   shuffle(v, i, ...)     vector of the lanes i, ... of v
+ *   shuffle(v, w, i, ...)  the same, of the concatenation of v and w
+ *   hsum(v), hprod(v)      horizontal reductions, as a float
+ *   hmin(v), hmax(v)
+ *
+ * The lane indexes are constants. The LLVM vectors are portable: the
+ * backend lowers them to the instructions of the target CPU (see `--cpu`),
+ * or splits them on the targets without wide enough registers.
+ */
+class ArxVector {
+ public:
+  static auto is_builtin(const std::string& name) -> bool;
+  static auto from_float(llvm::Value* value, const std::string& type_name)
+    -> llvm::Value*;
+  static auto to_float(llvm::Value* value) -> llvm::Value*;
+  static auto emit_broadcast(llvm::Value* value, const std::string& type_name)
+    -> llvm::Value*;
+  static auto emit_binary(char op, llvm::Value* lhs, llvm::Value* rhs)
+    -> llvm::Value*;
+  static auto emit_reduce(const std::string& name, llvm::Value* value)
+    -> llvm::Value*;
+};
@@ -0,0 +1,429 @@
+#include "compute/stream.h"  // for ArxRunOptions, ArxStream
+#include <algorithm>           // for max
+#include <deque>               // for deque
+#include <filesystem>          // for path
+#include <fstream>             // for ifstream
+#include <memory>              // for shared_ptr, make_shared
+#include <sstream>             // for stringstream
+#include <string>              // for string
+#include <thread>              // for thread
+#include <utility>             // for move
+#include <vector>              // for vector
+
+#include <arrow/api.h>              // for RecordBatch, RecordBatchReader
+#include <arrow/compute/api.h>      // for CallFunction, Cast
+#include <arrow/csv/api.h>          // for StreamingReader, MakeCSVWriter
+#include <arrow/io/api.h>           // for MemoryMappedFile, ReadableFile
+#include <arrow/io/stdio.h>         // for StdoutStream
+#include <arrow/ipc/api.h>          // for RecordBatchFileReader
+#include <arrow/util/thread_pool.h>  // for ThreadPool
+#include <glog/logging.h>            // for LOG
+#include <parquet/arrow/reader.h>    // for FileReader, FileReaderBuilder
+#include <parquet/arrow/writer.h>    // for FileWriter
+
+#include "arx-io.h"       // for arx_flush
+#include "compute/udf.h"  // for ArxUDF
+
+/**
+ * @brief RecordBatchReader over the record batches of an Arrow IPC file.
+ *
+ */
+class IPCFileBatchReader : public arrow::RecordBatchReader {
+ public:
+  std::shared_ptr<arrow::ipc::RecordBatchFileReader> reader;
+  int next_batch = 0;
+
+  /**
+   * @param _reader The IPC file reader
+   */
+  explicit IPCFileBatchReader(
+    std::shared_ptr<arrow::ipc::RecordBatchFileReader> _reader)
+      : reader(std::move(_reader)) {}
+
+  std::shared_ptr<arrow::Schema> schema() const override {
+    return this->reader->schema();
+  }
+
+  arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override {
+    if (this->next_batch >= this->reader->num_record_batches()) {
+      *batch = nullptr;
+      return arrow::Status::OK();
+    }
+    ARROW_ASSIGN_OR_RAISE(
+      *batch, this->reader->ReadRecordBatch(this->next_batch++));
+    return arrow::Status::OK();
+  }
+};
+
+/**
+ * @brief RecordBatchReader over a Parquet file, one row group at a time.
+ *
+ */
+class ParquetBatchReader : public arrow::RecordBatchReader {
+ public:
+  std::unique_ptr<parquet::arrow::FileReader> reader;
+  std::shared_ptr<arrow::Schema> file_schema;
+  std::unique_ptr<arrow::TableBatchReader> row_group_reader;
+  std::shared_ptr<arrow::Table> row_group;
+  int64_t batch_size;
+  int next_row_group = 0;
+
+  /**
+   * @param _reader The Parquet file reader
+   * @param _file_schema The Arrow schema of the file
+   * @param _batch_size Maximum number of rows per record batch
+   */
+  ParquetBatchReader(
+    std::unique_ptr<parquet::arrow::FileReader> _reader,
+    std::shared_ptr<arrow::Schema> _file_schema,
+    int64_t _batch_size)
+      : reader(std::move(_reader)),
+        file_schema(std::move(_file_schema)),
+        batch_size(_batch_size) {}
+
+  std::shared_ptr<arrow::Schema> schema() const override {
+    return this->file_schema;
+  }
+
+  arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override {
+    while (true) {
+      if (this->row_group_reader) {
+        ARROW_RETURN_NOT_OK(this->row_group_reader->ReadNext(batch));
+        if (*batch) {
+          return arrow::Status::OK();
+        }
+        this->row_group_reader.reset();
+        this->row_group.reset();
+      }
+
+      if (this->next_row_group >= this->reader->num_row_groups()) {
+        *batch = nullptr;
+        return arrow::Status::OK();
+      }
+
+      ARROW_ASSIGN_OR_RAISE(
+        this->row_group, this->reader->ReadRowGroup(this->next_row_group++));
+      this->row_group_reader =
+        std::make_unique<arrow::TableBatchReader>(*this->row_group);
+      this->row_group_reader->set_chunksize(this->batch_size);
+    }
+  }
+};
+
+/**
+ * @brief RecordBatchWriter for Parquet files.
+ *
+ */
+class ParquetBatchWriter : public arrow::ipc::RecordBatchWriter {
+ public:
+  std::unique_ptr<parquet::arrow::FileWriter> writer;
+
+  /**
+   * @param _writer The Parquet file writer
+   */
+  explicit ParquetBatchWriter(
+    std::unique_ptr<parquet::arrow::FileWriter> _writer)
+      : writer(std::move(_writer)) {}
+
+  arrow::Status WriteRecordBatch(const arrow::RecordBatch& batch) override {
+    return this->writer->WriteRecordBatch(batch);
+  }
+
+  arrow::Status Close() override {
+    return this->writer->Close();
+  }
+
+  arrow::ipc::WriteStats stats() const override {
+    return arrow::ipc::WriteStats();
+  }
+};
+
+/**
+ * @brief Get the file extension in lower case.
+ *
+ */
+static auto get_extension(const std::string& filename) -> std::string {
+  std::string extension = std::filesystem::path(filename).extension();
+  std::transform(
+    extension.begin(), extension.end(), extension.begin(), ::tolower);
+  return extension;
+}
+
+/**
+ * @brief Open a streaming reader according to the input file extension.
+ *
+ */
+static auto open_reader(const ArxRunOptions& options)
+  -> arrow::Result<std::shared_ptr<arrow::RecordBatchReader>> {
+  std::string extension = get_extension(options.input_file);
+
+  if (extension == ".csv") {
+    ARROW_ASSIGN_OR_RAISE(
+      auto input, arrow::io::ReadableFile::Open(options.input_file));
+    auto read_options = arrow::csv::ReadOptions::Defaults();
+    ARROW_ASSIGN_OR_RAISE(
+      auto reader,
+      arrow::csv::StreamingReader::Make(
+        arrow::io::default_io_context(),
+        input,
+        read_options,
+        arrow::csv::ParseOptions::Defaults(),
+        arrow::csv::ConvertOptions::Defaults()));
+    return reader;
+  }
+
+  if (
+    extension == ".arrow" || extension == ".feather" || extension == ".ipc") {
+    ARROW_ASSIGN_OR_RAISE(
+      auto input,
+      arrow::io::MemoryMappedFile::Open(
+        options.input_file, arrow::io::FileMode::READ));
+    ARROW_ASSIGN_OR_RAISE(
+      auto reader, arrow::ipc::RecordBatchFileReader::Open(input));
+    return std::make_shared<IPCFileBatchReader>(std::move(reader));
+  }
+
+  if (extension == ".arrows") {
+    ARROW_ASSIGN_OR_RAISE(
+      auto input,
+      arrow::io::MemoryMappedFile::Open(
+        options.input_file, arrow::io::FileMode::READ));
+    ARROW_ASSIGN_OR_RAISE(
+      auto reader, arrow::ipc::RecordBatchStreamReader::Open(input));
+    return reader;
+  }
+
+  if (extension == ".parquet") {
+    ARROW_ASSIGN_OR_RAISE(
+      auto input, arrow::io::ReadableFile::Open(options.input_file));
+    parquet::arrow::FileReaderBuilder builder;
+    ARROW_RETURN_NOT_OK(builder.Open(input));
+    std::unique_ptr<parquet::arrow::FileReader> reader;
+    ARROW_RETURN_NOT_OK(builder.Build(&reader));
+    std::shared_ptr<arrow::Schema> schema;
+    ARROW_RETURN_NOT_OK(reader->GetSchema(&schema));
+    return std::make_shared<ParquetBatchReader>(
+      std::move(reader), std::move(schema), options.batch_size);
+  }
+
+  return arrow::Status::Invalid(
+    "ArxStream: input format not supported: ", options.input_file);
+}
+
+/**
+ * @brief Open a writer according to the output file extension.
+ *
+ */
+static auto open_writer(
+  const ArxRunOptions& options, const std::shared_ptr<arrow::Schema>& schema)
+  -> arrow::Result<std::shared_ptr<arrow::ipc::RecordBatchWriter>> {
+  if (options.output_file == "") {
+    return arrow::csv::MakeCSVWriter(
+      std::make_shared<arrow::io::StdoutStream>(), schema);
+  }
+
+  std::string extension = get_extension(options.output_file);
+  ARROW_ASSIGN_OR_RAISE(
+    auto output, arrow::io::FileOutputStream::Open(options.output_file));
+
+  if (extension == ".csv") {
+    return arrow::csv::MakeCSVWriter(output, schema);
+  }
+  if (
+    extension == ".arrow" || extension == ".feather" || extension == ".ipc") {
+    return arrow::ipc::MakeFileWriter(output, schema);
+  }
+  if (extension == ".arrows") {
+    return arrow::ipc::MakeStreamWriter(output, schema);
+  }
+  if (extension == ".parquet") {
+    ARROW_ASSIGN_OR_RAISE(
+      auto writer,
+      parquet::arrow::FileWriter::Open(
+        *schema, arrow::default_memory_pool(), output));
+    return std::make_shared<ParquetBatchWriter>(std::move(writer));
+  }
+
+  return arrow::Status::Invalid(
+    "ArxStream: output format not supported: ", options.output_file);
+}
+
+/**
+ * @brief Apply the kernel to a record batch.
+ * @return The input batch with the kernel result as a new column.
+ */
+static auto apply_kernel(
+  const std::shared_ptr<arrow::RecordBatch>& batch,
+  const std::vector<int>& column_indices,
+  const std::vector<std::shared_ptr<arrow::DataType>>& arg_types,
+  const std::shared_ptr<arrow::Field>& out_field,
+  arrow::compute::ExecContext* ctx)
+  -> arrow::Result<std::shared_ptr<arrow::RecordBatch>> {
+  std::vector<arrow::Datum> args;
+  for (size_t i = 0; i < column_indices.size(); ++i) {
+    std::shared_ptr<arrow::Array> column = batch->column(column_indices[i]);
+    // note: columns with the argument type are used in place, other
+    //       columns are converted (e.g. int32 to float32).
+    if (!column->type()->Equals(arg_types[i])) {
+      ARROW_ASSIGN_OR_RAISE(
+        arrow::Datum casted,
+        arrow::compute::Cast(
+          column, arg_types[i], arrow::compute::CastOptions::Safe(), ctx));
+      column = casted.make_array();
+    }
+    args.emplace_back(column);
+  }
+
+  ARROW_ASSIGN_OR_RAISE(
+    arrow::Datum result,
+    arrow::compute::CallFunction(out_field->name(), args, ctx));
+
+  return batch->AddColumn(
+    batch->num_columns(), out_field, result.make_array());
+}
+
+/**
+ * @brief Read the content of the Arx source file.
+ *
+ */
+static auto read_source(const std::string& filename)
+  -> arrow::Result<std::string> {
+  std::ifstream arxfile(filename);
+  if (!arxfile.is_open()) {
+    return arrow::Status::IOError(
+      "ArxStream: could not open the source file: ", filename);
+  }
+  std::stringstream content;
+  content << arxfile.rdbuf();
+  return content.str();
+}
+
+/**
+ * @brief Run the kernel over the input file and write the results.
+ * @param options The run options.
+ * @return The status of the execution.
+ */
+static auto run_kernel(const ArxRunOptions& options) -> arrow::Status {
+  ARROW_ASSIGN_OR_RAISE(std::string source, read_source(options.source_file));
+
+  auto registry = arrow::compute::FunctionRegistry::Make(
+    arrow::compute::GetFunctionRegistry());
+  ARROW_RETURN_NOT_OK(ArxUDF::register_functions(source, registry.get()));
+  ARROW_ASSIGN_OR_RAISE(
+    auto function, registry->GetFunction(options.kernel));
+
+  arrow::compute::ExecContext ctx(
+    arrow::default_memory_pool(), nullptr, registry.get());
+
+  ARROW_ASSIGN_OR_RAISE(auto reader, open_reader(options));
+  std::shared_ptr<arrow::Schema> input_schema = reader->schema();
+
+  // Map the kernel arguments to the input columns.
+  std::vector<int> column_indices;
+  if (options.columns.empty()) {
+    for (int i = 0; i < function->arity().num_args; ++i) {
+      column_indices.push_back(i);
+    }
+  } else {
+    for (const std::string& column : options.columns) {
+      int idx = input_schema->GetFieldIndex(column);
+      if (idx < 0) {
+        return arrow::Status::Invalid(
+          "ArxStream: column not found: ", column);
+      }
+      column_indices.push_back(idx);
+    }
+  }
+  if (
+    static_cast<int>(column_indices.size()) != function->arity().num_args ||
+    column_indices.back() >= input_schema->num_fields()) {
+    return arrow::Status::Invalid(
+      "ArxStream: `",
+      options.kernel,
+      "` expects ",
+      function->arity().num_args,
+      " columns.");
+  }
+
+  // Arx functions are registered with a single kernel (see ArxUDF).
+  auto signature =
+    static_cast<const arrow::compute::ScalarFunction&>(*function)
+      .kernels()
+      .front()
+      ->signature;
+  std::vector<std::shared_ptr<arrow::DataType>> arg_types;
+  for (const arrow::compute::InputType& in_type : signature->in_types()) {
+    arg_types.push_back(in_type.type());
+  }
+  auto out_field =
+    arrow::field(options.kernel, signature->out_type().type());
+
+  ARROW_ASSIGN_OR_RAISE(
+    auto output_schema,
+    input_schema->AddField(input_schema->num_fields(), out_field));
+  ARROW_ASSIGN_OR_RAISE(auto writer, open_writer(options, output_schema));
+
+  int threads = options.threads > 0
+    ? options.threads
+    : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  ARROW_ASSIGN_OR_RAISE(
+    auto thread_pool, arrow::internal::ThreadPool::Make(threads));
+
+  // note: the batches are processed in parallel, but written in the input
+  //       order. The number of batches in flight is bounded, so the memory
+  //       usage is constant regardless of the input size.
+  const size_t max_in_flight = static_cast<size_t>(threads) * 2;
+  std::deque<arrow::Future<std::shared_ptr<arrow::RecordBatch>>> pending;
+  int64_t num_rows = 0;
+
+  auto write_front = [&]() -> arrow::Status {
+    ARROW_ASSIGN_OR_RAISE(auto result, pending.front().result());
+    pending.pop_front();
+    num_rows += result->num_rows();
+    return writer->WriteRecordBatch(*result);
+  };
+
+  while (true) {
+    ARROW_ASSIGN_OR_RAISE(
+      std::shared_ptr<arrow::RecordBatch> batch, reader->Next());
+    if (!batch) {
+      break;
+    }
+
+    ARROW_ASSIGN_OR_RAISE(
+      auto future,
+      thread_pool->Submit(
+        [batch, &column_indices, &arg_types, &out_field, &ctx]() {
+          return apply_kernel(
+            batch, column_indices, arg_types, out_field, &ctx);
+        }));
+    pending.push_back(std::move(future));
+
+    if (pending.size() >= max_in_flight) {
+      ARROW_RETURN_NOT_OK(write_front());
+    }
+  }
+
+  while (!pending.empty()) {
+    ARROW_RETURN_NOT_OK(write_front());
+  }
+
+  ARROW_RETURN_NOT_OK(writer->Close());
+  LOG(INFO) << "ArxStream: " << num_rows << " rows processed";
+
+  return thread_pool->Shutdown();
+}
+
+/**
+ * @brief Run the kernel over the input file and write the results.
+ * @param options The run options.
+ * @return The status of the execution.
+ *
+ * The output of the kernel (see ArxWriter) is flushed before returning,
+ * also on error.
+ */
+auto ArxStream::run(const ArxRunOptions& options) -> arrow::Status {
+  arrow::Status status = run_kernel(options);
+  arx_flush();
+  return status;
+}
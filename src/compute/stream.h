@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>  // for int64_t
+#include <string>   // for string
+#include <vector>   // for vector
+
+#include <arrow/status.h>  // for Status
+
+/**
+ * @brief Options for running an Arx function over a data file.
+ *
+ */
+struct ArxRunOptions {
+  // Arx source file with the kernel definition
+  std::string source_file;
+  // Name of the Arx function applied to each row
+  std::string kernel;
+  // Input file (.csv, .parquet, .arrow/.feather/.ipc or .arrows)
+  std::string input_file;
+  // Output file (same formats as the input), empty for CSV on stdout
+  std::string output_file;
+  // Input columns used as the kernel arguments (default: the first columns)
+  std::vector<std::string> columns;
+  // Number of worker threads (0 uses the hardware concurrency)
+  int threads = 0;
+  // Maximum number of rows per record batch
+  int64_t batch_size = 64 * 1024;
+};
+
+/**
+ * @brief Streaming driver that applies an Arx function to a data file.
+ *
+ * Record batches are read one at a time (memory-mapped for Arrow IPC
+ * files), the JIT-compiled kernel is applied to each batch in a thread
+ * pool and the results are written in the input order. Just a bounded
+ * number of batches is kept in memory, so the memory usage doesn't depend
+ * on the file size.
+ */
+class ArxStream {
+ public:
+  static auto run(const ArxRunOptions& options) -> arrow::Status;
+};
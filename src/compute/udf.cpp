@@ -0,0 +1,318 @@
+#include "compute/udf.h"  // for ArxUDF
+#include <array>           // for array
+#include <cstdint>         // for int64_t
+#include <memory>          // for make_shared, shared_ptr
+#include <string>          // for string
+#include <string_view>     // for string_view
+#include <utility>         // for move
+#include <vector>          // for vector
+
+#include <arrow/api.h>              // for float32, decimal128, date32
+#include <arrow/compute/api.h>      // for ScalarFunction, FunctionRegistry
+#include <arrow/compute/exec.h>     // for ExecSpan, ExecResult
+#include <arrow/compute/kernel.h>   // for KernelContext, KernelState
+#include <arrow/scalar.h>           // for PrimitiveScalarBase
+#include <arrow/status.h>           // for Status
+#include <glog/logging.h>           // for LOG
+#include <llvm/IR/Function.h>       // for Function
+#include <llvm/IR/Module.h>         // for Module
+
+#include "arx-io.h"                 // for arx_flush
+#include "arx-string.h"             // for ArxString, ArxStringBuffers
+#include "codegen/arx-llvm.h"        // for ArxLLVM
+#include "codegen/ast-to-jit.h"      // for ASTToJITVisitor, get_kernel_name
+#include "datatypes.h"               // for get_type_kind, get_decimal_scale
+#include "io.h"                      // for string_to_buffer
+#include "lexer.h"                   // for Lexer
+#include "parser.h"                  // for Parser, TreeAST
+#include "passes/pass-manager.h"     // for ASTPassManager
+
+/**
+ * @brief Kernel state with the address of the JIT-compiled Arx kernel.
+ *
+ */
+class ArxKernelState : public arrow::compute::KernelState {
+ public:
+  using KernelFn =
+    void (*)(int64_t, const void* const*, const int64_t*, void*);
+
+  KernelFn kernel;
+  std::shared_ptr<arrow::DataType> out_type;
+
+  /**
+   * @param _kernel The JIT-compiled kernel (see ASTToJITVisitor::emit_kernel)
+   * @param _out_type The output type
+   */
+  ArxKernelState(KernelFn _kernel, std::shared_ptr<arrow::DataType> _out_type)
+      : kernel(_kernel), out_type(std::move(_out_type)) {}
+};
+
+/**
+ * @brief Get the Arrow data type for an Arx type name.
+ * @return The Arrow data type or nullptr if there is no equivalent type.
+ *
+ * The physical layout of both types is the same (see datatypes.h).
+ */
+static auto get_arrow_type(const std::string& type_name)
+  -> std::shared_ptr<arrow::DataType> {
+  switch (get_type_kind(type_name)) {
+    case ExprKind::FloatDTKind:
+      return arrow::float32();
+    case ExprKind::Date32DTKind:
+      return arrow::date32();
+    case ExprKind::Date64DTKind:
+      return arrow::date64();
+    case ExprKind::TimestampDTKind:
+      return arrow::timestamp(arrow::TimeUnit::MICRO);
+    case ExprKind::Time32DTKind:
+      return arrow::time32(arrow::TimeUnit::MILLI);
+    case ExprKind::Time64DTKind:
+      return arrow::time64(arrow::TimeUnit::MICRO);
+    case ExprKind::Decimal128DTKind:
+      return arrow::decimal128(
+        get_decimal_precision(type_name), get_decimal_scale(type_name));
+    case ExprKind::Decimal256DTKind:
+      return arrow::decimal256(
+        get_decimal_precision(type_name), get_decimal_scale(type_name));
+    case ExprKind::StringDTKind:
+      return arrow::utf8();
+    case ExprKind::BinaryDTKind:
+      return arrow::binary();
+    default:
+      return nullptr;
+  }
+}
+
+/**
+ * @brief Copy the string views returned by a kernel to an Arrow array.
+ * @param ctx The kernel context.
+ * @param views The string views, one per row of the batch.
+ * @param batch The kernel input, a row is null if any input is null.
+ * @param type The output type (utf8 or binary).
+ * @param out The output array.
+ */
+static auto make_string_array(
+  arrow::compute::KernelContext* ctx,
+  const std::vector<arx_string_t>& views,
+  const arrow::compute::ExecSpan& batch,
+  const std::shared_ptr<arrow::DataType>& type,
+  arrow::compute::ExecResult* out) -> arrow::Status {
+  auto is_valid = [&batch](int64_t row) -> bool {
+    for (const arrow::compute::ExecValue& value : batch.values) {
+      bool is_null = value.is_array() ? value.array.IsNull(row)
+                                      : !value.scalar->is_valid;
+      if (is_null) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  int64_t data_size = 0;
+  for (arx_string_t view : views) {
+    data_size += ArxString::from_value(view).length;
+  }
+
+  ARROW_ASSIGN_OR_RAISE(
+    std::unique_ptr<arrow::ArrayBuilder> builder,
+    arrow::MakeBuilder(type, ctx->memory_pool()));
+  auto& binary_builder = static_cast<arrow::BinaryBuilder&>(*builder);
+  ARROW_RETURN_NOT_OK(binary_builder.Reserve(batch.length));
+  ARROW_RETURN_NOT_OK(binary_builder.ReserveData(data_size));
+
+  for (int64_t row = 0; row < batch.length; ++row) {
+    if (!is_valid(row)) {
+      binary_builder.UnsafeAppendNull();
+      continue;
+    }
+    ArxString view =
+      ArxString::from_value(views[static_cast<size_t>(row)]);
+    binary_builder.UnsafeAppend(view.data(), view.length);
+  }
+
+  std::shared_ptr<arrow::Array> array;
+  ARROW_RETURN_NOT_OK(binary_builder.Finish(&array));
+  out->value = array->data();
+  return arrow::Status::OK();
+}
+
+/**
+ * @brief Execute an Arx kernel over an Arrow batch.
+ *
+ * Arrays are read in place from their data buffer and scalars are
+ * broadcast using a stride of 0. The output buffer and the validity bitmap
+ * are preallocated by Arrow (nulls are the intersection of the inputs).
+ *
+ * String and binary inputs are passed as their offsets and data buffers.
+ * String results are views into the inputs or into the string arena of the
+ * thread, they are copied to the output array and the arena is reset.
+ *
+ * The output of the kernel (see ArxWriter) is flushed after each batch.
+ */
+static auto exec_kernel(
+  arrow::compute::KernelContext* ctx,
+  const arrow::compute::ExecSpan& batch,
+  arrow::compute::ExecResult* out) -> arrow::Status {
+  auto state = static_cast<const ArxKernelState*>(ctx->kernel()->data.get());
+
+  size_t num_values = static_cast<size_t>(batch.num_values());
+  std::vector<const void*> inputs(num_values);
+  std::vector<int64_t> strides(num_values);
+  std::vector<ArxStringBuffers> string_inputs(num_values);
+  std::vector<std::array<int32_t, 2>> scalar_offsets(num_values);
+
+  for (size_t i = 0; i < num_values; ++i) {
+    const arrow::compute::ExecValue& value = batch[static_cast<int>(i)];
+    bool is_string = arrow::is_binary_like(value.type()->id());
+
+    if (is_string && value.is_array()) {
+      string_inputs[i] = {
+        value.array.GetValues<int32_t>(1),
+        reinterpret_cast<const char*>(value.array.buffers[2].data)};
+      inputs[i] = &string_inputs[i];
+      strides[i] = 1;
+    } else if (is_string) {
+      std::string_view view =
+        static_cast<const arrow::BaseBinaryScalar*>(value.scalar)->view();
+      scalar_offsets[i] = {0, static_cast<int32_t>(view.size())};
+      string_inputs[i] = {scalar_offsets[i].data(), view.data()};
+      inputs[i] = &string_inputs[i];
+      strides[i] = 0;
+    } else if (value.is_array()) {
+      inputs[i] = value.array.GetValues<uint8_t>(
+        1, value.array.offset * value.type()->byte_width());
+      strides[i] = 1;
+    } else {
+      inputs[i] =
+        static_cast<const arrow::internal::PrimitiveScalarBase*>(value.scalar)
+          ->data();
+      strides[i] = 0;
+    }
+  }
+
+  if (arrow::is_binary_like(state->out_type->id())) {
+    std::vector<arx_string_t> views(static_cast<size_t>(batch.length));
+    state->kernel(batch.length, inputs.data(), strides.data(), views.data());
+    arx_flush();
+    arrow::Status status =
+      make_string_array(ctx, views, batch, state->out_type, out);
+    get_string_arena().reset();
+    return status;
+  }
+
+  arrow::ArraySpan* result = out->array_span_mutable();
+  uint8_t* output =
+    result->GetValues<uint8_t>(1, result->offset * result->type->byte_width());
+  state->kernel(batch.length, inputs.data(), strides.data(), output);
+  arx_flush();
+  get_string_arena().reset();
+
+  return arrow::Status::OK();
+}
+
+/**
+ * @brief Compile the Arx source and register its functions.
+ * @param source The Arx source code.
+ * @param registry The Arrow function registry.
+ * @param prefix A prefix for the name of the registered functions.
+ * @return The status of the registration.
+ */
+auto ArxUDF::register_functions(
+  std::string source,
+  arrow::compute::FunctionRegistry* registry,
+  std::string prefix) -> arrow::Status {
+  Parser::setup();
+  string_to_buffer(source);
+  Lexer::reset();
+  auto ast = Parser::parse();
+
+  ASTPassManager pass_manager;
+  pass_manager.add_default_passes();
+  pass_manager.run(*ast);
+
+  auto codegen = std::make_unique<ASTToJITVisitor>();
+  codegen->initialize();
+  codegen->main_loop(*ast);
+
+  // note: nullary functions and top-level expressions don't map to a
+  //       scalar function, because there is no input to get the length from.
+  std::vector<llvm::Function*> functions;
+  for (llvm::Function& fn : *ArxLLVM::module) {
+    if (
+      fn.isDeclaration() || fn.arg_empty() ||
+      fn.getName() == "__anon_expr") {
+      continue;
+    }
+    functions.push_back(&fn);
+  }
+
+  // the signatures are read before the module is moved to the JIT
+  std::vector<std::string> names;
+  std::vector<std::vector<std::string>> arg_names(functions.size());
+  std::vector<std::vector<arrow::compute::InputType>> in_types(
+    functions.size());
+  std::vector<std::shared_ptr<arrow::DataType>> out_types;
+
+  for (unsigned i = 0, e = functions.size(); i != e; ++i) {
+    llvm::Function* fn = functions[i];
+    names.emplace_back(fn->getName());
+
+    for (auto& arg : fn->args()) {
+      arg_names[i].emplace_back(arg.getName());
+      auto arg_type =
+        get_arrow_type(ArxLLVM::get_arg_type_name(fn, arg.getArgNo()));
+      if (!arg_type) {
+        return arrow::Status::NotImplemented(
+          "ArxUDF: argument type of `", names.back(), "` not supported.");
+      }
+      in_types[i].emplace_back(arg_type);
+    }
+
+    out_types.push_back(get_arrow_type(ArxLLVM::get_return_type_name(fn)));
+    if (!out_types.back()) {
+      return arrow::Status::NotImplemented(
+        "ArxUDF: return type of `", names.back(), "` not supported.");
+    }
+
+    codegen->emit_kernel(fn);
+  }
+
+  codegen->optimize();
+  codegen->add_module();
+
+  for (unsigned i = 0, e = functions.size(); i != e; ++i) {
+    const std::string& name = names[i];
+    int arity = static_cast<int>(arg_names[i].size());
+
+    auto kernel_fn = reinterpret_cast<ArxKernelState::KernelFn>(
+      codegen->lookup(get_kernel_name(name)));
+    if (!kernel_fn) {
+      return arrow::Status::Invalid(
+        "ArxUDF: kernel for `", name, "` was not found.");
+    }
+
+    auto function = std::make_shared<arrow::compute::ScalarFunction>(
+      prefix + name,
+      arrow::compute::Arity(arity),
+      arrow::compute::FunctionDoc(
+        "Arx function `" + name + "`", "", std::move(arg_names[i])));
+
+    arrow::compute::ScalarKernel kernel(
+      std::move(in_types[i]), out_types[i], exec_kernel);
+    kernel.data = std::make_shared<ArxKernelState>(kernel_fn, out_types[i]);
+
+    // the size of a string output is only known after running the kernel
+    if (arrow::is_binary_like(out_types[i]->id())) {
+      kernel.null_handling =
+        arrow::compute::NullHandling::COMPUTED_NO_PREALLOCATE;
+      kernel.mem_allocation = arrow::compute::MemAllocation::NO_PREALLOCATE;
+    }
+
+    ARROW_RETURN_NOT_OK(function->AddKernel(std::move(kernel)));
+    ARROW_RETURN_NOT_OK(registry->AddFunction(std::move(function)));
+
+    LOG(INFO) << "ArxUDF: registered " << prefix + name;
+  }
+
+  return arrow::Status::OK();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>  // for string
+
+#include <arrow/status.h>  // for Status
+
+namespace arrow {
+  namespace compute {
+    class FunctionRegistry;
+  }
+}  // namespace arrow
+
+/**
+ * @brief Register Arx functions as Arrow compute functions (UDFs).
+ *
+ * The Arx source is JIT-compiled by ArxLLVM::jit and every function
+ * defined there is registered as a scalar function that receives and
+ * returns float32 values. The registered kernels read the Arrow buffers
+ * directly, so there is no interpretation or copy on each call.
+ */
+class ArxUDF {
+ public:
+  static auto register_functions(
+    std::string source,
+    arrow::compute::FunctionRegistry* registry,
+    std::string prefix = "") -> arrow::Status;
+};
@@ -0,0 +1,354 @@
+#include "datatypes.h"  // for get_type_kind, get_decimal_scale
+#include <cctype>        // for isdigit
+#include <cstdint>       // for int64_t
+#include <cstdlib>       // for atoi, atoll
+#include <string>        // for string, to_string
+
+#include "parser.h"  // for ExprKind, Parser
+
+/**
+ * @brief Get the type name without the parameters (e.g. `decimal128`).
+ *
+ */
+static auto get_base_type_name(const std::string& type_name) -> std::string {
+  return type_name.substr(0, type_name.find('('));
+}
+
+/**
+ * @brief Get the ExprKind for the given type name.
+ * @param type_name The data type name.
+ * @return The data type kind or ExprKind::GenericKind if it is unknown.
+ */
+auto get_type_kind(const std::string& type_name) -> ExprKind {
+  // the arrays of decimals have parameters in their element type
+  if (is_array_type(type_name)) {
+    return ExprKind::ArrayDTKind;
+  }
+
+  std::string base_type_name = get_base_type_name(type_name);
+
+  if (base_type_name == "float") {
+    return ExprKind::FloatDTKind;
+  } else if (base_type_name == "date32") {
+    return ExprKind::Date32DTKind;
+  } else if (base_type_name == "date64") {
+    return ExprKind::Date64DTKind;
+  } else if (base_type_name == "timestamp") {
+    return ExprKind::TimestampDTKind;
+  } else if (base_type_name == "time32") {
+    return ExprKind::Time32DTKind;
+  } else if (base_type_name == "time64") {
+    return ExprKind::Time64DTKind;
+  } else if (base_type_name == "decimal128") {
+    return ExprKind::Decimal128DTKind;
+  } else if (base_type_name == "decimal256") {
+    return ExprKind::Decimal256DTKind;
+  } else if (base_type_name == "string") {
+    return ExprKind::StringDTKind;
+  } else if (base_type_name == "binary") {
+    return ExprKind::BinaryDTKind;
+  } else if (is_vector_type(base_type_name)) {
+    return ExprKind::VectorDTKind;
+  } else if (is_record_type(type_name)) {
+    return ExprKind::RecordDTKind;
+  }
+  return ExprKind::GenericKind;
+}
+
+/**
+ * @brief Check if the type is a date, a timestamp or a time of the day.
+ *
+ */
+auto is_temporal_type(const std::string& type_name) -> bool {
+  switch (get_type_kind(type_name)) {
+    case ExprKind::Date32DTKind:
+    case ExprKind::Date64DTKind:
+    case ExprKind::TimestampDTKind:
+    case ExprKind::Time32DTKind:
+    case ExprKind::Time64DTKind:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Check if the type is a decimal128 or a decimal256.
+ *
+ */
+auto is_decimal_type(const std::string& type_name) -> bool {
+  ExprKind kind = get_type_kind(type_name);
+  return kind == ExprKind::Decimal128DTKind ||
+    kind == ExprKind::Decimal256DTKind;
+}
+
+/**
+ * @brief Check if the type is a string or a binary.
+ *
+ */
+auto is_string_type(const std::string& type_name) -> bool {
+  ExprKind kind = get_type_kind(type_name);
+  return kind == ExprKind::StringDTKind || kind == ExprKind::BinaryDTKind;
+}
+
+/**
+ * @brief Get the size in bits of the physical representation of the type.
+ *
+ */
+auto get_type_bit_width(const std::string& type_name) -> int {
+  switch (get_type_kind(type_name)) {
+    case ExprKind::FloatDTKind:
+    case ExprKind::Date32DTKind:
+    case ExprKind::Time32DTKind:
+      return 32;
+    case ExprKind::Date64DTKind:
+    case ExprKind::TimestampDTKind:
+    case ExprKind::Time64DTKind:
+      return 64;
+    case ExprKind::Decimal128DTKind:
+    case ExprKind::StringDTKind:
+    case ExprKind::BinaryDTKind:
+      return 128;
+    case ExprKind::Decimal256DTKind:
+      return 256;
+    case ExprKind::VectorDTKind:
+      return get_vector_element_bit_width(type_name) *
+        get_vector_lanes(type_name);
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Get the number of ticks of a temporal type in one day.
+ * @return The number of ticks or 0 if it is not a temporal type.
+ *
+ * It is used to convert between temporal types with different units, e.g.
+ * from date32 (days) to timestamp (microseconds).
+ */
+auto get_temporal_ticks_per_day(const std::string& type_name) -> int64_t {
+  switch (get_type_kind(type_name)) {
+    case ExprKind::Date32DTKind:
+      return 1;
+    case ExprKind::Date64DTKind:
+    case ExprKind::Time32DTKind:
+      return 86400000LL;
+    case ExprKind::TimestampDTKind:
+    case ExprKind::Time64DTKind:
+      return 86400000000LL;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Get the precision of a decimal type like `decimal128(18,2)`.
+ *
+ * When the parameters are omitted, the maximum precision is used.
+ */
+auto get_decimal_precision(const std::string& type_name) -> int {
+  size_t start = type_name.find('(');
+  if (start != std::string::npos) {
+    return atoi(type_name.c_str() + start + 1);
+  }
+  return get_type_kind(type_name) == ExprKind::Decimal256DTKind
+    ? DECIMAL256_MAX_PRECISION
+    : DECIMAL128_MAX_PRECISION;
+}
+
+/**
+ * @brief Get the scale of a decimal type like `decimal128(18,2)`.
+ *
+ * When the scale is omitted, it is 0.
+ */
+auto get_decimal_scale(const std::string& type_name) -> int {
+  size_t start = type_name.find(',');
+  if (start != std::string::npos) {
+    return atoi(type_name.c_str() + start + 1);
+  }
+  return 0;
+}
+
+/**
+ * @brief Get the name of the smallest decimal type for the given precision.
+ *
+ */
+auto get_decimal_type_name(int precision, int scale) -> std::string {
+  ExprKind kind = precision > DECIMAL128_MAX_PRECISION
+    ? ExprKind::Decimal256DTKind
+    : ExprKind::Decimal128DTKind;
+  return get_decimal_type_name(kind, precision, scale);
+}
+
+/**
+ * @brief Get the canonical name of a decimal type.
+ *
+ */
+auto get_decimal_type_name(ExprKind kind, int precision, int scale)
+  -> std::string {
+  std::string base_type_name =
+    kind == ExprKind::Decimal256DTKind ? "decimal256" : "decimal128";
+  return base_type_name + "(" + std::to_string(precision) + "," +
+    std::to_string(scale) + ")";
+}
+
+/**
+ * @brief Get the number of digits after the decimal point of a literal.
+ *
+ */
+auto get_literal_scale(const std::string& literal) -> int {
+  size_t point = literal.find('.');
+  if (point == std::string::npos) {
+    return 0;
+  }
+  return static_cast<int>(literal.size() - point - 1);
+}
+
+/**
+ * @brief Check if the type is a SIMD vector like `f32x8`.
+ *
+ */
+auto is_vector_type(const std::string& type_name) -> bool {
+  size_t x = type_name.find('x');
+  if (x == std::string::npos || x < 2 || x + 1 >= type_name.size()) {
+    return false;
+  }
+  for (size_t i = 1; i < type_name.size(); ++i) {
+    if (i != x && !isdigit(type_name[i])) {
+      return false;
+    }
+  }
+
+  int bits = get_vector_element_bit_width(type_name);
+  int lanes = get_vector_lanes(type_name);
+  bool valid_element = type_name[0] == 'f'
+    ? (bits == 32 || bits == 64)
+    : (type_name[0] == 'i' &&
+       (bits == 8 || bits == 16 || bits == 32 || bits == 64));
+  // a power of 2 number of lanes
+  return valid_element && lanes >= 2 && lanes <= 64 &&
+    (lanes & (lanes - 1)) == 0;
+}
+
+/**
+ * @brief Check if the type is a SIMD vector of floats or doubles.
+ *
+ */
+auto is_float_vector_type(const std::string& type_name) -> bool {
+  return is_vector_type(type_name) && type_name[0] == 'f';
+}
+
+/**
+ * @brief Get the number of lanes of a vector type, e.g. 8 for `f32x8`.
+ *
+ */
+auto get_vector_lanes(const std::string& type_name) -> int {
+  return atoi(type_name.c_str() + type_name.find('x') + 1);
+}
+
+/**
+ * @brief Get the size in bits of the elements of a vector type.
+ *
+ */
+auto get_vector_element_bit_width(const std::string& type_name) -> int {
+  return atoi(type_name.c_str() + 1);
+}
+
+/**
+ * @brief Get the name of the vector type with the same elements as
+ *        `type_name` and `lanes` lanes.
+ *
+ */
+auto get_vector_type_name(const std::string& type_name, int lanes)
+  -> std::string {
+  return type_name.substr(0, type_name.find('x') + 1) + std::to_string(lanes);
+}
+
+/**
+ * @brief Check if the type is a struct declared by the source.
+ *
+ */
+auto is_record_type(const std::string& type_name) -> bool {
+  return Parser::struct_fields.count(type_name) > 0;
+}
+
+/**
+ * @brief Get the position of a field in its struct.
+ * @return The field index or -1 if the struct doesn't have the field.
+ */
+auto get_record_field_index(
+  const std::string& type_name, const std::string& field) -> int {
+  auto fields = Parser::struct_fields.find(type_name);
+  if (fields == Parser::struct_fields.end()) {
+    return -1;
+  }
+  for (size_t i = 0; i < fields->second.size(); ++i) {
+    if (fields->second[i].first == field) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Check if the type is an array like `Particle[1024]@soa`.
+ *
+ */
+auto is_array_type(const std::string& type_name) -> bool {
+  size_t end = type_name.size();
+  if (is_soa_array_type(type_name)) {
+    end -= 4;
+  }
+  size_t start = type_name.rfind('[', end);
+  if (start == std::string::npos || start == 0 || end < start + 3) {
+    return false;
+  }
+  if (type_name[end - 1] != ']') {
+    return false;
+  }
+  for (size_t i = start + 1; i < end - 1; ++i) {
+    if (!isdigit(type_name[i])) {
+      return false;
+    }
+  }
+
+  ExprKind element_kind = get_type_kind(type_name.substr(0, start));
+  return element_kind != ExprKind::GenericKind &&
+    element_kind != ExprKind::ArrayDTKind;
+}
+
+/**
+ * @brief Check if the array uses the struct of arrays layout.
+ *
+ */
+auto is_soa_array_type(const std::string& type_name) -> bool {
+  return type_name.size() > 4 &&
+    type_name.compare(type_name.size() - 4, 4, "@soa") == 0;
+}
+
+/**
+ * @brief Get the type of the elements of an array type.
+ *
+ */
+auto get_array_element_type(const std::string& type_name) -> std::string {
+  return type_name.substr(0, type_name.rfind('['));
+}
+
+/**
+ * @brief Get the number of elements of an array type.
+ *
+ */
+auto get_array_length(const std::string& type_name) -> int64_t {
+  return atoll(type_name.c_str() + type_name.rfind('[') + 1);
+}
+
+/**
+ * @brief Get the canonical name of an array type.
+ *
+ */
+auto get_array_type_name(
+  const std::string& element_type, int64_t length, bool is_soa)
+  -> std::string {
+  return element_type + "[" + std::to_string(length) + "]" +
+    (is_soa ? "@soa" : "");
+}
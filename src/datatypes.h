@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>  // for int64_t
+#include <string>   // for string
+
+#include "parser.h"  // for ExprKind
+
+/*
+ * Data types are referenced by their name (e.g. the `type_name` attribute
+ * of VariableExprAST and PrototypeAST). The temporal and decimal types use
+ * the same physical layout as Arrow:
+ *
+ *   date32         int32, days since the UNIX epoch
+ *   date64         int64, milliseconds since the UNIX epoch
+ *   timestamp      int64, microseconds since the UNIX epoch
+ *   time32         int32, milliseconds since midnight
+ *   time64         int64, microseconds since midnight
+ *   decimal128(p,s)  int128, value * 10^s
+ *   decimal256(p,s)  int256, value * 10^s
+ *
+ * The string and binary values are 16 bytes views, passed as an int128
+ * (see arx-string.h). Arrays of strings use the Arrow offsets and data
+ * buffers, the views are created from them without copying the data:
+ *
+ *   string         UTF-8 text
+ *   binary         bytes
+ *
+ * The SIMD vector types are named by their element type and their number
+ * of lanes (a power of 2, from 2 to 64), e.g. `f32x8` or `i64x2`, and they
+ * are lowered to LLVM fixed vectors:
+ *
+ *   f32xN, f64xN           N floats or doubles
+ *   i8xN, i16xN, i32xN, i64xN  N signed integers
+ *
+ * The structs are named by their declaration (`struct Particle: x, y`,
+ * see Parser::struct_fields) and they are lowered to LLVM structs. The
+ * arrays have a fixed length and are named by their element type, with
+ * the layout of the arrays of structs as a suffix:
+ *
+ *   T[N]           N values of T, an array of structs for a struct T
+ *   T[N]@soa       a struct of N-element arrays, one for each field of T
+ *
+ * An array value is a pointer to its storage.
+ */
+
+const int DECIMAL128_MAX_PRECISION = 38;
+const int DECIMAL256_MAX_PRECISION = 76;
+
+auto get_type_kind(const std::string& type_name) -> ExprKind;
+auto is_temporal_type(const std::string& type_name) -> bool;
+auto is_decimal_type(const std::string& type_name) -> bool;
+auto is_string_type(const std::string& type_name) -> bool;
+auto get_type_bit_width(const std::string& type_name) -> int;
+auto get_temporal_ticks_per_day(const std::string& type_name) -> int64_t;
+auto get_decimal_precision(const std::string& type_name) -> int;
+auto get_decimal_scale(const std::string& type_name) -> int;
+auto get_decimal_type_name(int precision, int scale) -> std::string;
+auto get_decimal_type_name(ExprKind kind, int precision, int scale)
+  -> std::string;
+auto get_literal_scale(const std::string& literal) -> int;
+auto is_vector_type(const std::string& type_name) -> bool;
+auto is_float_vector_type(const std::string& type_name) -> bool;
+auto get_vector_lanes(const std::string& type_name) -> int;
+auto get_vector_element_bit_width(const std::string& type_name) -> int;
+auto get_vector_type_name(const std::string& type_name, int lanes)
+  -> std::string;
+auto is_record_type(const std::string& type_name) -> bool;
+auto get_record_field_index(
+  const std::string& type_name, const std::string& field) -> int;
+auto is_array_type(const std::string& type_name) -> bool;
+auto is_soa_array_type(const std::string& type_name) -> bool;
+auto get_array_element_type(const std::string& type_name) -> std::string;
+auto get_array_length(const std::string& type_name) -> int64_t;
+auto get_array_type_name(
+  const std::string& element_type, int64_t length, bool is_soa)
+  -> std::string;
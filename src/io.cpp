@@ -49,7 +49,7 @@ auto file_to_buffer(std::string filename) -> void {
 auto string_to_buffer(std::string value) -> void {
   input_buffer.clear();
   input_buffer.str("");
-  input_buffer << value << std::endl << EOF;
+  input_buffer << value << std::endl;
 }
 
 /**
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <iosfwd>  // for basic_stringstream, stringstream
 #include <string>  // for string
 
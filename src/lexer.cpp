@@ -1,17 +1,24 @@
-#include "lexer.h"  // for Lexer, SourceLocation, tok_binary, tok_else, tok_eof
-#include <cctype>   // for isdigit, isalnum, isalpha, isspace
-#include <cstdio>   // for EOF
-#include <cstdlib>  // for strtod
-#include <string>   // for operator==, allocator, string, basic_string
-#include "io.h"     // for get_char
+#include "lexer.h"        // for Lexer, SourceLocation, tok_binary, tok_eof
+#include <cctype>         // for isdigit, isalnum, isalpha, isspace
+#include <chrono>         // for steady_clock, duration
+#include <cstdio>         // for EOF
+#include <cstdlib>        // for strtod
+#include <string>         // for operator==, allocator, string, basic_string
+#include "io.h"           // for get_char
+#include "time-report.h"  // for ArxTimeReport
 
 SourceLocation Lexer::cur_loc;
 // Filled in if tok_identifier
 std::string Lexer::identifier_str = "<NOT DEFINED>";
 // Filled in if tok_float_literal
 float Lexer::num_float;
+// Filled in if tok_float_literal, with the literal as written in the source
+std::string Lexer::num_str;
+// Filled in if tok_string_literal, with the escape sequences resolved
+std::string Lexer::string_str;
 SourceLocation Lexer::lex_loc;
 int Lexer::cur_tok = tok_not_initialized;
+char Lexer::last_char = ' ';
 
 /**
  * @brief Get the Token name.
@@ -27,12 +34,16 @@ auto Lexer::get_tok_name(int tok) -> std::string {
       return "function";
     case tok_return:
       return "return";
+    case tok_struct:
+      return "struct";
     case tok_extern:
       return "extern";
     case tok_identifier:
       return "identifier";
     case tok_float_literal:
       return "float";
+    case tok_string_literal:
+      return "string";
     case tok_if:
       return "if";
     case tok_then:
@@ -43,6 +54,8 @@ auto Lexer::get_tok_name(int tok) -> std::string {
       return "for";
     case tok_in:
       return "in";
+    case tok_parfor:
+      return "parfor";
     case tok_binary:
       return "binary";
     case tok_unary:
@@ -92,13 +105,90 @@ auto Lexer::advance() -> int {
   return last_char;
 }
 
+/**
+ * @brief Get the value of a hexadecimal digit.
+ * @return The digit value or -1 if it is not a hexadecimal digit.
+ *
+ */
+static auto get_hex_digit(int c) -> int {
+  if (isdigit(c)) {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+/**
+ * @brief Read a string literal, the opening quote is the last char read.
+ * @return tok_string_literal or the '"' char if the literal is not closed.
+ *
+ * The supported escape sequences are `\n`, `\t`, `\r`, `\0`, `\\`,
+ * `\"` and `\xHH`, so binary data can be written in a literal as well.
+ */
+auto Lexer::gettok_string() -> int {
+  Lexer::string_str = "";
+
+  int c = Lexer::advance();
+  while (c != '"') {
+    if (c == EOF) {
+      Lexer::last_char = static_cast<char>(c);
+      return '"';
+    }
+
+    if (c == '\\') {
+      c = Lexer::advance();
+      switch (c) {
+        case 'n':
+          c = '\n';
+          break;
+        case 't':
+          c = '\t';
+          break;
+        case 'r':
+          c = '\r';
+          break;
+        case '0':
+          c = '\0';
+          break;
+        case 'x': {
+          int high = get_hex_digit(Lexer::advance());
+          int low = get_hex_digit(Lexer::advance());
+          if (high < 0 || low < 0) {
+            Lexer::last_char = static_cast<char>(Lexer::advance());
+            return '"';
+          }
+          c = high * 16 + low;
+          break;
+        }
+        case EOF:
+          Lexer::last_char = static_cast<char>(c);
+          return '"';
+        default:
+          // `\\`, `\"` and any other char are kept as they are
+          break;
+      }
+    }
+
+    Lexer::string_str += static_cast<char>(c);
+    c = Lexer::advance();
+  }
+
+  Lexer::last_char = static_cast<char>(Lexer::advance());  // eat '"'
+  return tok_string_literal;
+}
+
 /**
  * @brief Get the next token.
  * @return Return the next token from standard input.
  *
  */
 auto Lexer::gettok() -> int {
-  static char last_char = ' ';
+  char& last_char = Lexer::last_char;
 
   // Skip any whitespace.
   while (isspace(last_char)) {
@@ -120,6 +210,9 @@ auto Lexer::gettok() -> int {
     if (Lexer::identifier_str == "return") {
       return tok_return;
     }
+    if (Lexer::identifier_str == "struct") {
+      return tok_struct;
+    }
     if (Lexer::identifier_str == "extern") {
       return tok_extern;
     }
@@ -135,6 +228,9 @@ auto Lexer::gettok() -> int {
     if (Lexer::identifier_str == "in") {
       return tok_in;
     }
+    if (Lexer::identifier_str == "parfor") {
+      return tok_parfor;
+    }
     if (Lexer::identifier_str == "binary") {
       return tok_binary;
     }
@@ -144,6 +240,9 @@ auto Lexer::gettok() -> int {
     if (Lexer::identifier_str == "var") {
       return tok_var;
     }
+    if (Lexer::identifier_str == "const") {
+      return tok_const;
+    }
     return tok_identifier;
   }
 
@@ -155,10 +254,21 @@ auto Lexer::gettok() -> int {
       last_char = static_cast<char>(Lexer::advance());
     } while (isdigit(last_char) || last_char == '.');
 
+    // a single '.' is the field access operator, e.g. `p.x`
+    if (num_str == ".") {
+      return '.';
+    }
+
     Lexer::num_float = strtod(num_str.c_str(), nullptr);
+    Lexer::num_str = num_str;
     return tok_float_literal;
   }
 
+  // String: '"' ([^"\\] | '\\' escape)* '"'
+  if (last_char == '"') {
+    return Lexer::gettok_string();
+  }
+
   // Comment until end of line.
   if (last_char == '#') {
     do {
@@ -189,5 +299,28 @@ auto Lexer::gettok() -> int {
  * cur_tok with its results.
  */
 auto Lexer::get_next_token() -> int {
-  return Lexer::cur_tok = Lexer::gettok();
+  if (!ArxTimeReport::is_enabled()) {
+    return Lexer::cur_tok = Lexer::gettok();
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  Lexer::cur_tok = Lexer::gettok();
+  std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - start;
+  ArxTimeReport::add("lex", elapsed.count());
+  return Lexer::cur_tok;
+}
+
+/**
+ * @brief Reset the lexer state so a new source can be tokenized.
+ *
+ * The lexer keeps the last read character and the current token between
+ * calls, so it needs to be reset before reading a second source in the
+ * same process (e.g. when compiling several sources through the JIT).
+ */
+auto Lexer::reset() -> void {
+  Lexer::last_char = ' ';
+  Lexer::cur_tok = tok_not_initialized;
+  Lexer::cur_loc = {0, 0};
+  Lexer::lex_loc = {0, 0};
 }
@@ -15,10 +15,12 @@ enum Token {
   tok_function = -2,
   tok_extern = -3,
   tok_return = -4,
+  tok_struct = -5,
 
   // primary
   tok_identifier = -10,
   tok_float_literal = -11,
+  tok_string_literal = -12,
 
   // control
   tok_if = -20,
@@ -26,6 +28,7 @@ enum Token {
   tok_else = -22,
   tok_for = -23,
   tok_in = -24,
+  tok_parfor = -25,
 
   // operators
   tok_binary = -30,
@@ -48,11 +51,16 @@ class Lexer {
   static SourceLocation cur_loc;
   static std::string identifier_str;  // Filled in if tok_identifier
   static float num_float;             // Filled in if tok_float_literal
+  static std::string num_str;         // Filled in if tok_float_literal
+  static std::string string_str;      // Filled in if tok_string_literal
   static int cur_tok;
   static SourceLocation lex_loc;
+  static char last_char;
 
   static std::string get_tok_name(int);
   static int gettok();
+  static int gettok_string();
   static int advance();
   static int get_next_token();
+  static void reset();
 };
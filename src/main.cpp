@@ -9,6 +9,8 @@
 // #include <arrow/table.h>
 
 #include <glog/logging.h>  // for InitGoogleLogging
+#include <llvm/Support/raw_ostream.h>  // for errs
+#include <stdio.h>         // for fprintf, stderr
 #include <stdlib.h>        // for exit
 #include <CLI/CLI.hpp>
 #include <string>                    // for string, allocator
@@ -16,8 +18,18 @@
 #include "codegen/ast-to-llvm-ir.h"  // for compile_llvm_ir
 #include "codegen/ast-to-object.h"   // for compile_object, open_shell_object
 #include "codegen/ast-to-stdout.h"   // for print_ast
+#include "codegen/const-eval.h"      // for ArxConstEval
+#include "codegen/debug-info.h"      // for ArxDebugInfo
+#include "codegen/emit.h"            // for ArxEmit
+#include "codegen/fp-mode.h"         // for ArxFPMode
+#include "codegen/lto.h"             // for ArxLTO
+#include "codegen/memo.h"            // for ArxMemo
+#include "codegen/profile.h"         // for ArxProfile
+#include "compute/stream.h"          // for ArxRunOptions, ArxStream
 #include "io.h"                      // for load_input_to_buffer
 #include "parser.h"                  // for Parser, TreeAST (ptr only)
+#include "passes/pass-manager.h"     // for ASTPassManager
+#include "time-report.h"             // for ArxTimeReport, ArxPhase
 #include "utils.h"                   // for show_version
 
 std::string ARX_VERSION = "1.6.0";  // semantic-release
@@ -26,6 +38,23 @@ extern std::string OUTPUT_FILE;
 extern bool INPUT_FROM_STDIN;
 extern bool IS_BUILD_LIB;
 
+bool SHOW_PASS_REPORT = false;
+
+/**
+ * @brief Run the AST passes before the code generation.
+ * @param ast The AST tree object.
+ */
+auto main_run_passes(TreeAST& ast) -> void {
+  ArxPhase phase("ast-passes");
+  ASTPassManager pass_manager;
+  pass_manager.add_default_passes();
+  pass_manager.run(ast);
+
+  if (SHOW_PASS_REPORT) {
+    pass_manager.print_report(llvm::errs());
+  }
+}
+
 /**
  * @brief Open the Arx shell.
  * @param count An internal value from CLI11.
@@ -63,6 +92,7 @@ auto main_show_ast() -> int {
 auto main_show_llvm_ir() -> int {
   load_input_to_buffer();
   auto ast = Parser::parse();
+  main_run_passes(*ast);
   return compile_llvm_ir(*ast);
 }
 
@@ -71,9 +101,39 @@ auto main_show_llvm_ir() -> int {
  *
  */
 auto main_compile() -> int {
+  ArxTimeReport::start();
+
+  ArxTimeReport::begin("input");
   load_input_to_buffer();
+  ArxTimeReport::end();
+
+  ArxTimeReport::begin("parse");
   auto ast = Parser::parse();
-  return compile_object(*ast);
+  ArxTimeReport::end();
+
+  main_run_passes(*ast);
+  int result = compile_object(*ast);
+
+  if (ArxTimeReport::enabled) {
+    ArxTimeReport::print(llvm::errs());
+  }
+  if (!ArxTimeReport::write_trace()) {
+    return 1;
+  }
+  return result;
+}
+
+/**
+ * @brief Run an Arx function over the rows of a data file.
+ * @param options The options from the `run` subcommand.
+ */
+auto main_run(const ArxRunOptions& options) -> int {
+  arrow::Status status = ArxStream::run(options);
+  if (!status.ok()) {
+    fprintf(stderr, "Error: %s\n", status.ToString().c_str());
+    return 1;
+  }
+  return 0;
 }
 
 /**
@@ -88,6 +148,7 @@ auto main(int argc, const char* argv[]) -> int {
   bool is_show_ast = false;
   bool is_show_llvm_ir = false;
   bool is_show_version = false;
+  ArxRunOptions run_options;
 
   google::InitGoogleLogging(argv[0]);
 
@@ -99,18 +160,137 @@ auto main(int argc, const char* argv[]) -> int {
   //       but here we are doing it manually in order to have full control
   //       over the workflow.
   app.add_option("--input", INPUT_FILE, "Input file.");
-  app.add_option("--output", OUTPUT_FILE, "Output file.");
+  app.add_option(
+    "--output",
+    OUTPUT_FILE,
+    "Output file (see --emit), - for stdout (not for the object of a "
+    "program, see --build-lib).");
   app.add_flag("--shell", is_open_shell, "Open Arx Shell.");
   app.add_flag("--show-ast", is_show_ast, "Show AST from source.");
   app.add_flag("--show-llvm-ir", is_show_llvm_ir, "Show LLVM IR from source.");
   app.add_flag("--version", is_show_version, "Show ArxLang version.");
+  app.add_option(
+    "--eval-budget",
+    ArxConstEval::max_steps,
+    "Maximum basic blocks executed by a call evaluated at compile time. "
+    "Default: 1000000, 0 disables the evaluation.");
+  app.add_flag(
+    "--auto-memo",
+    ArxMemo::auto_memo,
+    "Memoize the pure functions that call themselves more than once.");
+  app.add_flag(
+    "--ffast-math",
+    ArxFPMode::fast_math,
+    "Allow the fast-math transformations of the floating-point operations "
+    "(reassociation, no NaN, no infinity, ...).");
+  app
+    .add_option(
+      "--fp-contract",
+      ArxFPMode::fp_contract,
+      "Fusion of the floating-point multiplications and additions (FMA): "
+      "off, on or fast (the same as on, the decorators of the functions "
+      "are kept). Default: off.")
+    ->check(CLI::IsMember({"off", "on", "fast"}));
+  app.add_flag(
+    "--show-pass-report",
+    SHOW_PASS_REPORT,
+    "Show the time and the changes of the AST passes.");
+  app.add_flag(
+    "--time-report",
+    ArxTimeReport::enabled,
+    "Show the time of the phases of the compilation and of the LLVM "
+    "passes.");
+  app.add_option(
+    "--time-trace",
+    ArxTimeReport::trace_path,
+    "Write the time of the phases and of the LLVM passes to a file of "
+    "Chrome trace events (chrome://tracing).");
+  CLI::Option* profile_generate = app.add_flag(
+    "--profile-generate",
+    ArxProfile::generate,
+    "Instrument the program to write a profile of its runs "
+    "(default_*.profraw or $LLVM_PROFILE_FILE).");
+  app
+    .add_option(
+      "--profile-use",
+      ArxProfile::use_path,
+      "Optimize the program with a profile merged by `llvm-profdata merge`.")
+    ->excludes(profile_generate);
+  app
+    .add_option(
+      "-g",
+      ArxDebugInfo::level,
+      "Debug information: none, line-tables-only (the functions and the "
+      "lines) or full (also the types and the arguments). Default: none.")
+    ->check(CLI::IsMember({"none", "line-tables-only", "full"}));
+  CLI::Option* emit = app.add_option(
+    "--emit",
+    ArxEmit::kind,
+    "Output file: obj (object, linked into a program), asm, llvm-ir or "
+    "llvm-bc. Default: obj.");
+  emit->check(CLI::IsMember({"obj", "asm", "llvm-ir", "llvm-bc"}));
+  app
+    .add_option(
+      "--lto",
+      ArxLTO::mode,
+      "Link-time optimization: the objects are LLVM bitcode, optimized "
+      "together when the program is linked. thin (ThinLTO) or full.")
+    ->check(CLI::IsMember({"thin", "full"}))
+    ->excludes(emit);
+  app.add_option(
+    "--lto-jobs",
+    ArxLTO::jobs,
+    "Threads of the ThinLTO backends. Default: 0, all the cores.");
+  app.add_option(
+    "--link",
+    LINK_FILES,
+    "Objects of the other Arx modules of the program, compiled with "
+    "--build-lib (and --lto for the link-time optimization).");
+  app.add_option(
+    "--cpu",
+    TARGET_CPU,
+    "Target CPU of the object: generic, native (the host CPU and its "
+    "features) or a CPU name. Default: generic.");
+  app.add_option(
+    "--runtime-dir",
+    RUNTIME_DIR,
+    "Directory of the Arx runtime library (libarxrt), linked into the "
+    "programs. Default: the installation directory.");
   app.add_flag(
     "--build-lib",
     IS_BUILD_LIB,
     "Default False. When False it creates a program instead");
 
+  CLI::App* run_cmd = app.add_subcommand(
+    "run", "Apply an Arx function to a CSV, Parquet or Arrow IPC file.");
+  run_cmd
+    ->add_option("--source", run_options.source_file, "Arx source file.")
+    ->required();
+  run_cmd
+    ->add_option(
+      "--kernel", run_options.kernel, "Arx function applied to each row.")
+    ->required();
+  run_cmd->add_option("--input", run_options.input_file, "Input data file.")
+    ->required();
+  run_cmd->add_option(
+    "--output",
+    run_options.output_file,
+    "Output data file. Default: CSV on stdout.");
+  run_cmd->add_option(
+    "--columns",
+    run_options.columns,
+    "Input columns used as the function arguments.");
+  run_cmd->add_option(
+    "--threads", run_options.threads, "Number of worker threads.");
+  run_cmd->add_option(
+    "--batch-size", run_options.batch_size, "Maximum rows per batch.");
+
   CLI11_PARSE(app, argc, argv);
 
+  if (run_cmd->parsed()) {
+    return main_run(run_options);
+  }
+
   if (is_open_shell) {
     return main_open_shell();
   }
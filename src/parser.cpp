@@ -1,5 +1,6 @@
 #include "parser.h"     // for ExprAST, Parser, PrototypeAST, ForExprAST
 #include <cctype>       // for isascii
+#include <cmath>        // for trunc
 #include <cstring>      // for strcat, strcpy
 #include <iostream>     // for operator<<, basic_ostream::operator<<, cout
 #include <map>          // for map
@@ -8,6 +9,8 @@
 #include <type_traits>  // for __underlying_type_impl<>::type, underlying_type
 #include <utility>      // for move, pair
 #include <vector>       // for vector
+#include "arx-memo.h"   // for ARX_MEMO_DEFAULT_CAPACITY, ARX_MEMO_MAX_CAP...
+#include "datatypes.h"  // for get_type_kind, is_decimal_type, is_arr...
 #include "error.h"      // for LogError
 #include "lexer.h"  // for Lexer, Lexer::cur_tok, Lexer::cur_loc, tok_iden...
 
@@ -16,6 +19,8 @@
  * is defined.
  */
 std::map<char, int> Parser::bin_op_precedence;
+std::map<std::string, StructFields> Parser::struct_fields;
+std::vector<std::string> Parser::type_params;
 
 static auto get_token_value(int tok) -> std::string {
   switch (tok) {
@@ -35,6 +40,10 @@ void ExprAST::accept(Visitor& visitor) {
       visitor.visit((FloatExprAST&) *this);
       break;
     }
+    case ExprKind::StringDTKind: {
+      visitor.visit((StringExprAST&) *this);
+      break;
+    }
     case ExprKind::VariableKind: {
       visitor.visit((VariableExprAST&) *this);
       break;
@@ -63,6 +72,14 @@ void ExprAST::accept(Visitor& visitor) {
       visitor.visit((VarExprAST&) *this);
       break;
     }
+    case ExprKind::ConstKind: {
+      visitor.visit((ConstExprAST&) *this);
+      break;
+    }
+    case ExprKind::AccessKind: {
+      visitor.visit((AccessExprAST&) *this);
+      break;
+    }
     case ExprKind::PrototypeKind: {
       visitor.visit((PrototypeAST&) *this);
       break;
@@ -108,11 +125,23 @@ auto Parser::get_tok_precedence() -> int {
  * numberexpr ::= number
  */
 std::unique_ptr<FloatExprAST> Parser::parse_float_expr() {
-  auto result = std::make_unique<FloatExprAST>(Lexer::num_float);
+  auto result =
+    std::make_unique<FloatExprAST>(Lexer::num_float, Lexer::num_str);
   Lexer::get_next_token();  // consume the number
   return result;
 }
 
+/**
+ * @brief Parse the string expression.
+ * @return
+ * stringexpr ::= string
+ */
+std::unique_ptr<StringExprAST> Parser::parse_string_expr() {
+  auto result = std::make_unique<StringExprAST>(Lexer::string_str);
+  Lexer::get_next_token();  // consume the string
+  return result;
+}
+
 /**
  * @brief Parse the parenthesis expression.
  * @return
@@ -132,12 +161,81 @@ std::unique_ptr<ExprAST> Parser::parse_paren_expr() {
   return expr;
 }
 
+/**
+ * @brief Build the range loop of a `sum`, `min`, `max`, `map` or `reduce`
+ *        call.
+ *
+ * The arguments of a range builtin are `var = start, end, (step,)? body`,
+ * so the calls with other arguments are left to the functions with these
+ * names (e.g. `fn sum(a, b)`).
+ * @return The loop, or nullptr if the call isn't a range builtin.
+ */
+static auto make_range_builtin(
+  SourceLocation loc,
+  const std::string& name,
+  std::string reduce_op,
+  std::vector<std::unique_ptr<ExprAST>>& args) -> std::unique_ptr<ForExprAST> {
+  size_t first = 0;
+  if (name == "sum") {
+    reduce_op = "+";
+  } else if (name == "min" || name == "max") {
+    reduce_op = name;
+  } else if (name == "reduce" && reduce_op.empty() && !args.empty()) {
+    // reduce(min, ...) and reduce(max, ...)
+    auto op = args[0].get();
+    if (op->kind != ExprKind::VariableKind) {
+      return nullptr;
+    }
+    reduce_op = static_cast<VariableExprAST*>(op)->name;
+    if (reduce_op != "min" && reduce_op != "max") {
+      return nullptr;
+    }
+    first = 1;
+  } else if (name != "map" && name != "reduce") {
+    return nullptr;
+  }
+
+  size_t num_args = args.size() - first;
+  if (num_args != 3 && num_args != 4) {
+    return nullptr;
+  }
+
+  auto binding = args[first].get();
+  if (
+    binding->kind != ExprKind::BinaryOpKind ||
+    static_cast<BinaryExprAST*>(binding)->op != '=' ||
+    static_cast<BinaryExprAST*>(binding)->lhs->kind !=
+      ExprKind::VariableKind) {
+    return nullptr;
+  }
+  auto assign = static_cast<BinaryExprAST*>(binding);
+
+  std::unique_ptr<ExprAST> step;
+  if (num_args == 4) {
+    step = std::move(args[first + 2]);
+  }
+  auto for_expr = std::make_unique<ForExprAST>(
+    static_cast<VariableExprAST*>(assign->lhs.get())->name,
+    std::move(assign->rhs),
+    std::move(args[first + 1]),
+    std::move(step),
+    std::move(args.back()));
+  for_expr->loc = loc;
+  for_expr->is_range = true;
+  for_expr->reduce_op = reduce_op;
+  return for_expr;
+}
+
 /**
  * @brief Parse the identifier expression.
  * @return
  * identifierexpr
  *   ::= identifier
  *   ::= identifier '(' expression* ')'
+ *   ::= ('sum' | 'min' | 'max' | 'map') '(' identifier '=' expression ','
+ *       expression (',' expression)? ',' expression ')'
+ *   ::= 'reduce' '(' ('+' | '*' | 'min' | 'max') ',' identifier '='
+ *       expression ',' expression (',' expression)? ',' expression ')'
  */
 std::unique_ptr<ExprAST> Parser::parse_identifier_expr() {
   std::string id_name = Lexer::identifier_str;
@@ -149,11 +247,25 @@ std::unique_ptr<ExprAST> Parser::parse_identifier_expr() {
   if (Lexer::cur_tok != '(') {
     // Simple variable ref, not a function call
     // todo: we need to get the variable type from a specific scope
-    return std::make_unique<VariableExprAST>(id_loc, id_name, "float");
+    return Parser::parse_access_expr(
+      std::make_unique<VariableExprAST>(id_loc, id_name, "float"));
   }
 
   // Call. //
   Lexer::get_next_token();  // eat (
+
+  // the operator of `reduce` (`min` and `max` are parsed as variables)
+  std::string reduce_op;
+  if (
+    id_name == "reduce" && (Lexer::cur_tok == '+' || Lexer::cur_tok == '*')) {
+    reduce_op = std::string(1, static_cast<char>(Lexer::cur_tok));
+    Lexer::get_next_token();  // eat the operator.
+    if (Lexer::cur_tok != ',') {
+      return LogError<ExprAST>("Parser: Expected ',' after reduce operator");
+    }
+    Lexer::get_next_token();  // eat ','.
+  }
+
   std::vector<std::unique_ptr<ExprAST>> args;
   if (Lexer::cur_tok != ')') {
     while (true) {
@@ -170,15 +282,61 @@ std::unique_ptr<ExprAST> Parser::parse_identifier_expr() {
       if (Lexer::cur_tok != ',') {
         return LogError<ExprAST>(
           "Parser: Expected ')' or ',' in argument list");
-        Lexer::get_next_token();
       }
+      Lexer::get_next_token();  // eat ','.
     }
   }
 
   // Eat the ')'.
   Lexer::get_next_token();
 
-  return std::make_unique<CallExprAST>(id_loc, id_name, std::move(args));
+  if (
+    auto range_builtin =
+      make_range_builtin(id_loc, id_name, reduce_op, args)) {
+    return range_builtin;
+  }
+  if (!reduce_op.empty()) {
+    return LogError<ExprAST>(
+      "Parser: Expected `reduce(op, var = start, end, body)`");
+  }
+
+  return Parser::parse_access_expr(
+    std::make_unique<CallExprAST>(id_loc, id_name, std::move(args)));
+}
+
+/**
+ * @brief Parse the element and field accesses after an expression.
+ * @return
+ * accessexpr ::= expression ('[' expression ']' | '.' id)*
+ */
+std::unique_ptr<ExprAST> Parser::parse_access_expr(
+  std::unique_ptr<ExprAST> base) {
+  while (Lexer::cur_tok == '[' || Lexer::cur_tok == '.') {
+    SourceLocation access_loc = Lexer::cur_loc;
+
+    if (Lexer::cur_tok == '.') {
+      if (Lexer::get_next_token() != tok_identifier) {
+        return LogError<ExprAST>("Parser: Expected field name after '.'");
+      }
+      base = std::make_unique<AccessExprAST>(
+        access_loc, std::move(base), nullptr, Lexer::identifier_str);
+      Lexer::get_next_token();  // eat the field name.
+      continue;
+    }
+
+    Lexer::get_next_token();  // eat '['.
+    auto index = Parser::parse_expression();
+    if (!index) {
+      return nullptr;
+    }
+    if (Lexer::cur_tok != ']') {
+      return LogError<ExprAST>("Parser: Expected ']' after the index");
+    }
+    Lexer::get_next_token();  // eat ']'.
+    base = std::make_unique<AccessExprAST>(
+      access_loc, std::move(base), std::move(index), "");
+  }
+  return base;
 }
 
 /**
@@ -234,11 +392,14 @@ std::unique_ptr<IfExprAST> Parser::parse_if_expr() {
 }
 
 /**
- * @brief Parse the `for` expression.
+ * @brief Parse the `for` and the `parfor` expressions.
  * @return
  * forexpr ::= 'for' identifier '=' expr ',' expr (',' expr)? 'in' expression
+ *   ::= 'parfor' identifier '=' expr ',' expr (',' expr)?
+ *       ('reduce' ('+' | '*' | 'min' | 'max'))? 'in' expression
  */
 std::unique_ptr<ForExprAST> Parser::parse_for_expr() {
+  bool is_parallel = Lexer::cur_tok == tok_parfor;
   Lexer::get_next_token();  // eat the for.
 
   if (Lexer::cur_tok != tok_identifier) {
@@ -277,6 +438,24 @@ std::unique_ptr<ForExprAST> Parser::parse_for_expr() {
     }
   }
 
+  std::string reduce_op;
+  if (
+    is_parallel && Lexer::cur_tok == tok_identifier &&
+    Lexer::identifier_str == "reduce") {
+    Lexer::get_next_token();  // eat 'reduce'.
+    if (Lexer::cur_tok == '+' || Lexer::cur_tok == '*') {
+      reduce_op = std::string(1, static_cast<char>(Lexer::cur_tok));
+    } else if (
+      Lexer::cur_tok == tok_identifier &&
+      (Lexer::identifier_str == "min" || Lexer::identifier_str == "max")) {
+      reduce_op = Lexer::identifier_str;
+    } else {
+      return LogError<ForExprAST>(
+        "Parser: Expected '+', '*', 'min' or 'max' after reduce");
+    }
+    Lexer::get_next_token();  // eat the operator.
+  }
+
   if (Lexer::cur_tok != tok_in) {
     return LogError<ForExprAST>("Parser: Expected 'in' after for");
   }
@@ -287,24 +466,29 @@ std::unique_ptr<ForExprAST> Parser::parse_for_expr() {
     return nullptr;
   }
 
-  return std::make_unique<ForExprAST>(
+  auto for_expr = std::make_unique<ForExprAST>(
     id_name,
     std::move(start),
     std::move(end),
     std::move(step),
     std::move(body));
+  for_expr->is_parallel = is_parallel;
+  for_expr->is_range = is_parallel;
+  for_expr->reduce_op = reduce_op;
+  return for_expr;
 }
 
 /**
  * @brief Parse the `var` declaration expression.
  * @return
- * varexpr ::= 'var' identifier ('=' expression)?
- *                    (',' identifier ('=' expression)?)* 'in' expression
+ * varexpr ::= 'var' identifier (':' type)? ('=' expression)?
+ *              (',' identifier (':' type)? ('=' expression)?)* 'in' expression
  */
 std::unique_ptr<VarExprAST> Parser::parse_var_expr() {
   Lexer::get_next_token();  // eat the var.
 
   std::vector<std::pair<std::string, std::unique_ptr<ExprAST>>> var_names;
+  std::vector<std::string> type_names;
 
   // At least one variable name is required. //
   if (Lexer::cur_tok != tok_identifier) {
@@ -315,6 +499,16 @@ std::unique_ptr<VarExprAST> Parser::parse_var_expr() {
     std::string name = Lexer::identifier_str;
     Lexer::get_next_token();  // eat identifier.
 
+    // Read the optional type annotation. //
+    std::string type_name = "";
+    if (Lexer::cur_tok == ':') {
+      Lexer::get_next_token();  // eat the ':'.
+      type_name = Parser::parse_type_annotation();
+      if (type_name == "") {
+        return nullptr;
+      }
+    }
+
     // Read the optional initializer. //
     std::unique_ptr<ExprAST> Init = nullptr;
     if (Lexer::cur_tok == '=') {
@@ -327,6 +521,7 @@ std::unique_ptr<VarExprAST> Parser::parse_var_expr() {
     }
 
     var_names.emplace_back(name, std::move(Init));
+    type_names.emplace_back(type_name);
 
     // end of var list, exit loop. //
     if (Lexer::cur_tok != ',') {
@@ -352,7 +547,77 @@ std::unique_ptr<VarExprAST> Parser::parse_var_expr() {
   }
 
   return std::make_unique<VarExprAST>(
-    std::move(var_names), "float", std::move(body));
+    std::move(var_names), std::move(type_names), std::move(body));
+}
+
+/**
+ * @brief Parse the `const` declaration expression.
+ * @return
+ * constexpr ::= 'const' identifier (':' type)? '=' expression
+ *               (',' identifier (':' type)? '=' expression)*
+ *               ('in' expression)?
+ *
+ * The body is optional only for top level declarations.
+ */
+std::unique_ptr<ConstExprAST> Parser::parse_const_expr() {
+  Lexer::get_next_token();  // eat the const.
+
+  std::vector<std::pair<std::string, std::unique_ptr<ExprAST>>> const_names;
+  std::vector<std::string> type_names;
+
+  while (true) {
+    if (Lexer::cur_tok != tok_identifier) {
+      return LogError<ConstExprAST>(
+        "Parser: Expected identifier after const");
+    }
+
+    std::string name = Lexer::identifier_str;
+    Lexer::get_next_token();  // eat identifier.
+
+    // Read the optional type annotation. //
+    std::string type_name = "";
+    if (Lexer::cur_tok == ':') {
+      Lexer::get_next_token();  // eat the ':'.
+      type_name = Parser::parse_type_annotation();
+      if (type_name == "") {
+        return nullptr;
+      }
+    }
+
+    // Read the required value. //
+    if (Lexer::cur_tok != '=') {
+      return LogError<ConstExprAST>(
+        "Parser: Expected '=' after the const name");
+    }
+    Lexer::get_next_token();  // eat the '='.
+
+    auto value = Parser::parse_expression();
+    if (!value) {
+      return nullptr;
+    }
+
+    const_names.emplace_back(name, std::move(value));
+    type_names.emplace_back(type_name);
+
+    // end of const list, exit loop. //
+    if (Lexer::cur_tok != ',') {
+      break;
+    }
+    Lexer::get_next_token();  // eat the ','.
+  }
+
+  std::unique_ptr<ExprAST> body = nullptr;
+  if (Lexer::cur_tok == tok_in) {
+    Lexer::get_next_token();  // eat 'in'.
+
+    body = Parser::parse_expression();
+    if (!body) {
+      return nullptr;
+    }
+  }
+
+  return std::make_unique<ConstExprAST>(
+    std::move(const_names), std::move(type_names), std::move(body));
 }
 
 /**
@@ -361,10 +626,12 @@ std::unique_ptr<VarExprAST> Parser::parse_var_expr() {
  * primary
  *   ::= identifierexpr
  *   ::= numberexpr
+ *   ::= stringexpr
  *   ::= parenexpr
  *   ::= ifexpr
  *   ::= forexpr
  *   ::= varexpr
+ *   ::= constexpr
  */
 std::unique_ptr<ExprAST> Parser::parse_primary() {
   char msg[80];
@@ -374,14 +641,25 @@ std::unique_ptr<ExprAST> Parser::parse_primary() {
       return Parser::parse_identifier_expr();
     case tok_float_literal:
       return static_cast<std::unique_ptr<ExprAST>>(parse_float_expr());
+    case tok_string_literal:
+      return static_cast<std::unique_ptr<ExprAST>>(parse_string_expr());
     case '(':
       return Parser::parse_paren_expr();
     case tok_if:
       return static_cast<std::unique_ptr<ExprAST>>(parse_if_expr());
     case tok_for:
+    case tok_parfor:
       return static_cast<std::unique_ptr<ExprAST>>(parse_for_expr());
     case tok_var:
       return static_cast<std::unique_ptr<ExprAST>>(parse_var_expr());
+    case tok_const: {
+      auto const_expr = Parser::parse_const_expr();
+      if (const_expr && !const_expr->body) {
+        return LogError<ExprAST>(
+          "Parser: Expected 'in' keyword after 'const'");
+      }
+      return static_cast<std::unique_ptr<ExprAST>>(std::move(const_expr));
+    }
     case ';':
       // ignore top-level semicolons.
       Lexer::get_next_token();  // eat `;`
@@ -485,7 +763,7 @@ std::unique_ptr<ExprAST> Parser::parse_expression() {
  * @brief Parse an extern prototype expression.
  * @return
  * prototype
- *   ::= id '(' id* ')'
+ *   ::= id '(' (id (':' type)?)* ')' ('->' type)?
  *   ::= binary LETTER number? (id, id)
  *   ::= unary LETTER (id)
  */
@@ -522,10 +800,18 @@ std::unique_ptr<PrototypeAST> Parser::parse_extern_prototype() {
 
     var_type_annotation = "float";
 
+    if (Lexer::get_next_token() == ':') {
+      Lexer::get_next_token();  // eat ':'.
+      var_type_annotation = Parser::parse_type_annotation();
+      if (var_type_annotation == "") {
+        return nullptr;
+      }
+    }
+
     args.push_back(std::make_unique<VariableExprAST>(
       cur_loc, identifier_name, var_type_annotation));
 
-    if (Lexer::get_next_token() != ',') {
+    if (Lexer::cur_tok != ',') {
       break;
     }
   }
@@ -540,15 +826,45 @@ std::unique_ptr<PrototypeAST> Parser::parse_extern_prototype() {
 
   ret_type_annotation = "float";
 
+  if (Lexer::cur_tok == '-') {
+    if (Lexer::get_next_token() != '>') {
+      return LogError<PrototypeAST>(
+        "Parser: Expected '->' before the return type.");
+    }
+    Lexer::get_next_token();  // eat '>'.
+    ret_type_annotation = Parser::parse_type_annotation();
+    if (ret_type_annotation == "") {
+      return nullptr;
+    }
+    // the storage of the arrays is released at the end of their `var`
+    if (is_array_type(ret_type_annotation)) {
+      return LogError<PrototypeAST>("Parser: Functions can't return arrays.");
+    }
+  }
+
   return std::make_unique<PrototypeAST>(
     fn_loc, fn_name, ret_type_annotation, std::move(args));
 }
 
+/**
+ * @brief Check if the name is a type parameter of the generic function
+ *        being parsed.
+ *
+ */
+static auto is_type_param(const std::string& name) -> bool {
+  for (auto& type_param : Parser::type_params) {
+    if (type_param == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
 /**
  * @brief Parse the prototype expression.
  * @return
  * prototype
- *   ::= id '(' id* ')'
+ *   ::= id typeparams? '(' (id (':' type)?)* ')' ('->' type)?
  *   ::= binary LETTER number? (id, id)
  *   ::= unary LETTER (id)
  */
@@ -572,6 +888,11 @@ std::unique_ptr<PrototypeAST> Parser::parse_prototype() {
         "Parser: Expected function name in prototype");
   }
 
+  Parser::type_params.clear();
+  if (Lexer::cur_tok == '[' && !Parser::parse_type_params()) {
+    return nullptr;
+  }
+
   if (Lexer::cur_tok != '(') {
     return LogError<PrototypeAST>(
       "Parser: Expected '(' in the function definition.");
@@ -585,10 +906,18 @@ std::unique_ptr<PrototypeAST> Parser::parse_prototype() {
 
     var_type_annotation = "float";
 
+    if (Lexer::get_next_token() == ':') {
+      Lexer::get_next_token();  // eat ':'.
+      var_type_annotation = Parser::parse_type_annotation();
+      if (var_type_annotation == "") {
+        return nullptr;
+      }
+    }
+
     args.push_back(std::make_unique<VariableExprAST>(
       cur_loc, identifier_name, var_type_annotation));
 
-    if (Lexer::get_next_token() != ',') {
+    if (Lexer::cur_tok != ',') {
       break;
     }
   }
@@ -603,6 +932,22 @@ std::unique_ptr<PrototypeAST> Parser::parse_prototype() {
 
   ret_type_annotation = "float";
 
+  if (Lexer::cur_tok == '-') {
+    if (Lexer::get_next_token() != '>') {
+      return LogError<PrototypeAST>(
+        "Parser: Expected '->' before the return type.");
+    }
+    Lexer::get_next_token();  // eat '>'.
+    ret_type_annotation = Parser::parse_type_annotation();
+    if (ret_type_annotation == "") {
+      return nullptr;
+    }
+    // the storage of the arrays is released at the end of their `var`
+    if (is_array_type(ret_type_annotation)) {
+      return LogError<PrototypeAST>("Parser: Functions can't return arrays.");
+    }
+  }
+
   if (Lexer::cur_tok != ':') {
     return LogError<PrototypeAST>(
       "Parser: Expected ':' in the function definition");
@@ -610,8 +955,159 @@ std::unique_ptr<PrototypeAST> Parser::parse_prototype() {
 
   Lexer::get_next_token();  // eat ':'.
 
-  return std::make_unique<PrototypeAST>(
+  auto proto = std::make_unique<PrototypeAST>(
     fn_loc, fn_name, ret_type_annotation, std::move(args));
+  proto->type_params = Parser::type_params;
+  return proto;
+}
+
+/**
+ * @brief Parse the type parameters of a generic function to
+ *        Parser::type_params.
+ * @return false if they are not valid.
+ * typeparams ::= '[' id (',' id)* ']'
+ */
+auto Parser::parse_type_params() -> bool {
+  do {
+    if (Lexer::get_next_token() != tok_identifier) {
+      LogError<ExprAST>("Parser: Expected a type parameter name.");
+      return false;
+    }
+    const std::string& name = Lexer::identifier_str;
+    if (get_type_kind(name) != ExprKind::GenericKind) {
+      std::string msg = "Parser: The type parameter `" + name +
+        "` has the name of a type.";
+      LogError<ExprAST>(msg.c_str());
+      return false;
+    }
+    if (is_type_param(name)) {
+      std::string msg = "Parser: Duplicated type parameter `" + name + "`.";
+      LogError<ExprAST>(msg.c_str());
+      return false;
+    }
+    Parser::type_params.push_back(name);
+  } while (Lexer::get_next_token() == ',');
+
+  if (Lexer::cur_tok != ']') {
+    LogError<ExprAST>("Parser: Expected ']' after the type parameters.");
+    return false;
+  }
+  Lexer::get_next_token();  // eat ']'.
+  return true;
+}
+
+/**
+ * @brief Parse a type annotation.
+ * @return The canonical type name or an empty string if it is not valid.
+ * type
+ *   ::= scalar ('[' number ']' ('@' ('aos' | 'soa'))?)?
+ * scalar
+ *   ::= id
+ *   ::= 'binary'
+ *   ::= ('decimal128' | 'decimal256') '(' number (',' number)? ')'
+ *
+ * The layout of an array of structs is `aos` (array of structs) by default.
+ */
+auto Parser::parse_type_annotation() -> std::string {
+  std::string type_name = Parser::parse_scalar_type_annotation();
+  if (type_name == "" || Lexer::cur_tok != '[') {
+    return type_name;
+  }
+
+  if (
+    Lexer::get_next_token() != tok_float_literal || Lexer::num_float < 1 ||
+    Lexer::num_str.find('.') != std::string::npos) {
+    LogError<ExprAST>("Parser: Expected the array length.");
+    return "";
+  }
+  auto length = static_cast<int64_t>(Lexer::num_float);
+  if (Lexer::get_next_token() != ']') {
+    LogError<ExprAST>("Parser: Expected ']' in the array type.");
+    return "";
+  }
+  Lexer::get_next_token();  // eat ']'.
+
+  bool is_soa = false;
+  if (Lexer::cur_tok == '@') {
+    if (
+      Lexer::get_next_token() != tok_identifier ||
+      (Lexer::identifier_str != "aos" && Lexer::identifier_str != "soa")) {
+      LogError<ExprAST>("Parser: Expected `aos` or `soa` array layout.");
+      return "";
+    }
+    is_soa = Lexer::identifier_str == "soa";
+    Lexer::get_next_token();  // eat the layout.
+  }
+
+  // the element of a type parameter is checked when it is instantiated
+  if (is_soa && !is_record_type(type_name) && !is_type_param(type_name)) {
+    LogError<ExprAST>("Parser: The `soa` layout needs a struct element.");
+    return "";
+  }
+  return get_array_type_name(type_name, length, is_soa);
+}
+
+/**
+ * @brief Parse the type annotation of a single value (not an array).
+ * @return The canonical type name or an empty string if it is not valid.
+ */
+auto Parser::parse_scalar_type_annotation() -> std::string {
+  // note: `binary` is also the keyword used to define binary operators
+  if (Lexer::cur_tok != tok_identifier && Lexer::cur_tok != tok_binary) {
+    LogError<ExprAST>("Parser: Expected a type name.");
+    return "";
+  }
+
+  std::string type_name = Lexer::identifier_str;
+  ExprKind kind = get_type_kind(type_name);
+  Lexer::get_next_token();  // eat the type name.
+
+  if (is_type_param(type_name)) {
+    return type_name;
+  }
+  if (kind == ExprKind::GenericKind) {
+    std::string msg = "Parser: Unknown type `" + type_name + "`.";
+    LogError<ExprAST>(msg.c_str());
+    return "";
+  }
+
+  if (!is_decimal_type(type_name)) {
+    return type_name;
+  }
+
+  int max_precision = kind == ExprKind::Decimal256DTKind
+    ? DECIMAL256_MAX_PRECISION
+    : DECIMAL128_MAX_PRECISION;
+  int precision = max_precision;
+  int scale = 0;
+
+  if (Lexer::cur_tok == '(') {
+    if (Lexer::get_next_token() != tok_float_literal) {
+      LogError<ExprAST>("Parser: Expected the decimal precision.");
+      return "";
+    }
+    precision = static_cast<int>(Lexer::num_float);
+    if (Lexer::get_next_token() == ',') {
+      if (Lexer::get_next_token() != tok_float_literal) {
+        LogError<ExprAST>("Parser: Expected the decimal scale.");
+        return "";
+      }
+      scale = static_cast<int>(Lexer::num_float);
+      Lexer::get_next_token();  // eat the scale.
+    }
+    if (Lexer::cur_tok != ')') {
+      LogError<ExprAST>("Parser: Expected ')' in the decimal type.");
+      return "";
+    }
+    Lexer::get_next_token();  // eat ')'.
+  }
+
+  if (precision < 1 || precision > max_precision || scale > precision) {
+    LogError<ExprAST>("Parser: Invalid decimal precision or scale.");
+    return "";
+  }
+
+  return get_decimal_type_name(kind, precision, scale);
 }
 
 /**
@@ -623,15 +1119,102 @@ std::unique_ptr<FunctionAST> Parser::parse_definition() {
   Lexer::get_next_token();  // eat function.
   auto proto = Parser::parse_prototype();
   if (!proto) {
+    Parser::type_params.clear();
     return nullptr;
   }
 
-  if (auto E = Parser::parse_expression()) {
+  // the type parameters are types in the body
+  auto E = Parser::parse_expression();
+  Parser::type_params.clear();
+  if (E) {
     return std::make_unique<FunctionAST>(std::move(proto), std::move(E));
   }
   return nullptr;
 }
 
+/**
+ * @brief Parse the function definition with its decorators.
+ * @return
+ * decorated ::= ('@' id ('(' (id | number) (',' (id | number))* ')')?)+
+ *               definition
+ *
+ * `@memo` caches the results of the function, the options are `sync` for
+ * a thread-safe cache and the number of cached results.
+ *
+ * `@fastmath` allows the fast-math transformations in the function, the
+ * option is `contract` to only allow FMA or `off` for strict semantics.
+ */
+std::unique_ptr<FunctionAST> Parser::parse_decorated_definition() {
+  int memo_capacity = 0;
+  bool memo_sync = false;
+  std::string fp_mode;
+
+  while (Lexer::cur_tok == '@') {
+    if (Lexer::get_next_token() != tok_identifier) {
+      return LogError<FunctionAST>("Parser: Expected decorator name");
+    }
+    std::string decorator = Lexer::identifier_str;
+    if (decorator == "memo") {
+      memo_capacity = ARX_MEMO_DEFAULT_CAPACITY;
+    } else if (decorator == "fastmath") {
+      fp_mode = "fast";
+    } else {
+      std::string msg = "Parser: Unknown decorator: @" + decorator;
+      return LogError<FunctionAST>(msg.c_str());
+    }
+    Lexer::get_next_token();  // eat the decorator name.
+
+    if (Lexer::cur_tok != '(') {
+      continue;
+    }
+
+    do {
+      Lexer::get_next_token();  // eat '(' or ','.
+      if (
+        decorator == "memo" && Lexer::cur_tok == tok_identifier &&
+        Lexer::identifier_str == "sync") {
+        memo_sync = true;
+      } else if (
+        decorator == "memo" && Lexer::cur_tok == tok_float_literal &&
+        Lexer::num_float >= 1 && Lexer::num_float <= ARX_MEMO_MAX_CAPACITY &&
+        Lexer::num_float == std::trunc(Lexer::num_float)) {
+        memo_capacity = static_cast<int>(Lexer::num_float);
+      } else if (
+        decorator == "fastmath" && Lexer::cur_tok == tok_identifier &&
+        (Lexer::identifier_str == "contract" ||
+         Lexer::identifier_str == "off")) {
+        fp_mode =
+          Lexer::identifier_str == "off" ? "strict" : Lexer::identifier_str;
+      } else if (decorator == "memo") {
+        return LogError<FunctionAST>(
+          "Parser: Expected `sync` or an integer cache size in @memo");
+      } else {
+        return LogError<FunctionAST>(
+          "Parser: Expected `contract` or `off` in @fastmath");
+      }
+    } while (Lexer::get_next_token() == ',');
+
+    if (Lexer::cur_tok != ')') {
+      std::string msg = "Parser: Expected ')' in @" + decorator;
+      return LogError<FunctionAST>(msg.c_str());
+    }
+    Lexer::get_next_token();  // eat ')'.
+  }
+
+  if (Lexer::cur_tok != tok_function) {
+    return LogError<FunctionAST>(
+      "Parser: Expected function definition after decorator");
+  }
+
+  auto function = Parser::parse_definition();
+  if (function) {
+    function->proto->memo_capacity = memo_capacity;
+    function->proto->memo_sync = memo_sync;
+    function->proto->fp_mode = fp_mode;
+  }
+  return function;
+}
+
 /**
  * @brief Parse the top level expression.
  * @return
@@ -651,6 +1234,90 @@ std::unique_ptr<FunctionAST> Parser::parse_top_level_expr() {
   return nullptr;
 }
 
+/**
+ * @brief Parse a top level const declaration.
+ * @return
+ * toplevelconst ::= constexpr
+ *
+ * A declaration with a body is an expression, so it is wrapped in an
+ * anonymous function like the other top level expressions.
+ */
+std::unique_ptr<ExprAST> Parser::parse_top_level_const() {
+  SourceLocation fn_loc = Lexer::cur_loc;
+  auto const_expr = Parser::parse_const_expr();
+  if (!const_expr || !const_expr->body) {
+    return const_expr;
+  }
+
+  auto proto = std::make_unique<PrototypeAST>(
+    fn_loc,
+    "__anon_expr",
+    "float",
+    std::move(std::vector<std::unique_ptr<VariableExprAST>>()));
+  return std::make_unique<FunctionAST>(
+    std::move(proto), std::move(const_expr));
+}
+
+/**
+ * @brief Parse a struct declaration and add it to Parser::struct_fields.
+ * @return false if the declaration is not valid.
+ * struct ::= 'struct' id ':' id (':' type)? (',' id (':' type)?)*
+ *
+ * The fields are floats by default, like the function arguments, and
+ * they can't be structs or arrays.
+ */
+auto Parser::parse_struct() -> bool {
+  if (Lexer::get_next_token() != tok_identifier) {
+    LogError<ExprAST>("Parser: Expected struct name");
+    return false;
+  }
+  std::string struct_name = Lexer::identifier_str;
+  if (get_type_kind(struct_name) != ExprKind::GenericKind) {
+    std::string msg = "Parser: Type `" + struct_name + "` already exists.";
+    LogError<ExprAST>(msg.c_str());
+    return false;
+  }
+
+  if (Lexer::get_next_token() != ':') {
+    LogError<ExprAST>("Parser: Expected ':' after the struct name");
+    return false;
+  }
+
+  StructFields fields;
+  do {
+    if (Lexer::get_next_token() != tok_identifier) {
+      LogError<ExprAST>("Parser: Expected field name in the struct");
+      return false;
+    }
+    std::string field_name = Lexer::identifier_str;
+    for (auto& field : fields) {
+      if (field.first == field_name) {
+        std::string msg = "Parser: Duplicated field `" + field_name + "`.";
+        LogError<ExprAST>(msg.c_str());
+        return false;
+      }
+    }
+
+    std::string field_type = "float";
+    if (Lexer::get_next_token() == ':') {
+      Lexer::get_next_token();  // eat ':'.
+      field_type = Parser::parse_type_annotation();
+      if (field_type == "") {
+        return false;
+      }
+      if (is_record_type(field_type) || is_array_type(field_type)) {
+        LogError<ExprAST>(
+          "Parser: The struct fields can't be structs or arrays.");
+        return false;
+      }
+    }
+    fields.emplace_back(field_name, field_type);
+  } while (Lexer::cur_tok == ',');
+
+  Parser::struct_fields[struct_name] = std::move(fields);
+  return true;
+}
+
 /**
  * @brief Parse the extern expression;
  * @return
@@ -680,9 +1347,21 @@ auto Parser::parse() -> std::unique_ptr<TreeAST> {
       case tok_function:
         ast->nodes.emplace_back(Parser::parse_definition());
         break;
+      case '@':
+        ast->nodes.emplace_back(Parser::parse_decorated_definition());
+        break;
       case tok_extern:
         ast->nodes.emplace_back(Parser::parse_extern());
         break;
+      case tok_struct:
+        // the structs are types, so they don't add a node
+        if (!Parser::parse_struct()) {
+          ast->nodes.emplace_back(nullptr);
+        }
+        break;
+      case tok_const:
+        ast->nodes.emplace_back(Parser::parse_top_level_const());
+        break;
       default:
         ast->nodes.emplace_back(Parser::parse_top_level_expr());
         break;
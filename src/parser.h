@@ -14,7 +14,8 @@ enum class ExprKind {
 
   // variables
   VariableKind = -10,
-  VarKind = -11,  // var keyword for variable declaration
+  VarKind = -11,    // var keyword for variable declaration
+  ConstKind = -12,  // const keyword for constant declaration
 
   // operators
   UnaryOpKind = -20,
@@ -29,6 +30,9 @@ enum class ExprKind {
   IfKind = -40,
   ForKind = -41,
 
+  // aggregates
+  AccessKind = -50,  // element of an array or field of a struct
+
   // data types
   NullDTKind = -100,
   BooleanDTKind = -101,
@@ -52,6 +56,9 @@ enum class ExprKind {
   Time64DTKind = -119,
   Decimal128DTKind = -120,
   Decimal256DTKind = -121,
+  VectorDTKind = -122,
+  RecordDTKind = -123,
+  ArrayDTKind = -124,
 
 };
 
@@ -99,8 +106,14 @@ class ExprAST {
 class FloatExprAST : public ExprAST {
  public:
   float val;
+  std::string literal;
 
-  FloatExprAST(float _val) : val(_val) {
+  /**
+   * @param _val The literal value
+   * @param _literal The literal text, used for exact decimal conversions
+   */
+  FloatExprAST(float _val, std::string _literal = "")
+      : val(_val), literal(std::move(_literal)) {
     this->kind = ExprKind::FloatDTKind;
   }
 
@@ -109,6 +122,27 @@ class FloatExprAST : public ExprAST {
   }
 };
 
+/**
+ * @brief Expression class for string literals like "abc".
+ *
+ *
+ */
+class StringExprAST : public ExprAST {
+ public:
+  std::string val;
+
+  /**
+   * @param _val The literal value, with the escape sequences resolved
+   */
+  StringExprAST(std::string _val) : val(std::move(_val)) {
+    this->kind = ExprKind::StringDTKind;
+  }
+
+  llvm::raw_ostream& dump(llvm::raw_ostream& out, int ind) override {
+    return ExprAST::dump(out << '"' << this->val << '"', ind);
+  }
+};
+
 /**
  * @brief Expression class for referencing a variable, like "a".
  *
@@ -228,6 +262,50 @@ class CallExprAST : public ExprAST {
   }
 };
 
+/**
+ * @brief Expression class for the element of an array, like "a[i]", or
+ *        the field of a struct, like "p.x".
+ *
+ * Just one of `index` and `field` is set, so "a[i].x" is the field access
+ * of an element access.
+ */
+class AccessExprAST : public ExprAST {
+ public:
+  std::unique_ptr<ExprAST> base;
+  std::unique_ptr<ExprAST> index;
+  std::string field;
+
+  /**
+   * @param _loc The token location
+   * @param _base The array or struct expression
+   * @param _index The element index, nullptr for a field access
+   * @param _field The field name, empty for an element access
+   */
+  AccessExprAST(
+    SourceLocation _loc,
+    std::unique_ptr<ExprAST> _base,
+    std::unique_ptr<ExprAST> _index,
+    std::string _field)
+      : ExprAST(_loc),
+        base(std::move(_base)),
+        index(std::move(_index)),
+        field(std::move(_field)) {
+    this->kind = ExprKind::AccessKind;
+  }
+
+  llvm::raw_ostream& dump(llvm::raw_ostream& out, int ind) override {
+    if (this->index) {
+      ExprAST::dump(out << "index", ind);
+      this->base->dump(indent(out, ind) << "base:", ind + 1);
+      this->index->dump(indent(out, ind) << "index:", ind + 1);
+    } else {
+      ExprAST::dump(out << "field " << this->field, ind);
+      this->base->dump(indent(out, ind) << "base:", ind + 1);
+    }
+    return out;
+  }
+};
+
 /**
  * @brief Expression class for if/then/else.
  *
@@ -272,6 +350,13 @@ class ForExprAST : public ExprAST {
  public:
   std::string var_name;
   std::unique_ptr<ExprAST> start, end, step, body;
+  // `parfor`: the iterations are independent and they run in parallel
+  bool is_parallel = false;
+  // `parfor` and the range builtins (`sum`, `map`, ...): `end` is the
+  // exclusive bound of the variable instead of a condition
+  bool is_range = false;
+  // the reduction of the body values of a range loop (+, *, min or max)
+  std::string reduce_op;
 
   /**
    * @param _var_name The variable name
@@ -295,7 +380,12 @@ class ForExprAST : public ExprAST {
   }
 
   llvm::raw_ostream& dump(llvm::raw_ostream& out, int ind) override {
-    ExprAST::dump(out << "for", ind);
+    ExprAST::dump(
+      out << (this->is_parallel ? "parfor" : this->is_range ? "range" : "for"),
+      ind);
+    if (!this->reduce_op.empty()) {
+      indent(out, ind) << "reduce:" << this->reduce_op << '\n';
+    }
     this->start->dump(indent(out, ind) << "cond:", ind + 1);
     this->end->dump(indent(out, ind) << "end:", ind + 1);
     this->step->dump(indent(out, ind) << "step:", ind + 1);
@@ -312,20 +402,20 @@ class ForExprAST : public ExprAST {
 class VarExprAST : public ExprAST {
  public:
   std::vector<std::pair<std::string, std::unique_ptr<ExprAST>>> var_names;
-  std::string type_name;
+  std::vector<std::string> type_names;
   std::unique_ptr<ExprAST> body;
 
   /**
    * @param _var_names Variable names
-   * @param _type_name Variables' type name
+   * @param _type_names Variables' type names (empty when not annotated)
    * @param _body body of the variables
    */
   VarExprAST(
     std::vector<std::pair<std::string, std::unique_ptr<ExprAST>>> _var_names,
-    std::string _type_name,
+    std::vector<std::string> _type_names,
     std::unique_ptr<ExprAST> _body)
       : var_names(std::move(_var_names)),
-        type_name(std::move(_type_name)),
+        type_names(std::move(_type_names)),
         body(std::move(_body)) {
     this->kind = ExprKind::VarKind;
   }
@@ -341,6 +431,49 @@ class VarExprAST : public ExprAST {
   }
 };
 
+/**
+ * @brief Expression class for const/in
+ *
+ * The values are evaluated at compile time and folded into their uses.
+ * Without a body, the constants are declared at the top level and they are
+ * visible from the functions defined after them.
+ */
+class ConstExprAST : public ExprAST {
+ public:
+  std::vector<std::pair<std::string, std::unique_ptr<ExprAST>>> const_names;
+  std::vector<std::string> type_names;
+  std::unique_ptr<ExprAST> body;
+
+  /**
+   * @param _const_names Constant names and values
+   * @param _type_names Constants' type names (empty when not annotated)
+   * @param _body body of the constants (nullptr for top level constants)
+   */
+  ConstExprAST(
+    std::vector<std::pair<std::string, std::unique_ptr<ExprAST>>>
+      _const_names,
+    std::vector<std::string> _type_names,
+    std::unique_ptr<ExprAST> _body)
+      : const_names(std::move(_const_names)),
+        type_names(std::move(_type_names)),
+        body(std::move(_body)) {
+    this->kind = ExprKind::ConstKind;
+  }
+
+  llvm::raw_ostream& dump(llvm::raw_ostream& out, int ind) override {
+    ExprAST::dump(out << "const", ind);
+    for (auto node = this->const_names.begin();
+         node != this->const_names.end();
+         ++node) {
+      node->second->dump(indent(out, ind) << node->first << ':', ind + 1);
+    }
+    if (this->body) {
+      this->body->dump(indent(out, ind) << "body:", ind + 1);
+    }
+    return out;
+  }
+};
+
 /**
  @brief This class represents the "prototype" for a function.
 
@@ -354,6 +487,24 @@ class PrototypeAST : public ExprAST {
   std::string type_name;
   int line;
 
+  // the value of a function without arguments that returns a constant
+  // expression, it is folded into the calls (see ConstExprAST).
+  std::unique_ptr<ExprAST> constant;
+  std::string constant_type;
+  // the function has no side effects, so calls with constant arguments are
+  // evaluated at compile time (see ArxConstEval).
+  bool is_pure = false;
+  // the number of results cached by `@memo` (0 when the function isn't
+  // memoized) and if the cache is thread-safe (see ArxMemo).
+  int memo_capacity = 0;
+  bool memo_sync = false;
+  // the floating-point mode of `@fastmath`: fast, contract or strict, or
+  // empty for the mode of the command line (see ArxFPMode).
+  std::string fp_mode;
+  // the type parameters of a generic function, that is instantiated for
+  // the types of the arguments of each call (see ArxGeneric).
+  std::vector<std::string> type_params;
+
   /**
    * @param _loc The token location
    * @param _name The prototype name
@@ -417,6 +568,7 @@ class TreeAST : public ExprAST {
 class Visitor {
  public:
   virtual void visit(FloatExprAST&) = 0;
+  virtual void visit(StringExprAST&) = 0;
   virtual void visit(VariableExprAST&) = 0;
   virtual void visit(UnaryExprAST&) = 0;
   virtual void visit(BinaryExprAST&) = 0;
@@ -424,17 +576,28 @@ class Visitor {
   virtual void visit(IfExprAST&) = 0;
   virtual void visit(ForExprAST&) = 0;
   virtual void visit(VarExprAST&) = 0;
+  virtual void visit(ConstExprAST&) = 0;
+  virtual void visit(AccessExprAST&) = 0;
   virtual void visit(PrototypeAST&) = 0;
   virtual void visit(FunctionAST&) = 0;
   virtual void clean() = 0;
   virtual ~Visitor() = default;
 };
 
+// the fields of a struct, as (name, type name) pairs
+typedef std::vector<std::pair<std::string, std::string>> StructFields;
+
 class Parser {
  public:
   static std::map<char, int> bin_op_precedence;
+  // the structs declared by the source
+  static std::map<std::string, StructFields> struct_fields;
+  // the type parameters of the generic function being parsed
+  static std::vector<std::string> type_params;
 
   static void setup() {
+    Parser::struct_fields.clear();
+    Parser::type_params.clear();
     Parser::bin_op_precedence['='] = 2;
     Parser::bin_op_precedence['<'] = 10;
     Parser::bin_op_precedence['+'] = 20;
@@ -447,19 +610,29 @@ class Parser {
   static auto get_tok_precedence() -> int;
 
   static std::unique_ptr<FunctionAST> parse_definition();
+  static std::unique_ptr<FunctionAST> parse_decorated_definition();
   static std::unique_ptr<PrototypeAST> parse_extern();
   static std::unique_ptr<FunctionAST> parse_top_level_expr();
+  static std::unique_ptr<ExprAST> parse_top_level_const();
   static std::unique_ptr<ExprAST> parse_primary();
   static std::unique_ptr<ExprAST> parse_expression();
   static std::unique_ptr<IfExprAST> parse_if_expr();
   static std::unique_ptr<FloatExprAST> parse_float_expr();
+  static std::unique_ptr<StringExprAST> parse_string_expr();
   static std::unique_ptr<ExprAST> parse_paren_expr();
   static std::unique_ptr<ExprAST> parse_identifier_expr();
+  static std::unique_ptr<ExprAST> parse_access_expr(
+    std::unique_ptr<ExprAST> base);
+  static auto parse_struct() -> bool;
   static std::unique_ptr<ForExprAST> parse_for_expr();
   static std::unique_ptr<VarExprAST> parse_var_expr();
+  static std::unique_ptr<ConstExprAST> parse_const_expr();
   static std::unique_ptr<ExprAST> parse_unary();
   static std::unique_ptr<ExprAST> parse_bin_op_rhs(
     int expr_prec, std::unique_ptr<ExprAST> lhs);
   static std::unique_ptr<PrototypeAST> parse_prototype();
   static std::unique_ptr<PrototypeAST> parse_extern_prototype();
+  static auto parse_type_params() -> bool;
+  static auto parse_type_annotation() -> std::string;
+  static auto parse_scalar_type_annotation() -> std::string;
 };
@@ -0,0 +1,174 @@
+#include "passes/pass-manager.h"  // for ASTPass, ASTPassManager
+#include <chrono>                  // for steady_clock, duration
+#include <memory>                  // for unique_ptr, make_unique
+#include <utility>                 // for move
+
+#include <llvm/Support/Format.h>  // for format
+
+#include "parser.h"           // for ExprAST, TreeAST, FunctionAST
+#include "passes/simplify.h"  // for ConstantFoldingPass, ...
+#include "time-report.h"      // for ArxPhase
+
+/**
+ * @brief Visit a node and replace it with the result of the visit.
+ * @param node The node, it can be nullptr (e.g. a parsing error).
+ */
+auto ASTPass::transform(std::unique_ptr<ExprAST>& node) -> void {
+  if (!node) {
+    return;
+  }
+
+  ++this->nodes;
+  this->result = nullptr;
+  node->accept(*this);
+  if (this->result) {
+    node = std::move(this->result);
+  }
+}
+
+/**
+ * @brief Run the pass over all the top level nodes.
+ *
+ */
+auto ASTPass::run(TreeAST& ast) -> void {
+  auto start = std::chrono::steady_clock::now();
+
+  this->nodes = 0;
+  for (auto& node : ast.nodes) {
+    this->transform(node);
+  }
+
+  std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - start;
+  this->time_ms += elapsed.count();
+}
+
+auto ASTPass::visit(FloatExprAST&) -> void {}
+
+auto ASTPass::visit(StringExprAST&) -> void {}
+
+auto ASTPass::visit(VariableExprAST&) -> void {}
+
+auto ASTPass::visit(UnaryExprAST& expr) -> void {
+  this->transform(expr.operand);
+}
+
+auto ASTPass::visit(BinaryExprAST& expr) -> void {
+  this->transform(expr.lhs);
+  this->transform(expr.rhs);
+}
+
+auto ASTPass::visit(CallExprAST& expr) -> void {
+  for (auto& arg : expr.args) {
+    this->transform(arg);
+  }
+}
+
+auto ASTPass::visit(IfExprAST& expr) -> void {
+  this->transform(expr.cond);
+  this->transform(expr.then);
+  this->transform(expr.else_);
+}
+
+auto ASTPass::visit(ForExprAST& expr) -> void {
+  this->transform(expr.start);
+  this->transform(expr.end);
+  this->transform(expr.step);
+  this->transform(expr.body);
+}
+
+auto ASTPass::visit(VarExprAST& expr) -> void {
+  for (auto& var : expr.var_names) {
+    this->transform(var.second);
+  }
+  this->transform(expr.body);
+}
+
+auto ASTPass::visit(ConstExprAST& expr) -> void {
+  for (auto& constant : expr.const_names) {
+    this->transform(constant.second);
+  }
+  this->transform(expr.body);
+}
+
+auto ASTPass::visit(AccessExprAST& expr) -> void {
+  this->transform(expr.base);
+  this->transform(expr.index);
+}
+
+auto ASTPass::visit(PrototypeAST&) -> void {}
+
+auto ASTPass::visit(FunctionAST& expr) -> void {
+  this->transform(expr.body);
+}
+
+auto ASTPass::clean() -> void {
+  this->result = nullptr;
+}
+
+/**
+ * @brief Add a pass to the end of the pipeline.
+ *
+ */
+auto ASTPassManager::add_pass(std::unique_ptr<ASTPass> pass) -> void {
+  this->passes.push_back(std::move(pass));
+}
+
+/**
+ * @brief Add the passes used by the compiler, in order.
+ *
+ * The branches are removed after folding their conditions, and the
+ * simplifications can leave unused variables behind.
+ */
+auto ASTPassManager::add_default_passes() -> void {
+  this->add_pass(std::make_unique<ConstantFoldingPass>());
+  this->add_pass(std::make_unique<DeadBranchEliminationPass>());
+  this->add_pass(std::make_unique<AlgebraicSimplificationPass>());
+  this->add_pass(std::make_unique<UnusedVarEliminationPass>());
+}
+
+/**
+ * @brief Run all the passes over the AST.
+ *
+ */
+auto ASTPassManager::run(TreeAST& ast) -> void {
+  // an empty pass just counts the nodes
+  ASTPass counter("count");
+
+  counter.run(ast);
+  this->nodes_before = counter.nodes;
+
+  for (auto& pass : this->passes) {
+    ArxPhase phase(pass->name);
+    pass->run(ast);
+  }
+
+  counter.run(ast);
+  this->nodes_after = counter.nodes;
+}
+
+/**
+ * @brief Print the time, the changes and the visited nodes of each pass.
+ *
+ */
+auto ASTPassManager::print_report(llvm::raw_ostream& out) -> void {
+  double total_ms = 0;
+  int total_changes = 0;
+
+  out << "===== AST passes =====\n";
+  out << "  Time (ms)   Changes     Nodes  Pass\n";
+  for (auto& pass : this->passes) {
+    out << llvm::format(
+      "%11.3f %9d %9d  %s\n",
+      pass->time_ms,
+      pass->changes,
+      pass->nodes,
+      pass->name.c_str());
+    total_ms += pass->time_ms;
+    total_changes += pass->changes;
+  }
+  out << llvm::format(
+    "%11.3f %9d %9s  Total\n", total_ms, total_changes, (const char*) "");
+  out << "  AST nodes: " << this->nodes_before << " -> " << this->nodes_after
+      << "\n";
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <llvm/Support/raw_ostream.h>  // for raw_ostream
+#include <memory>                      // for unique_ptr
+#include <string>                      // for string
+#include <vector>                      // for vector
+
+#include "parser.h"  // for Visitor, ExprAST, TreeAST
+
+/**
+ * @brief Base class for the passes that transform the AST before codegen.
+ *
+ * The default implementation of each visit just transforms the children of
+ * the node. A pass overrides the visits for the nodes it changes, and to
+ * replace the visited node it sets `result` with the new node (see
+ * `transform`).
+ */
+class ASTPass : public Visitor {
+ public:
+  // name used in the report, like `constant-folding`
+  std::string name;
+  // number of changes done by the pass
+  int changes = 0;
+  // number of nodes visited in the last run
+  int nodes = 0;
+  // total time spent by the pass, in milliseconds
+  double time_ms = 0;
+  // replacement for the visited node, nullptr to keep it
+  std::unique_ptr<ExprAST> result;
+
+  explicit ASTPass(std::string _name) : name(std::move(_name)) {}
+
+  virtual void visit(FloatExprAST&) override;
+  virtual void visit(StringExprAST&) override;
+  virtual void visit(VariableExprAST&) override;
+  virtual void visit(UnaryExprAST&) override;
+  virtual void visit(BinaryExprAST&) override;
+  virtual void visit(CallExprAST&) override;
+  virtual void visit(IfExprAST&) override;
+  virtual void visit(ForExprAST&) override;
+  virtual void visit(VarExprAST&) override;
+  virtual void visit(ConstExprAST&) override;
+  virtual void visit(AccessExprAST&) override;
+  virtual void visit(PrototypeAST&) override;
+  virtual void visit(FunctionAST&) override;
+  virtual void clean() override;
+
+  auto transform(std::unique_ptr<ExprAST>& node) -> void;
+  auto run(TreeAST& ast) -> void;
+};
+
+/**
+ * @brief Run a pipeline of AST passes and report their statistics.
+ *
+ */
+class ASTPassManager {
+ public:
+  std::vector<std::unique_ptr<ASTPass>> passes;
+
+  ASTPassManager() = default;
+
+  auto add_pass(std::unique_ptr<ASTPass> pass) -> void;
+  auto add_default_passes() -> void;
+  auto run(TreeAST& ast) -> void;
+  auto print_report(llvm::raw_ostream& out) -> void;
+
+ private:
+  // number of nodes before the first pass and after the last one
+  int nodes_before = 0;
+  int nodes_after = 0;
+};
@@ -0,0 +1,378 @@
+#include "passes/simplify.h"  // for ConstantFoldingPass, ...
+#include <map>                 // for map
+#include <memory>              // for unique_ptr, make_unique
+#include <string>              // for string
+#include <utility>             // for move
+
+#include <llvm/IR/Operator.h>  // for FastMathFlags
+
+#include "codegen/fp-mode.h"  // for ArxFPMode
+#include "parser.h"           // for ExprAST, FloatExprAST, StringExprAST
+
+/**
+ * @brief Check if the expression is the float literal `value`.
+ *
+ */
+static auto is_float_literal(const std::unique_ptr<ExprAST>& expr, float value)
+  -> bool {
+  return expr && expr->kind == ExprKind::FloatDTKind &&
+    static_cast<FloatExprAST&>(*expr).val == value;
+}
+
+/**
+ * @brief Check if the variable `name` is used in the expression.
+ *
+ * Shadowing is ignored, so it can return true for an unused variable.
+ */
+static auto is_referenced(ExprAST* expr, const std::string& name) -> bool {
+  if (!expr) {
+    return false;
+  }
+
+  switch (expr->kind) {
+    case ExprKind::VariableKind:
+      return static_cast<VariableExprAST*>(expr)->name == name;
+    case ExprKind::UnaryOpKind:
+      return is_referenced(
+        static_cast<UnaryExprAST*>(expr)->operand.get(), name);
+    case ExprKind::BinaryOpKind: {
+      auto binary = static_cast<BinaryExprAST*>(expr);
+      return is_referenced(binary->lhs.get(), name) ||
+        is_referenced(binary->rhs.get(), name);
+    }
+    case ExprKind::CallKind: {
+      for (auto& arg : static_cast<CallExprAST*>(expr)->args) {
+        if (is_referenced(arg.get(), name)) {
+          return true;
+        }
+      }
+      return false;
+    }
+    case ExprKind::IfKind: {
+      auto if_expr = static_cast<IfExprAST*>(expr);
+      return is_referenced(if_expr->cond.get(), name) ||
+        is_referenced(if_expr->then.get(), name) ||
+        is_referenced(if_expr->else_.get(), name);
+    }
+    case ExprKind::ForKind: {
+      auto for_expr = static_cast<ForExprAST*>(expr);
+      return is_referenced(for_expr->start.get(), name) ||
+        is_referenced(for_expr->end.get(), name) ||
+        is_referenced(for_expr->step.get(), name) ||
+        is_referenced(for_expr->body.get(), name);
+    }
+    case ExprKind::VarKind: {
+      auto var_expr = static_cast<VarExprAST*>(expr);
+      for (auto& var : var_expr->var_names) {
+        if (is_referenced(var.second.get(), name)) {
+          return true;
+        }
+      }
+      return is_referenced(var_expr->body.get(), name);
+    }
+    case ExprKind::ConstKind: {
+      auto const_expr = static_cast<ConstExprAST*>(expr);
+      for (auto& constant : const_expr->const_names) {
+        if (is_referenced(constant.second.get(), name)) {
+          return true;
+        }
+      }
+      return is_referenced(const_expr->body.get(), name);
+    }
+    case ExprKind::AccessKind: {
+      auto access = static_cast<AccessExprAST*>(expr);
+      return is_referenced(access->base.get(), name) ||
+        is_referenced(access->index.get(), name);
+    }
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Check if evaluating the expression has no side effects.
+ *
+ * Calls, assignments, loops and the user defined operators can have side
+ * effects.
+ */
+static auto is_pure(ExprAST* expr) -> bool {
+  if (!expr) {
+    return true;
+  }
+
+  switch (expr->kind) {
+    case ExprKind::FloatDTKind:
+    case ExprKind::StringDTKind:
+    case ExprKind::VariableKind:
+      return true;
+    case ExprKind::BinaryOpKind: {
+      auto binary = static_cast<BinaryExprAST*>(expr);
+      switch (binary->op) {
+        case '+':
+        case '-':
+        case '*':
+        case '<':
+          return is_pure(binary->lhs.get()) && is_pure(binary->rhs.get());
+        default:
+          return false;
+      }
+    }
+    case ExprKind::IfKind: {
+      auto if_expr = static_cast<IfExprAST*>(expr);
+      return is_pure(if_expr->cond.get()) && is_pure(if_expr->then.get()) &&
+        is_pure(if_expr->else_.get());
+    }
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Fold the operators on float or string literals.
+ *
+ */
+auto ConstantFoldingPass::visit(BinaryExprAST& expr) -> void {
+  ASTPass::visit(expr);
+
+  if (
+    expr.lhs->kind == ExprKind::FloatDTKind &&
+    expr.rhs->kind == ExprKind::FloatDTKind) {
+    float lhs = static_cast<FloatExprAST&>(*expr.lhs).val;
+    float rhs = static_cast<FloatExprAST&>(*expr.rhs).val;
+
+    switch (expr.op) {
+      case '+':
+        this->result = std::make_unique<FloatExprAST>(lhs + rhs);
+        break;
+      case '-':
+        this->result = std::make_unique<FloatExprAST>(lhs - rhs);
+        break;
+      case '*':
+        this->result = std::make_unique<FloatExprAST>(lhs * rhs);
+        break;
+      case '<':
+        // unordered, like the `fcmp ult` emitted for the operator
+        this->result =
+          std::make_unique<FloatExprAST>(!(lhs >= rhs) ? 1.0f : 0.0f);
+        break;
+    }
+  } else if (
+    expr.lhs->kind == ExprKind::StringDTKind &&
+    expr.rhs->kind == ExprKind::StringDTKind) {
+    const std::string& lhs = static_cast<StringExprAST&>(*expr.lhs).val;
+    const std::string& rhs = static_cast<StringExprAST&>(*expr.rhs).val;
+
+    switch (expr.op) {
+      case '+':
+        this->result = std::make_unique<StringExprAST>(lhs + rhs);
+        break;
+      case '<':
+        this->result = std::make_unique<FloatExprAST>(lhs < rhs ? 1.0f : 0.0f);
+        break;
+    }
+  }
+
+  if (this->result) {
+    this->result->loc = expr.loc;
+    ++this->changes;
+  }
+}
+
+/**
+ * @brief Keep just the branch selected by a literal condition.
+ *
+ * The value takes the type of the selected branch, instead of the type of
+ * the `then` branch.
+ */
+auto DeadBranchEliminationPass::visit(IfExprAST& expr) -> void {
+  ASTPass::visit(expr);
+
+  if (expr.cond->kind != ExprKind::FloatDTKind) {
+    return;
+  }
+
+  if (static_cast<FloatExprAST&>(*expr.cond).val != 0.0f) {
+    this->result = std::move(expr.then);
+  } else {
+    this->result = std::move(expr.else_);
+  }
+  ++this->changes;
+}
+
+/**
+ * @brief Check if the expression is known to be a float.
+ *
+ */
+auto AlgebraicSimplificationPass::is_float(ExprAST* expr) -> bool {
+  if (!expr) {
+    return false;
+  }
+
+  switch (expr->kind) {
+    case ExprKind::FloatDTKind:
+      return true;
+    case ExprKind::VariableKind: {
+      auto it =
+        this->var_types.find(static_cast<VariableExprAST*>(expr)->name);
+      return it != this->var_types.end() && it->second == "float";
+    }
+    case ExprKind::BinaryOpKind: {
+      auto binary = static_cast<BinaryExprAST*>(expr);
+      switch (binary->op) {
+        case '+':
+        case '-':
+        case '*':
+        case '<':
+          return this->is_float(binary->lhs.get()) &&
+            this->is_float(binary->rhs.get());
+        default:
+          return false;
+      }
+    }
+    case ExprKind::IfKind: {
+      auto if_expr = static_cast<IfExprAST*>(expr);
+      return this->is_float(if_expr->then.get()) &&
+        this->is_float(if_expr->else_.get());
+    }
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Replace the identities by their operand.
+ *
+ */
+auto AlgebraicSimplificationPass::visit(BinaryExprAST& expr) -> void {
+  ASTPass::visit(expr);
+
+  switch (expr.op) {
+    case '*':
+      if (is_float_literal(expr.rhs, 1.0f) && this->is_float(expr.lhs.get())) {
+        this->result = std::move(expr.lhs);
+      } else if (
+        is_float_literal(expr.lhs, 1.0f) && this->is_float(expr.rhs.get())) {
+        this->result = std::move(expr.rhs);
+      }
+      break;
+    case '+':
+      if (!this->no_signed_zeros) {
+        break;
+      }
+      if (is_float_literal(expr.rhs, 0.0f) && this->is_float(expr.lhs.get())) {
+        this->result = std::move(expr.lhs);
+      } else if (
+        is_float_literal(expr.lhs, 0.0f) && this->is_float(expr.rhs.get())) {
+        this->result = std::move(expr.rhs);
+      }
+      break;
+    case '-':
+      if (is_float_literal(expr.rhs, 0.0f) && this->is_float(expr.lhs.get())) {
+        this->result = std::move(expr.lhs);
+      }
+      break;
+  }
+
+  if (this->result) {
+    ++this->changes;
+  }
+}
+
+/**
+ * @brief Bind the variable of the loop, a float, in its body.
+ *
+ */
+auto AlgebraicSimplificationPass::visit(ForExprAST& expr) -> void {
+  std::map<std::string, std::string> outer_types = this->var_types;
+  this->transform(expr.start);
+  this->var_types[expr.var_name] = "float";
+  this->transform(expr.end);
+  this->transform(expr.step);
+  this->transform(expr.body);
+  this->var_types = std::move(outer_types);
+}
+
+/**
+ * @brief Bind the variables, in order, with their annotation or the type
+ *        of their initializer (float without initializer).
+ *
+ */
+auto AlgebraicSimplificationPass::visit(VarExprAST& expr) -> void {
+  std::map<std::string, std::string> outer_types = this->var_types;
+  for (size_t i = 0; i < expr.var_names.size(); ++i) {
+    auto& var = expr.var_names[i];
+    this->transform(var.second);
+    std::string type_name = expr.type_names[i];
+    if (type_name.empty()) {
+      bool is_float = !var.second || this->is_float(var.second.get());
+      type_name = is_float ? "float" : "";
+    }
+    this->var_types[var.first] = type_name;
+  }
+  this->transform(expr.body);
+  this->var_types = std::move(outer_types);
+}
+
+/**
+ * @brief Bind the constants, in order, with their annotation or the type
+ *        of their value.
+ *
+ */
+auto AlgebraicSimplificationPass::visit(ConstExprAST& expr) -> void {
+  std::map<std::string, std::string> outer_types = this->var_types;
+  for (size_t i = 0; i < expr.const_names.size(); ++i) {
+    auto& constant = expr.const_names[i];
+    this->transform(constant.second);
+    std::string type_name = expr.type_names[i];
+    if (type_name.empty() && this->is_float(constant.second.get())) {
+      type_name = "float";
+    }
+    this->var_types[constant.first] = type_name;
+  }
+  this->transform(expr.body);
+  this->var_types = std::move(outer_types);
+}
+
+/**
+ * @brief Bind the arguments and read the fast-math flags of the function.
+ *
+ */
+auto AlgebraicSimplificationPass::visit(FunctionAST& expr) -> void {
+  this->var_types.clear();
+  for (auto& arg : expr.proto->args) {
+    this->var_types[arg->name] = arg->type_name;
+  }
+  this->no_signed_zeros =
+    ArxFPMode::get_flags(*expr.proto).noSignedZeros();
+  ASTPass::visit(expr);
+}
+
+/**
+ * @brief Remove the unused bindings, starting from the last one, so the
+ *        bindings used only by removed initializers are removed too.
+ *
+ */
+auto UnusedVarEliminationPass::visit(VarExprAST& expr) -> void {
+  ASTPass::visit(expr);
+
+  for (size_t i = expr.var_names.size(); i-- > 0;) {
+    const std::string& var_name = expr.var_names[i].first;
+
+    bool is_used = is_referenced(expr.body.get(), var_name);
+    for (size_t j = i + 1; j < expr.var_names.size() && !is_used; ++j) {
+      is_used = is_referenced(expr.var_names[j].second.get(), var_name);
+    }
+
+    if (is_used || !is_pure(expr.var_names[i].second.get())) {
+      continue;
+    }
+
+    expr.var_names.erase(expr.var_names.begin() + i);
+    expr.type_names.erase(expr.type_names.begin() + i);
+    ++this->changes;
+  }
+
+  if (expr.var_names.empty() && expr.body) {
+    this->result = std::move(expr.body);
+  }
+}
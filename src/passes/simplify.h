@@ -0,0 +1,78 @@
+#pragma once
+
+#include <map>     // for map
+#include <string>  // for string
+
+#include "parser.h"               // for BinaryExprAST, IfExprAST, VarExprAST
+#include "passes/pass-manager.h"  // for ASTPass
+
+/**
+ * @brief Replace the builtin operators on literals by their result.
+ *
+ * Float operations use the float arithmetic, like the generated code, and
+ * the string literals are concatenated and compared.
+ */
+class ConstantFoldingPass : public ASTPass {
+ public:
+  ConstantFoldingPass() : ASTPass("constant-folding") {}
+
+  using ASTPass::visit;
+  virtual void visit(BinaryExprAST&) override;
+};
+
+/**
+ * @brief Replace `if` expressions with a literal condition by a branch.
+ *
+ */
+class DeadBranchEliminationPass : public ASTPass {
+ public:
+  DeadBranchEliminationPass() : ASTPass("dead-branch-elimination") {}
+
+  using ASTPass::visit;
+  virtual void visit(IfExprAST&) override;
+};
+
+/**
+ * @brief Remove the identities `x * 1`, `1 * x`, `x - 0`, and `x + 0` and
+ *        `0 + x` when the signed zeros can be ignored (`-0 + 0` is `+0`).
+ *
+ * `x` should be known to be a float (e.g. not a decimal, whose scale
+ * depends on the literal): a float literal, a variable without type
+ * annotation or annotated `float`, or the builtin operators and `if` on
+ * them. The signed zeros are ignored with `@fastmath` or `--ffast-math`
+ * (see ArxFPMode).
+ */
+class AlgebraicSimplificationPass : public ASTPass {
+ public:
+  AlgebraicSimplificationPass() : ASTPass("algebraic-simplification") {}
+
+  using ASTPass::visit;
+  virtual void visit(BinaryExprAST&) override;
+  virtual void visit(ForExprAST&) override;
+  virtual void visit(VarExprAST&) override;
+  virtual void visit(ConstExprAST&) override;
+  virtual void visit(FunctionAST&) override;
+
+ private:
+  // type of the variables in scope, empty when it is not known
+  std::map<std::string, std::string> var_types;
+  // the fast-math flags of the function ignore the signed zeros
+  bool no_signed_zeros = false;
+
+  auto is_float(ExprAST* expr) -> bool;
+};
+
+/**
+ * @brief Remove the `var` bindings that are never used.
+ *
+ * A binding is kept when its initializer can have side effects (e.g. a
+ * call), and the `var` expression is replaced by its body when no binding
+ * is left.
+ */
+class UnusedVarEliminationPass : public ASTPass {
+ public:
+  UnusedVarEliminationPass() : ASTPass("unused-var-elimination") {}
+
+  using ASTPass::visit;
+  virtual void visit(VarExprAST&) override;
+};
@@ -0,0 +1,187 @@
+#include "time-report.h"  // for ArxTimeReport, ArxPhaseTime
+#include <chrono>         // for steady_clock, duration
+#include <cstddef>        // for size_t
+#include <memory>         // for unique_ptr, make_unique
+#include <string>         // for string
+#include <utility>        // for move
+#include <vector>         // for vector
+
+#include <llvm/IR/PassTimingInfo.h>     // for TimePassesHandler
+#include <llvm/Pass.h>                  // for TimePassesIsEnabled
+#include <llvm/Support/Error.h>         // for Error, toString
+#include <llvm/Support/Format.h>        // for format
+#include <llvm/Support/TimeProfiler.h>  // for timeTraceProfilerBegin
+#include <llvm/Support/raw_ostream.h>   // for raw_ostream, errs
+
+#include "utils.h"  // for indent
+
+bool ArxTimeReport::enabled = false;
+std::string ArxTimeReport::trace_path = "";
+std::vector<ArxPhaseTime> ArxTimeReport::phases;
+
+/**
+ * @brief A phase that is running: its index in ArxTimeReport::phases and
+ *        its start.
+ *
+ */
+struct OpenPhase {
+  size_t index;
+  std::chrono::steady_clock::time_point start;
+};
+
+static std::vector<OpenPhase> open_phases;
+
+// the time of the LLVM passes of the new pass manager
+static std::unique_ptr<llvm::TimePassesHandler> pass_timer;
+
+/**
+ * @brief Check if the phases are timed (--time-report or --time-trace).
+ *
+ */
+auto ArxTimeReport::is_enabled() -> bool {
+  return ArxTimeReport::enabled || !ArxTimeReport::trace_path.empty();
+}
+
+/**
+ * @brief Clear the phases and start the timers of LLVM, before compiling.
+ *
+ * The trace keeps all the events (granularity of 0 microseconds).
+ */
+auto ArxTimeReport::start() -> void {
+  ArxTimeReport::phases.clear();
+  open_phases.clear();
+
+  // the backend runs in the legacy pass manager, with its own timers
+  llvm::TimePassesIsEnabled = ArxTimeReport::enabled;
+  if (ArxTimeReport::enabled && !pass_timer) {
+    pass_timer = std::make_unique<llvm::TimePassesHandler>(true);
+  }
+
+  if (
+    !ArxTimeReport::trace_path.empty() && !llvm::timeTraceProfilerEnabled()) {
+    llvm::timeTraceProfilerInitialize(0, "arx");
+  }
+}
+
+/**
+ * @brief Begin a phase, inside the phases that are running.
+ *
+ */
+auto ArxTimeReport::begin(const std::string& name) -> void {
+  if (!ArxTimeReport::is_enabled()) {
+    return;
+  }
+
+  int depth = static_cast<int>(open_phases.size());
+  ArxTimeReport::phases.push_back({name, depth, 0});
+  open_phases.push_back(
+    {ArxTimeReport::phases.size() - 1, std::chrono::steady_clock::now()});
+
+  if (llvm::timeTraceProfilerEnabled()) {
+    llvm::timeTraceProfilerBegin(name, "");
+  }
+}
+
+/**
+ * @brief End the last phase that began.
+ *
+ */
+auto ArxTimeReport::end() -> void {
+  if (!ArxTimeReport::is_enabled() || open_phases.empty()) {
+    return;
+  }
+
+  OpenPhase open_phase = open_phases.back();
+  open_phases.pop_back();
+  std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now() - open_phase.start;
+  ArxTimeReport::phases[open_phase.index].time_ms = elapsed.count();
+
+  if (llvm::timeTraceProfilerEnabled()) {
+    llvm::timeTraceProfilerEnd();
+  }
+}
+
+/**
+ * @brief Add time to a phase inside the last phase that began, e.g. the
+ *        time of a token to `lex`.
+ *
+ * The time outside of the phases is not reported.
+ */
+auto ArxTimeReport::add(const std::string& name, double time_ms) -> void {
+  if (!ArxTimeReport::is_enabled() || open_phases.empty()) {
+    return;
+  }
+
+  // the phase is usually the last one
+  size_t parent = open_phases.back().index;
+  int depth = static_cast<int>(open_phases.size());
+  auto& phases = ArxTimeReport::phases;
+  for (size_t i = phases.size() - 1; i > parent; --i) {
+    if (phases[i].depth == depth && phases[i].name == name) {
+      phases[i].time_ms += time_ms;
+      return;
+    }
+  }
+  phases.push_back({name, depth, time_ms});
+}
+
+/**
+ * @brief Time the passes run with the callbacks (see PassBuilder).
+ *
+ */
+auto ArxTimeReport::register_callbacks(
+  llvm::PassInstrumentationCallbacks& pic) -> void {
+  if (pass_timer) {
+    pass_timer->registerCallbacks(pic);
+  }
+}
+
+/**
+ * @brief Print the time of each phase, indented inside its parent, and the
+ *        time of the LLVM passes.
+ *
+ */
+auto ArxTimeReport::print(llvm::raw_ostream& out) -> void {
+  double total_ms = 0;
+  for (auto& phase : ArxTimeReport::phases) {
+    total_ms += phase.depth == 0 ? phase.time_ms : 0;
+  }
+
+  out << "===== Compiler phases =====\n";
+  out << "  Time (ms)       %  Phase\n";
+  for (auto& phase : ArxTimeReport::phases) {
+    double percent = total_ms > 0 ? 100 * phase.time_ms / total_ms : 0;
+    out << llvm::format("%11.3f %6.1f%%  ", phase.time_ms, percent);
+    indent(out, 2 * phase.depth) << phase.name << "\n";
+  }
+  out << llvm::format("%11.3f %6.1f%%  Total\n", total_ms, 100.0);
+
+  // the handler prints its report when it is destroyed
+  if (pass_timer) {
+    pass_timer->setOutStream(out);
+    pass_timer.reset();
+  }
+  llvm::reportAndResetTimings(&out);
+}
+
+/**
+ * @brief Write the trace to ArxTimeReport::trace_path, if it is set.
+ * @return false if the file can't be written.
+ */
+auto ArxTimeReport::write_trace() -> bool {
+  if (!llvm::timeTraceProfilerEnabled()) {
+    return true;
+  }
+
+  llvm::Error error =
+    llvm::timeTraceProfilerWrite(ArxTimeReport::trace_path, "arx");
+  llvm::timeTraceProfilerCleanup();
+  if (error) {
+    llvm::errs() << "ARX[FAIL]: Could not write the trace "
+                 << ArxTimeReport::trace_path << ": "
+                 << llvm::toString(std::move(error)) << "\n";
+    return false;
+  }
+  return true;
+}
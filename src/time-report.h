@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>  // for string
+#include <vector>  // for vector
+
+namespace llvm {
+  class PassInstrumentationCallbacks;
+  class raw_ostream;
+}  // namespace llvm
+
+/**
+ * @brief Time of a phase of the compiler.
+ *
+ */
+struct ArxPhaseTime {
+  std::string name;
+  // number of enclosing phases
+  int depth;
+  // total time of the phase, in milliseconds
+  double time_ms;
+};
+
+/**
+ * @brief Time of the phases of the compiler.
+ *
+ * The phases are nested: `input`, `parse` (with `lex`), `ast-passes` (with
+ * each pass), `ir-gen`, `optimization`, `codegen` and `link` (with `lto`).
+ *
+ *   arx --input kernel.arx --time-report
+ *   arx --input kernel.arx --time-trace=kernel.json
+ *
+ * `--time-report` prints a table of the phases to stderr, followed by the
+ * time of each LLVM pass (TimePassesHandler for the optimization pipeline,
+ * the timers of the legacy pass manager for the backend). `--time-trace`
+ * writes the phases and the LLVM passes as Chrome trace events, for
+ * chrome://tracing or https://ui.perfetto.dev.
+ *
+ * The lexer runs inside the parser, token by token, so `lex` is the sum of
+ * the time of the tokens: it is only in the table, not in the trace.
+ * Without these options `begin` and `end` return immediately.
+ */
+class ArxTimeReport {
+ public:
+  // --time-report
+  static bool enabled;
+  // --time-trace, the output file of the trace
+  static std::string trace_path;
+  // the phases in the order of their beginning
+  static std::vector<ArxPhaseTime> phases;
+
+  static auto is_enabled() -> bool;
+  static auto start() -> void;
+  static auto begin(const std::string& name) -> void;
+  static auto end() -> void;
+  static auto add(const std::string& name, double time_ms) -> void;
+  static auto register_callbacks(llvm::PassInstrumentationCallbacks& pic)
+    -> void;
+  static auto print(llvm::raw_ostream& out) -> void;
+  static auto write_trace() -> bool;
+};
+
+/**
+ * @brief Time a phase until the end of the scope.
+ *
+ */
+class ArxPhase {
+ public:
+  explicit ArxPhase(const std::string& name) {
+    ArxTimeReport::begin(name);
+  }
+  ~ArxPhase() {
+    ArxTimeReport::end();
+  }
+};
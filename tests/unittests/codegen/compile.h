@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+
+/**
+ * @brief Generate the code for the source in ArxLLVM::module.
+ *
+ * The visitor is a template parameter, so the `initialize` of the visitor
+ * itself is called (e.g. ASTToLLVMIRVisitor).
+ */
+template <typename Codegen>
+auto compile(Codegen& codegen, const char* source) -> void {
+  Parser::setup();
+  string_to_buffer((char*) source);
+  Lexer::reset();
+  auto ast = Parser::parse();
+
+  codegen.initialize();
+  codegen.main_loop(*ast);
+}
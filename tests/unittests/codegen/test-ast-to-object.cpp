@@ -1,8 +1,12 @@
 #include <gtest/gtest.h>
 #include <memory>
 
+#include "../src/codegen/ast-to-jit.h"
 #include "../src/codegen/ast-to-object.h"
 #include "../src/io.h"
+#include "../src/parser.h"
+
+#include "compile.h"
 
 extern bool IS_BUILD_LIB;
 
@@ -19,3 +23,56 @@ TEST(CodeGenTest, ObjectGeneration) {
   IS_BUILD_LIB = true;
   compile_object(*ast);
 }
+
+// A program needs a `main` function, the entry point of the runtime calls it
+TEST(CodeGenTest, ProgramWithoutMain) {
+  string_to_buffer((char*) R""""(
+  fn add_one(a):
+    a + 1
+  )"""");
+
+  auto ast = std::make_unique<TreeAST>(TreeAST());
+  IS_BUILD_LIB = false;
+  EXPECT_EQ(compile_object(*ast), 1);
+  IS_BUILD_LIB = true;
+}
+
+// The runtime calls the `main` of a program as `float arx_main()`
+TEST(CodeGenTest, ProgramWithoutFloatMain) {
+  string_to_buffer((char*) R""""(
+  fn main() -> string:
+    "hello"
+  )"""");
+
+  auto ast = std::make_unique<TreeAST>(TreeAST());
+  IS_BUILD_LIB = false;
+  EXPECT_EQ(compile_object(*ast), 1);
+  IS_BUILD_LIB = true;
+}
+
+// Check that a decimal256 is rescaled without a 256-bit division, which the
+// backend can't lower (decimal128(20, 2) * decimal128(20, 2) is a
+// decimal256(41, 4))
+TEST(CodeGenTest, Decimal256Rescale) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  fn product(a: decimal128(20, 2), b: decimal128(20, 2)) -> decimal128(20, 2):
+    a * b
+  )"""");
+
+  codegen.add_module();
+  auto fn = reinterpret_cast<__int128 (*)(__int128, __int128)>(
+    codegen.lookup("product"));
+  ASSERT_NE(fn, nullptr);
+
+  // 1.25 * 2.50 = 3.125, rounded half away from zero
+  EXPECT_EQ(fn(125, 250), 313);
+  EXPECT_EQ(fn(-125, 250), -313);
+  EXPECT_EQ(fn(125, -250), -313);
+  EXPECT_EQ(fn(0, 250), 0);
+
+  // 10^15 * 10^15 = 10^30, the product spans several limbs
+  __int128 big = static_cast<__int128>(100000000000000000LL);
+  EXPECT_EQ(fn(big, big), big * big / 100);
+  EXPECT_EQ(fn(-big, big), -(big * big / 100));
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <memory>
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/codegen/const-eval.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+/**
+ * @brief Generate the code for the source in ArxLLVM::module, with a JIT
+ *        visitor that isn't kept.
+ *
+ */
+static auto compile(const char* source) -> void {
+  ASTToJITVisitor codegen;
+  compile(codegen, source);
+}
+
+/**
+ * @brief Get the constant returned by the function, or nullptr if it
+ *        doesn't return a constant.
+ */
+static auto get_return_constant(const char* name) -> llvm::ConstantFP* {
+  llvm::Function* fn = ArxLLVM::module->getFunction(name);
+  if (!fn) {
+    return nullptr;
+  }
+
+  for (llvm::BasicBlock& block : *fn) {
+    for (llvm::Instruction& inst : block) {
+      if (auto ret = llvm::dyn_cast<llvm::ReturnInst>(&inst)) {
+        return llvm::dyn_cast<llvm::ConstantFP>(ret->getReturnValue());
+      }
+    }
+  }
+  return nullptr;
+}
+
+// Check that the calls to pure functions are evaluated while compiling
+TEST(ConstEvalTest, PureFunctions) {
+  compile(R""""(
+  extern printd(x)
+
+  fn fib(x):
+    if x < 3:
+      1
+    else:
+      fib(x - 1) + fib(x - 2)
+
+  fn sum_to(n):
+    var total = 0 in
+      (for i = 1, i < n in
+        total = total + i) + total
+
+  fn log_fib(x):
+    printd(fib(x))
+
+  fn fib_10():
+    fib(10)
+
+  fn sum_100():
+    sum_to(2 * 50)
+
+  fn log_fib_10():
+    log_fib(10)
+  )"""");
+
+  auto proto = ArxLLVM::function_protos.find("fib");
+  ASSERT_NE(proto, ArxLLVM::function_protos.end());
+  EXPECT_TRUE(proto->second->is_pure);
+  EXPECT_FALSE(ArxLLVM::function_protos["log_fib"]->is_pure);
+
+  llvm::ConstantFP* value = get_return_constant("fib_10");
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(value->getValueAPF().convertToFloat(), 55.0f);
+
+  value = get_return_constant("sum_100");
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(value->getValueAPF().convertToFloat(), 5050.0f);
+
+  // printd has side effects, so it is still called
+  EXPECT_EQ(get_return_constant("log_fib_10"), nullptr);
+}
+
+// Check that the call is generated when the evaluation is over the budget
+TEST(ConstEvalTest, Budget) {
+  int64_t max_steps = ArxConstEval::max_steps;
+  ArxConstEval::max_steps = 100;
+
+  compile(R""""(
+  fn forever(x):
+    forever(x + 1)
+
+  fn slow_fib(x):
+    if x < 3:
+      1
+    else:
+      slow_fib(x - 1) + slow_fib(x - 2)
+
+  fn call_forever():
+    forever(1)
+
+  fn slow_fib_20():
+    slow_fib(20)
+
+  fn slow_fib_3():
+    slow_fib(3)
+  )"""");
+
+  ArxConstEval::max_steps = max_steps;
+
+  EXPECT_EQ(get_return_constant("call_forever"), nullptr);
+  EXPECT_EQ(get_return_constant("slow_fib_20"), nullptr);
+
+  llvm::ConstantFP* value = get_return_constant("slow_fib_3");
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(value->getValueAPF().convertToFloat(), 2.0f);
+}
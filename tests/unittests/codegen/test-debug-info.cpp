@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+#include <llvm/IR/DebugInfoMetadata.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-llvm-ir.h"
+#include "../src/codegen/debug-info.h"
+#include "../src/io.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+/**
+ * @brief Generate the code of the source with the debug information of the
+ *        level.
+ *
+ */
+static auto compile_scale(
+  ASTToLLVMIRVisitor& codegen, const std::string& level) -> void {
+  ArxDebugInfo::level = level;
+  INPUT_FILE = "/tmp/kernels/scale.arx";
+  compile(codegen, R""""(
+  fn scale(x, y):
+    x * y + 1
+  )"""");
+  ArxDebugInfo::finalize();
+  ArxDebugInfo::level = "none";
+  INPUT_FILE = "";
+}
+
+// Check that the code has no debug information by default
+TEST(DebugInfoTest, None) {
+  ASTToLLVMIRVisitor codegen;
+  compile_scale(codegen, "none");
+
+  EXPECT_EQ(codegen.llvm_di_compile_unit, nullptr);
+  EXPECT_EQ(ArxLLVM::di_builder, nullptr);
+  EXPECT_EQ(ArxLLVM::module->getNamedMetadata("llvm.dbg.cu"), nullptr);
+
+  llvm::Function* fn = ArxLLVM::module->getFunction("scale");
+  ASSERT_NE(fn, nullptr);
+  EXPECT_EQ(fn->getSubprogram(), nullptr);
+  for (auto& block : *fn) {
+    for (auto& inst : block) {
+      EXPECT_FALSE(inst.getDebugLoc());
+    }
+  }
+}
+
+// Check the lines of the functions, without the types and the variables
+TEST(DebugInfoTest, LineTablesOnly) {
+  ASTToLLVMIRVisitor codegen;
+  compile_scale(codegen, "line-tables-only");
+
+  ASSERT_NE(codegen.llvm_di_compile_unit, nullptr);
+  EXPECT_EQ(
+    codegen.llvm_di_compile_unit->getEmissionKind(),
+    llvm::DICompileUnit::LineTablesOnly);
+  EXPECT_EQ(codegen.llvm_di_compile_unit->getFilename(), "scale.arx");
+  EXPECT_EQ(codegen.llvm_di_compile_unit->getDirectory(), "/tmp/kernels");
+
+  llvm::Function* fn = ArxLLVM::module->getFunction("scale");
+  ASSERT_NE(fn, nullptr);
+  ASSERT_NE(fn->getSubprogram(), nullptr);
+  EXPECT_GT(fn->getSubprogram()->getLine(), 0);
+  EXPECT_EQ(fn->getSubprogram()->getType()->getTypeArray().size(), 0);
+  EXPECT_EQ(ArxLLVM::module->getFunction("llvm.dbg.declare"), nullptr);
+  EXPECT_FALSE(llvm::verifyModule(*ArxLLVM::module, &llvm::errs()));
+}
+
+// Check the types and the arguments of the functions
+TEST(DebugInfoTest, Full) {
+  ASTToLLVMIRVisitor codegen;
+  compile_scale(codegen, "full");
+
+  ASSERT_NE(codegen.llvm_di_compile_unit, nullptr);
+  EXPECT_EQ(
+    codegen.llvm_di_compile_unit->getEmissionKind(),
+    llvm::DICompileUnit::FullDebug);
+
+  llvm::Function* fn = ArxLLVM::module->getFunction("scale");
+  ASSERT_NE(fn, nullptr);
+  ASSERT_NE(fn->getSubprogram(), nullptr);
+  // the result and the two arguments
+  EXPECT_EQ(fn->getSubprogram()->getType()->getTypeArray().size(), 3);
+  EXPECT_NE(ArxLLVM::module->getFunction("llvm.dbg.declare"), nullptr);
+  EXPECT_FALSE(llvm::verifyModule(*ArxLLVM::module, &llvm::errs()));
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <string>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/ModuleSummaryIndex.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/codegen/emit.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+/**
+ * @brief Generate the code of a module and write it with ArxEmit.
+ * @return The path of the file.
+ */
+static auto emit(ASTToJITVisitor& codegen, const std::string& kind)
+  -> std::string {
+  compile(codegen, R""""(
+  fn square(x):
+    x * x
+
+  fn cube(x):
+    square(x) * x
+  )"""");
+
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+  auto machine = ArxLLVM::exit_on_err(
+    ArxLLVM::exit_on_err(llvm::orc::JITTargetMachineBuilder::detectHost())
+      .createTargetMachine());
+  ArxLLVM::module->setTargetTriple(machine->getTargetTriple().str());
+  ArxLLVM::module->setDataLayout(machine->createDataLayout());
+
+  ArxEmit::kind = kind;
+  llvm::SmallString<128> path;
+  EXPECT_FALSE(llvm::sys::fs::createTemporaryFile(
+    "arx-emit", ArxEmit::get_extension().substr(1), path));
+  EXPECT_TRUE(ArxEmit::write(*ArxLLVM::module, machine.get(), path.c_str()));
+  ArxEmit::kind = "obj";
+  return std::string(path);
+}
+
+/**
+ * @brief Read a text file.
+ *
+ */
+static auto read_file(const std::string& path) -> std::string {
+  std::ifstream file(path);
+  return std::string(
+    std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Check the textual IR and the assembly
+TEST(EmitTest, Text) {
+  ASTToJITVisitor codegen;
+
+  std::string ir_path = emit(codegen, "llvm-ir");
+  llvm::LLVMContext context;
+  llvm::SMDiagnostic diagnostic;
+  auto module = llvm::parseIRFile(ir_path, diagnostic, context);
+  ASSERT_NE(module, nullptr);
+  EXPECT_NE(module->getFunction("cube"), nullptr);
+  llvm::sys::fs::remove(ir_path);
+
+  std::string asm_path = emit(codegen, "asm");
+  std::string text = read_file(asm_path);
+  EXPECT_NE(text.find("square:"), std::string::npos);
+  EXPECT_NE(text.find("cube:"), std::string::npos);
+  llvm::sys::fs::remove(asm_path);
+}
+
+// Check the lazy loading and the summary of the bitcode
+TEST(EmitTest, Bitcode) {
+  ASTToJITVisitor codegen;
+  std::string path = emit(codegen, "llvm-bc");
+
+  auto buffer = ArxLLVM::exit_on_err(
+    llvm::errorOrToExpected(llvm::MemoryBuffer::getFile(path)));
+  auto info =
+    ArxLLVM::exit_on_err(llvm::getBitcodeLTOInfo(buffer->getMemBufferRef()));
+  EXPECT_TRUE(info.HasSummary);
+
+  // the functions are read when they are materialized
+  llvm::LLVMContext context;
+  auto module = ArxLLVM::exit_on_err(
+    llvm::getLazyBitcodeModule(buffer->getMemBufferRef(), context));
+  llvm::Function* square = module->getFunction("square");
+  llvm::Function* cube = module->getFunction("cube");
+  ASSERT_NE(square, nullptr);
+  ASSERT_NE(cube, nullptr);
+  EXPECT_TRUE(cube->isMaterializable());
+  ArxLLVM::exit_on_err(cube->materialize());
+  EXPECT_FALSE(cube->empty());
+  EXPECT_TRUE(square->isMaterializable());
+
+  // the calls of the functions without their code
+  auto index = ArxLLVM::exit_on_err(
+    llvm::getModuleSummaryIndex(buffer->getMemBufferRef()));
+  auto summary = index->getGlobalValueSummary(
+    llvm::GlobalValue::getGUID("cube"), false);
+  ASSERT_NE(summary, nullptr);
+  EXPECT_EQ(llvm::cast<llvm::FunctionSummary>(summary)->calls().size(), 1);
+  llvm::sys::fs::remove(path);
+}
+
+// Check the symbols of the object
+TEST(EmitTest, Object) {
+  ASTToJITVisitor codegen;
+  std::string path = emit(codegen, "obj");
+
+  auto object =
+    ArxLLVM::exit_on_err(llvm::object::ObjectFile::createObjectFile(path));
+  std::set<std::string> names;
+  for (auto& symbol : object.getBinary()->symbols()) {
+    names.insert(ArxLLVM::exit_on_err(symbol.getName()).str());
+  }
+  EXPECT_EQ(names.count("square"), 1);
+  EXPECT_EQ(names.count("cube"), 1);
+  llvm::sys::fs::remove(path);
+}
+
+// Check the error of a file that can't be opened
+TEST(EmitTest, Errors) {
+  ASTToJITVisitor codegen;
+  codegen.initialize();
+  ArxEmit::kind = "llvm-ir";
+  EXPECT_FALSE(ArxEmit::write(
+    *ArxLLVM::module, nullptr, "/missing-directory/output.ll"));
+  ArxEmit::kind = "obj";
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+
+#include <llvm/IR/Module.h>
+
+#include "../src/arx-memory.h"
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/codegen/escape.h"
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+// Check the uses of an array that make it escape
+TEST(EscapeTest, Analysis) {
+  ASTToJITVisitor codegen;
+  codegen.initialize();
+  Parser::setup();
+  string_to_buffer((char*) R""""(
+  fn accesses(ps, i):
+    (ps[i].x = len(ps)) + ps[i + 1].y
+
+  fn extern_call(ps):
+    use(ps)
+
+  fn value(ps):
+    if ps[0].x: ps else: 0
+
+  fn index(ps):
+    ps[use(ps)]
+
+  fn hidden(ps):
+    (var ps = 1 in use(ps)) + (for ps = 0, ps < 1 in use(ps))
+
+  fn alias(ps):
+    var qs = ps in qs[0]
+  )"""");
+  Lexer::reset();
+  auto ast = Parser::parse();
+  ASSERT_EQ(ast->nodes.size(), 6);
+
+  auto body = [&](size_t i) {
+    return static_cast<FunctionAST&>(*ast->nodes[i]).body.get();
+  };
+  EXPECT_FALSE(ArxEscape::escapes(body(0), "ps"));
+  EXPECT_TRUE(ArxEscape::escapes(body(1), "ps"));
+  EXPECT_FALSE(ArxEscape::escapes(body(1), "qs"));
+  EXPECT_TRUE(ArxEscape::escapes(body(2), "ps"));
+  EXPECT_TRUE(ArxEscape::escapes(body(3), "ps"));
+  EXPECT_FALSE(ArxEscape::escapes(body(4), "ps"));
+  // a variable bound to the array is not tracked
+  EXPECT_TRUE(ArxEscape::escapes(body(5), "ps"));
+}
+
+// Check that the typical kernels don't use the heap
+TEST(EscapeTest, StackArrays) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  struct Particle: x, y, mass
+
+  fn total(ps: Particle[64]@soa):
+    sum(i = 0, len(ps), ps[i].mass * ps[i].x)
+
+  fn kernel(k):
+    var ps: Particle[64]@soa in
+      map(i = 0, 64, ps[i] = Particle(i, 0, k)) + total(ps)
+
+  fn in_loop(n):
+    sum(j = 0, n, var t: float[4] in (t[1] = t[1] + j))
+
+  fn recursive(n):
+    var t: float[2] in
+      (t[0] = n) + (if n < 1: 0 else: recursive(n - 1)) * 0 + t[0]
+  )"""");
+
+  EXPECT_EQ(ArxLLVM::module->getFunction("arx_alloc"), nullptr);
+
+  codegen.add_module();
+  using fn_t = float (*)(float);
+  auto kernel = reinterpret_cast<fn_t>(codegen.lookup("kernel"));
+  auto in_loop = reinterpret_cast<fn_t>(codegen.lookup("in_loop"));
+  auto recursive = reinterpret_cast<fn_t>(codegen.lookup("recursive"));
+  ASSERT_NE(kernel, nullptr);
+  ASSERT_NE(in_loop, nullptr);
+  ASSERT_NE(recursive, nullptr);
+
+  int64_t count = arx_alloc_count();
+  EXPECT_EQ(kernel(2), 4032.0f);
+  EXPECT_EQ(kernel(1), 2016.0f);
+  // the storage is zero filled in each iteration
+  EXPECT_EQ(in_loop(10), 45.0f);
+  // each call has its own storage
+  EXPECT_EQ(recursive(10), 20.0f);
+  EXPECT_EQ(arx_alloc_count(), count);
+}
+
+// Check that the arrays above the stack limit are allocated in the heap
+TEST(EscapeTest, HeapArrays) {
+  ASTToJITVisitor codegen;
+  ArxEscape::max_stack_size = 16;
+  compile(codegen, R""""(
+  fn small():
+    var t: float[4] in (t[3] = 2) + t[3]
+
+  fn large():
+    var t: float[8] in (t[7] = 2) + t[7]
+  )"""");
+  ArxEscape::max_stack_size = 64 * 1024;
+
+  codegen.add_module();
+  using fn_t = float (*)();
+  auto small = reinterpret_cast<fn_t>(codegen.lookup("small"));
+  auto large = reinterpret_cast<fn_t>(codegen.lookup("large"));
+  ASSERT_NE(small, nullptr);
+  ASSERT_NE(large, nullptr);
+
+  int64_t count = arx_alloc_count();
+  EXPECT_EQ(small(), 4.0f);
+  EXPECT_EQ(arx_alloc_count(), count);
+  EXPECT_EQ(large(), 4.0f);
+  EXPECT_EQ(large(), 4.0f);
+  EXPECT_EQ(arx_alloc_count(), count + 2);
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instruction.h>
+#include <llvm/IR/Metadata.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetOptions.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/codegen/fp-mode.h"
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+/**
+ * @brief Get the floating-point addition of a function.
+ *
+ */
+static auto get_fadd(const char* name) -> llvm::Instruction* {
+  llvm::Function* fn = ArxLLVM::module->getFunction(name);
+  if (!fn) {
+    return nullptr;
+  }
+  for (auto& block : *fn) {
+    for (auto& inst : block) {
+      if (inst.getOpcode() == llvm::Instruction::FAdd) {
+        return &inst;
+      }
+    }
+  }
+  return nullptr;
+}
+
+// Check the parsing of the decorator
+TEST(FPModeTest, ParseDecorator) {
+  Parser::setup();
+  string_to_buffer((char*) R""""(
+  @fastmath
+  fn fast(x):
+    x
+
+  @fastmath(contract)
+  fn contract(x):
+    x
+
+  @memo
+  @fastmath(off)
+  fn strict(x):
+    x
+  )"""");
+  Lexer::reset();
+  auto ast = Parser::parse();
+
+  ASSERT_EQ(ast->nodes.size(), 3);
+  const char* fp_modes[] = {"fast", "contract", "strict"};
+  for (int i = 0; i < 3; ++i) {
+    auto& fn = static_cast<FunctionAST&>(*ast->nodes[i]);
+    EXPECT_EQ(fn.proto->fp_mode, fp_modes[i]);
+  }
+  auto& fn = static_cast<FunctionAST&>(*ast->nodes[2]);
+  EXPECT_GT(fn.proto->memo_capacity, 0);
+}
+
+// Check the flags of the decorated functions
+TEST(FPModeTest, FunctionFlags) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  @fastmath
+  fn fast(a, b, c):
+    a * b + c
+
+  @fastmath(contract)
+  fn contract(a, b, c):
+    a * b + c
+
+  fn strict(a, b, c):
+    a * b + c
+  )"""");
+
+  llvm::Instruction* fast = get_fadd("fast");
+  llvm::Instruction* contract = get_fadd("contract");
+  llvm::Instruction* strict = get_fadd("strict");
+  ASSERT_NE(fast, nullptr);
+  ASSERT_NE(contract, nullptr);
+  ASSERT_NE(strict, nullptr);
+
+  EXPECT_TRUE(fast->isFast());
+  EXPECT_TRUE(contract->hasAllowContract());
+  EXPECT_FALSE(contract->hasAllowReassoc());
+  EXPECT_FALSE(strict->getFastMathFlags().any());
+
+  auto unsafe_fp_math = [](const char* name) {
+    return ArxLLVM::module->getFunction(name)
+      ->getFnAttribute("unsafe-fp-math")
+      .getValueAsString()
+      .str();
+  };
+  EXPECT_EQ(unsafe_fp_math("fast"), "true");
+  EXPECT_EQ(unsafe_fp_math("strict"), "false");
+
+  codegen.add_module();
+  using fn_t = float (*)(float, float, float);
+  auto fast_fn = reinterpret_cast<fn_t>(codegen.lookup("fast"));
+  ASSERT_NE(fast_fn, nullptr);
+  EXPECT_EQ(fast_fn(2, 3, 4), 10.0f);
+}
+
+// Check that the decorator overrides the command line
+TEST(FPModeTest, CommandLine) {
+  ArxFPMode::fast_math = true;
+  ArxFPMode::fp_contract = "fast";
+
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  fn fast(a, b):
+    a + b
+
+  @fastmath(off)
+  fn strict(a, b):
+    a + b
+  )"""");
+
+  ArxFPMode::record(*ArxLLVM::module);
+  // the target machine doesn't fuse the operations of the strict function
+  llvm::TargetOptions options;
+  ArxFPMode::set_target_options(options);
+  ArxFPMode::fast_math = false;
+  ArxFPMode::fp_contract = "off";
+
+  llvm::Instruction* fast = get_fadd("fast");
+  llvm::Instruction* strict = get_fadd("strict");
+  ASSERT_NE(fast, nullptr);
+  ASSERT_NE(strict, nullptr);
+  EXPECT_TRUE(fast->isFast());
+  EXPECT_FALSE(strict->getFastMathFlags().any());
+  EXPECT_EQ(options.AllowFPOpFusion, llvm::FPOpFusion::Standard);
+
+  llvm::NamedMDNode* ident =
+    ArxLLVM::module->getNamedMetadata("llvm.ident");
+  ASSERT_NE(ident, nullptr);
+  ASSERT_EQ(ident->getNumOperands(), 1);
+  auto mode = llvm::cast<llvm::MDString>(ident->getOperand(0)->getOperand(0));
+  EXPECT_EQ(
+    mode->getString(),
+    "arx fp-mode: fast, fp-contract: fast, strict: strict");
+}
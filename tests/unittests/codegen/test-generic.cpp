@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <memory>
+
+#include <llvm/IR/Module.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/codegen/generic.h"
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+/**
+ * @brief Count the functions of the module with the prefix.
+ *
+ */
+static auto count_functions(const std::string& prefix) -> int {
+  int count = 0;
+  for (auto& fn : ArxLLVM::module->functions()) {
+    count += fn.getName().startswith(prefix) ? 1 : 0;
+  }
+  return count;
+}
+
+// Check the parsing of the type parameters
+TEST(GenericTest, Parse) {
+  Parser::setup();
+  string_to_buffer((char*) R""""(
+  fn first[T, U](xs: T[4], y: U) -> T:
+    var x: T = xs[0] in x
+
+  fn plain(x):
+    x
+  )"""");
+  Lexer::reset();
+  auto ast = Parser::parse();
+
+  ASSERT_EQ(ast->nodes.size(), 2);
+  auto& first = static_cast<FunctionAST&>(*ast->nodes[0]);
+  ASSERT_EQ(first.proto->type_params.size(), 2);
+  EXPECT_EQ(first.proto->type_params[1], "U");
+  EXPECT_EQ(first.proto->args[0]->type_name, "T[4]");
+  EXPECT_EQ(first.proto->type_name, "T");
+  ASSERT_EQ(first.body->kind, ExprKind::VarKind);
+  EXPECT_EQ(static_cast<VarExprAST&>(*first.body).type_names[0], "T");
+  EXPECT_TRUE(static_cast<FunctionAST&>(*ast->nodes[1]).proto->type_params
+                .empty());
+
+  // the type parameters are only types in their function
+  string_to_buffer((char*) R""""(
+  fn wrong[float](x: float):
+    x
+  )"""");
+  Lexer::reset();
+  ast = Parser::parse();
+  ASSERT_FALSE(ast->nodes.empty());
+  EXPECT_EQ(ast->nodes[0], nullptr);
+  EXPECT_TRUE(Parser::type_params.empty());
+}
+
+// Check the type inference and the instances
+TEST(GenericTest, Instances) {
+  EXPECT_EQ(ArxGeneric::resolve_type("T[8]@soa", {{"T", "P"}}), "P[8]@soa");
+  EXPECT_EQ(ArxGeneric::resolve_type("float", {{"T", "P"}}), "float");
+
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  fn twice[T](x: T) -> T:
+    var y: T = x in y + x
+
+  fn first[T](xs: T[4]) -> T:
+    xs[0]
+
+  fn fact[T](n: T) -> T:
+    if n < 1: 1 else: n * fact(n - 1)
+
+  fn use_float(x):
+    twice(x) + twice(x + 1) + fact(x)
+
+  fn use_vector(x):
+    hsum(twice(f32x4(x)))
+
+  fn use_array(x):
+    var xs: float[4] in (xs[0] = x) + first(xs)
+  )"""");
+
+  // one instance by type, the generic functions have no code
+  EXPECT_EQ(count_functions("twice"), 2);
+  EXPECT_NE(ArxLLVM::module->getFunction("twice[float]"), nullptr);
+  EXPECT_NE(ArxLLVM::module->getFunction("twice[f32x4]"), nullptr);
+  EXPECT_NE(ArxLLVM::module->getFunction("first[float]"), nullptr);
+  EXPECT_EQ(count_functions("fact"), 1);
+
+  codegen.add_module();
+  using fn_t = float (*)(float);
+  auto use_float = reinterpret_cast<fn_t>(codegen.lookup("use_float"));
+  auto use_vector = reinterpret_cast<fn_t>(codegen.lookup("use_vector"));
+  auto use_array = reinterpret_cast<fn_t>(codegen.lookup("use_array"));
+  ASSERT_NE(use_float, nullptr);
+  ASSERT_NE(use_vector, nullptr);
+  ASSERT_NE(use_array, nullptr);
+
+  EXPECT_EQ(use_float(4), 8.0f + 10.0f + 24.0f);
+  EXPECT_EQ(use_vector(1.5), 12.0f);
+  EXPECT_EQ(use_array(3), 6.0f);
+}
+
+// Check the errors of the instances
+TEST(GenericTest, Errors) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  fn same[T](x: T, y: T) -> T:
+    x
+
+  fn result_only[T](x) -> T:
+    x
+
+  fn lanes[T](x: T):
+    hsum(x)
+
+  fn conflict(x):
+    same(x, f32x4(x))
+
+  fn not_inferred(x):
+    result_only(x)
+
+  fn wrong_body(x):
+    lanes(x) + lanes(x)
+  )"""");
+
+  EXPECT_EQ(ArxLLVM::module->getFunction("conflict"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("not_inferred"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("wrong_body"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("lanes[float]"), nullptr);
+  EXPECT_EQ(ArxLLVM::function_protos.count("lanes[float]"), 0);
+}
+
+// Check that a plain function replaces a generic function with its name,
+// and that the generic functions are not kept for the next compilation
+TEST(GenericTest, Registry) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  fn scale[T](x: T) -> T:
+    x * 2
+
+  fn use_scale(x):
+    scale(x)
+
+  fn scale(x):
+    x * 3
+
+  fn use_plain(x):
+    scale(x)
+
+  fn offset[T](x: T) -> T:
+    x + 1
+  )"""");
+
+  EXPECT_FALSE(ArxGeneric::is_generic("scale"));
+  EXPECT_EQ(ArxLLVM::function_protos.count("scale[float]"), 0);
+  EXPECT_NE(ArxLLVM::module->getFunction("use_plain"), nullptr);
+  EXPECT_TRUE(ArxGeneric::is_generic("offset"));
+
+  ASTToJITVisitor next_codegen;
+  compile(next_codegen, "");
+  EXPECT_FALSE(ArxGeneric::is_generic("offset"));
+}
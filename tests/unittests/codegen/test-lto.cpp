@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <set>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Object/Archive.h>
+#include <llvm/Object/ArchiveWriter.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/codegen/lto.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+/**
+ * @brief Compile the source to a bitcode file.
+ * @return The path of the file.
+ */
+static auto compile(
+  ASTToJITVisitor& codegen, llvm::TargetMachine& machine, const char* source)
+  -> std::string {
+  compile(codegen, source);
+  ArxLLVM::module->setTargetTriple(machine.getTargetTriple().str());
+  ArxLLVM::module->setDataLayout(machine.createDataLayout());
+
+  llvm::SmallString<128> path;
+  EXPECT_FALSE(llvm::sys::fs::createTemporaryFile("arx-lto", "bc", path));
+  std::error_code error_code;
+  llvm::raw_fd_ostream out(path, error_code);
+  EXPECT_FALSE(error_code);
+  ArxLTO::write_bitcode(*ArxLLVM::module, out);
+  return std::string(path);
+}
+
+/**
+ * @brief Get the names of the functions of the objects.
+ * @param is_defined The defined functions, otherwise the undefined
+ *        symbols (the calls to another object).
+ */
+static auto get_symbols(
+  const std::vector<std::string>& objects, bool is_defined)
+  -> std::set<std::string> {
+  std::set<std::string> names;
+  for (auto& path : objects) {
+    auto object = ArxLLVM::exit_on_err(
+      llvm::object::ObjectFile::createObjectFile(path));
+    for (auto& symbol : object.getBinary()->symbols()) {
+      auto type = ArxLLVM::exit_on_err(symbol.getType());
+      auto flags = ArxLLVM::exit_on_err(symbol.getFlags());
+      bool is_undefined = flags & llvm::object::SymbolRef::SF_Undefined;
+      bool is_function =
+        type == llvm::object::SymbolRef::ST_Function && !is_undefined;
+      if (is_defined ? is_function : is_undefined) {
+        names.insert(ArxLLVM::exit_on_err(symbol.getName()).str());
+      }
+    }
+  }
+  return names;
+}
+
+/**
+ * @brief Create the target machine of the host.
+ *
+ */
+static auto get_host_machine() -> std::unique_ptr<llvm::TargetMachine> {
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+  return ArxLLVM::exit_on_err(
+    ArxLLVM::exit_on_err(llvm::orc::JITTargetMachineBuilder::detectHost())
+      .createTargetMachine());
+}
+
+// Check the inlining of the functions of another module
+TEST(LTOTest, Link) {
+  auto machine = get_host_machine();
+
+  for (std::string mode : {"thin", "full"}) {
+    ArxLTO::mode = mode;
+    ASTToJITVisitor codegen;
+    std::string helpers = compile(codegen, *machine, R""""(
+    fn square(x):
+      x * x
+
+    fn unused(x):
+      x + 1
+    )"""");
+    std::string program = compile(codegen, *machine, R""""(
+    extern square(x)
+
+    fn main():
+      square(3) + 1
+    )"""");
+
+    // the helpers in an archive, like the runtime (libarxrt-lto.a)
+    std::string archive = helpers + ".a";
+    auto member = ArxLLVM::exit_on_err(
+      llvm::NewArchiveMember::getFile(helpers, true));
+    ASSERT_FALSE(llvm::writeArchive(
+      archive, {std::move(member)}, true, llvm::object::Archive::K_GNU, true,
+      false));
+
+    std::string prefix = program + ".program";
+    auto objects = ArxLTO::link({program, archive}, prefix, machine.get());
+    ASSERT_FALSE(objects.empty()) << mode;
+    auto functions = get_symbols(objects, true);
+    auto calls = get_symbols(objects, false);
+
+    // `square` is inlined in `main` and `unused` is removed, ThinLTO keeps
+    // `square` in its module since it is imported by another one
+    EXPECT_EQ(functions.count("main"), 1) << mode;
+    EXPECT_EQ(calls.count("square"), 0) << mode;
+    EXPECT_EQ(functions.count("unused"), 0) << mode;
+    if (mode == "full") {
+      EXPECT_EQ(functions.count("square"), 0);
+    }
+
+    for (auto& path : objects) {
+      llvm::sys::fs::remove(path);
+    }
+    llvm::sys::fs::remove(helpers);
+    llvm::sys::fs::remove(archive);
+    llvm::sys::fs::remove(program);
+  }
+  ArxLTO::mode = "";
+}
+
+// Check the error of an object that is not bitcode
+TEST(LTOTest, Errors) {
+  auto machine = get_host_machine();
+
+  llvm::SmallString<128> path;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("arx-lto", "o", path));
+  {
+    std::error_code error_code;
+    llvm::raw_fd_ostream out(path, error_code);
+    out << "not bitcode";
+  }
+
+  ArxLTO::mode = "thin";
+  auto objects = ArxLTO::link({std::string(path)}, "missing", machine.get());
+  ArxLTO::mode = "";
+  llvm::sys::fs::remove(path);
+  EXPECT_TRUE(objects.empty());
+}
+
+// Check that the vector functions of the runtime are recorded on the calls
+// of the bitcode, since the LTO pipeline doesn't know them
+TEST(LTOTest, VectorFunctions) {
+  auto machine = get_host_machine();
+
+  ArxLTO::mode = "thin";
+  ASTToJITVisitor codegen;
+  std::string path = compile(codegen, *machine, R""""(
+  fn wave(x):
+    exp(x)
+  )"""");
+  ArxLTO::mode = "";
+  llvm::sys::fs::remove(path);
+
+  bool has_variant = false;
+  for (auto& inst : llvm::instructions(ArxLLVM::module->getFunction("wave"))) {
+    auto call = llvm::dyn_cast<llvm::CallInst>(&inst);
+    if (call && call->hasFnAttr("vector-function-abi-variant")) {
+      has_variant = true;
+    }
+  }
+  EXPECT_TRUE(has_variant);
+}
+
+// Check that a runtime bitcode that can't be read (e.g. from a clang of
+// another LLVM version) is not linked, then the program links libarxrt.a
+TEST(LTOTest, UnreadableRuntime) {
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("arx-lto", dir));
+  std::string path = std::string(dir) + "/libarxrt-lto.a";
+  {
+    std::error_code error_code;
+    llvm::raw_fd_ostream out(path, error_code);
+    out << "not bitcode";
+  }
+
+  std::string runtime_dir = RUNTIME_DIR;
+  RUNTIME_DIR = std::string(dir);
+  ArxLTO::mode = "thin";
+  EXPECT_EQ(ArxLTO::get_runtime_bitcode(), "");
+  ArxLTO::mode = "";
+  RUNTIME_DIR = runtime_dir;
+
+  llvm::sys::fs::remove(path);
+  llvm::sys::fs::remove(dir);
+}
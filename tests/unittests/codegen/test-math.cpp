@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+/**
+ * @brief Check if the function calls the function `callee`.
+ *
+ */
+static auto calls(llvm::Function* fn, const std::string& callee) -> bool {
+  for (auto& block : *fn) {
+    for (auto& inst : block) {
+      auto call = llvm::dyn_cast<llvm::CallInst>(&inst);
+      if (
+        call && call->getCalledFunction() &&
+        call->getCalledFunction()->getName() == callee) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Check the lowering and the results of the builtins
+TEST(MathTest, Builtins) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  fn scalar(x):
+    sqrt(x) + abs(x - 10) + floor(x * 0.3) + ceil(x * 0.3)
+
+  fn fused(x):
+    fma(x, 2, 1) + pow(2, x)
+
+  fn vector(x):
+    hsum(exp(f32x8(x))) + hsum(sin(f32x4(x, 0, x, 0)))
+
+  fn double_vector(x):
+    hsum(log(f64x2(x)))
+
+  fn floor(x):
+    x + 1
+
+  fn hidden(x):
+    floor(x)
+  )"""");
+
+  auto scalar = ArxLLVM::module->getFunction("scalar");
+  auto vector = ArxLLVM::module->getFunction("vector");
+  ASSERT_NE(scalar, nullptr);
+  ASSERT_NE(vector, nullptr);
+  EXPECT_TRUE(calls(scalar, "llvm.sqrt.f32"));
+  EXPECT_TRUE(calls(scalar, "llvm.fabs.f32"));
+
+  // the vectors of floats call the vector functions of the runtime
+  EXPECT_TRUE(calls(vector, "arx_exp_f32x4"));
+  EXPECT_TRUE(calls(vector, "arx_sin_f32x4"));
+  EXPECT_TRUE(calls(
+    ArxLLVM::module->getFunction("double_vector"), "llvm.log.v2f64"));
+
+  codegen.add_module();
+  using fn_t = float (*)(float);
+  auto scalar_fn = reinterpret_cast<fn_t>(codegen.lookup("scalar"));
+  auto fused_fn = reinterpret_cast<fn_t>(codegen.lookup("fused"));
+  auto vector_fn = reinterpret_cast<fn_t>(codegen.lookup("vector"));
+  auto double_fn = reinterpret_cast<fn_t>(codegen.lookup("double_vector"));
+  auto hidden_fn = reinterpret_cast<fn_t>(codegen.lookup("hidden"));
+  ASSERT_NE(scalar_fn, nullptr);
+  ASSERT_NE(fused_fn, nullptr);
+  ASSERT_NE(vector_fn, nullptr);
+  ASSERT_NE(double_fn, nullptr);
+  ASSERT_NE(hidden_fn, nullptr);
+
+  EXPECT_EQ(scalar_fn(4), 2.0f + 6.0f + 1.0f + 2.0f);
+  EXPECT_EQ(fused_fn(3), 7.0f + 8.0f);
+  EXPECT_FLOAT_EQ(vector_fn(1), 8 * std::exp(1.0f) + 2 * std::sin(1.0f));
+  EXPECT_FLOAT_EQ(double_fn(2), 2 * std::log(2.0f));
+  EXPECT_EQ(hidden_fn(3), 4.0f);
+}
+
+// Check that the loops that call the builtins are vectorized
+TEST(MathTest, VectorizedLoops) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  fn wave(x):
+    exp(x) * sin(x)
+  )"""");
+
+  auto kernel = codegen.emit_kernel(ArxLLVM::module->getFunction("wave"));
+  ASSERT_NE(kernel, nullptr);
+  codegen.optimize();
+  EXPECT_TRUE(calls(kernel, "arx_exp_f32x4"));
+  EXPECT_TRUE(calls(kernel, "arx_sin_f32x4"));
+
+  codegen.add_module();
+  using kernel_t =
+    void (*)(int64_t, const void* const*, const int64_t*, void*);
+  auto kernel_fn =
+    reinterpret_cast<kernel_t>(codegen.lookup(get_kernel_name("wave")));
+  ASSERT_NE(kernel_fn, nullptr);
+
+  const int64_t length = 37;
+  float input[length];
+  float output[length];
+  for (int64_t i = 0; i < length; ++i) {
+    input[i] = static_cast<float>(i) * 0.25f - 4.0f;
+  }
+  const void* inputs[] = {input};
+  const int64_t strides[] = {1};
+  kernel_fn(length, inputs, strides, output);
+  for (int64_t i = 0; i < length; ++i) {
+    EXPECT_NEAR(
+      output[i],
+      std::exp(input[i]) * std::sin(input[i]),
+      1e-5f * std::exp(input[i]));
+  }
+}
+
+// Check the errors of the builtins
+TEST(MathTest, Errors) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  fn arity(x):
+    sqrt(x, x)
+
+  fn integers(x):
+    hsum(exp(i32x4(x)))
+
+  fn mixed(x):
+    hsum(pow(f32x4(x), f32x8(x)))
+  )"""");
+
+  EXPECT_EQ(ArxLLVM::module->getFunction("arity"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("integers"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("mixed"), nullptr);
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <memory>
+
+#include <llvm/IR/Module.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/codegen/memo.h"
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+/**
+ * @brief Compute fibonacci with the float arithmetic of the Arx code.
+ *
+ */
+static auto fib(int n) -> float {
+  float a = 1, b = 1;
+  for (int i = 3; i <= n; ++i) {
+    float c = a + b;
+    a = b;
+    b = c;
+  }
+  return b;
+}
+
+// Check that the decorator options are parsed
+TEST(MemoTest, ParseDecorator) {
+  Parser::setup();
+  string_to_buffer((char*) R""""(
+  @memo
+  fn f(x):
+    x
+
+  @memo(sync, 100)
+  fn g(x):
+    x
+  )"""");
+  Lexer::reset();
+  auto ast = Parser::parse();
+
+  ASSERT_EQ(ast->nodes.size(), 2);
+  auto& f = static_cast<FunctionAST&>(*ast->nodes[0]);
+  auto& g = static_cast<FunctionAST&>(*ast->nodes[1]);
+  EXPECT_EQ(f.proto->memo_capacity, 1024);
+  EXPECT_FALSE(f.proto->memo_sync);
+  EXPECT_EQ(g.proto->memo_capacity, 100);
+  EXPECT_TRUE(g.proto->memo_sync);
+}
+
+// Check that the cache size is an integer
+TEST(MemoTest, NonIntegralCapacity) {
+  Parser::setup();
+  string_to_buffer((char*) R""""(
+  @memo(2.5)
+  fn f(x):
+    x
+  )"""");
+  Lexer::reset();
+  Lexer::get_next_token();  // update Lexer::cur_tok
+  EXPECT_EQ(Parser::parse_decorated_definition(), nullptr);
+}
+
+// Check that the recursive calls of a memoized function use the cache
+TEST(MemoTest, Fibonacci) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  @memo
+  fn fib(x):
+    if x < 3:
+      1
+    else:
+      fib(x - 1) + fib(x - 2)
+
+  @memo(sync)
+  fn fib_sync(x):
+    if x < 3:
+      1
+    else:
+      fib_sync(x - 1) + fib_sync(x - 2)
+  )"""");
+
+  EXPECT_NE(ArxLLVM::module->getFunction("fib.impl"), nullptr);
+  EXPECT_NE(ArxLLVM::module->getGlobalVariable("fib.memo", true), nullptr);
+
+  codegen.add_module();
+  auto fn = reinterpret_cast<float (*)(float)>(codegen.lookup("fib"));
+  auto fn_sync =
+    reinterpret_cast<float (*)(float)>(codegen.lookup("fib_sync"));
+  ASSERT_NE(fn, nullptr);
+  ASSERT_NE(fn_sync, nullptr);
+
+  // without the cache, it would take about 2^80 calls
+  EXPECT_EQ(fn(80), fib(80));
+  EXPECT_EQ(fn(10), fib(10));
+  EXPECT_EQ(fn_sync(80), fib(80));
+}
+
+// Check that only the pure functions with tree recursion are memoized
+TEST(MemoTest, AutoMemo) {
+  ArxMemo::auto_memo = true;
+
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  extern printd(x)
+
+  fn fib(x):
+    if x < 3:
+      1
+    else:
+      fib(x - 1) + fib(x - 2)
+
+  fn countdown(x):
+    if x < 1:
+      0
+    else:
+      countdown(x - 1)
+
+  fn log_fib(x):
+    if x < 3:
+      printd(1)
+    else:
+      log_fib(x - 1) + log_fib(x - 2)
+  )"""");
+
+  ArxMemo::auto_memo = false;
+
+  EXPECT_NE(ArxLLVM::module->getFunction("fib.impl"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("countdown.impl"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("log_fib.impl"), nullptr);
+}
+
+// Check that only numbers can be used as cache keys
+TEST(MemoTest, InvalidTypes) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  @memo
+  fn name(s: string) -> string:
+    s
+  )"""");
+
+  EXPECT_EQ(ArxLLVM::module->getFunction("name"), nullptr);
+}
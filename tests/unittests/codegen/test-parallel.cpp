@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <memory>
+
+#include <llvm/IR/Module.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+// Check the parsing of the reduction
+TEST(ParallelForTest, Parse) {
+  Parser::setup();
+  string_to_buffer((char*) R""""(
+  parfor i = 0, 10, 2 reduce max in i
+  )"""");
+  Lexer::reset();
+  auto ast = Parser::parse();
+
+  ASSERT_EQ(ast->nodes.size(), 1);
+  auto& fn = static_cast<FunctionAST&>(*ast->nodes[0]);
+  ASSERT_EQ(fn.body->kind, ExprKind::ForKind);
+  auto& for_expr = static_cast<ForExprAST&>(*fn.body);
+  EXPECT_TRUE(for_expr.is_parallel);
+  EXPECT_EQ(for_expr.reduce_op, "max");
+}
+
+// Check the reductions of the parallel loops
+TEST(ParallelForTest, Reductions) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  fn sum_squares(n):
+    parfor i = 0, n reduce + in i * i
+
+  fn scaled_sum(n, k):
+    parfor i = 0, n reduce + in i * k
+
+  fn factorial(n):
+    parfor i = 1, n + 1 reduce * in i
+
+  fn max_distance(n, x):
+    parfor i = 0, n reduce max in
+      if i < x:
+        x - i
+      else:
+        i - x
+
+  fn min_odd(n):
+    parfor i = 1, n, 2 reduce min in i
+
+  fn grid(n):
+    parfor i = 0, n reduce + in
+      parfor j = 0, n reduce + in 1
+
+  fn local_assign(n):
+    var x = 1 in
+      (parfor i = 0, n in (x = x + 1)) + x
+
+  fn zero_step(n):
+    parfor i = 0, n, 0 reduce + in 1
+  )"""");
+
+  EXPECT_NE(ArxLLVM::module->getFunction("sum_squares.parfor"), nullptr);
+
+  codegen.add_module();
+  using fn1_t = float (*)(float);
+  using fn2_t = float (*)(float, float);
+  auto sum_squares = reinterpret_cast<fn1_t>(codegen.lookup("sum_squares"));
+  auto scaled_sum = reinterpret_cast<fn2_t>(codegen.lookup("scaled_sum"));
+  auto factorial = reinterpret_cast<fn1_t>(codegen.lookup("factorial"));
+  auto max_distance = reinterpret_cast<fn2_t>(codegen.lookup("max_distance"));
+  auto min_odd = reinterpret_cast<fn1_t>(codegen.lookup("min_odd"));
+  auto grid = reinterpret_cast<fn1_t>(codegen.lookup("grid"));
+  auto local_assign = reinterpret_cast<fn1_t>(codegen.lookup("local_assign"));
+  auto zero_step = reinterpret_cast<fn1_t>(codegen.lookup("zero_step"));
+  ASSERT_NE(sum_squares, nullptr);
+  ASSERT_NE(local_assign, nullptr);
+  ASSERT_NE(zero_step, nullptr);
+
+  EXPECT_EQ(sum_squares(100), 328350.0f);
+  EXPECT_EQ(sum_squares(0), 0.0f);
+  EXPECT_EQ(scaled_sum(100, 2), 9900.0f);
+  EXPECT_EQ(factorial(10), 3628800.0f);
+  EXPECT_EQ(max_distance(100, 30), 69.0f);
+  EXPECT_EQ(min_odd(100), 1.0f);
+  EXPECT_EQ(grid(50), 2500.0f);
+  // the assignments in the body don't change the outer variable
+  EXPECT_EQ(local_assign(100), 1.0f);
+  // the count of a zero step is infinite, the loop has no iteration
+  EXPECT_EQ(zero_step(100), 0.0f);
+}
+
+// Check that the outlined body keeps the floating-point mode of the
+// function
+TEST(ParallelForTest, FPMode) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  @fastmath
+  fn fast_sum(n):
+    parfor i = 0, n reduce + in i * 0.5
+
+  fn strict_sum(n):
+    parfor i = 0, n reduce + in i * 0.5
+  )"""");
+
+  auto unsafe_fp_math = [](const char* name) {
+    return ArxLLVM::module->getFunction(name)
+      ->getFnAttribute("unsafe-fp-math")
+      .getValueAsString()
+      .str();
+  };
+  EXPECT_EQ(unsafe_fp_math("fast_sum.parfor"), "true");
+  EXPECT_EQ(unsafe_fp_math("strict_sum.parfor"), "false");
+}
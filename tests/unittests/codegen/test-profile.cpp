@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#include <llvm/ProfileData/InstrProf.h>
+#include <llvm/ProfileData/InstrProfReader.h>
+#include <llvm/ProfileData/InstrProfWriter.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/codegen/profile.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+static const char* SOURCE = R""""(
+  fn branchy(x):
+    if x < 10: x * 2 else: x + 1
+  )"""";
+
+/**
+ * @brief Generate the code for the source in ArxLLVM::module, and run the
+ *        pipeline of ArxProfile.
+ *
+ */
+static auto compile(ASTToJITVisitor& codegen) -> bool {
+  compile(codegen, SOURCE);
+
+  auto machine = ArxLLVM::exit_on_err(
+    ArxLLVM::exit_on_err(llvm::orc::JITTargetMachineBuilder::detectHost())
+      .createTargetMachine());
+  ArxLLVM::module->setTargetTriple(machine->getTargetTriple().str());
+  return ArxProfile::optimize(*ArxLLVM::module, machine.get());
+}
+
+// Check the instrumentation of the functions
+TEST(ProfileTest, Generate) {
+  ASTToJITVisitor codegen;
+  ArxProfile::generate = true;
+  ASSERT_TRUE(compile(codegen));
+  ArxProfile::generate = false;
+
+  // the counters of the edges of `branchy`
+  auto& module = *ArxLLVM::module;
+  EXPECT_NE(module.getGlobalVariable("__profc_branchy", true), nullptr);
+  EXPECT_NE(module.getGlobalVariable("__profd_branchy", true), nullptr);
+  EXPECT_EQ(ArxProfile::get_link_args().size(), 0);
+}
+
+// Check the branch weights from a profile
+TEST(ProfileTest, Use) {
+  ASTToJITVisitor codegen;
+
+  // the hash and the number of counters of the instrumented function
+  ArxProfile::generate = true;
+  ASSERT_TRUE(compile(codegen));
+  ArxProfile::generate = false;
+  auto data = ArxLLVM::module->getGlobalVariable("__profd_branchy", true);
+  auto counters = ArxLLVM::module->getGlobalVariable("__profc_branchy", true);
+  ASSERT_NE(data, nullptr);
+  ASSERT_NE(counters, nullptr);
+  uint64_t hash = llvm::cast<llvm::ConstantInt>(
+                    data->getInitializer()->getAggregateElement(1u))
+                    ->getZExtValue();
+  uint64_t num_counters =
+    llvm::cast<llvm::ArrayType>(counters->getValueType())->getNumElements();
+
+  // a profile where `x < 10` is true in 1000 of 1010 calls
+  llvm::SmallString<128> path;
+  ASSERT_FALSE(
+    llvm::sys::fs::createTemporaryFile("arx-profile", "profdata", path));
+  {
+    // the text format of `llvm-profdata merge --text`
+    std::string text = ":ir\nbranchy\n" + std::to_string(hash) + "\n" +
+      std::to_string(num_counters) + "\n1000\n";
+    for (uint64_t i = 1; i < num_counters; ++i) {
+      text += "10\n";
+    }
+    auto reader = ArxLLVM::exit_on_err(llvm::InstrProfReader::create(
+      llvm::MemoryBuffer::getMemBufferCopy(text)));
+
+    llvm::InstrProfWriter writer;
+    ASSERT_FALSE(writer.mergeProfileKind(reader->getProfileKind()));
+    for (auto& record : *reader) {
+      writer.addRecord(std::move(record), [](llvm::Error err) {
+        llvm::consumeError(std::move(err));
+      });
+    }
+    std::error_code error_code;
+    llvm::raw_fd_ostream out(path, error_code);
+    ASSERT_FALSE(error_code);
+    ASSERT_FALSE(writer.write(out));
+  }
+
+  ArxProfile::use_path = std::string(path);
+  bool is_optimized = compile(codegen);
+  ArxProfile::use_path = "";
+  llvm::sys::fs::remove(path);
+  ASSERT_TRUE(is_optimized);
+
+  llvm::Function* fn = ArxLLVM::module->getFunction("branchy");
+  ASSERT_NE(fn, nullptr);
+  EXPECT_TRUE(fn->getEntryCount().hasValue());
+
+  bool has_weights = false;
+  for (auto& block : *fn) {
+    for (auto& inst : block) {
+      has_weights = has_weights || inst.getMetadata("prof") != nullptr;
+    }
+  }
+  EXPECT_TRUE(has_weights);
+}
+
+// Check the error of a profile that can't be read
+TEST(ProfileTest, Errors) {
+  ASTToJITVisitor codegen;
+  ArxProfile::use_path = "missing.profdata";
+  EXPECT_FALSE(compile(codegen));
+  ArxProfile::use_path = "";
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <memory>
+
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+// Check that only the calls with a binding are range builtins
+TEST(RangeBuiltinTest, Parse) {
+  Parser::setup();
+  string_to_buffer((char*) R""""(
+  sum(i = 0, 10, 2, i)
+  reduce(*, i = 1, 5, i)
+  reduce(max, i = 1, 5, i)
+  map(i = 0, 3, i)
+  sum(1, 2)
+  )"""");
+  Lexer::reset();
+  auto ast = Parser::parse();
+
+  ASSERT_EQ(ast->nodes.size(), 5);
+  const char* reduce_ops[] = {"+", "*", "max", ""};
+  for (int i = 0; i < 4; ++i) {
+    auto& fn = static_cast<FunctionAST&>(*ast->nodes[i]);
+    ASSERT_EQ(fn.body->kind, ExprKind::ForKind);
+    auto& for_expr = static_cast<ForExprAST&>(*fn.body);
+    EXPECT_TRUE(for_expr.is_range);
+    EXPECT_FALSE(for_expr.is_parallel);
+    EXPECT_EQ(for_expr.var_name, "i");
+    EXPECT_EQ(for_expr.reduce_op, reduce_ops[i]);
+  }
+  auto& fn = static_cast<FunctionAST&>(*ast->nodes[4]);
+  EXPECT_EQ(fn.body->kind, ExprKind::CallKind);
+}
+
+// Check the values of the builtins and their code
+TEST(RangeBuiltinTest, Reductions) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  fn sum(a, b):
+    a + b
+
+  fn sum_squares(n):
+    sum(i = 0, n, i * i)
+
+  fn triangle(n):
+    sum(i = 0, n, sum(i, 1))
+
+  fn half_sum(n):
+    sum(i = 0, n, i) * 0.5
+
+  fn sum_odd(n):
+    sum(i = 1, n, 2, i)
+
+  fn zero_step(n):
+    sum(i = 0, n, 0, 1)
+
+  fn factorial(n):
+    reduce(*, i = 1, n + 1, i)
+
+  fn max_distance(n, x):
+    max(i = 0, n, if i < x: x - i else: i - x)
+
+  fn min_distance(n, x):
+    reduce(min, i = 0, n, if i < x: x - i else: i - x)
+
+  fn grid(n):
+    sum(i = 0, n, sum(j = 0, i, 1))
+
+  fn count_map(n):
+    var x = 0 in
+      map(i = 0, n, x = x + 1) + x
+
+  fn cube(n):
+    sum(i = 0, n, sum(j = 0, n, sum(k = 0, n, i * j * k)))
+  )"""");
+
+  llvm::Function* fn = ArxLLVM::module->getFunction("sum_squares");
+  ASSERT_NE(fn, nullptr);
+  // the reassociation is only allowed for the reduction
+  int reassoc_adds = 0;
+  for (auto& block : *fn) {
+    for (auto& inst : block) {
+      if (inst.getOpcode() == llvm::Instruction::FAdd) {
+        reassoc_adds += inst.hasAllowReassoc();
+      } else if (inst.getOpcode() == llvm::Instruction::FMul) {
+        EXPECT_FALSE(inst.hasAllowReassoc());
+      }
+    }
+  }
+  EXPECT_EQ(reassoc_adds, 1);
+
+  // the body of each builtin is emitted once
+  fn = ArxLLVM::module->getFunction("cube");
+  ASSERT_NE(fn, nullptr);
+  int phis = 0;
+  for (auto& block : *fn) {
+    for (auto& inst : block) {
+      phis += llvm::isa<llvm::PHINode>(inst);
+    }
+  }
+  // the index, the accumulator and the value of each loop
+  EXPECT_EQ(phis, 9);
+
+  codegen.add_module();
+  using fn1_t = float (*)(float);
+  using fn2_t = float (*)(float, float);
+  auto sum_squares = reinterpret_cast<fn1_t>(codegen.lookup("sum_squares"));
+  auto triangle = reinterpret_cast<fn1_t>(codegen.lookup("triangle"));
+  auto half_sum = reinterpret_cast<fn1_t>(codegen.lookup("half_sum"));
+  auto sum_odd = reinterpret_cast<fn1_t>(codegen.lookup("sum_odd"));
+  auto zero_step = reinterpret_cast<fn1_t>(codegen.lookup("zero_step"));
+  auto factorial = reinterpret_cast<fn1_t>(codegen.lookup("factorial"));
+  auto max_distance = reinterpret_cast<fn2_t>(codegen.lookup("max_distance"));
+  auto min_distance = reinterpret_cast<fn2_t>(codegen.lookup("min_distance"));
+  auto grid = reinterpret_cast<fn1_t>(codegen.lookup("grid"));
+  auto count_map = reinterpret_cast<fn1_t>(codegen.lookup("count_map"));
+  ASSERT_NE(sum_squares, nullptr);
+  ASSERT_NE(count_map, nullptr);
+
+  EXPECT_EQ(sum_squares(100), 328350.0f);
+  EXPECT_EQ(sum_squares(0), 0.0f);
+  EXPECT_EQ(sum_squares(-5), 0.0f);
+  for (int n = 1; n < 10; ++n) {
+    EXPECT_EQ(triangle(n), n * (n + 1) / 2.0f);
+  }
+  EXPECT_EQ(half_sum(101), 2525.0f);
+  EXPECT_EQ(sum_odd(10), 25.0f);
+  EXPECT_EQ(sum_odd(11), 25.0f);
+  EXPECT_EQ(zero_step(10), 0.0f);
+  EXPECT_EQ(factorial(10), 3628800.0f);
+  EXPECT_EQ(factorial(0), 1.0f);
+  EXPECT_EQ(max_distance(100, 30), 69.0f);
+  EXPECT_EQ(min_distance(100, 30), 0.0f);
+  EXPECT_EQ(min_distance(0, 30), INFINITY);
+  EXPECT_EQ(grid(50), 1225.0f);
+  // unlike `parfor`, the iterations run in order in the function scope
+  EXPECT_EQ(count_map(7), 7.0f);
+  auto cube = reinterpret_cast<fn1_t>(codegen.lookup("cube"));
+  ASSERT_NE(cube, nullptr);
+  EXPECT_EQ(cube(4), 216.0f);
+}
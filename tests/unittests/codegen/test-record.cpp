@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <memory>
+
+#include <llvm/IR/Module.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/datatypes.h"
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+// Check the parsing of the structs, the array types and the accesses
+TEST(RecordTest, Parse) {
+  Parser::setup();
+  string_to_buffer((char*) R""""(
+  struct Point: x, y: f32x4, id: date32
+
+  fn norm(ps: Point[8]@soa, i):
+    ps[i].x
+  )"""");
+  Lexer::reset();
+  auto ast = Parser::parse();
+
+  ASSERT_EQ(Parser::struct_fields.count("Point"), 1);
+  auto& fields = Parser::struct_fields["Point"];
+  ASSERT_EQ(fields.size(), 3);
+  EXPECT_EQ(fields[1].first, "y");
+  EXPECT_EQ(fields[1].second, "f32x4");
+  EXPECT_EQ(fields[2].second, "date32");
+  EXPECT_TRUE(is_record_type("Point"));
+  EXPECT_EQ(get_type_kind("Point"), ExprKind::RecordDTKind);
+  EXPECT_EQ(get_record_field_index("Point", "id"), 2);
+  EXPECT_EQ(get_record_field_index("Point", "z"), -1);
+
+  ASSERT_EQ(ast->nodes.size(), 1);
+  auto& fn = static_cast<FunctionAST&>(*ast->nodes[0]);
+  EXPECT_EQ(fn.proto->args[0]->type_name, "Point[8]@soa");
+  ASSERT_EQ(fn.body->kind, ExprKind::AccessKind);
+  auto& field = static_cast<AccessExprAST&>(*fn.body);
+  EXPECT_EQ(field.field, "x");
+  EXPECT_EQ(field.index, nullptr);
+  ASSERT_EQ(field.base->kind, ExprKind::AccessKind);
+  auto& element = static_cast<AccessExprAST&>(*field.base);
+  EXPECT_NE(element.index, nullptr);
+  EXPECT_EQ(element.base->kind, ExprKind::VariableKind);
+}
+
+// Check that both layouts give the same results
+TEST(RecordTest, Layouts) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  struct Particle: x, y, mass
+
+  fn total_aos(ps: Particle[64]):
+    sum(i = 0, len(ps), ps[i].mass * ps[i].x)
+
+  fn total_soa(ps: Particle[64]@soa):
+    sum(i = 0, len(ps), ps[i].mass * ps[i].x)
+
+  fn run_aos(k):
+    var ps: Particle[64] in
+      map(i = 0, 64, ps[i] = Particle(i, 2 * i, k)) +
+      (ps[3].y = ps[3].y + 1) * 0 + total_aos(ps) + ps[3].y
+
+  fn run_soa(k):
+    var ps: Particle[64]@soa in
+      map(i = 0, 64, ps[i] = Particle(i, 2 * i, k)) +
+      (ps[3].y = ps[3].y + 1) * 0 + total_soa(ps) + ps[3].y
+  )"""");
+
+  EXPECT_NE(ArxLLVM::module->getFunction("total_soa"), nullptr);
+
+  codegen.add_module();
+  using fn_t = float (*)(float);
+  auto run_aos = reinterpret_cast<fn_t>(codegen.lookup("run_aos"));
+  auto run_soa = reinterpret_cast<fn_t>(codegen.lookup("run_soa"));
+  ASSERT_NE(run_aos, nullptr);
+  ASSERT_NE(run_soa, nullptr);
+
+  // 2 * (0 + 1 + ... + 63) + 6 + 1
+  EXPECT_EQ(run_aos(2), 4039.0f);
+  EXPECT_EQ(run_soa(2), 4039.0f);
+  EXPECT_EQ(run_soa(0), 7.0f);
+}
+
+// Check the struct values
+TEST(RecordTest, Records) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  struct Pair: a, b: float
+
+  fn swap(p: Pair) -> Pair:
+    Pair(p.b, p.a)
+
+  fn fields(x):
+    var p = Pair(x, 3) in
+      (p.a = p.a * 2) + p.b + swap(p).a + swap(Pair()).b
+  )"""");
+
+  codegen.add_module();
+  using fn_t = float (*)(float);
+  auto fields = reinterpret_cast<fn_t>(codegen.lookup("fields"));
+  ASSERT_NE(fields, nullptr);
+
+  EXPECT_EQ(fields(5), 16.0f);
+}
+
+// Check the errors of the accesses
+TEST(RecordTest, Errors) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  struct Pair: a, b
+
+  fn unknown_field(p: Pair):
+    p.c
+
+  fn not_array(x):
+    x[0]
+
+  fn not_struct(x):
+    x.a
+
+  fn initialized():
+    var ps: Pair[4] = 1 in 0
+
+  fn assigned(ps: Pair[4]):
+    ps = ps
+
+  fn alias_param(ps: Pair[4]):
+    var qs = ps in 0
+
+  fn alias_local():
+    var ps: Pair[4] in var qs = ps in qs[0].a
+
+  fn returned():
+    var ps: Pair[4] in ps
+
+  fn inner_var(x):
+    var ps: Pair[4] in (var k = 1 in (ps[0].a = x) + k) + ps[0].a
+  )"""");
+
+  EXPECT_EQ(ArxLLVM::module->getFunction("unknown_field"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("not_array"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("not_struct"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("initialized"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("assigned"), nullptr);
+  // the arrays are not copied nor returned by a `var`, that releases them
+  EXPECT_EQ(ArxLLVM::module->getFunction("alias_param"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("alias_local"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("returned"), nullptr);
+
+  // an inner `var` doesn't release the arrays of the outer one
+  codegen.add_module();
+  using fn_t = float (*)(float);
+  auto inner_var = reinterpret_cast<fn_t>(codegen.lookup("inner_var"));
+  ASSERT_NE(inner_var, nullptr);
+  EXPECT_EQ(inner_var(3), 7.0f);
+}
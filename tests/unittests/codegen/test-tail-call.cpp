@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <memory>
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+/**
+ * @brief Count the calls of the function to itself.
+ *
+ */
+static auto count_self_calls(const char* name) -> int {
+  llvm::Function* fn = ArxLLVM::module->getFunction(name);
+  int count = 0;
+  for (llvm::BasicBlock& block : *fn) {
+    for (llvm::Instruction& inst : block) {
+      auto call = llvm::dyn_cast<llvm::CallInst>(&inst);
+      if (call && call->getCalledFunction() == fn) {
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+// Check that the self tail calls are lowered to loops without optimizations
+TEST(TailCallTest, SelfTailCalls) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  fn sum(n, acc):
+    if n < 1:
+      acc
+    else:
+      sum(n - 1, acc + 1)
+
+  fn countdown(n):
+    var m = n - 1 in
+      if m < 0:
+        0
+      else:
+        countdown(m)
+
+  fn fib(x):
+    if x < 3:
+      1
+    else:
+      fib(x - 1) + fib(x - 2)
+  )"""");
+
+  EXPECT_EQ(count_self_calls("sum"), 0);
+  EXPECT_EQ(count_self_calls("countdown"), 0);
+  EXPECT_EQ(count_self_calls("fib"), 2);
+
+  codegen.add_module();
+  auto sum = reinterpret_cast<float (*)(float, float)>(codegen.lookup("sum"));
+  auto countdown =
+    reinterpret_cast<float (*)(float)>(codegen.lookup("countdown"));
+  ASSERT_NE(sum, nullptr);
+  ASSERT_NE(countdown, nullptr);
+
+  // deep enough to overflow the stack with recursive calls
+  EXPECT_EQ(sum(10000000, 0), 10000000.0f);
+  EXPECT_EQ(countdown(10000000), 0.0f);
+}
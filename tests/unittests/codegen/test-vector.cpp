@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <memory>
+
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Module.h>
+
+#include "../src/codegen/arx-llvm.h"
+#include "../src/codegen/ast-to-jit.h"
+#include "../src/parser.h"
+
+#include "compile.h"
+
+// Check the LLVM types of the vectors
+TEST(VectorTest, Types) {
+  ASTToJITVisitor codegen;
+  codegen.initialize();
+
+  auto f32x8 = llvm::cast<llvm::FixedVectorType>(
+    ArxLLVM::get_data_type("f32x8"));
+  EXPECT_EQ(f32x8->getNumElements(), 8);
+  EXPECT_TRUE(f32x8->getElementType()->isFloatTy());
+
+  auto i16x4 = llvm::cast<llvm::FixedVectorType>(
+    ArxLLVM::get_data_type("i16x4"));
+  EXPECT_EQ(i16x4->getNumElements(), 4);
+  EXPECT_TRUE(i16x4->getElementType()->isIntegerTy(16));
+}
+
+// Check the lane-wise operators and the builtins
+TEST(VectorTest, Operators) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  fn axpy(a: f32x8, x: f32x8, y: f32x8) -> f32x8:
+    a * x + y
+
+  fn dot4(a, b, c, d):
+    var v: f32x4 = f32x4(a, b, c, d) in
+      hsum(v * v)
+
+  fn lane(i):
+    var v: f32x8 = axpy(f32x8(2), f32x8(0, 1, 2, 3, 4, 5, 6, 7), f32x8(1)) in
+      extract(v, 3) + extract(v, 7) * 100
+
+  fn int_lanes(x):
+    var v: i32x4 = i32x4(x) + i32x4(0, 1, 2, 3) in
+      hsum(v * 2) + hmax(v) * 100
+
+  fn compare(x):
+    hsum(f32x4(0, 1, 2, 3) < x)
+
+  fn shuffled():
+    var v = f32x4(1, 2, 3, 4) in
+      extract(shuffle(v, 3, 2), 0) * 10 + extract(shuffle(v, v, 0, 5), 1)
+
+  fn broadcast_lane():
+    hsum(broadcast(insert(f32x4(1), 2, 10), 2))
+
+  fn extremes():
+    var v = f64x2(0 - 1.5, 2.5) in
+      hmin(v) + hmax(v) * 10 + hprod(v) * 100
+  )"""");
+
+  EXPECT_NE(ArxLLVM::module->getFunction("axpy"), nullptr);
+
+  codegen.add_module();
+  using fn0_t = float (*)();
+  using fn1_t = float (*)(float);
+  using fn4_t = float (*)(float, float, float, float);
+  auto dot4 = reinterpret_cast<fn4_t>(codegen.lookup("dot4"));
+  auto lane = reinterpret_cast<fn1_t>(codegen.lookup("lane"));
+  auto int_lanes = reinterpret_cast<fn1_t>(codegen.lookup("int_lanes"));
+  auto compare = reinterpret_cast<fn1_t>(codegen.lookup("compare"));
+  auto shuffled = reinterpret_cast<fn0_t>(codegen.lookup("shuffled"));
+  auto broadcast_lane =
+    reinterpret_cast<fn0_t>(codegen.lookup("broadcast_lane"));
+  auto extremes = reinterpret_cast<fn0_t>(codegen.lookup("extremes"));
+  ASSERT_NE(dot4, nullptr);
+  ASSERT_NE(extremes, nullptr);
+
+  EXPECT_EQ(dot4(1, 2, 3, 4), 30.0f);
+  EXPECT_EQ(lane(0), 7.0f + 15.0f * 100);
+  // v = (5, 6, 7, 8)
+  EXPECT_EQ(int_lanes(5.7f), 52.0f + 800.0f);
+  EXPECT_EQ(compare(2), 2.0f);
+  EXPECT_EQ(shuffled(), 42.0f);
+  EXPECT_EQ(broadcast_lane(), 40.0f);
+  EXPECT_EQ(extremes(), -1.5f + 25.0f - 375.0f);
+}
+
+// Check the errors of the builtins
+TEST(VectorTest, Errors) {
+  ASTToJITVisitor codegen;
+  compile(codegen, R""""(
+  fn wrong_lanes():
+    hsum(f32x4(1, 2, 3))
+
+  fn wrong_index(i):
+    extract(f32x4(1), i)
+
+  fn wrong_condition():
+    if f32x4(1): 1 else: 0
+  )"""");
+
+  EXPECT_EQ(ArxLLVM::module->getFunction("wrong_lanes"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("wrong_index"), nullptr);
+  EXPECT_EQ(ArxLLVM::module->getFunction("wrong_condition"), nullptr);
+}
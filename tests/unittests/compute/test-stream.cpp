@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+
+#include "../src/compute/stream.h"
+
+/**
+ * @brief Get the path of a new temporary file.
+ *
+ */
+static auto get_temporary_file(const char* prefix, const char* suffix)
+  -> std::string {
+  llvm::SmallString<128> path;
+  EXPECT_FALSE(llvm::sys::fs::createTemporaryFile(prefix, suffix, path));
+  return std::string(path);
+}
+
+// Check that an Arx function is applied to all the batches of an IPC file
+TEST(StreamTest, RunIPCFile) {
+  std::string source_file = get_temporary_file("arx-test-stream", "x");
+  std::string input_file =
+    get_temporary_file("arx-test-stream-input", "arrow");
+  std::string output_file =
+    get_temporary_file("arx-test-stream-output", "arrow");
+
+  std::ofstream source(source_file);
+  source << "fn weighted(x, y):\n  x * 2 + y\n";
+  source.close();
+
+  auto schema = arrow::schema(
+    {arrow::field("x", arrow::int32()), arrow::field("y", arrow::float32())});
+  auto output = arrow::io::FileOutputStream::Open(input_file).ValueOrDie();
+  auto writer = arrow::ipc::MakeFileWriter(output, schema).ValueOrDie();
+
+  // three batches, the first column needs a cast to float32
+  for (int batch_idx = 0; batch_idx < 3; ++batch_idx) {
+    arrow::Int32Builder x_builder;
+    arrow::FloatBuilder y_builder;
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_TRUE(x_builder.Append(batch_idx * 100 + i).ok());
+      ASSERT_TRUE(y_builder.Append(1.0f).ok());
+    }
+    auto batch = arrow::RecordBatch::Make(
+      schema,
+      100,
+      {x_builder.Finish().ValueOrDie(), y_builder.Finish().ValueOrDie()});
+    ASSERT_TRUE(writer->WriteRecordBatch(*batch).ok());
+  }
+  ASSERT_TRUE(writer->Close().ok());
+  ASSERT_TRUE(output->Close().ok());
+
+  ArxRunOptions options;
+  options.source_file = source_file;
+  options.kernel = "weighted";
+  options.input_file = input_file;
+  options.output_file = output_file;
+  options.threads = 2;
+
+  auto status = ArxStream::run(options);
+  ASSERT_TRUE(status.ok()) << status.ToString();
+
+  auto input = arrow::io::ReadableFile::Open(output_file).ValueOrDie();
+  auto reader = arrow::ipc::RecordBatchFileReader::Open(input).ValueOrDie();
+  ASSERT_EQ(reader->num_record_batches(), 3);
+  ASSERT_EQ(reader->schema()->num_fields(), 3);
+  EXPECT_EQ(reader->schema()->field(2)->name(), "weighted");
+
+  // the batches are written in the input order
+  for (int batch_idx = 0; batch_idx < 3; ++batch_idx) {
+    auto batch = reader->ReadRecordBatch(batch_idx).ValueOrDie();
+    auto result = std::static_pointer_cast<arrow::FloatArray>(batch->column(2));
+    ASSERT_EQ(result->length(), 100);
+    EXPECT_EQ(result->Value(0), batch_idx * 200 + 1.0f);
+    EXPECT_EQ(result->Value(99), (batch_idx * 100 + 99) * 2 + 1.0f);
+  }
+
+  llvm::sys::fs::remove(source_file);
+  llvm::sys::fs::remove(input_file);
+  llvm::sys::fs::remove(output_file);
+}
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include <memory>
+
+#include <arrow/api.h>
+#include <arrow/compute/api.h>
+
+#include "../src/compute/udf.h"
+
+// Check that Arx functions can be called as Arrow compute functions
+TEST(UDFTest, RegisterFunctions) {
+  auto registry = arrow::compute::FunctionRegistry::Make(
+    arrow::compute::GetFunctionRegistry());
+
+  auto status = ArxUDF::register_functions(
+    R""""(
+  fn average(x, y):
+    (x + y) * 0.5
+  )"""",
+    registry.get(),
+    "arx_");
+  ASSERT_TRUE(status.ok()) << status.ToString();
+
+  arrow::FloatBuilder builder;
+  ASSERT_TRUE(builder.AppendValues({1, 2, 3, 4}).ok());
+  auto values = builder.Finish().ValueOrDie();
+
+  arrow::compute::ExecContext ctx(
+    arrow::default_memory_pool(), nullptr, registry.get());
+
+  auto result = arrow::compute::CallFunction(
+    "arx_average", {values, arrow::Datum(3.0f)}, &ctx);
+  ASSERT_TRUE(result.ok()) << result.status().ToString();
+
+  auto output = std::static_pointer_cast<arrow::FloatArray>(
+    result.ValueOrDie().make_array());
+  ASSERT_EQ(output->length(), 4);
+  EXPECT_EQ(output->Value(0), 2.0f);
+  EXPECT_EQ(output->Value(3), 3.5f);
+}
+
+// Check that temporal and decimal values are passed with the Arrow layout
+TEST(UDFTest, TemporalAndDecimalTypes) {
+  auto registry = arrow::compute::FunctionRegistry::Make(
+    arrow::compute::GetFunctionRegistry());
+
+  auto status = ArxUDF::register_functions(
+    R""""(
+  fn total(price: decimal128(18, 2), qty: decimal128(10)) -> decimal128(18, 2):
+    price * qty * 1.05
+
+  fn add_week(d: date32) -> date32:
+    d + 7
+
+  fn to_date(t: timestamp) -> date32:
+    t
+  )"""",
+    registry.get());
+  ASSERT_TRUE(status.ok()) << status.ToString();
+
+  arrow::compute::ExecContext ctx(
+    arrow::default_memory_pool(), nullptr, registry.get());
+
+  // decimals
+  arrow::Decimal128Builder price_builder(arrow::decimal128(18, 2));
+  ASSERT_TRUE(price_builder.Append(arrow::Decimal128(1000)).ok());
+  ASSERT_TRUE(price_builder.Append(arrow::Decimal128(99)).ok());
+  auto prices = price_builder.Finish().ValueOrDie();
+  auto qty = std::make_shared<arrow::Decimal128Scalar>(
+    arrow::Decimal128(3), arrow::decimal128(10, 0));
+
+  auto result = arrow::compute::CallFunction(
+    "total", {prices, arrow::Datum(qty)}, &ctx);
+  ASSERT_TRUE(result.ok()) << result.status().ToString();
+  auto totals = std::static_pointer_cast<arrow::Decimal128Array>(
+    result.ValueOrDie().make_array());
+  EXPECT_EQ(totals->FormatValue(0), "31.50");
+  EXPECT_EQ(totals->FormatValue(1), "3.12");  // 3.1185 rounded
+
+  // dates
+  arrow::Date32Builder date_builder;
+  ASSERT_TRUE(date_builder.AppendValues({0, 19000}).ok());
+  auto dates = date_builder.Finish().ValueOrDie();
+
+  result = arrow::compute::CallFunction("add_week", {dates}, &ctx);
+  ASSERT_TRUE(result.ok()) << result.status().ToString();
+  auto next_dates = std::static_pointer_cast<arrow::Date32Array>(
+    result.ValueOrDie().make_array());
+  EXPECT_EQ(next_dates->Value(0), 7);
+  EXPECT_EQ(next_dates->Value(1), 19007);
+
+  // timestamps (microseconds)
+  arrow::TimestampBuilder timestamp_builder(
+    arrow::timestamp(arrow::TimeUnit::MICRO), arrow::default_memory_pool());
+  ASSERT_TRUE(timestamp_builder.Append(19000LL * 86400000000LL + 1).ok());
+  ASSERT_TRUE(timestamp_builder.Append(-1).ok());
+  auto timestamps = timestamp_builder.Finish().ValueOrDie();
+
+  result = arrow::compute::CallFunction("to_date", {timestamps}, &ctx);
+  ASSERT_TRUE(result.ok()) << result.status().ToString();
+  auto timestamp_dates = std::static_pointer_cast<arrow::Date32Array>(
+    result.ValueOrDie().make_array());
+  EXPECT_EQ(timestamp_dates->Value(0), 19000);
+  // before the epoch, the previous day
+  EXPECT_EQ(timestamp_dates->Value(1), -1);
+}
+
+// Check that string arrays are read from their offsets and data buffers
+TEST(UDFTest, StringTypes) {
+  auto registry = arrow::compute::FunctionRegistry::Make(
+    arrow::compute::GetFunctionRegistry());
+
+  auto status = ArxUDF::register_functions(
+    R""""(
+  extern str_len(s: string) -> float
+  extern str_find(s: string, sub: string) -> float
+  extern str_slice(s: string, start, end) -> string
+
+  fn greet(name: string) -> string:
+    "hello, " + name
+
+  fn name_len(name: string) -> float:
+    str_len(name)
+
+  fn first_word(s: string) -> string:
+    str_slice(s, 0, str_find(s, " "))
+  )"""",
+    registry.get());
+  ASSERT_TRUE(status.ok()) << status.ToString();
+
+  arrow::compute::ExecContext ctx(
+    arrow::default_memory_pool(), nullptr, registry.get());
+
+  arrow::StringBuilder name_builder;
+  ASSERT_TRUE(name_builder.Append("arx").ok());
+  ASSERT_TRUE(name_builder.Append("a long name for a test").ok());
+  ASSERT_TRUE(name_builder.AppendNull().ok());
+  auto names = name_builder.Finish().ValueOrDie();
+
+  auto result = arrow::compute::CallFunction("greet", {names}, &ctx);
+  ASSERT_TRUE(result.ok()) << result.status().ToString();
+  auto greetings = std::static_pointer_cast<arrow::StringArray>(
+    result.ValueOrDie().make_array());
+  EXPECT_EQ(greetings->GetString(0), "hello, arx");
+  EXPECT_EQ(greetings->GetString(1), "hello, a long name for a test");
+  EXPECT_TRUE(greetings->IsNull(2));
+
+  result = arrow::compute::CallFunction("name_len", {names}, &ctx);
+  ASSERT_TRUE(result.ok()) << result.status().ToString();
+  auto lengths = std::static_pointer_cast<arrow::FloatArray>(
+    result.ValueOrDie().make_array());
+  EXPECT_EQ(lengths->Value(0), 3);
+  EXPECT_EQ(lengths->Value(1), 22);
+  EXPECT_TRUE(lengths->IsNull(2));
+
+  result = arrow::compute::CallFunction(
+    "first_word", {arrow::Datum(names->Slice(1))}, &ctx);
+  ASSERT_TRUE(result.ok()) << result.status().ToString();
+  auto words = std::static_pointer_cast<arrow::StringArray>(
+    result.ValueOrDie().make_array());
+  EXPECT_EQ(words->GetString(0), "a");
+  EXPECT_EQ(words->length(), 2);
+}
+
+// Check that constants are folded into the functions
+TEST(UDFTest, Constants) {
+  auto registry = arrow::compute::FunctionRegistry::Make(
+    arrow::compute::GetFunctionRegistry());
+
+  auto status = ArxUDF::register_functions(
+    R""""(
+  const RATE = 2 * 3 + 1
+  const FEE: decimal128(10, 2) = 0.10
+  const DISCOUNT: decimal128(10, 2) = 0 - 0.125
+  const GREETING = "hello, "
+
+  fn limit():
+    if RATE < 10:
+      100
+    else:
+      0
+
+  fn scale(x):
+    const offset = limit() - RATE in
+      x * RATE + offset
+
+  fn with_fee(price: decimal128(18, 2)) -> decimal128(18, 2):
+    price + FEE
+
+  fn with_discount(price: decimal128(18, 2)) -> decimal128(18, 2):
+    price + DISCOUNT
+
+  fn welcome(name: string) -> string:
+    GREETING + name
+  )"""",
+    registry.get());
+  ASSERT_TRUE(status.ok()) << status.ToString();
+
+  arrow::compute::ExecContext ctx(
+    arrow::default_memory_pool(), nullptr, registry.get());
+
+  arrow::FloatBuilder builder;
+  ASSERT_TRUE(builder.AppendValues({0, 2}).ok());
+  auto values = builder.Finish().ValueOrDie();
+
+  auto result = arrow::compute::CallFunction("scale", {values}, &ctx);
+  ASSERT_TRUE(result.ok()) << result.status().ToString();
+  auto scaled = std::static_pointer_cast<arrow::FloatArray>(
+    result.ValueOrDie().make_array());
+  EXPECT_EQ(scaled->Value(0), 93.0f);
+  EXPECT_EQ(scaled->Value(1), 107.0f);
+
+  arrow::Decimal128Builder price_builder(arrow::decimal128(18, 2));
+  ASSERT_TRUE(price_builder.Append(arrow::Decimal128(1234)).ok());
+  auto prices = price_builder.Finish().ValueOrDie();
+
+  result = arrow::compute::CallFunction("with_fee", {prices}, &ctx);
+  ASSERT_TRUE(result.ok()) << result.status().ToString();
+  auto totals = std::static_pointer_cast<arrow::Decimal128Array>(
+    result.ValueOrDie().make_array());
+  EXPECT_EQ(totals->FormatValue(0), "12.44");
+
+  // the folded literal -0.125 is rounded away from zero
+  result = arrow::compute::CallFunction("with_discount", {prices}, &ctx);
+  ASSERT_TRUE(result.ok()) << result.status().ToString();
+  totals = std::static_pointer_cast<arrow::Decimal128Array>(
+    result.ValueOrDie().make_array());
+  EXPECT_EQ(totals->FormatValue(0), "12.21");
+
+  arrow::StringBuilder name_builder;
+  ASSERT_TRUE(name_builder.Append("arx").ok());
+  auto names = name_builder.Finish().ValueOrDie();
+
+  result = arrow::compute::CallFunction("welcome", {names}, &ctx);
+  ASSERT_TRUE(result.ok()) << result.status().ToString();
+  auto greetings = std::static_pointer_cast<arrow::StringArray>(
+    result.ValueOrDie().make_array());
+  EXPECT_EQ(greetings->GetString(0), "hello, arx");
+}
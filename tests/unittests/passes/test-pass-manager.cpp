@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+#include <llvm/Support/raw_ostream.h>
+
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+#include "../src/passes/pass-manager.h"
+
+// Check that the passes run in order and are reported
+TEST(PassManagerTest, DefaultPasses) {
+  Parser::setup();
+  string_to_buffer((char*) R""""(
+  fn scale(x):
+    var unused = 3 in
+      if 1 < 2:
+        x * (3 - 2)
+      else:
+        x * 2
+  )"""");
+  Lexer::reset();
+  auto ast = Parser::parse();
+
+  ASTPassManager pass_manager;
+  pass_manager.add_default_passes();
+  pass_manager.run(*ast);
+
+  // folded: `1 < 2` and `3 - 2`, then the branch, `x * 1` and the var
+  ExprAST* body = static_cast<FunctionAST&>(*ast->nodes[0]).body.get();
+  ASSERT_EQ(body->kind, ExprKind::VariableKind);
+
+  ASSERT_EQ(pass_manager.passes.size(), 4);
+  EXPECT_EQ(pass_manager.passes[0]->name, "constant-folding");
+  EXPECT_EQ(pass_manager.passes[0]->changes, 2);
+  EXPECT_EQ(pass_manager.passes[1]->changes, 1);
+  EXPECT_EQ(pass_manager.passes[2]->changes, 1);
+  EXPECT_EQ(pass_manager.passes[3]->changes, 1);
+
+  std::string report;
+  llvm::raw_string_ostream out(report);
+  pass_manager.print_report(out);
+  out.flush();
+  EXPECT_NE(report.find("unused-var-elimination"), std::string::npos);
+  EXPECT_NE(report.find("AST nodes: 15 -> 2"), std::string::npos) << report;
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <memory>
+
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+#include "../src/passes/simplify.h"
+
+/**
+ * @brief Parse the source and run the given pass over it.
+ *
+ */
+static auto run_pass(ASTPass& pass, const char* source)
+  -> std::unique_ptr<TreeAST> {
+  Parser::setup();
+  string_to_buffer((char*) source);
+  Lexer::reset();
+  auto ast = Parser::parse();
+  pass.run(*ast);
+  return ast;
+}
+
+/**
+ * @brief Get the body of the first function.
+ *
+ */
+static auto get_body(TreeAST& ast) -> ExprAST* {
+  return static_cast<FunctionAST&>(*ast.nodes[0]).body.get();
+}
+
+TEST(SimplifyTest, ConstantFoldingTest) {
+  ConstantFoldingPass pass;
+  auto ast = run_pass(pass, R""""(
+  fn answer():
+    (2 + 3) * 8 + 2
+  )"""");
+
+  ExprAST* body = get_body(*ast);
+  ASSERT_EQ(body->kind, ExprKind::FloatDTKind);
+  EXPECT_EQ(static_cast<FloatExprAST*>(body)->val, 42);
+  EXPECT_EQ(pass.changes, 3);
+
+  ConstantFoldingPass string_pass;
+  ast = run_pass(string_pass, R""""(
+  fn greeting(name: string) -> string:
+    "hello" + ", " + name
+  )"""");
+
+  body = get_body(*ast);
+  ASSERT_EQ(body->kind, ExprKind::BinaryOpKind);
+  auto lhs = static_cast<BinaryExprAST*>(body)->lhs.get();
+  ASSERT_EQ(lhs->kind, ExprKind::StringDTKind);
+  EXPECT_EQ(static_cast<StringExprAST*>(lhs)->val, "hello, ");
+}
+
+TEST(SimplifyTest, DeadBranchEliminationTest) {
+  DeadBranchEliminationPass pass;
+  auto ast = run_pass(pass, R""""(
+  fn pick(x):
+    if 0:
+      x + 1
+    else:
+      x
+  )"""");
+
+  ExprAST* body = get_body(*ast);
+  ASSERT_EQ(body->kind, ExprKind::VariableKind);
+  EXPECT_EQ(static_cast<VariableExprAST*>(body)->name, "x");
+  EXPECT_EQ(pass.changes, 1);
+}
+
+TEST(SimplifyTest, AlgebraicSimplificationTest) {
+  AlgebraicSimplificationPass pass;
+  auto ast = run_pass(pass, R""""(
+  @fastmath
+  fn identity(x):
+    1 * (x - 0) * 1 + 0
+
+  fn signed_zero(x):
+    var y = x * 1 in
+      y + 0
+
+  fn price(p: decimal128(10, 2)):
+    p * 1
+  )"""");
+
+  ExprAST* body = get_body(*ast);
+  ASSERT_EQ(body->kind, ExprKind::VariableKind);
+
+  // `-0 + 0` is `+0` without @fastmath
+  auto& signed_zero = static_cast<FunctionAST&>(*ast->nodes[1]);
+  ASSERT_EQ(signed_zero.body->kind, ExprKind::VarKind);
+  auto var_expr = static_cast<VarExprAST*>(signed_zero.body.get());
+  EXPECT_EQ(var_expr->var_names[0].second->kind, ExprKind::VariableKind);
+  EXPECT_EQ(var_expr->body->kind, ExprKind::BinaryOpKind);
+
+  // the scale of a decimal depends on the literal
+  auto& price = static_cast<FunctionAST&>(*ast->nodes[2]);
+  EXPECT_EQ(price.body->kind, ExprKind::BinaryOpKind);
+  EXPECT_EQ(pass.changes, 5);
+}
+
+TEST(SimplifyTest, UnusedVarEliminationTest) {
+  UnusedVarEliminationPass pass;
+  auto ast = run_pass(pass, R""""(
+  fn unused(x):
+    var a = 1, b = a + x, c = printd(x), d = 2 in
+      d
+  )"""");
+
+  // `c` is kept because its initializer has side effects
+  ExprAST* body = get_body(*ast);
+  ASSERT_EQ(body->kind, ExprKind::VarKind);
+  auto var_expr = static_cast<VarExprAST*>(body);
+  ASSERT_EQ(var_expr->var_names.size(), 2);
+  EXPECT_EQ(var_expr->var_names[0].first, "c");
+  EXPECT_EQ(var_expr->var_names[1].first, "d");
+  EXPECT_EQ(pass.changes, 2);
+}
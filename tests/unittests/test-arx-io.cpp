@@ -0,0 +1,84 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../src/arx-io.h"
+
+/**
+ * @brief Format the float with arx_format_float.
+ *
+ */
+static auto format(float value, bool is_fixed) -> std::string {
+  char text[64];
+  char* end = arx_format_float(text, text + sizeof(text), value, is_fixed);
+  return std::string(text, end);
+}
+
+/**
+ * @brief Read the content of the file from the start.
+ *
+ */
+static auto read_all(FILE* file) -> std::string {
+  std::string content;
+  char text[256];
+  size_t size = 0;
+  rewind(file);
+  while ((size = fread(text, 1, sizeof(text), file)) > 0) {
+    content.append(text, size);
+  }
+  return content;
+}
+
+TEST(IOTest, FormatTest) {
+  // the shortest text that reads back to the same float
+  EXPECT_EQ(format(0.1f, false), "0.1");
+  EXPECT_EQ(format(1.0f, false), "1");
+  EXPECT_EQ(format(-2.5f, false), "-2.5");
+  EXPECT_EQ(format(1e30f, false), "1e+30");
+
+  float value = 1.0f;
+  for (int i = 0; i < 1000; ++i) {
+    value = value * 1.37f + 0.001f * static_cast<float>(i);
+    if (value > 1e30f) {
+      value = 1.0f / value;
+    }
+    EXPECT_EQ(strtof(format(value, false).c_str(), nullptr), value);
+  }
+
+  // the fixed format is the one of "%f"
+  for (float fixed : {0.0f, 0.1f, -3.25f, 123456.789f, 3.4e38f}) {
+    char expected[64];
+    snprintf(expected, sizeof(expected), "%f", fixed);
+    EXPECT_EQ(format(fixed, true), expected);
+  }
+}
+
+TEST(IOTest, WriterTest) {
+  FILE* file = tmpfile();
+  ASSERT_NE(file, nullptr);
+
+  {
+    ArxWriter writer(file);
+    writer.write("a", 1);
+    writer.write("bc\n", 3);
+
+    // nothing is written to the stream before the flush
+    EXPECT_EQ(read_all(file), "");
+    writer.flush();
+    EXPECT_EQ(read_all(file), "abc\n");
+
+    // the text larger than the buffer is written directly
+    std::string large(ARX_IO_BUFFER_SIZE + 10, 'x');
+    fseek(file, 0, SEEK_END);
+    writer.write(large.data(), large.size());
+    EXPECT_EQ(read_all(file), "abc\n" + large);
+
+    // the writer flushes its buffer when it is destroyed
+    fseek(file, 0, SEEK_END);
+    writer.write("end", 3);
+  }
+  EXPECT_EQ(read_all(file).substr(ARX_IO_BUFFER_SIZE + 14), "end");
+  fclose(file);
+}
@@ -0,0 +1,53 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "../src/arx-math.h"
+
+TEST(MathTest, FunctionsTest) {
+  EXPECT_EQ(arx_sqrt(16.0f), 4.0f);
+  EXPECT_EQ(arx_pow(2.0f, 10.0f), 1024.0f);
+  EXPECT_EQ(arx_floor(-1.5f), -2.0f);
+  EXPECT_EQ(arx_ceil(-1.5f), -1.0f);
+  EXPECT_EQ(arx_abs(-3.0f), 3.0f);
+  EXPECT_FLOAT_EQ(arx_exp(1.0f), 2.7182817f);
+  EXPECT_FLOAT_EQ(arx_log(arx_exp(2.0f)), 2.0f);
+  EXPECT_FLOAT_EQ(arx_sin(1.0f), std::sin(1.0f));
+  EXPECT_FLOAT_EQ(arx_cos(1.0f), std::cos(1.0f));
+  EXPECT_FLOAT_EQ(arx_tan(1.0f), std::tan(1.0f));
+  EXPECT_TRUE(std::isnan(arx_sqrt(-1.0f)));
+}
+
+TEST(MathTest, VectorFunctionsTest) {
+  // the polynomials, compared to libm
+  for (float x = -20.0f; x < 20.0f; x += 0.37f) {
+    arx_f32x4_t v = {x, x * 0.5f, x * 2.0f, x * 100.0f};
+    arx_f32x4_t a = v * v + 0.5f;
+    arx_f32x4_t exp_v = arx_exp_f32x4(v);
+    arx_f32x4_t log_a = arx_log_f32x4(a);
+    arx_f32x4_t sin_v = arx_sin_f32x4(v);
+    arx_f32x4_t cos_v = arx_cos_f32x4(v);
+    arx_f32x4_t pow_v = arx_pow_f32x4(a, v * 0.1f);
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_FLOAT_EQ(exp_v[i], std::exp(v[i]));
+      EXPECT_FLOAT_EQ(log_a[i], std::log(a[i]));
+      EXPECT_NEAR(sin_v[i], std::sin(v[i]), 1e-7f);
+      EXPECT_NEAR(cos_v[i], std::cos(v[i]), 1e-7f);
+      EXPECT_EQ(pow_v[i], std::pow(a[i], v[i] * 0.1f));
+    }
+  }
+
+  // the lanes out of the range of the polynomials
+  arx_f32x4_t special = {INFINITY, -INFINITY, NAN, 1e10f};
+  arx_f32x4_t exp_v = arx_exp_f32x4(special);
+  arx_f32x4_t log_v = arx_log_f32x4(special);
+  arx_f32x4_t sin_v = arx_sin_f32x4(special);
+  EXPECT_EQ(exp_v[0], INFINITY);
+  EXPECT_EQ(exp_v[1], 0.0f);
+  EXPECT_TRUE(std::isnan(exp_v[2]));
+  EXPECT_EQ(log_v[0], INFINITY);
+  EXPECT_TRUE(std::isnan(log_v[1]));
+  EXPECT_EQ(arx_log_f32x4(arx_f32x4_t{})[0], -INFINITY);
+  EXPECT_TRUE(std::isnan(sin_v[0]));
+  EXPECT_EQ(sin_v[3], std::sin(1e10f));
+}
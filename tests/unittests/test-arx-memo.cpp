@@ -0,0 +1,85 @@
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../src/arx-memo.h"
+
+TEST(MemoTableTest, LookupInsert) {
+  const int32_t capacity = 16;
+  std::vector<int64_t> table(
+    static_cast<size_t>(arx_memo_table_size(capacity, 2)), 0);
+
+  int64_t key[2] = {1, 2};
+  int64_t other[2] = {2, 1};
+  int64_t value = 0;
+
+  EXPECT_EQ(arx_memo_lookup(table.data(), capacity, 2, key, &value), 0);
+
+  arx_memo_insert(table.data(), capacity, 2, key, 42);
+  EXPECT_EQ(arx_memo_lookup(table.data(), capacity, 2, key, &value), 1);
+  EXPECT_EQ(value, 42);
+  EXPECT_EQ(arx_memo_lookup(table.data(), capacity, 2, other, &value), 0);
+
+  // the value of a key is replaced
+  arx_memo_insert(table.data(), capacity, 2, key, 7);
+  EXPECT_EQ(arx_memo_lookup(table.data(), capacity, 2, key, &value), 1);
+  EXPECT_EQ(value, 7);
+}
+
+// Check that the table keeps working when there are more keys than entries
+TEST(MemoTableTest, Bounded) {
+  const int32_t capacity = 8;
+  std::vector<int64_t> table(
+    static_cast<size_t>(arx_memo_table_size(capacity, 1)), 0);
+
+  for (int64_t i = 0; i < 100; ++i) {
+    arx_memo_insert(table.data(), capacity, 1, &i, i * 10);
+  }
+
+  int found = 0;
+  for (int64_t i = 0; i < 100; ++i) {
+    int64_t value = -1;
+    if (arx_memo_lookup(table.data(), capacity, 1, &i, &value)) {
+      EXPECT_EQ(value, i * 10);
+      ++found;
+    }
+  }
+  EXPECT_GT(found, 0);
+  EXPECT_LE(found, capacity);
+
+  int64_t last = 99;
+  int64_t value = -1;
+  EXPECT_EQ(arx_memo_lookup(table.data(), capacity, 1, &last, &value), 1);
+  EXPECT_EQ(value, 990);
+}
+
+TEST(MemoTableTest, ThreadSafe) {
+  const int32_t capacity = 1024;
+  std::vector<int64_t> table(
+    static_cast<size_t>(arx_memo_table_size(capacity, 1)), 0);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&table]() {
+      for (int64_t i = 0; i < 512; ++i) {
+        int64_t value = 0;
+        if (!arx_memo_lookup_sync(table.data(), capacity, 1, &i, &value)) {
+          arx_memo_insert_sync(table.data(), capacity, 1, &i, i * i);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(table[0], 0);
+  for (int64_t i = 0; i < 512; ++i) {
+    int64_t value = -1;
+    if (arx_memo_lookup(table.data(), capacity, 1, &i, &value)) {
+      EXPECT_EQ(value, i * i);
+    }
+  }
+}
@@ -0,0 +1,55 @@
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../src/arx-parallel.h"
+
+/**
+ * @brief Sum the iterations, and count them in the environment.
+ *
+ */
+static auto sum_iterations(void* env, int64_t begin, int64_t end) -> float {
+  auto counts = static_cast<std::vector<std::atomic<int>>*>(env);
+  float sum = 0;
+  for (int64_t i = begin; i < end; ++i) {
+    (*counts)[static_cast<size_t>(i)]++;
+    sum += static_cast<float>(i);
+  }
+  return sum;
+}
+
+/**
+ * @brief Run a nested parallel loop in each iteration.
+ *
+ */
+static auto nested(void*, int64_t begin, int64_t end) -> float {
+  float sum = 0;
+  for (int64_t i = begin; i < end; ++i) {
+    std::vector<std::atomic<int>> counts(100);
+    sum += arx_parfor(sum_iterations, &counts, 100, ARX_REDUCE_ADD);
+  }
+  return sum;
+}
+
+// Check that each iteration runs once
+TEST(ParallelTest, Iterations) {
+  std::vector<std::atomic<int>> counts(1000);
+
+  float sum = arx_parfor(sum_iterations, &counts, 1000, ARX_REDUCE_ADD);
+
+  EXPECT_EQ(sum, 499500.0f);
+  for (auto& count : counts) {
+    EXPECT_EQ(count.load(), 1);
+  }
+
+  EXPECT_EQ(arx_parfor(sum_iterations, &counts, 0, ARX_REDUCE_ADD), 0.0f);
+  EXPECT_EQ(arx_parfor(sum_iterations, &counts, 0, ARX_REDUCE_MUL), 1.0f);
+  EXPECT_EQ(arx_parfor(sum_iterations, &counts, 10, ARX_REDUCE_NONE), 0.0f);
+}
+
+// Check that the workers run nested loops without blocking
+TEST(ParallelTest, Nested) {
+  EXPECT_EQ(arx_parfor(nested, nullptr, 64, ARX_REDUCE_ADD), 64 * 4950.0f);
+}
@@ -0,0 +1,58 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "../src/arx-string.h"
+
+static auto make_string(const std::string& s) -> arx_string_t {
+  return arx_string_view(s.data(), static_cast<int64_t>(s.size()));
+}
+
+static auto to_string(arx_string_t value) -> std::string {
+  ArxString s = ArxString::from_value(value);
+  return std::string(s.data(), static_cast<size_t>(s.length));
+}
+
+TEST(StringsTest, LayoutTest) {
+  EXPECT_EQ(sizeof(ArxString), 16);
+  EXPECT_EQ(make_string(""), 0);
+
+  // short strings are inlined, long strings point to the data
+  std::string text = "a long string value";
+  ArxString inline_string = ArxString::from_value(make_string("short"));
+  ArxString long_string = ArxString::from_value(make_string(text));
+
+  EXPECT_TRUE(inline_string.is_inline());
+  EXPECT_EQ(inline_string.length, 5);
+  EXPECT_FALSE(long_string.is_inline());
+  EXPECT_EQ(long_string.ptr, text.data());
+  EXPECT_EQ(std::string(long_string.prefix, 4), "a lo");
+}
+
+TEST(StringsTest, OperationsTest) {
+  std::string text = "hello, world!";
+  arx_string_t hello = make_string(text);
+
+  EXPECT_EQ(str_len(hello), 13);
+  EXPECT_EQ(str_find(hello, make_string("world")), 7);
+  EXPECT_EQ(str_find(hello, make_string("arx")), -1);
+  EXPECT_EQ(to_string(str_slice(hello, 7, 12)), "world");
+  EXPECT_EQ(to_string(str_slice(hello, 5, 100)), ", world!");
+  EXPECT_EQ(to_string(str_slice(hello, 10, 2)), "");
+
+  // slices of long strings are views of the same data
+  arx_string_t tail = str_slice(hello, 0, 13);
+  EXPECT_EQ(ArxString::from_value(tail).ptr, text.data());
+
+  arx_string_t concat = arx_string_concat(hello, make_string(" bye"));
+  EXPECT_EQ(to_string(concat), "hello, world! bye");
+  EXPECT_EQ(to_string(arx_string_concat(make_string("ab"), 0)), "ab");
+
+  EXPECT_EQ(str_eq(concat, make_string("hello, world! bye")), 1);
+  EXPECT_EQ(str_eq(make_string("abc"), make_string("abd")), 0);
+  EXPECT_LT(arx_string_compare(make_string("abc"), make_string("abd")), 0);
+  EXPECT_GT(arx_string_compare(hello, make_string("hello")), 0);
+  EXPECT_EQ(arx_string_compare(hello, make_string(text)), 0);
+
+  get_string_arena().reset();
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include "../src/datatypes.h"
+#include "../src/parser.h"
+
+TEST(DataTypesTest, TypeKindTest) {
+  EXPECT_EQ(get_type_kind("float"), ExprKind::FloatDTKind);
+  EXPECT_EQ(get_type_kind("date32"), ExprKind::Date32DTKind);
+  EXPECT_EQ(get_type_kind("timestamp"), ExprKind::TimestampDTKind);
+  EXPECT_EQ(get_type_kind("decimal128(18,2)"), ExprKind::Decimal128DTKind);
+  EXPECT_EQ(get_type_kind("unknown"), ExprKind::GenericKind);
+
+  EXPECT_TRUE(is_temporal_type("time64"));
+  EXPECT_FALSE(is_temporal_type("decimal256(40,2)"));
+  EXPECT_TRUE(is_decimal_type("decimal256(40,2)"));
+  EXPECT_EQ(get_type_kind("string"), ExprKind::StringDTKind);
+  EXPECT_TRUE(is_string_type("binary"));
+  EXPECT_FALSE(is_string_type("float"));
+}
+
+TEST(DataTypesTest, PhysicalLayoutTest) {
+  EXPECT_EQ(get_type_bit_width("date32"), 32);
+  EXPECT_EQ(get_type_bit_width("date64"), 64);
+  EXPECT_EQ(get_type_bit_width("decimal128(18,2)"), 128);
+  EXPECT_EQ(get_type_bit_width("decimal256(40,2)"), 256);
+  EXPECT_EQ(get_type_bit_width("string"), 128);
+  EXPECT_EQ(get_temporal_ticks_per_day("date32"), 1);
+  EXPECT_EQ(get_temporal_ticks_per_day("timestamp"), 86400000000LL);
+}
+
+TEST(DataTypesTest, DecimalTest) {
+  EXPECT_EQ(get_decimal_precision("decimal128(18,2)"), 18);
+  EXPECT_EQ(get_decimal_scale("decimal128(18,2)"), 2);
+  EXPECT_EQ(get_decimal_precision("decimal256"), DECIMAL256_MAX_PRECISION);
+  EXPECT_EQ(get_decimal_type_name(18, 2), "decimal128(18,2)");
+  EXPECT_EQ(get_decimal_type_name(39, 4), "decimal256(39,4)");
+  EXPECT_EQ(get_literal_scale("1.050"), 3);
+  EXPECT_EQ(get_literal_scale("7"), 0);
+}
+
+TEST(DataTypesTest, VectorTest) {
+  EXPECT_EQ(get_type_kind("f32x8"), ExprKind::VectorDTKind);
+  EXPECT_TRUE(is_vector_type("i64x2"));
+  EXPECT_TRUE(is_float_vector_type("f64x4"));
+  EXPECT_FALSE(is_float_vector_type("i8x16"));
+  EXPECT_FALSE(is_vector_type("f16x8"));
+  EXPECT_FALSE(is_vector_type("f32x3"));
+  EXPECT_FALSE(is_vector_type("f32x128"));
+  EXPECT_FALSE(is_vector_type("fx4"));
+  EXPECT_FALSE(is_vector_type("i32x"));
+  EXPECT_EQ(get_vector_lanes("i32x16"), 16);
+  EXPECT_EQ(get_vector_element_bit_width("i16x8"), 16);
+  EXPECT_EQ(get_type_bit_width("f32x8"), 256);
+  EXPECT_EQ(get_vector_type_name("f32x8", 4), "f32x4");
+}
+
+TEST(DataTypesTest, ArrayTest) {
+  Parser::setup();
+  Parser::struct_fields["Point"] = {{"x", "float"}, {"y", "float"}};
+
+  EXPECT_EQ(get_type_kind("Point"), ExprKind::RecordDTKind);
+  EXPECT_EQ(get_record_field_index("Point", "y"), 1);
+  EXPECT_EQ(get_type_kind("float[8]"), ExprKind::ArrayDTKind);
+  EXPECT_TRUE(is_array_type("Point[16]@soa"));
+  EXPECT_TRUE(is_soa_array_type("Point[16]@soa"));
+  EXPECT_FALSE(is_soa_array_type("Point[16]"));
+  EXPECT_FALSE(is_array_type("float"));
+  EXPECT_EQ(get_array_element_type("Point[16]@soa"), "Point");
+  EXPECT_EQ(get_array_length("i64[100]"), 100);
+  EXPECT_EQ(get_array_type_name("Point", 4, true), "Point[4]@soa");
+  EXPECT_EQ(get_array_type_name("f64x4", 4, false), "f64x4[4]");
+}
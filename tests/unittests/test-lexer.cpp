@@ -14,6 +14,8 @@ TEST(LexerTest, TokenNameTest) {
   EXPECT_EQ(Lexer::get_tok_name(tok_identifier), "identifier");
   EXPECT_EQ(Lexer::get_tok_name(tok_if), "if");
   EXPECT_EQ(Lexer::get_tok_name(tok_for), "for");
+  EXPECT_EQ(Lexer::get_tok_name(tok_parfor), "parfor");
+  EXPECT_EQ(Lexer::get_tok_name(tok_struct), "struct");
   EXPECT_EQ(Lexer::get_tok_name('+'), "+");
 }
 
@@ -93,3 +95,33 @@ TEST(LexerTest, GetTokTest) {
   EXPECT_EQ(Lexer::gettok(), (int) ')');
   EXPECT_EQ(Lexer::gettok(), (int) ';');
 }
+
+TEST(LexerTest, GetTokAccessTest) {
+  string_to_buffer((char*) "struct P: x\nps[1].x + .5");
+  Lexer::reset();
+
+  EXPECT_EQ(Lexer::gettok(), tok_struct);
+  EXPECT_EQ(Lexer::gettok(), tok_identifier);
+  EXPECT_EQ(Lexer::gettok(), (int) ':');
+  EXPECT_EQ(Lexer::gettok(), tok_identifier);
+  EXPECT_EQ(Lexer::gettok(), tok_identifier);
+  EXPECT_EQ(Lexer::gettok(), (int) '[');
+  EXPECT_EQ(Lexer::gettok(), tok_float_literal);
+  EXPECT_EQ(Lexer::gettok(), (int) ']');
+  EXPECT_EQ(Lexer::gettok(), (int) '.');
+  EXPECT_EQ(Lexer::gettok(), tok_identifier);
+  EXPECT_EQ(Lexer::gettok(), (int) '+');
+  EXPECT_EQ(Lexer::gettok(), tok_float_literal);
+  EXPECT_EQ(Lexer::num_float, 0.5);
+}
+
+TEST(LexerTest, GetTokStringTest) {
+  string_to_buffer((char*) R""""("abc" "a\tb\"c\x41" "unclosed)"""");
+  Lexer::reset();
+
+  EXPECT_EQ(Lexer::gettok(), tok_string_literal);
+  EXPECT_EQ(Lexer::string_str, "abc");
+  EXPECT_EQ(Lexer::gettok(), tok_string_literal);
+  EXPECT_EQ(Lexer::string_str, "a\tb\"cA");
+  EXPECT_EQ(Lexer::gettok(), (int) '"');
+}
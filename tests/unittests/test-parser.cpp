@@ -122,3 +122,63 @@ TEST(ParserTest, ParseIfExprTest) {
   Lexer::get_next_token();  // update Lexer::cur_tok
   auto expr = Parser::parse_primary();
 }
+
+TEST(ParserTest, ParseTypeAnnotationTest) {
+  string_to_buffer((char*) R""""(
+  fn add_days(d: date32, price: decimal128(18, 2)) -> timestamp:
+    d
+  )"""");
+
+  Lexer::reset();
+  Lexer::get_next_token();  // update Lexer::cur_tok
+  auto fn = Parser::parse_definition();
+  ASSERT_NE(fn, nullptr);
+  ASSERT_EQ(fn->proto->args.size(), 2);
+  EXPECT_EQ(fn->proto->args[0]->type_name, "date32");
+  EXPECT_EQ(fn->proto->args[1]->type_name, "decimal128(18,2)");
+  EXPECT_EQ(fn->proto->type_name, "timestamp");
+
+  string_to_buffer((char*) "1.10;");
+  Lexer::reset();
+  Lexer::get_next_token();
+  auto expr = Parser::parse_float_expr();
+  ASSERT_NE(expr, nullptr);
+  EXPECT_EQ(expr->literal, "1.10");
+}
+
+TEST(ParserTest, ParseCallExprTest) {
+  string_to_buffer((char*) R""""(str_slice(s, 0, "abc");)"""");
+
+  Lexer::reset();
+  Lexer::get_next_token();  // update Lexer::cur_tok
+  auto expr = Parser::parse_primary();
+  ASSERT_NE(expr, nullptr);
+  ASSERT_EQ(expr->kind, ExprKind::CallKind);
+
+  auto call = static_cast<CallExprAST*>(expr.get());
+  ASSERT_EQ(call->args.size(), 3);
+  EXPECT_EQ(call->args[2]->kind, ExprKind::StringDTKind);
+  EXPECT_EQ(static_cast<StringExprAST*>(call->args[2].get())->val, "abc");
+}
+
+TEST(ParserTest, ParseConstExprTest) {
+  string_to_buffer((char*) R""""(
+  const rate: decimal128(10, 2) = 1.05, name = "arx" in
+    rate
+  )"""");
+
+  Lexer::reset();
+  Lexer::get_next_token();  // update Lexer::cur_tok
+  auto expr = Parser::parse_primary();
+  ASSERT_NE(expr, nullptr);
+  ASSERT_EQ(expr->kind, ExprKind::ConstKind);
+
+  auto const_expr = static_cast<ConstExprAST*>(expr.get());
+  ASSERT_EQ(const_expr->const_names.size(), 2);
+  EXPECT_EQ(const_expr->const_names[0].first, "rate");
+  EXPECT_EQ(const_expr->type_names[0], "decimal128(10,2)");
+  EXPECT_EQ(const_expr->const_names[1].first, "name");
+  EXPECT_EQ(const_expr->type_names[1], "");
+  EXPECT_EQ(const_expr->const_names[1].second->kind, ExprKind::StringDTKind);
+  EXPECT_NE(const_expr->body, nullptr);
+}
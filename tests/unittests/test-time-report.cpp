@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <llvm/Analysis/CGSCCPassManager.h>
+#include <llvm/Analysis/LoopAnalysisManager.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/PassInstrumentation.h>
+#include <llvm/IR/PassManager.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "../src/io.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+#include "../src/passes/pass-manager.h"
+#include "../src/time-report.h"
+
+/**
+ * @brief Time the parsing and the AST passes of a source.
+ *
+ */
+static auto run_phases() -> void {
+  ArxTimeReport::start();
+
+  Parser::setup();
+  string_to_buffer((char*) R""""(
+  fn scale(x):
+    x * (3 - 2)
+  )"""");
+  Lexer::reset();
+
+  ArxTimeReport::begin("parse");
+  auto ast = Parser::parse();
+  ArxTimeReport::end();
+
+  ArxPhase phase("ast-passes");
+  ASTPassManager pass_manager;
+  pass_manager.add_default_passes();
+  pass_manager.run(*ast);
+}
+
+// Check the nesting of the phases and the table
+TEST(TimeReportTest, Phases) {
+  ArxTimeReport::enabled = true;
+  run_phases();
+  ArxTimeReport::enabled = false;
+
+  auto& phases = ArxTimeReport::phases;
+  ASSERT_EQ(phases.size(), 7);
+  EXPECT_EQ(phases[0].name, "parse");
+  EXPECT_EQ(phases[0].depth, 0);
+  EXPECT_EQ(phases[1].name, "lex");
+  EXPECT_EQ(phases[1].depth, 1);
+  EXPECT_GT(phases[1].time_ms, 0);
+  EXPECT_LE(phases[1].time_ms, phases[0].time_ms);
+  EXPECT_EQ(phases[2].name, "ast-passes");
+  EXPECT_EQ(phases[3].name, "constant-folding");
+  EXPECT_EQ(phases[3].depth, 1);
+  EXPECT_EQ(phases[6].name, "unused-var-elimination");
+
+  std::string report;
+  llvm::raw_string_ostream out(report);
+  ArxTimeReport::print(out);
+  out.flush();
+  EXPECT_NE(report.find("===== Compiler phases ====="), std::string::npos);
+  EXPECT_NE(report.find("%  parse\n"), std::string::npos);
+  EXPECT_NE(report.find("%    lex\n"), std::string::npos);
+  EXPECT_NE(report.find("100.0%  Total\n"), std::string::npos);
+
+  // without the options nothing is timed
+  run_phases();
+  EXPECT_TRUE(ArxTimeReport::phases.empty());
+}
+
+// Check the time of the LLVM passes
+TEST(TimeReportTest, LLVMPasses) {
+  ArxTimeReport::enabled = true;
+  ArxTimeReport::start();
+  ArxTimeReport::enabled = false;
+
+  // twice(x) = x + x
+  llvm::LLVMContext context;
+  auto module = std::make_unique<llvm::Module>("twice", context);
+  llvm::Type* float_type = llvm::Type::getFloatTy(context);
+  llvm::Function* fn = llvm::Function::Create(
+    llvm::FunctionType::get(float_type, {float_type}, false),
+    llvm::Function::ExternalLinkage,
+    "twice",
+    *module);
+  llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", fn));
+  llvm::Value* x = fn->getArg(0);
+  builder.CreateRet(builder.CreateFAdd(x, x));
+
+  llvm::LoopAnalysisManager loop_am;
+  llvm::FunctionAnalysisManager function_am;
+  llvm::CGSCCAnalysisManager cgscc_am;
+  llvm::ModuleAnalysisManager module_am;
+
+  llvm::PassInstrumentationCallbacks pic;
+  ArxTimeReport::register_callbacks(pic);
+  llvm::PassBuilder pass_builder(
+    nullptr, llvm::PipelineTuningOptions(), llvm::None, &pic);
+  pass_builder.registerModuleAnalyses(module_am);
+  pass_builder.registerCGSCCAnalyses(cgscc_am);
+  pass_builder.registerFunctionAnalyses(function_am);
+  pass_builder.registerLoopAnalyses(loop_am);
+  pass_builder.crossRegisterProxies(loop_am, function_am, cgscc_am, module_am);
+  pass_builder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2)
+    .run(*module, module_am);
+
+  std::string report;
+  llvm::raw_string_ostream out(report);
+  ArxTimeReport::print(out);
+  out.flush();
+  EXPECT_NE(report.find("Pass execution timing report"), std::string::npos);
+  EXPECT_NE(report.find("InstCombinePass"), std::string::npos);
+}
+
+// Check the Chrome trace events
+TEST(TimeReportTest, Trace) {
+  llvm::SmallString<128> path;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("arx-trace", "json", path));
+  ArxTimeReport::trace_path = path.str().str();
+  run_phases();
+  bool is_written = ArxTimeReport::write_trace();
+  ArxTimeReport::trace_path = "";
+  ASSERT_TRUE(is_written);
+
+  std::ifstream file(path.str().str());
+  std::stringstream trace;
+  trace << file.rdbuf();
+  llvm::sys::fs::remove(path);
+
+  EXPECT_NE(trace.str().find("\"traceEvents\""), std::string::npos);
+  EXPECT_NE(trace.str().find("\"name\":\"parse\""), std::string::npos);
+  EXPECT_NE(
+    trace.str().find("\"name\":\"constant-folding\""), std::string::npos);
+  // `lex` is only in the table
+  EXPECT_EQ(trace.str().find("\"name\":\"lex\""), std::string::npos);
+}